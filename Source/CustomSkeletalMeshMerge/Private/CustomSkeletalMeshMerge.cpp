@@ -5,6 +5,11 @@
 =============================================================================*/
 
 #include "CustomSkeletalMeshMerge.h"
+#include "CustomSkeletalMeshMergeDiskCache.h"
+#include "CustomSkeletalMeshMergeCache.h"
+#include "CustomSkeletalMeshMergeKernels.h"
+#include "CustomSkeletalMeshMergePool.h"
+#include "CustomSkeletalMeshMergeStats.h"
 #include "GPUSkinPublicDefs.h"
 #include "RawIndexBuffer.h"
 #include "Animation/Skeleton.h"
@@ -12,6 +17,7 @@
 #include "Engine/SkeletalMeshSocket.h"
 #include "Rendering/SkeletalMeshRenderData.h"
 #include "Rendering/SkeletalMeshLODRenderData.h"
+#include "Hash/CityHash.h"
 
 #include "ImageUtils.h"
 #include "FileHelper.h"
@@ -30,32 +36,44 @@ static TAutoConsoleVariable<int32> CVarSaveIntermediateTextures(
 	TEXT("1: Turned On"),
 	ECVF_Default);
 
+#if SKELETALMESHMERGE_WITH_TRACE_COUNTERS
+TRACE_DECLARE_INT_COUNTER(SkeletalMeshMerge_Vertices, TEXT("SkeletalMeshMerge/Vertices"));
+TRACE_DECLARE_INT_COUNTER(SkeletalMeshMerge_Indices, TEXT("SkeletalMeshMerge/Indices"));
+TRACE_DECLARE_INT_COUNTER(SkeletalMeshMerge_Sections, TEXT("SkeletalMeshMerge/Sections"));
+TRACE_DECLARE_INT_COUNTER(SkeletalMeshMerge_Bones, TEXT("SkeletalMeshMerge/Bones"));
+TRACE_DECLARE_INT_COUNTER(SkeletalMeshMerge_AtlasTiles, TEXT("SkeletalMeshMerge/AtlasTiles"));
+#endif
+
 /**
 * Constructor
 * @param InMergeMesh - destination mesh to merge to
-* @param InSrcMeshList - array of source meshes to merge
+* @param InSrcParts - source meshes to merge, referenced until the merge is done
 * @param InForceSectionMapping - optional array to map sections from the source meshes to merged section entries
 */
 FCustomSkeletalMeshMerge::FCustomSkeletalMeshMerge(USkeletalMesh* InMergeMesh,
 	UMaterialInterface* InBaseMaterial,
-	const TArray<FSkelMeshMergePart>& InSrcMeshList,
-	const TArray<FSkelMeshMergeSectionMapping>& InForceSectionMapping,
+	TArrayView<const FSkelMeshMergePart> InSrcParts,
+	TArrayView<const FSkelMeshMergeSectionMapping> InForceSectionMapping,
 	int32 InStripTopLODs,
 	EMeshBufferAccess InMeshBufferAccess)
 	: MergeMesh(InMergeMesh)
 	, BaseMaterial(InBaseMaterial)
+	, SrcParts(InSrcParts)
 	, StripTopLODs(InStripTopLODs)
 	, MeshBufferAccess(InMeshBufferAccess)
+	, LastCommitTime(0.0)
+	, bHasCacheKey(false)
+	, bHasAtlasKey(false)
+	, bCompositeAtlas(true)
+	, AtlasCPUBytes(0)
+	, AtlasGPUBytes(0)
+	, MergedCPUBytes(0)
+	, MergedGPUBytes(0)
+	, IncrementalState(nullptr)
+	, Report(nullptr)
 	, ForceSectionMapping(InForceSectionMapping)
 {
 	check(MergeMesh);
-
-	for (int i = 0; i < InSrcMeshList.Num(); i++)
-	{
-		SrcMeshList.Add(InSrcMeshList[i].SkeletalMesh);
-		SrcMeshAttachedBoneNameList.Add(InSrcMeshList[i].AttachedBoneName);
-		VerticesTransformList.Add(InSrcMeshList[i].VerticesTransform);
-	}
 }
 
 /** Helper macro to call GenerateLODModel which requires compile time vertex type. */
@@ -88,159 +106,183 @@ FCustomSkeletalMeshMerge::FCustomSkeletalMeshMerge(USkeletalMesh* InMergeMesh,
 */
 bool FCustomSkeletalMeshMerge::DoMerge(TArray<FRefPoseOverride>* RefPoseOverrides /* = nullptr */)
 {
+	SKELETALMESHMERGE_TRACE_SCOPE(SkeletalMeshMerge_DoMerge);
+
 	MergeMaterial();
-	MergeSkeleton(RefPoseOverrides);
 
-	return FinalizeMesh();
+	if (!PrepareMerge(RefPoseOverrides))
+	{
+		return false;
+	}
+
+	CommitPreparedData(true);
+	return true;
 }
 
-namespace
+int32 FCustomSkeletalMeshMerge::GetSourceLODIdx(int32 PartIdx, int32 LODIdx) const
 {
-	void GeneratedBinnedTextureSquares(const FVector2D DestinationSize, TArray<FVector2D>& InTexureSize, TArray<FBox2D>& OutGeneratedBoxes)
+	const FSkelMeshMergePart& Part = SrcParts[PartIdx];
+	if (Part.MaxLOD != INDEX_NONE && LODIdx - StripTopLODs > Part.MaxLOD)
 	{
-		typedef FBox2D FTextureArea;
-		struct FWeightedTexture
-		{
-			FTextureArea Area;
-			int32 TextureIndex;
-			float Weight;
-		};
+		return INDEX_NONE;
+	}
+
+	const int32 NumSourceLODs = Part.SkeletalMesh->GetResourceForRendering()->LODRenderData.Num();
+	return FMath::Clamp(LODIdx + Part.LODBias, 0, NumSourceLODs - 1);
+}
 
-		TArray<FWeightedTexture> WeightedTextures;
-		const float TotalArea = DestinationSize.X * DestinationSize.Y;
-		// Generate textures with their size calculated according to their weight
-		for (int32 TextureIndex = 0; TextureIndex < InTexureSize.Num(); ++TextureIndex)
+bool FCustomSkeletalMeshMerge::PrepareMerge(TArray<FRefPoseOverride>* RefPoseOverrides /* = nullptr */)
+{
+	// Identical merges from earlier sessions can skip building the skeleton and LOD render data
+	const bool bUsePersistentCache = CanUsePersistentCache(RefPoseOverrides);
+	const double LoadStartTime = FPlatformTime::Seconds();
+	if (bUsePersistentCache &&
+		FCustomSkeletalMeshMergeDiskCache::Load(CacheKey, GetSourceGuids(), MergeMesh->Skeleton, MergedMaterial, MergedData))
+	{
+		if (Report)
 		{
-			FWeightedTexture Texture;
-			const FVector2D& TextureSize = InTexureSize[TextureIndex];
-			Texture.Area = FTextureArea(FVector2D(0.0f, 0.0f), TextureSize);
-			Texture.TextureIndex = TextureIndex;
-			Texture.Weight = TextureSize.X / DestinationSize.X;
-			WeightedTextures.Add(Texture);
+			Report->Source = ECustomSkeletalMeshMergeSource::PersistentCache;
+			Report->MergeMeshMs = (FPlatformTime::Seconds() - LoadStartTime) * 1000.0;
 		}
+		RecordSkeletalMeshMergeCsvTime(LoadStartTime);
+		return true;
+	}
+
+	PrepareSkeleton(RefPoseOverrides);
+
+	if (!PrepareMesh())
+	{
+		return false;
+	}
+
+	if (bUsePersistentCache)
+	{
+		FCustomSkeletalMeshMergeDiskCache::Save(CacheKey, GetSourceGuids(), MergedData);
+	}
+
+	return true;
+}
+
+void FCustomSkeletalMeshMerge::CommitMerge()
+{
+	check(IsInGameThread());
+	CommitPreparedData(true);
+}
+
+bool FCustomSkeletalMeshMerge::CommitPrebaked(const TArray<uint8>& Data, UMaterialInterface* Material)
+{
+	check(IsInGameThread());
+
+	// Baked data of parts that were saved again since the bake is rejected, the merge then runs at runtime
+	const double LoadStartTime = FPlatformTime::Seconds();
+	if (!FCustomSkeletalMeshMergeDiskCache::LoadFromMemory(Data.GetData(), Data.Num(), GetSourceGuids(), MergeMesh->Skeleton, Material, MergedData))
+	{
+		return false;
+	}
+	RecordSkeletalMeshMergeCsvTime(LoadStartTime);
+
+	if (Report)
+	{
+		Report->Source = ECustomSkeletalMeshMergeSource::Prebaked;
+	}
+	CommitPreparedData(true);
+	return true;
+}
+
+void FCustomSkeletalMeshMerge::RecycleRenderData()
+{
+	check(IsInGameThread());
+
+	FSkeletalMeshRenderData* Resource = MergeMesh->GetResourceForRendering();
+	if (!Resource || Resource->LODRenderData.Num() == 0)
+	{
+		return;
+	}
+
+	// the LODs are refilled off the game thread, the render thread must be done with their buffers first
+	MergeMesh->ReleaseResources();
+	MergeMesh->ReleaseResourcesFence.Wait();
+
+	MergedData.LODRenderData.Empty();
+	Exchange(MergedData.LODRenderData, Resource->LODRenderData);
+}
 
-		// Sort textures by their weight (high to low) which influences the insert order
-		WeightedTextures.Sort([](const FWeightedTexture& One, const FWeightedTexture& Two) { return One.Weight > Two.Weight; });
+void FCustomSkeletalMeshMerge::SetCacheKey(const FSHAHash& InCacheKey)
+{
+	CacheKey = InCacheKey;
+	bHasCacheKey = true;
+}
 
-		TArray<FWeightedTexture> InsertedTextures;
-		typedef FBox2D FUnusedArea;
-		TArray<FUnusedArea> UnusedAreas;
+bool FCustomSkeletalMeshMerge::CanUsePersistentCache(const TArray<FRefPoseOverride>* RefPoseOverrides) const
+{
+	// Pose overrides are not part of the content key
+	if (!bHasCacheKey || RefPoseOverrides || !FCustomSkeletalMeshMergeDiskCache::IsEnabled())
+	{
+		return false;
+	}
 
-		bool bSuccess = true;
-		do
+	// Transient meshes do not outlive the session, so their merges can not be reused
+	for (const FSkelMeshMergePart& SrcPart : SrcParts)
+	{
+		if (!SrcPart.SkeletalMesh || SrcPart.SkeletalMesh->GetOutermost() == GetTransientPackage())
 		{
-			// Reset state
-			bSuccess = true;
-			UnusedAreas.Empty();
-			InsertedTextures.Empty();
-			FUnusedArea StartArea(FVector2D(0, 0), DestinationSize);
-			UnusedAreas.Add(StartArea);
+			return false;
+		}
+	}
 
-			for (const FWeightedTexture& Texture : WeightedTextures)
-			{
-				int32 BestAreaIndex = -1;
-				float RemainingArea = FLT_MAX;
-				FVector2D TextureSize = Texture.Area.GetSize();
-				float TextureSurface = TextureSize.X * TextureSize.Y;
+	return true;
+}
 
-				// Find best area to insert this texture in (determined by tightest fit)
-				for (int32 AreaIndex = 0; AreaIndex < UnusedAreas.Num(); ++AreaIndex)
-				{
-					const FUnusedArea& UnusedArea = UnusedAreas[AreaIndex];
-					if (UnusedArea.GetSize() >= TextureSize)
-					{
-						const float Remainder = UnusedArea.GetArea() - TextureSurface;
-						if (Remainder < RemainingArea && Remainder >= 0)
-						{
-							BestAreaIndex = AreaIndex;
-							RemainingArea = Remainder;
-						}
-					}
-				}
+TArray<FGuid> FCustomSkeletalMeshMerge::GetSourceGuids() const
+{
+	TArray<FGuid> SourceGuids;
+	SourceGuids.Reserve(SrcParts.Num());
 
-				// Insert the texture in case we found an appropriate area
-				if (BestAreaIndex != -1)
-				{
-					FUnusedArea& UnusedArea = UnusedAreas[BestAreaIndex];
-					FVector2D UnusedSize = UnusedArea.GetSize();
-
-					// Push back texture
-					FWeightedTexture WeightedTexture;
-					WeightedTexture.Area = FTextureArea(UnusedArea.Min, UnusedArea.Min + TextureSize);
-					WeightedTexture.TextureIndex = Texture.TextureIndex;
-					InsertedTextures.Add(WeightedTexture);
-
-					// Generate two new resulting unused areas from splitting up the result
-					/*
-						___________
-						|	  |   |
-						|	  | V |
-						|_____|   |
-						|  H  |   |
-						|_____|___|
-					*/
-					FUnusedArea HorizontalArea, VerticalArea;
-					HorizontalArea.Min.X = UnusedArea.Min.X;
-					HorizontalArea.Min.Y = UnusedArea.Min.Y + TextureSize.Y;
-					HorizontalArea.Max.X = HorizontalArea.Min.X + TextureSize.X;
-					HorizontalArea.Max.Y = HorizontalArea.Min.Y + (UnusedSize.Y - TextureSize.Y);
-
-					VerticalArea.Min.X = UnusedArea.Min.X + TextureSize.X;
-					VerticalArea.Min.Y = UnusedArea.Min.Y;
-					VerticalArea.Max.X = VerticalArea.Min.X + (UnusedSize.X - TextureSize.X);
-					VerticalArea.Max.Y = UnusedSize.Y;
-
-					// Append valid new areas to list (replace original one with either one of the new ones)
-					const bool bValidHorizontal = HorizontalArea.GetArea() > 0.0f;
-					const bool bValidVertical = VerticalArea.GetArea() > 0.0f;
-					if (bValidVertical && bValidHorizontal)
-					{
-						UnusedAreas[BestAreaIndex] = HorizontalArea;
-						UnusedAreas.Add(VerticalArea);
-					}
-					else if (bValidVertical)
-					{
-						UnusedAreas[BestAreaIndex] = VerticalArea;
-					}
-					else if (bValidHorizontal)
-					{
-						UnusedAreas[BestAreaIndex] = HorizontalArea;
-					}
-					else
-					{
-						// Make sure we remove the area entry
-						UnusedAreas.RemoveAtSwap(BestAreaIndex);
-					}
-				}
-				else
-				{
-					bSuccess = false;
-					break;
-				}
-			}
+	for (const FSkelMeshMergePart& SrcPart : SrcParts)
+	{
+		SourceGuids.Add(SrcPart.SkeletalMesh ? SrcPart.SkeletalMesh->GetOutermost()->GetGuid() : FGuid());
+	}
 
-			// This means we failed to find a fit, in this case we resize the textures and try again until we find one
-			if (bSuccess == false)
-			{
-				for (FWeightedTexture& Texture : WeightedTextures)
-				{
-					Texture.Area.Max *= .99f;
-				}
-			}
-		} while (!bSuccess);
+	return SourceGuids;
+}
+
+void FCustomSkeletalMeshMerge::CommitPreparedData(bool bIncludeSkeleton)
+{
+	SKELETALMESHMERGE_TRACE_SCOPE(SkeletalMeshMerge_Commit);
 
-		// Now generate boxes
-		OutGeneratedBoxes.Empty(InTexureSize.Num());
-		OutGeneratedBoxes.AddZeroed(InTexureSize.Num());
+	const double StartTime = FPlatformTime::Seconds();
 
-		// Generate boxes according to the inserted textures
-		for (const FWeightedTexture& Texture : InsertedTextures)
+	// the LOD render data moves to the merge mesh on commit
+	if (Report)
+	{
+		Report->LODs.Reset(MergedData.LODRenderData.Num());
+		for (const FSkeletalMeshLODRenderData& LODData : MergedData.LODRenderData)
 		{
-			FBox2D& Box = OutGeneratedBoxes[Texture.TextureIndex];
-			Box = Texture.Area;
+			const FRawStaticIndexBuffer16or32Interface* IndexBuffer = LODData.MultiSizeIndexContainer.GetIndexBuffer();
+			FCustomSkeletalMeshMergeLODReport& LODReport = Report->LODs[Report->LODs.AddDefaulted()];
+			LODReport.NumVertices = LODData.StaticVertexBuffers.PositionVertexBuffer.GetNumVertices();
+			LODReport.NumIndices = IndexBuffer ? IndexBuffer->Num() : 0;
+			LODReport.NumSections = LODData.RenderSections.Num();
+			LODReport.NumBones = LODData.ActiveBoneIndices.Num();
 		}
 	}
 
+	if (bIncludeSkeleton)
+	{
+		CommitSkeleton();
+	}
+	CommitMesh();
+
+	LastCommitTime = FPlatformTime::Seconds() - StartTime;
+	if (Report)
+	{
+		Report->CommitMs = LastCommitTime * 1000.0;
+	}
+	UE_LOG(LogSkeletalMesh, Verbose, TEXT("FCustomSkeletalMeshMerge: Commit to %s took %.3f ms"), *MergeMesh->GetName(), LastCommitTime * 1000.0);
+}
+
+namespace
+{
 	UTexture2D* CreateCompositeTexture(UObject* WorldContextObject, const FIntPoint& Size, bool bNormal,
 		const TArray<UTexture*>* Textures, const TArray<FBox2D>* Boxes)
 	{
@@ -296,6 +338,55 @@ namespace
 
 		return DestinationTexture;
 	}
+
+	/** Bytes of mip data a texture keeps in CPU memory */
+	SIZE_T GetTextureCPUSize(const UTexture2D* Texture)
+	{
+		SIZE_T CPUBytes = 0;
+
+		if (Texture->PlatformData)
+		{
+			for (const FTexture2DMipMap& Mip : Texture->PlatformData->Mips)
+			{
+				if (Mip.BulkData.IsBulkDataLoaded())
+				{
+					CPUBytes += Mip.BulkData.GetBulkDataSize();
+				}
+			}
+		}
+
+		return CPUBytes;
+	}
+
+	/** Exact size of the buffers of a merged LOD, CPU copies are only counted if they are kept */
+	void GetLODRenderDataSize(const FSkeletalMeshLODRenderData& LODData, bool bNeedsCPUAccess, SIZE_T& OutCPUBytes, SIZE_T& OutGPUBytes)
+	{
+		const FStaticMeshVertexBuffers& VertexBuffers = LODData.StaticVertexBuffers;
+		const FRawStaticIndexBuffer16or32Interface* IndexBuffer = LODData.MultiSizeIndexContainer.GetIndexBuffer();
+
+		const SIZE_T StreamBytes =
+			(SIZE_T)VertexBuffers.PositionVertexBuffer.GetNumVertices() * VertexBuffers.PositionVertexBuffer.GetStride() +
+			VertexBuffers.StaticMeshVertexBuffer.GetTangentSize() +
+			VertexBuffers.StaticMeshVertexBuffer.GetTexCoordSize() +
+			(SIZE_T)VertexBuffers.ColorVertexBuffer.GetNumVertices() * VertexBuffers.ColorVertexBuffer.GetStride() +
+			LODData.SkinWeightVertexBuffer.GetVertexDataSize() +
+			(IndexBuffer ? (SIZE_T)IndexBuffer->Num() * LODData.MultiSizeIndexContainer.GetDataTypeSize() : 0);
+
+		SIZE_T SectionBytes = 0;
+		for (const FSkelMeshRenderSection& Section : LODData.RenderSections)
+		{
+			const SIZE_T DupVertBytes =
+				(SIZE_T)Section.DuplicatedVerticesBuffer.DupVertData.Num() * sizeof(uint32) +
+				(SIZE_T)Section.DuplicatedVerticesBuffer.DupVertIndexData.Num() * sizeof(FIndexLengthPair);
+
+			OutGPUBytes += DupVertBytes;
+			SectionBytes += DupVertBytes + Section.BoneMap.GetAllocatedSize();
+		}
+
+		OutGPUBytes += StreamBytes;
+		OutCPUBytes += SectionBytes + LODData.RequiredBones.GetAllocatedSize() + LODData.ActiveBoneIndices.GetAllocatedSize() +
+			(bNeedsCPUAccess ? StreamBytes : 0);
+	}
 }
 
 const int MaterialPropertyCount = 2; // BaseColor, Normap
@@ -312,15 +403,19 @@ const bool MaterialPropertyIsNormal[MaterialPropertyCount] = { false, true, };
 
 void FCustomSkeletalMeshMerge::MergeMaterial()
 {
+	SCOPE_CYCLE_COUNTER(STAT_SkeletalMeshMerge_MergeMaterial);
+	SKELETALMESHMERGE_TRACE_SCOPE(SkeletalMeshMerge_MergeMaterial);
+	const double StartTime = FPlatformTime::Seconds();
+
 	typedef TPair<int32, int32> FMeshSectionKey; // MeshIdx, MtlIdx
 	TArray<UMaterialInterface*> MaterialList; // ʶ
 	TMap<FMeshSectionKey, int32> MeshSectionToMaterialList; // ͨMeshSectionҲ
 	TArray<FVector2D> TextureSize; // ʵȨ
 
 	// ռв
-	for (int32 MeshIdx = 0; MeshIdx < SrcMeshList.Num(); MeshIdx++)
+	for (int32 MeshIdx = 0; MeshIdx < SrcParts.Num(); MeshIdx++)
 	{
-		USkeletalMesh* SrcMesh = SrcMeshList[MeshIdx];
+		USkeletalMesh* SrcMesh = SrcParts[MeshIdx].SkeletalMesh;
 		for (int32 MtlIdx = 0; MtlIdx < SrcMesh->Materials.Num(); MtlIdx++)
 		{
 			FSkeletalMaterial& Material = SrcMesh->Materials[MtlIdx];
@@ -333,11 +428,63 @@ void FCustomSkeletalMeshMerge::MergeMaterial()
 			UTexture2D* MainTexture2D = Cast<UTexture2D>(MainTexture);
 			check(MainTexture2D);
 			TextureSize.Add(FVector2D(MainTexture2D->GetSizeX(), MainTexture2D->GetSizeY()));
+		}
+	}
+
+	// λ
+	TArray<FBox2D> UVBoxes;
+	{
+		SCOPE_CYCLE_COUNTER(STAT_SkeletalMeshMerge_AtlasPacking);
+		SKELETALMESHMERGE_TRACE_SCOPE(SkeletalMeshMerge_AtlasPacking);
+		SkelMeshMergeKernels::GeneratedBinnedTextureSquares(MaterialPropertyTextureSize[0], TextureSize, UVBoxes);
+	}
+
+	AtlasMaterials = MaterialList;
+	AtlasBoxes = UVBoxes;
+
+	if (Report)
+	{
+		// packing shrinks every texture by the same factor until they fit
+		const FVector2D AtlasSize(MaterialPropertyTextureSize[0]);
+		float CoveredArea = 0.0f;
+		float MinScale = 1.0f;
+		for (int32 MaterialIndex = 0; MaterialIndex < UVBoxes.Num(); MaterialIndex++)
+		{
+			CoveredArea += UVBoxes[MaterialIndex].GetArea();
+			if (TextureSize[MaterialIndex].X > 0.0f)
+			{
+				MinScale = FMath::Min(MinScale, UVBoxes[MaterialIndex].GetSize().X / TextureSize[MaterialIndex].X);
+			}
+		}
+		Report->AtlasOccupancy = CoveredArea / (AtlasSize.X * AtlasSize.Y);
+		Report->AtlasScale = MinScale;
+	}
+
+	// Reuse the atlas of an identical material list
+	FCustomSkeletalMeshMergeCache& MergeCache = FCustomSkeletalMeshMergeCache::Get();
+	bHasAtlasKey = bCompositeAtlas && FCustomSkeletalMeshMergeCache::IsEnabled();
+	MergedMaterial = nullptr;
+	AtlasCPUBytes = 0;
+	AtlasGPUBytes = 0;
+
+	if (bHasAtlasKey)
+	{
+		AtlasKey = FCustomSkeletalMeshMergeCache::ComputeAtlasKey(BaseMaterial, MaterialList);
+		MergedMaterial = MergeCache.FindAtlas(AtlasKey);
+	}
+
+	if (!MergedMaterial && bCompositeAtlas)
+	{
+		// Force load textures used by the source materials
+		const double WaitStartTime = FPlatformTime::Seconds();
+		for (UMaterialInterface* Material : MaterialList)
+		{
+			SCOPE_CYCLE_COUNTER(STAT_SkeletalMeshMerge_StreamingWait);
+			SKELETALMESHMERGE_TRACE_SCOPE(SkeletalMeshMerge_StreamingWait);
 
 			TArray<UTexture*> MaterialTextures;
-			Material.MaterialInterface->GetUsedTextures(MaterialTextures, EMaterialQualityLevel::Num, true, GMaxRHIFeatureLevel, true);
+			Material->GetUsedTextures(MaterialTextures, EMaterialQualityLevel::Num, true, GMaxRHIFeatureLevel, true);
 
-			// Force load materials used by the current material
 			for (UTexture* Texture : MaterialTextures)
 			{
 				if (Texture != NULL)
@@ -351,40 +498,58 @@ void FCustomSkeletalMeshMerge::MergeMaterial()
 				}
 			}
 		}
-	}
-
-	// λ
-	TArray<FBox2D> UVBoxes;
-	GeneratedBinnedTextureSquares(MaterialPropertyTextureSize[0], TextureSize, UVBoxes);
+		if (Report)
+		{
+			Report->TextureWaitMs = (FPlatformTime::Seconds() - WaitStartTime) * 1000.0;
+		}
+		CSV_CUSTOM_STAT(SkeletalMeshMerge, TextureWaitMs, (float)((FPlatformTime::Seconds() - WaitStartTime) * 1000.0), ECsvCustomStatOp::Accumulate);
 
-	// 
-	MergedMaterial = UMaterialInstanceDynamic::Create(BaseMaterial, nullptr);
-	checkf(MergedMaterial, TEXT("Failed to create material"));
+		// 
+		MergedMaterial = UMaterialInstanceDynamic::Create(BaseMaterial, nullptr);
+		checkf(MergedMaterial, TEXT("Failed to create material"));
 
-	// ÿMaterialProperty
-	for (int32 PropertyIndex = 0; PropertyIndex < MaterialPropertyCount; PropertyIndex++)
-	{
-		// ռ
-		TArray<UTexture*> Textures;
-		Textures.AddDefaulted(MaterialList.Num());
-		for (int32 MaterialIndex = 0; MaterialIndex < MaterialList.Num(); MaterialIndex++)
+		// ÿMaterialProperty
+		for (int32 PropertyIndex = 0; PropertyIndex < MaterialPropertyCount; PropertyIndex++)
 		{
-			UMaterialInterface* Material = MaterialList[MaterialIndex];
-			Material->GetTextureParameterValue(MaterialPropertyTextureNames[PropertyIndex], Textures[MaterialIndex]);
-		}
+			// ռ
+			TArray<UTexture*> Textures;
+			Textures.AddDefaulted(MaterialList.Num());
+			for (int32 MaterialIndex = 0; MaterialIndex < MaterialList.Num(); MaterialIndex++)
+			{
+				UMaterialInterface* Material = MaterialList[MaterialIndex];
+				Material->GetTextureParameterValue(MaterialPropertyTextureNames[PropertyIndex], Textures[MaterialIndex]);
+			}
+
+			// ϲ
+			UTexture2D* CompositeTexture = nullptr;
+			{
+				SCOPE_CYCLE_COUNTER(STAT_SkeletalMeshMerge_Compositing);
+				SKELETALMESHMERGE_TRACE_SCOPE(SkeletalMeshMerge_Compositing);
+				SKELETALMESHMERGE_LLM_SCOPE(Atlas);
+				CompositeTexture = CreateCompositeTexture(GEngine->GetWorld(),
+					MaterialPropertyTextureSize[PropertyIndex], MaterialPropertyIsNormal[PropertyIndex], &Textures, &UVBoxes);
+			}
 
-		// ϲ
-		UTexture2D* CompositeTexture = CreateCompositeTexture(GEngine->GetWorld(),
-			MaterialPropertyTextureSize[PropertyIndex], MaterialPropertyIsNormal[PropertyIndex], &Textures, &UVBoxes);
+			MergedMaterial->SetTextureParameterValue(MaterialPropertyTextureNames[PropertyIndex], CompositeTexture);
+
+			if (CompositeTexture)
+			{
+				AtlasCPUBytes += GetTextureCPUSize(CompositeTexture);
+				AtlasGPUBytes += CompositeTexture->CalcTextureMemorySizeEnum(TMC_AllMips);
+			}
+		}
 
-		MergedMaterial->SetTextureParameterValue(MaterialPropertyTextureNames[PropertyIndex], CompositeTexture);
+		if (bHasAtlasKey)
+		{
+			MergeCache.AddAtlas(AtlasKey, MergedMaterial, AtlasCPUBytes, AtlasGPUBytes);
+		}
 	}
 
 	// 洢UVTransformMeshMergeʹ
-	UVTransformsPerMesh.AddDefaulted(SrcMeshList.Num());
-	for (int32 MeshIdx = 0; MeshIdx < SrcMeshList.Num(); MeshIdx++)
+	UVTransformsPerMesh.AddDefaulted(SrcParts.Num());
+	for (int32 MeshIdx = 0; MeshIdx < SrcParts.Num(); MeshIdx++)
 	{
-		USkeletalMesh* SrcMesh = SrcMeshList[MeshIdx];
+		USkeletalMesh* SrcMesh = SrcParts[MeshIdx].SkeletalMesh;
 		for (int32 MtlIdx = 0; MtlIdx < SrcMesh->Materials.Num(); MtlIdx++)
 		{
 			int MaterialDataIndex = *MeshSectionToMaterialList.Find(FMeshSectionKey(MeshIdx, MtlIdx));
@@ -395,37 +560,117 @@ void FCustomSkeletalMeshMerge::MergeMaterial()
 			UVTransformsPerMesh[MeshIdx].Add(Transform);
 		}
 	}
+
+	if (Report)
+	{
+		Report->MergeMaterialMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	}
+	RecordSkeletalMeshMergeCsvTime(StartTime);
+
+	// shared atlases were counted by the merge that composited them
+	CSV_CUSTOM_STAT(SkeletalMeshMerge, ProducedKB, (float)((AtlasCPUBytes + AtlasGPUBytes) / 1024.0), ECsvCustomStatOp::Accumulate);
+}
+
+void FCustomSkeletalMeshMerge::GetAtlasLayout(FCustomSkeletalMeshMergeAtlasLayout& OutLayout) const
+{
+	OutLayout.BaseMaterial = BaseMaterial;
+	OutLayout.Materials = AtlasMaterials;
+	OutLayout.Boxes = AtlasBoxes;
+	OutLayout.Properties.Reset(MaterialPropertyCount);
+
+	for (int32 PropertyIndex = 0; PropertyIndex < MaterialPropertyCount; PropertyIndex++)
+	{
+		FCustomSkeletalMeshMergeAtlasProperty& Property = OutLayout.Properties[OutLayout.Properties.AddDefaulted()];
+		Property.TextureName = MaterialPropertyTextureNames[PropertyIndex];
+		Property.Size = MaterialPropertyTextureSize[PropertyIndex];
+		Property.bIsNormal = MaterialPropertyIsNormal[PropertyIndex];
+	}
 }
 
 void FCustomSkeletalMeshMerge::MergeSkeleton(const TArray<FRefPoseOverride>* RefPoseOverrides /* = nullptr */)
 {
-	// Release the rendering resources.
+	PrepareSkeleton(RefPoseOverrides);
+	CommitSkeleton();
+}
 
-	MergeMesh->ReleaseResources();
-	MergeMesh->ReleaseResourcesFence.Wait();
+void FCustomSkeletalMeshMerge::PrepareSkeleton(const TArray<FRefPoseOverride>* RefPoseOverrides /* = nullptr */)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SkeletalMeshMerge_MergeSkeleton);
+	SKELETALMESHMERGE_TRACE_SCOPE(SkeletalMeshMerge_MergeSkeleton);
+	const double StartTime = FPlatformTime::Seconds();
 
 	// Build the reference skeleton & sockets.
 
-	BuildReferenceSkeleton(SrcMeshList, NewRefSkeleton, MergeMesh->Skeleton);
-	BuildSockets(SrcMeshList);
+	BuildReferenceSkeleton(SrcParts, MergedData.RefSkeleton, MergeMesh->Skeleton);
+	BuildSockets(SrcParts);
 
 	// Override the reference bone poses & sockets, if specified.
 
 	if (RefPoseOverrides)
 	{
-		OverrideReferenceSkeletonPose(*RefPoseOverrides, NewRefSkeleton, MergeMesh->Skeleton);
+		OverrideReferenceSkeletonPose(*RefPoseOverrides, MergedData.RefSkeleton, MergeMesh->Skeleton);
 		OverrideMergedSockets(*RefPoseOverrides);
 	}
 
+	if (Report)
+	{
+		Report->MergeSkeletonMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	}
+	RecordSkeletalMeshMergeCsvTime(StartTime);
+}
+
+void FCustomSkeletalMeshMerge::CommitSkeleton()
+{
+	check(IsInGameThread());
+	SKELETALMESHMERGE_TRACE_SCOPE(SkeletalMeshMerge_CommitSkeleton);
+	const double StartTime = FPlatformTime::Seconds();
+
+	// Release the rendering resources.
+
+	MergeMesh->ReleaseResources();
+	MergeMesh->ReleaseResourcesFence.Wait();
+
 	// Assign new referencer skeleton.
 
-	MergeMesh->RefSkeleton = NewRefSkeleton;
+	MergeMesh->RefSkeleton = MergedData.RefSkeleton;
+
+	// Create the prepared sockets on the merged mesh. A mesh merged into before already owns sockets
+	// from its last merge, those are rewritten instead of creating new objects.
+
+	TArray<USkeletalMeshSocket*>& MeshSocketList = MergeMesh->GetMeshOnlySocketList();
+	TArray<USkeletalMeshSocket*> OwnedSockets;
+	OwnedSockets.Reserve(MeshSocketList.Num());
+	for (USkeletalMeshSocket* Socket : MeshSocketList)
+	{
+		if (Socket && Socket->GetOuter() == MergeMesh)
+		{
+			OwnedSockets.Add(Socket);
+		}
+	}
+	MeshSocketList.Reset(MergedData.Sockets.Num());
+
+	for (int32 SocketIdx = 0; SocketIdx < MergedData.Sockets.Num(); SocketIdx++)
+	{
+		const FMergedSocketInfo& SocketInfo = MergedData.Sockets[SocketIdx];
+
+		// a new socket only needs the socket properties, far cheaper than duplicating the source object
+		USkeletalMeshSocket* NewSocket = OwnedSockets.IsValidIndex(SocketIdx) ? OwnedSockets[SocketIdx] : NewObject<USkeletalMeshSocket>(MergeMesh);
+		NewSocket->bForceAlwaysAnimated = SocketInfo.bForceAlwaysAnimated;
+		NewSocket->SocketName = SocketInfo.SocketName;
+		NewSocket->BoneName = SocketInfo.BoneName;
+		NewSocket->RelativeLocation = SocketInfo.RelativeLocation;
+		NewSocket->RelativeRotation = SocketInfo.RelativeRotation;
+		NewSocket->RelativeScale = SocketInfo.RelativeScale;
+		MeshSocketList.Add(NewSocket);
+	}
 
 	// Rebuild inverse ref pose matrices here as some access patterns 
 	// may need to access these matrices before FinalizeMesh is called
 	// (which would *normally* rebuild the inv ref matrices).
 	MergeMesh->RefBasesInvMatrix.Empty();
 	MergeMesh->CalculateInvRefMatrices();
+
+	RecordSkeletalMeshMergeCsvTime(StartTime);
 }
 
 namespace
@@ -464,99 +709,246 @@ namespace
 
 		return ComponentSpaceTransforms;
 	}
-}
-
-bool FCustomSkeletalMeshMerge::FinalizeMesh()
-{
-	bool Result = true;
-
-	// Find the common maximum number of LODs available in the list of source meshes.
-
-	int32 MaxNumLODs = CalculateLodCount(SrcMeshList);
 
-	if (MaxNumLODs == -1)
+	/** @return Hash of the bone names of a reference skeleton, which is all a part's bone mapping depends on. */
+	uint64 GetRefSkeletonSignature(const FReferenceSkeleton& RefSkeleton)
 	{
-		UE_LOG(LogSkeletalMesh, Warning, TEXT("FCustomSkeletalMeshMerge: Invalid source mesh list"));
-		return false;
-	}
-
-	ReleaseResources(MaxNumLODs);
-
-	// Create a mapping from each input mesh bone to bones in the merged mesh.
-
-	TArray<FTransform> ComponentSpaceTransforms = GetComponentSpaceTransforms(NewRefSkeleton);
+		const TArray<FMeshBoneInfo>& BoneInfo = RefSkeleton.GetRawRefBoneInfo();
 
-	SrcMeshInfo.Empty();
-	SrcMeshInfo.AddZeroed(SrcMeshList.Num());
+		TArray<FName> BoneNames;
+		BoneNames.Reserve(BoneInfo.Num());
+		for (const FMeshBoneInfo& Bone : BoneInfo)
+		{
+			BoneNames.Add(Bone.Name);
+		}
+		return CityHash64((const char*)BoneNames.GetData(), BoneNames.Num() * sizeof(FName));
+	}
 
-	for (int32 MeshIdx = 0; MeshIdx < SrcMeshList.Num(); MeshIdx++)
+	/** Maps every bone of a source skeleton to the merged skeleton, falling back to a close parent or the root. */
+	void BuildSrcToDestRefSkeletonMap(const FReferenceSkeleton& SrcRefSkeleton, const FReferenceSkeleton& DestRefSkeleton, int32 AttachedBoneIndex, TArray<int32>& OutSrcToDestRefSkeletonMap)
 	{
-		USkeletalMesh* SrcMesh = SrcMeshList[MeshIdx];
-		if (SrcMesh)
+		OutSrcToDestRefSkeletonMap.SetNumUninitialized(SrcRefSkeleton.GetRawBoneNum());
+
+		for (int32 i = 0; i < SrcRefSkeleton.GetRawBoneNum(); i++)
 		{
-			if (SrcMesh->bHasVertexColors)
+			int32 DestBoneIndex = AttachedBoneIndex;
+
+			if (DestBoneIndex == INDEX_NONE)
 			{
-				MergeMesh->bHasVertexColors = true;
-#if WITH_EDITORONLY_DATA
-				MergeMesh->VertexColorGuid = FGuid::NewGuid();
-#endif
+				FName SrcBoneName = SrcRefSkeleton.GetBoneName(i);
+				DestBoneIndex = DestRefSkeleton.FindBoneIndex(SrcBoneName);
 			}
 
-			FMergeMeshInfo& MeshInfo = SrcMeshInfo[MeshIdx];
-			MeshInfo.SrcToDestRefSkeletonMap.AddUninitialized(SrcMesh->RefSkeleton.GetRawBoneNum());
+			if (DestBoneIndex == INDEX_NONE)
+			{
+				int32 ParentIndex = SrcRefSkeleton.GetParentIndex(i);
+				for (int32 j = 0; j < 3; j++)
+				{
+					if (ParentIndex == INDEX_NONE)
+						break;
 
-			FName AttachedBoneName = SrcMeshAttachedBoneNameList[MeshIdx];
-			int32 AttachedBoneIndex = NewRefSkeleton.FindBoneIndex(AttachedBoneName);
+					FName SrcBoneName = SrcRefSkeleton.GetBoneName(ParentIndex);
+					DestBoneIndex = DestRefSkeleton.FindBoneIndex(SrcBoneName);
 
-			// transform vertices
-			if (AttachedBoneIndex != INDEX_NONE)
-			{
-				TArray<FTransform> SrcBones = GetComponentSpaceTransforms(SrcMesh->RefSkeleton);
-				FTransform SrcInvTransform = FTransform::Identity;
-				if (SrcBones.Num() > 0)
-					SrcInvTransform = SrcBones[0].Inverse();
-				FTransform BindingTransform = ComponentSpaceTransforms[AttachedBoneIndex];
-				VerticesTransformList[MeshIdx] = VerticesTransformList[MeshIdx] * SrcInvTransform * BindingTransform;
+					if (DestBoneIndex == INDEX_NONE)
+						ParentIndex = SrcRefSkeleton.GetParentIndex(ParentIndex);
+					else
+						break;
+				}
 			}
 
-			// remap skin
-			for (int32 i = 0; i < SrcMesh->RefSkeleton.GetRawBoneNum(); i++)
+			if (DestBoneIndex == INDEX_NONE)
 			{
-				int32 DestBoneIndex = AttachedBoneIndex;
-
-				if (DestBoneIndex == INDEX_NONE)
-				{
-					FName SrcBoneName = SrcMesh->RefSkeleton.GetBoneName(i);
-					DestBoneIndex = NewRefSkeleton.FindBoneIndex(SrcBoneName);
-				}
+				// Missing bones shouldn't be possible, but can happen with invalid meshes;
+				// map any bone we are missing to the 'root'.
 
-				if (DestBoneIndex == INDEX_NONE)
-				{
-					int32 ParentIndex = SrcMesh->RefSkeleton.GetParentIndex(i);
-					for (int32 j = 0; j < 3; j++)
-					{
-						if (ParentIndex == INDEX_NONE)
-							break;
+				DestBoneIndex = 0;
+			}
 
-						FName SrcBoneName = SrcMesh->RefSkeleton.GetBoneName(ParentIndex);
-						DestBoneIndex = NewRefSkeleton.FindBoneIndex(SrcBoneName);
+			OutSrcToDestRefSkeletonMap[i] = DestBoneIndex;
+		}
+	}
+}
 
-						if (DestBoneIndex == INDEX_NONE)
-							ParentIndex = SrcMesh->RefSkeleton.GetParentIndex(ParentIndex);
-						else
-							break;
-					}
-				}
+static void BoneMapToNewRefSkel(const TArray<FBoneIndexType>& InBoneMap, const TArray<int32>& SrcToDestRefSkeletonMap, TArray<FBoneIndexType>& OutBoneMap)
+{
+	OutBoneMap.Empty();
+	OutBoneMap.AddUninitialized(InBoneMap.Num());
+
+	for (int32 i = 0; i < InBoneMap.Num(); i++)
+	{
+		check(InBoneMap[i] < SrcToDestRefSkeletonMap.Num());
+		OutBoneMap[i] = SrcToDestRefSkeletonMap[InBoneMap[i]];
+	}
+}
+
+/**
+* Publishes the size of a prepared merge to the stat group and, where available, to the trace counters
+*/
+static void ReportMergeCounters(const FMergedMeshData& PreparedData, int32 NumAtlasTiles)
+{
+	int32 NumVertices = 0;
+	int32 NumIndices = 0;
+	int32 NumSections = 0;
+	for (const FSkeletalMeshLODRenderData& LODData : PreparedData.LODRenderData)
+	{
+		const FRawStaticIndexBuffer16or32Interface* IndexBuffer = LODData.MultiSizeIndexContainer.GetIndexBuffer();
+		NumVertices += LODData.StaticVertexBuffers.PositionVertexBuffer.GetNumVertices();
+		NumIndices += IndexBuffer ? IndexBuffer->Num() : 0;
+		NumSections += LODData.RenderSections.Num();
+	}
+	const int32 NumBones = PreparedData.RefSkeleton.GetRawBoneNum();
+
+	INC_DWORD_STAT_BY(STAT_SkeletalMeshMerge_NumVertices, NumVertices);
+	INC_DWORD_STAT_BY(STAT_SkeletalMeshMerge_NumIndices, NumIndices);
+	INC_DWORD_STAT_BY(STAT_SkeletalMeshMerge_NumSections, NumSections);
+	INC_DWORD_STAT_BY(STAT_SkeletalMeshMerge_NumBones, NumBones);
+	INC_DWORD_STAT_BY(STAT_SkeletalMeshMerge_NumAtlasTiles, NumAtlasTiles);
+
+#if SKELETALMESHMERGE_WITH_TRACE_COUNTERS
+	TRACE_COUNTER_SET(SkeletalMeshMerge_Vertices, NumVertices);
+	TRACE_COUNTER_SET(SkeletalMeshMerge_Indices, NumIndices);
+	TRACE_COUNTER_SET(SkeletalMeshMerge_Sections, NumSections);
+	TRACE_COUNTER_SET(SkeletalMeshMerge_Bones, NumBones);
+	TRACE_COUNTER_SET(SkeletalMeshMerge_AtlasTiles, NumAtlasTiles);
+#endif
+}
+
+bool FCustomSkeletalMeshMerge::FinalizeMesh()
+{
+	if (!PrepareMesh())
+	{
+		return false;
+	}
+
+	CommitPreparedData(false);
+	return true;
+}
+
+bool FCustomSkeletalMeshMerge::PrepareMesh()
+{
+	SKELETALMESHMERGE_TRACE_SCOPE(SkeletalMeshMerge_PrepareMesh);
+	const double StartTime = FPlatformTime::Seconds();
+
+	bool Result = true;
+
+	// Find the common maximum number of LODs available in the list of source meshes.
+
+	int32 MaxNumLODs = CalculateLodCount(SrcParts);
+
+	if (MaxNumLODs == -1)
+	{
+		UE_LOG(LogSkeletalMesh, Warning, TEXT("FCustomSkeletalMeshMerge: Invalid source mesh list"));
+		return false;
+	}
+
+	// recycled LOD render data is refilled by GenerateLODModel(), LODs this merge does not produce are dropped
+	if (MergedData.LODRenderData.Num() > MaxNumLODs)
+	{
+		MergedData.LODRenderData.RemoveAt(MaxNumLODs, MergedData.LODRenderData.Num() - MaxNumLODs);
+	}
+	MergedData.LODRenderData.Reserve(MaxNumLODs);
+	MergedData.LODInfo.Reset(MaxNumLODs);
+	MergedData.Materials.Reset();
+	MergedData.bHasVertexColors = false;
+	MaterialIds.Empty();
+
+	// sections of the previous merge are matched against this one and the state only keeps the new ones
+	if (IncrementalState)
+	{
+		PreviousSections = MoveTemp(IncrementalState->Sections);
+		IncrementalState->Sections.Reset();
+		PreviousLODBuffers = MoveTemp(IncrementalState->LODBuffers);
+		IncrementalState->LODBuffers.Reset();
+		IncrementalState->NumReusedSections = 0;
+		IncrementalState->NumRebuiltSections = 0;
+	}
+
+	// Create a mapping from each input mesh bone to bones in the merged mesh.
+
+	TArray<FTransform> ComponentSpaceTransforms = GetComponentSpaceTransforms(MergedData.RefSkeleton);
+
+	SrcMeshInfo.Empty();
+	SrcMeshInfo.AddDefaulted(SrcParts.Num());
+
+	// Source meshes keep merge-ready records between merges
+	const bool bUsePartCache = FCustomSkeletalMeshMergePartCache::IsEnabled();
+	const uint64 MergedSkeletonSignature = bUsePartCache ? GetRefSkeletonSignature(MergedData.RefSkeleton) : 0;
+
+	for (int32 MeshIdx = 0; MeshIdx < SrcParts.Num(); MeshIdx++)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_SkeletalMeshMerge_BoneRemap);
+		SKELETALMESHMERGE_TRACE_SCOPE(SkeletalMeshMerge_BoneRemap);
+
+		USkeletalMesh* SrcMesh = SrcParts[MeshIdx].SkeletalMesh;
+		if (SrcMesh)
+		{
+			if (SrcMesh->bHasVertexColors)
+			{
+				MergedData.bHasVertexColors = true;
+			}
 
-				if (DestBoneIndex == INDEX_NONE)
+			FMergeMeshInfo& MeshInfo = SrcMeshInfo[MeshIdx];
+			MeshInfo.VerticesTransform = SrcParts[MeshIdx].VerticesTransform;
+			if (bUsePartCache)
+			{
+				FCustomSkeletalMeshMergePartCache& PartCache = FCustomSkeletalMeshMergePartCache::Get();
+				MeshInfo.ReadyRecord = PartCache.FindRecord(SrcMesh);
+				if (!MeshInfo.ReadyRecord.IsValid())
 				{
-					// Missing bones shouldn't be possible, but can happen with invalid meshes;
-					// map any bone we are missing to the 'root'.
+					MeshInfo.ReadyRecord = MakeShared<FSkelMeshMergeReadyRecord, ESPMode::ThreadSafe>(SrcMesh->GetResourceForRendering(), GetComponentSpaceTransforms(SrcMesh->RefSkeleton));
+					PartCache.AddRecord(SrcMesh, MeshInfo.ReadyRecord);
+				}
+			}
+
+			FName AttachedBoneName = SrcParts[MeshIdx].AttachedBoneName;
+			int32 AttachedBoneIndex = MergedData.RefSkeleton.FindBoneIndex(AttachedBoneName);
 
-					DestBoneIndex = 0;
+			// transform vertices
+			if (AttachedBoneIndex != INDEX_NONE)
+			{
+				TArray<FTransform> LocalSrcBones;
+				if (!MeshInfo.ReadyRecord.IsValid())
+				{
+					LocalSrcBones = GetComponentSpaceTransforms(SrcMesh->RefSkeleton);
 				}
+				const TArray<FTransform>& SrcBones = MeshInfo.ReadyRecord.IsValid() ? MeshInfo.ReadyRecord->GetComponentSpaceRefPose() : LocalSrcBones;
+				FTransform SrcInvTransform = FTransform::Identity;
+				if (SrcBones.Num() > 0)
+					SrcInvTransform = SrcBones[0].Inverse();
+				FTransform BindingTransform = ComponentSpaceTransforms[AttachedBoneIndex];
+				MeshInfo.VerticesTransform = MeshInfo.VerticesTransform * SrcInvTransform * BindingTransform;
+			}
+
+			// remap skin
+			if (MeshInfo.ReadyRecord.IsValid())
+			{
+				// the mapping only depends on the merged bone names and the attach bone
+				const uint64 BoneMapKey = CityHash64WithSeed((const char*)&AttachedBoneIndex, sizeof(AttachedBoneIndex), MergedSkeletonSignature);
+				MeshInfo.ReadyBoneMap = MeshInfo.ReadyRecord->FindBoneMap(BoneMapKey);
+				if (!MeshInfo.ReadyBoneMap.IsValid())
+				{
+					TSharedRef<FSkelMeshMergeReadyBoneMap, ESPMode::ThreadSafe> NewBoneMap = MakeShared<FSkelMeshMergeReadyBoneMap, ESPMode::ThreadSafe>();
+					BuildSrcToDestRefSkeletonMap(SrcMesh->RefSkeleton, MergedData.RefSkeleton, AttachedBoneIndex, NewBoneMap->SrcToDestRefSkeletonMap);
 
-				MeshInfo.SrcToDestRefSkeletonMap[i] = DestBoneIndex;
+					const FSkeletalMeshRenderData* SrcResource = SrcMesh->GetResourceForRendering();
+					NewBoneMap->DestChunkBoneMaps.SetNum(SrcResource->LODRenderData.Num());
+					for (int32 LODIdx = 0; LODIdx < SrcResource->LODRenderData.Num(); LODIdx++)
+					{
+						const TArray<FSkelMeshRenderSection>& RenderSections = SrcResource->LODRenderData[LODIdx].RenderSections;
+						NewBoneMap->DestChunkBoneMaps[LODIdx].SetNum(RenderSections.Num());
+						for (int32 SectionIdx = 0; SectionIdx < RenderSections.Num(); SectionIdx++)
+						{
+							BoneMapToNewRefSkel(RenderSections[SectionIdx].BoneMap, NewBoneMap->SrcToDestRefSkeletonMap, NewBoneMap->DestChunkBoneMaps[LODIdx][SectionIdx]);
+						}
+					}
+					MeshInfo.ReadyBoneMap = MeshInfo.ReadyRecord->AddBoneMap(BoneMapKey, NewBoneMap);
+				}
+				MeshInfo.SrcToDestRefSkeletonMap = MeshInfo.ReadyBoneMap->SrcToDestRefSkeletonMap;
+			}
+			else
+			{
+				BuildSrcToDestRefSkeletonMap(SrcMesh->RefSkeleton, MergedData.RefSkeleton, AttachedBoneIndex, MeshInfo.SrcToDestRefSkeletonMap);
 			}
 		}
 	}
@@ -565,7 +957,7 @@ bool FCustomSkeletalMeshMerge::FinalizeMesh()
 	if (Result)
 	{
 		// force 16 bit UVs if supported on hardware
-		MergeMesh->bUseFullPrecisionUVs = GVertexElementTypeSupport.IsSupported(VET_Half2) ? false : true;
+		MergedData.bUseFullPrecisionUVs = GVertexElementTypeSupport.IsSupported(VET_Half2) ? false : true;
 
 		// Array of per-lod number of UV sets
 		TArray<uint32> PerLODNumUVSets;
@@ -574,28 +966,29 @@ bool FCustomSkeletalMeshMerge::FinalizeMesh()
 		PerLODExtraBoneInfluences.AddZeroed(MaxNumLODs);
 
 		// Get the number of UV sets for each LOD.
-		for (int32 MeshIdx = 0; MeshIdx < SrcMeshList.Num(); MeshIdx++)
+		for (int32 MeshIdx = 0; MeshIdx < SrcParts.Num(); MeshIdx++)
 		{
-			USkeletalMesh* SrcSkelMesh = SrcMeshList[MeshIdx];
+			USkeletalMesh* SrcSkelMesh = SrcParts[MeshIdx].SkeletalMesh;
 			FSkeletalMeshRenderData* SrcResource = SrcSkelMesh->GetResourceForRendering();
 
 			for (int32 LODIdx = 0; LODIdx < MaxNumLODs; LODIdx++)
 			{
-				if (SrcResource->LODRenderData.IsValidIndex(LODIdx))
+				// the source LOD GenerateLODModel() merges into this LOD
+				const int32 SourceLODIdx = GetSourceLODIdx(MeshIdx, LODIdx + StripTopLODs);
+				if (SourceLODIdx != INDEX_NONE)
 				{
 					uint32& NumUVSets = PerLODNumUVSets[LODIdx];
-					NumUVSets = FMath::Max(NumUVSets, SrcResource->LODRenderData[LODIdx].GetNumTexCoords());
+					NumUVSets = FMath::Max(NumUVSets, SrcResource->LODRenderData[SourceLODIdx].GetNumTexCoords());
 
-					PerLODExtraBoneInfluences[LODIdx] |= SrcResource->LODRenderData[LODIdx].DoesVertexBufferHaveExtraBoneInfluences();
+					PerLODExtraBoneInfluences[LODIdx] |= SrcResource->LODRenderData[SourceLODIdx].DoesVertexBufferHaveExtraBoneInfluences();
 				}
 			}
 		}
 
 		// process each LOD for the new merged mesh
-		MergeMesh->AllocateResourceForRendering();
 		for (int32 LODIdx = 0; LODIdx < MaxNumLODs; LODIdx++)
 		{
-			if (!MergeMesh->bUseFullPrecisionUVs)
+			if (!MergedData.bUseFullPrecisionUVs)
 			{
 				if (PerLODExtraBoneInfluences[LODIdx])
 				{
@@ -618,45 +1011,167 @@ bool FCustomSkeletalMeshMerge::FinalizeMesh()
 				}
 			}
 		}
+
+		if (IncrementalState)
+		{
+			PreviousSections.Empty();
+			PreviousLODBuffers.Empty();
+			UE_LOG(LogSkeletalMesh, Verbose, TEXT("FCustomSkeletalMeshMerge: reused %d of %d sections from the previous merge"),
+				IncrementalState->NumReusedSections, IncrementalState->NumReusedSections + IncrementalState->NumRebuiltSections);
+		}
+
 		// update the merge skel mesh entries
 		if (!ProcessMergeMesh())
 		{
 			Result = false;
 		}
 
-		// Reinitialize the mesh's render resources.
-		MergeMesh->InitResources();
+		ReportMergeCounters(MergedData, AtlasBoxes.Num());
+	}
+
+	if (Report)
+	{
+		Report->MergeMeshMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
 	}
+	RecordSkeletalMeshMergeCsvTime(StartTime);
 
 	return Result;
 }
 
+void FCustomSkeletalMeshMerge::CommitMesh()
+{
+	check(IsInGameThread());
+	SKELETALMESHMERGE_TRACE_SCOPE(SkeletalMeshMerge_CommitMesh);
+	SKELETALMESHMERGE_LLM_SCOPE(Geometry);
+	const double StartTime = FPlatformTime::Seconds();
+
+	ReleaseResources();
+
+	MergeMesh->bHasVertexColors = MergedData.bHasVertexColors;
+#if WITH_EDITORONLY_DATA
+	if (MergedData.bHasVertexColors)
+	{
+		MergeMesh->VertexColorGuid = FGuid::NewGuid();
+	}
+#endif
+	MergeMesh->bUseFullPrecisionUVs = MergedData.bUseFullPrecisionUVs;
+
+	// measure the prepared buffers while they are still owned by the prepared data
+	MergedCPUBytes = 0;
+	MergedGPUBytes = 0;
+	for (int32 LODIdx = 0; LODIdx < MergedData.LODRenderData.Num(); LODIdx++)
+	{
+		GetLODRenderDataSize(MergedData.LODRenderData[LODIdx], MergedData.LODInfo[LODIdx].bNeedsCPUAccess, MergedCPUBytes, MergedGPUBytes);
+	}
+
+	// hand the prepared LOD render data over to the merge mesh, a previously merged mesh keeps
+	// its render data object, and gets back the LOD array and objects RecycleRenderData() took
+	if (!MergeMesh->GetResourceForRendering())
+	{
+		MergeMesh->AllocateResourceForRendering();
+	}
+	FSkeletalMeshRenderData* MergeResource = MergeMesh->GetResourceForRendering();
+	check(MergeResource);
+
+	Exchange(MergeResource->LODRenderData, MergedData.LODRenderData);
+	MergedData.LODRenderData.Empty();
+
+	for (const FMergedLODInfo& LODInfo : MergedData.LODInfo)
+	{
+		FSkeletalMeshLODInfo& MergeLODInfo = MergeMesh->AddLODInfo();
+		MergeLODInfo.ScreenSize = LODInfo.ScreenSize;
+		MergeLODInfo.LODHysteresis = LODInfo.LODHysteresis;
+	}
+
+	// material slots are rewritten in place
+	MergeMesh->Materials.Reset(MergedData.Materials.Num());
+	MergeMesh->Materials.Append(MergedData.Materials);
+
+	// copy settings gathered from the src meshes
+	MergeMesh->SkelMirrorTable.Empty();
+	MergeMesh->SetImportedBounds(MergedData.ImportedBounds);
+	MergeMesh->SkelMirrorAxis = MergedData.SkelMirrorAxis;
+	MergeMesh->SkelMirrorFlipAxis = MergedData.SkelMirrorFlipAxis;
+
+	// Rebuild inverse ref pose matrices.
+	MergeMesh->RefBasesInvMatrix.Empty();
+	MergeMesh->CalculateInvRefMatrices();
+
+	// Reinitialize the mesh's render resources.
+	{
+		SCOPE_CYCLE_COUNTER(STAT_SkeletalMeshMerge_InitResources);
+		SKELETALMESHMERGE_TRACE_SCOPE(SkeletalMeshMerge_InitResources);
+		MergeMesh->InitResources();
+	}
+
+	RecordSkeletalMeshMergeCsvTime(StartTime);
+	CSV_CUSTOM_STAT(SkeletalMeshMerge, Merges, 1, ECsvCustomStatOp::Accumulate);
+	CSV_CUSTOM_STAT(SkeletalMeshMerge, ProducedKB, (float)((MergedCPUBytes + MergedGPUBytes) / 1024.0), ECsvCustomStatOp::Accumulate);
+}
+
 /**
-* Merge a bonemap with an existing bonemap and keep track of remapping
-* (a bonemap is a list of indices of bones in the USkeletalMesh::RefSkeleton array)
-* @param MergedBoneMap - out merged bonemap
-* @param BoneMapToMergedBoneMap - out of mapping from original bonemap to new merged bonemap
-* @param BoneMap - input bonemap to merge
+* Whether a merged LOD has to be skinned on the CPU, mirrors FSkeletalMeshRenderData::RequiresCPUSkinning for a single LOD
 */
-void FCustomSkeletalMeshMerge::MergeBoneMap(TArray<FBoneIndexType>& MergedBoneMap, TArray<FBoneIndexType>& BoneMapToMergedBoneMap, const TArray<FBoneIndexType>& BoneMap)
+static bool LODRequiresCPUSkinning(const FSkeletalMeshLODRenderData& LODData, bool bHasExtraBoneInfluences)
 {
-	BoneMapToMergedBoneMap.AddUninitialized(BoneMap.Num());
-	for (int32 IdxB = 0; IdxB < BoneMap.Num(); IdxB++)
+	const int32 MaxGPUSkinBones = GetFeatureLevelMaxNumberOfBones(GMaxRHIFeatureLevel);
+
+	int32 MaxBonesPerSection = 0;
+	for (const FSkelMeshRenderSection& Section : LODData.RenderSections)
 	{
-		BoneMapToMergedBoneMap[IdxB] = MergedBoneMap.AddUnique(BoneMap[IdxB]);
+		MaxBonesPerSection = FMath::Max(MaxBonesPerSection, Section.BoneMap.Num());
 	}
+
+	return (MaxBonesPerSection > MaxGPUSkinBones) || (bHasExtraBoneInfluences && GMaxRHIFeatureLevel < ERHIFeatureLevel::ES3_1);
 }
 
-static void BoneMapToNewRefSkel(const TArray<FBoneIndexType>& InBoneMap, const TArray<int32>& SrcToDestRefSkeletonMap, TArray<FBoneIndexType>& OutBoneMap)
+/**
+* Whether the vertex and skin weight buffers of recycled LOD render data still hold a CPU copy with the layout of
+* the new LOD, so they can be written in place. Buffers without CPU access dropped their copy once uploaded.
+*/
+static bool CanFillVertexBuffersInPlace(const FSkeletalMeshLODRenderData& LODData, uint32 NumVertices, uint32 NumTexCoords, bool bUseFullPrecisionUVs, bool bHasExtraBoneInfluences, bool bNeedsCPUAccess)
 {
-	OutBoneMap.Empty();
-	OutBoneMap.AddUninitialized(InBoneMap.Num());
+	const FPositionVertexBuffer& PositionBuffer = LODData.StaticVertexBuffers.PositionVertexBuffer;
+	const FStaticMeshVertexBuffer& StaticMeshBuffer = LODData.StaticVertexBuffers.StaticMeshVertexBuffer;
+	const FSkinWeightVertexBuffer& SkinWeightBuffer = LODData.SkinWeightVertexBuffer;
+
+	return bNeedsCPUAccess && NumVertices > 0
+		&& PositionBuffer.GetAllowCPUAccess() && PositionBuffer.GetNumVertices() == NumVertices
+		&& StaticMeshBuffer.GetAllowCPUAccess() && StaticMeshBuffer.GetNumVertices() == NumVertices
+		&& StaticMeshBuffer.GetNumTexCoords() == NumTexCoords && StaticMeshBuffer.GetUseFullPrecisionUVs() == bUseFullPrecisionUVs
+		&& SkinWeightBuffer.GetNeedsCPUAccess() && SkinWeightBuffer.GetNumVertices() == NumVertices
+		&& SkinWeightBuffer.HasExtraBoneInfluences() == bHasExtraBoneInfluences;
+}
 
-	for (int32 i = 0; i < InBoneMap.Num(); i++)
+/** Overwrites the skin weights of a buffer checked by CanFillVertexBuffersInPlace() */
+template<bool bHasExtraBoneInfluences>
+static void CopySkinWeightsInPlace(FSkinWeightVertexBuffer& SkinWeightBuffer, const TArray<TSkinWeightInfo<bHasExtraBoneInfluences>>& SkinWeights)
+{
+	FMemory::Memcpy(SkinWeightBuffer.GetSkinWeightPtr<bHasExtraBoneInfluences>(0), SkinWeights.GetData(), SkinWeights.Num() * SkinWeights.GetTypeSize());
+}
+
+/** @return Whether the indices were written over the CPU copy of the index buffer, which needs the same count and index size */
+static bool CopyIndicesInPlace(FMultiSizeIndexContainer& IndexContainer, uint8 DataTypeSize, const TArray<uint32>& Indices)
+{
+	FRawStaticIndexBuffer16or32Interface* IndexBuffer = IndexContainer.IsIndexBufferValid() ? IndexContainer.GetIndexBuffer() : nullptr;
+	if (!IndexBuffer || Indices.Num() == 0 || IndexContainer.GetDataTypeSize() != DataTypeSize || IndexBuffer->Num() != Indices.Num())
 	{
-		check(InBoneMap[i] < SrcToDestRefSkeletonMap.Num());
-		OutBoneMap[i] = SrcToDestRefSkeletonMap[InBoneMap[i]];
+		return false;
+	}
+
+	if (DataTypeSize == sizeof(uint32))
+	{
+		FMemory::Memcpy(IndexBuffer->GetPointerTo(0), Indices.GetData(), Indices.Num() * sizeof(uint32));
+	}
+	else
+	{
+		uint16* DestIndices = (uint16*)IndexBuffer->GetPointerTo(0);
+		for (int32 Idx = 0; Idx < Indices.Num(); Idx++)
+		{
+			DestIndices[Idx] = (uint16)Indices[Idx];
+		}
 	}
+	return true;
 }
 
 /**
@@ -666,19 +1181,28 @@ static void BoneMapToNewRefSkel(const TArray<FBoneIndexType>& InBoneMap, const T
 */
 void FCustomSkeletalMeshMerge::GenerateNewSectionArray(TArray<FNewSectionInfo>& NewSectionArray, int32 LODIdx)
 {
+	SCOPE_CYCLE_COUNTER(STAT_SkeletalMeshMerge_GenerateNewSectionArray);
+	SKELETALMESHMERGE_TRACE_SCOPE(SkeletalMeshMerge_GenerateNewSectionArray);
+	SKELETALMESHMERGE_LLM_SCOPE(Scratch);
+
 	const int32 MaxGPUSkinBones = GetFeatureLevelMaxNumberOfBones(GMaxRHIFeatureLevel);
 
 	NewSectionArray.Empty();
-	for (int32 MeshIdx = 0; MeshIdx < SrcMeshList.Num(); MeshIdx++)
+	for (int32 MeshIdx = 0; MeshIdx < SrcParts.Num(); MeshIdx++)
 	{
 		// source mesh
-		USkeletalMesh* SrcMesh = SrcMeshList[MeshIdx];
-		const FTransform& VerticesTransform = VerticesTransformList[MeshIdx];
+		USkeletalMesh* SrcMesh = SrcParts[MeshIdx].SkeletalMesh;
+		const FTransform& VerticesTransform = SrcMeshInfo[MeshIdx].VerticesTransform;
 
 		if (SrcMesh)
 		{
 			FSkeletalMeshRenderData* SrcResource = SrcMesh->GetResourceForRendering();
-			int32 SourceLODIdx = FMath::Min(LODIdx, SrcResource->LODRenderData.Num() - 1);
+			int32 SourceLODIdx = GetSourceLODIdx(MeshIdx, LODIdx);
+			if (SourceLODIdx == INDEX_NONE)
+			{
+				// the part is left out of the LODs past its max LOD
+				continue;
+			}
 			FSkeletalMeshLODRenderData& SrcLODData = SrcResource->LODRenderData[SourceLODIdx];
 			FSkeletalMeshLODInfo& SrcLODInfo = *(SrcMesh->GetLODInfo(SourceLODIdx));
 
@@ -688,7 +1212,7 @@ void FCustomSkeletalMeshMerge::GenerateNewSectionArray(TArray<FNewSectionInfo>&
 				int32 MaterialId = -1;
 				// check for the optional list of material ids corresponding to the list of src meshes
 				// if the id is valid (not -1) it is used to find an existing section entry to merge with
-				if (ForceSectionMapping.Num() == SrcMeshList.Num() &&
+				if (ForceSectionMapping.Num() == SrcParts.Num() &&
 					ForceSectionMapping.IsValidIndex(MeshIdx) &&
 					ForceSectionMapping[MeshIdx].SectionIDs.IsValidIndex(SectionIdx))
 				{
@@ -697,14 +1221,19 @@ void FCustomSkeletalMeshMerge::GenerateNewSectionArray(TArray<FNewSectionInfo>&
 
 				FSkelMeshRenderSection& Section = SrcLODData.RenderSections[SectionIdx];
 
-				// Convert Chunk.BoneMap from src to dest bone indices
-				TArray<FBoneIndexType> DestChunkBoneMap;
-				BoneMapToNewRefSkel(Section.BoneMap, SrcMeshInfo[MeshIdx].SrcToDestRefSkeletonMap, DestChunkBoneMap);
+				// Convert Chunk.BoneMap from src to dest bone indices, unless the part's record already holds it
+				TArray<FBoneIndexType> LocalDestChunkBoneMap;
+				const FSkelMeshMergeReadyBoneMapPtr& ReadyBoneMap = SrcMeshInfo[MeshIdx].ReadyBoneMap;
+				if (!ReadyBoneMap.IsValid())
+				{
+					BoneMapToNewRefSkel(Section.BoneMap, SrcMeshInfo[MeshIdx].SrcToDestRefSkeletonMap, LocalDestChunkBoneMap);
+				}
+				const TArray<FBoneIndexType>& DestChunkBoneMap = ReadyBoneMap.IsValid() ? ReadyBoneMap->DestChunkBoneMaps[SourceLODIdx][SectionIdx] : LocalDestChunkBoneMap;
 
 				// get the material for this section
 				int32 MaterialIndex = Section.MaterialIndex;
 				// use the remapping of material indices for all LODs besides the base LOD 
-				if (LODIdx > 0 &&
+				if (SourceLODIdx > 0 &&
 					SrcLODInfo.LODMaterialMap.IsValidIndex(Section.MaterialIndex))
 				{
 					MaterialIndex = FMath::Clamp<int32>(SrcLODInfo.LODMaterialMap[Section.MaterialIndex], 0, SrcMesh->Materials.Num());
@@ -728,7 +1257,7 @@ void FCustomSkeletalMeshMerge::GenerateNewSectionArray(TArray<FNewSectionInfo>&
 						// merge the bonemap from the source section with the existing merged bonemap
 						TArray<FBoneIndexType> TempMergedBoneMap(NewSectionInfo.MergedBoneMap);
 						TArray<FBoneIndexType> TempBoneMapToMergedBoneMap;
-						MergeBoneMap(TempMergedBoneMap, TempBoneMapToMergedBoneMap, DestChunkBoneMap);
+						SkelMeshMergeKernels::MergeBoneMap(TempMergedBoneMap, TempBoneMapToMergedBoneMap, DestChunkBoneMap);
 
 						// check to see if the newly merged bonemap is still within the bone limit for GPU skinning
 						if (TempMergedBoneMap.Num() <= MaxGPUSkinBones)
@@ -744,7 +1273,9 @@ void FCustomSkeletalMeshMerge::GenerateNewSectionArray(TArray<FNewSectionInfo>&
 								SrcMesh,
 								&SrcLODData.RenderSections[SectionIdx],
 								SrcUVTransform,
-								VerticesTransform
+								VerticesTransform,
+								MeshIdx,
+								SectionIdx
 							);
 							// keep track of remapping for the existing chunk's bonemap 
 							// so that the bone matrix indices can be updated for the vertices
@@ -753,99 +1284,559 @@ void FCustomSkeletalMeshMerge::GenerateNewSectionArray(TArray<FNewSectionInfo>&
 							// use the updated bonemap for this new section
 							NewSectionInfo.MergedBoneMap = TempMergedBoneMap;
 
-							// keep track of the entry that was found
-							FoundIdx = Idx;
-							break;
-						}
-					}
-				}
+							// keep track of the entry that was found
+							FoundIdx = Idx;
+							break;
+						}
+					}
+				}
+
+				// new section entries will be created if the material for the source section was not found 
+				// or merging it with an existing entry would go over the bone limit for GPU skinning
+				if (FoundIdx == INDEX_NONE)
+				{
+					// create a new section entry
+					const FMeshUVChannelInfo& UVChannelData = SrcMesh->Materials[MaterialIndex].UVChannelData;
+					/* hack
+					FNewSectionInfo& NewSectionInfo = *new(NewSectionArray) FNewSectionInfo(Material, MaterialId, UVChannelData);
+					*/
+					FNewSectionInfo& NewSectionInfo = *new(NewSectionArray) FNewSectionInfo(MergedMaterial, MaterialId, UVChannelData);
+					// initialize the merged bonemap to simply use the original chunk bonemap
+					NewSectionInfo.MergedBoneMap = DestChunkBoneMap;
+
+					TArray<FTransform> SrcUVTransform;
+					if (MeshIdx < UVTransformsPerMesh.Num())
+					{
+						SrcUVTransform = UVTransformsPerMesh[MeshIdx];
+					}
+					// add a new merge section entry
+					FMergeSectionInfo& MergeSectionInfo = *new(NewSectionInfo.MergeSections) FMergeSectionInfo(
+						SrcMesh,
+						&SrcLODData.RenderSections[SectionIdx],
+						SrcUVTransform,
+						VerticesTransform,
+						MeshIdx,
+						SectionIdx);
+					// since merged bonemap == chunk.bonemap then remapping is just pass-through
+					MergeSectionInfo.BoneMapToMergedBoneMap.Empty(DestChunkBoneMap.Num());
+					for (int32 i = 0; i < DestChunkBoneMap.Num(); i++)
+					{
+						MergeSectionInfo.BoneMapToMergedBoneMap.Add((FBoneIndexType)i);
+					}
+				}
+			}
+		}
+	}
+}
+
+namespace
+{
+	/** @return Id of the vertex and skin weight layout a section was converted to. */
+	template<typename VertexDataType, typename SkinWeightType>
+	uint32 GetMergeVertexLayout()
+	{
+		const uint32 bFullPrecisionUVs = (VertexDataType::StaticMeshVertexUVType == EStaticMeshVertexUVType::HighPrecision) ? 1 : 0;
+		return VertexDataType::NumTexCoords | (bFullPrecisionUVs << 8) | ((uint32)sizeof(SkinWeightType) << 16);
+	}
+
+	/** @return Whether two lists of transforms are exactly the same. */
+	bool AreTransformsEqual(const TArray<FTransform>& A, const TArray<FTransform>& B)
+	{
+		if (A.Num() != B.Num())
+		{
+			return false;
+		}
+		for (int32 Idx = 0; Idx < A.Num(); Idx++)
+		{
+			if (!A[Idx].Equals(B[Idx], 0.f))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/** @return Number of UV channels of a source LOD that a merged vertex type keeps. */
+	template<typename VertexDataType>
+	uint32 GetNumMergedUVs(uint32 NumTexCoords)
+	{
+		return FMath::Min<uint32>(NumTexCoords, VertexDataType::NumTexCoords);
+	}
+
+	/** Moves the full precision source UVs into the atlas layout of the merged material, then narrows them to the merged UV type. */
+	template<typename VertexDataType>
+	void TransformVertexUVs(VertexDataType* Vertices, int32 NumVertices, const FVector2D* SrcUVs, uint32 NumUVs, const TArray<FTransform>& UVTransforms)
+	{
+		for (int32 VertIdx = 0; VertIdx < NumVertices; VertIdx++)
+		{
+			VertexDataType& DestVert = Vertices[VertIdx];
+			for (uint32 UVIndex = 0; UVIndex < NumUVs; ++UVIndex)
+			{
+				FVector2D UVs = SrcUVs[VertIdx * NumUVs + UVIndex];
+				if (UVIndex < (uint32)UVTransforms.Num())
+				{
+					FVector Transformed = UVTransforms[UVIndex].TransformPosition(FVector(UVs, 1.f));
+					UVs = FVector2D(Transformed.X, Transformed.Y);
+				}
+				DestVert.UVs[UVIndex] = UVs;
+			}
+		}
+	}
+
+	/**
+	 * Copies merge-ready streams to the destination, applying the part's vertex and UV transforms
+	 * and remapping the bone indices to the merged section bone map.
+	 */
+	template<typename VertexDataType, typename SkinWeightType>
+	void TransformReadySection(const FSkelMeshMergeReadySection& ReadySection, const FTransform& VerticesTransform, const TArray<FTransform>& UVTransforms, const TArray<FBoneIndexType>& BoneMapToMergedBoneMap, VertexDataType* DestVerts, SkinWeightType* DestWeights)
+	{
+		const int32 NumVertices = ReadySection.Vertices.Num() / sizeof(VertexDataType);
+		FMemory::Memcpy(DestVerts, ReadySection.Vertices.GetData(), ReadySection.Vertices.Num());
+		FMemory::Memcpy(DestWeights, ReadySection.SkinWeights.GetData(), ReadySection.SkinWeights.Num());
+
+		// the identity transform leaves positions untouched, skip it for parts that are not moved
+		if (!VerticesTransform.Equals(FTransform::Identity, 0.f))
+		{
+			for (int32 VertIdx = 0; VertIdx < NumVertices; VertIdx++)
+			{
+				DestVerts[VertIdx].Position = VerticesTransform.TransformFVector4(DestVerts[VertIdx].Position);
+			}
+		}
+
+		TransformVertexUVs<VertexDataType>(DestVerts, NumVertices, ReadySection.UVs.GetData(), GetNumMergedUVs<VertexDataType>(ReadySection.NumTexCoords), UVTransforms);
+
+		// remap the bone index used by each vertex to match the mergedbonemap 
+		for (int32 VertIdx = 0; VertIdx < NumVertices; VertIdx++)
+		{
+			SkelMeshMergeKernels::RemapInfluenceBones(DestWeights[VertIdx], BoneMapToMergedBoneMap);
+		}
+	}
+
+	/** Adds the colors of merge-ready streams, defaulting vertices without a source color to white. */
+	void AppendReadySectionColors(const FSkelMeshMergeReadySection& ReadySection, int32 NumVertices, TArray<FColor>& DestColors)
+	{
+		DestColors.Append(ReadySection.Colors);
+		for (int32 Idx = ReadySection.Colors.Num(); Idx < NumVertices; Idx++)
+		{
+			DestColors.Add(FColor(255, 255, 255));
+		}
+	}
+}
+
+template<typename VertexDataType, typename SkinWeightType>
+FSkelMeshMergeReadySectionPtr FCustomSkeletalMeshMerge::FindOrBuildReadySection(int32 SourceLODIdx, const FSkeletalMeshLODRenderData& SrcLODData, const FMergeSectionInfo& MergeSectionInfo)
+{
+	const FSkelMeshMergeReadyRecordPtr& Record = SrcMeshInfo[MergeSectionInfo.PartIdx].ReadyRecord;
+	check(Record.IsValid());
+
+	const uint32 VertexLayout = GetMergeVertexLayout<VertexDataType, SkinWeightType>();
+	FSkelMeshMergeReadySectionPtr ReadySection = Record->FindSection(SourceLODIdx, MergeSectionInfo.SectionIdx, VertexLayout);
+	if (!ReadySection.IsValid())
+	{
+		TSharedRef<FSkelMeshMergeReadySection, ESPMode::ThreadSafe> NewSection = MakeShared<FSkelMeshMergeReadySection, ESPMode::ThreadSafe>();
+		BuildReadySection<VertexDataType, SkinWeightType>(*NewSection, SrcLODData, MergeSectionInfo);
+		ReadySection = Record->AddSection(SourceLODIdx, MergeSectionInfo.SectionIdx, VertexLayout, NewSection);
+	}
+	return ReadySection;
+}
+
+template<typename VertexDataType, typename SkinWeightType>
+void FCustomSkeletalMeshMerge::BuildReadySection(FSkelMeshMergeReadySection& ReadySection, const FSkeletalMeshLODRenderData& SrcLODData, const FMergeSectionInfo& MergeSectionInfo)
+{
+	const FSkelMeshRenderSection& SrcSection = *MergeSectionInfo.Section;
+
+	ReadySection.VertexLayout = GetMergeVertexLayout<VertexDataType, SkinWeightType>();
+	ReadySection.NumTexCoords = SrcLODData.StaticVertexBuffers.StaticMeshVertexBuffer.GetNumTexCoords();
+	ReadySection.bExtraBoneInfluence = SrcLODData.SkinWeightVertexBuffer.HasExtraBoneInfluences();
+
+	const int32 MaxVertIdx = FMath::Min<int32>(
+		SrcSection.BaseVertexIndex + SrcSection.NumVertices,
+		SrcLODData.StaticVertexBuffers.PositionVertexBuffer.GetNumVertices()
+		);
+	const int32 NumVertices = FMath::Max<int32>(MaxVertIdx - (int32)SrcSection.BaseVertexIndex, 0);
+	const int32 NumColors = FMath::Clamp<int32>((int32)SrcLODData.StaticVertexBuffers.ColorVertexBuffer.GetNumVertices() - (int32)SrcSection.BaseVertexIndex, 0, NumVertices);
+
+	const uint32 NumUVs = GetNumMergedUVs<VertexDataType>(ReadySection.NumTexCoords);
+
+	ReadySection.Vertices.SetNumUninitialized(NumVertices * sizeof(VertexDataType));
+	ReadySection.UVs.Reset(NumVertices * NumUVs);
+	ReadySection.SkinWeights.SetNumUninitialized(NumVertices * sizeof(SkinWeightType));
+	ReadySection.Colors.Reset(NumColors);
+
+	VertexDataType* DestVerts = (VertexDataType*)ReadySection.Vertices.GetData();
+	SkinWeightType* DestWeights = (SkinWeightType*)ReadySection.SkinWeights.GetData();
+	const TArray<FTransform> NoUVTransforms;
+
+	for (int32 Idx = 0; Idx < NumVertices; Idx++)
+	{
+		const int32 VertIdx = SrcSection.BaseVertexIndex + Idx;
+
+		SkelMeshMergeKernels::CopyVertexFromSource<VertexDataType>(DestVerts[Idx], SrcLODData, VertIdx, FTransform::Identity, NoUVTransforms);
+
+		// read the same way CopyVertexFromSource does, but kept unrounded
+		for (uint32 UVIndex = 0; UVIndex < NumUVs; ++UVIndex)
+		{
+			ReadySection.UVs.Add(SrcLODData.StaticVertexBuffers.StaticMeshVertexBuffer.GetVertexUV_Typed<VertexDataType::StaticMeshVertexUVType>(VertIdx, UVIndex));
+		}
+
+		if (ReadySection.bExtraBoneInfluence)
+		{
+			SkelMeshMergeKernels::CopyWeightFromSource<SkinWeightType, true>(DestWeights[Idx], SrcLODData, VertIdx);
+		}
+		else
+		{
+			SkelMeshMergeKernels::CopyWeightFromSource<SkinWeightType, false>(DestWeights[Idx], SrcLODData, VertIdx);
+		}
+
+		if (Idx < NumColors)
+		{
+			ReadySection.Colors.Add(SrcLODData.StaticVertexBuffers.ColorVertexBuffer.VertexColor(VertIdx));
+		}
+	}
+
+	const int32 MaxIndexIdx = FMath::Min<int32>(
+		SrcSection.BaseIndex + SrcSection.NumTriangles * 3,
+		SrcLODData.MultiSizeIndexContainer.GetIndexBuffer()->Num()
+		);
+	ReadySection.Indices.Reset(FMath::Max<int32>(MaxIndexIdx - (int32)SrcSection.BaseIndex, 0));
+	for (int32 IndexIdx = SrcSection.BaseIndex; IndexIdx < MaxIndexIdx; IndexIdx++)
+	{
+		uint32 SrcIndex = SrcLODData.MultiSizeIndexContainer.GetIndexBuffer()->Get(IndexIdx);
+		checkSlow(SrcIndex >= SrcSection.BaseVertexIndex);
+		ReadySection.Indices.Add(SrcIndex - SrcSection.BaseVertexIndex);
+	}
+}
+
+template<typename VertexDataType, typename SkinWeightType>
+void FCustomSkeletalMeshMerge::AppendReadySection(const FSkelMeshMergeReadySection& ReadySection, const FMergeSectionInfo& MergeSectionInfo, TArray<VertexDataType>& MergedVertexBuffer, TArray<SkinWeightType>& MergedSkinWeightBuffer, TArray<FColor>& MergedColorBuffer, TArray<uint32>& MergedIndexBuffer, uint32& MaxIndex)
+{
+	const int32 NumVertices = ReadySection.Vertices.Num() / sizeof(VertexDataType);
+	const int32 CurrentBaseVertexIndex = MergedVertexBuffer.AddUninitialized(NumVertices);
+	MergedSkinWeightBuffer.AddUninitialized(NumVertices);
+
+	TransformReadySection<VertexDataType, SkinWeightType>(ReadySection, MergeSectionInfo.VerticesTransform, MergeSectionInfo.UVTransforms, MergeSectionInfo.BoneMapToMergedBoneMap,
+		MergedVertexBuffer.GetData() + CurrentBaseVertexIndex, MergedSkinWeightBuffer.GetData() + CurrentBaseVertexIndex);
+
+	if (MergedData.bHasVertexColors)
+	{
+		AppendReadySectionColors(ReadySection, NumVertices, MergedColorBuffer);
+	}
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_SkeletalMeshMerge_Indices);
+		SkelMeshMergeKernels::AppendSectionIndices(ReadySection.Indices, CurrentBaseVertexIndex, MergedIndexBuffer, MaxIndex);
+	}
+}
+
+template<typename VertexDataType, typename SkinWeightType>
+void FCustomSkeletalMeshMerge::SpliceIncrementalSections(int32 LODIdx, const TArray<FNewSectionInfo>& NewSectionArray, TArray<VertexDataType>& MergedVertexBuffer, TArray<SkinWeightType>& MergedSkinWeightBuffer, TArray<FColor>& MergedColorBuffer, TArray<uint32>& MergedIndexBuffer, uint32& MaxIndex, uint32& TotalNumUVs, bool& bSourceHasExtraBoneInfluences)
+{
+	check(IncrementalState);
+
+	const uint32 VertexLayout = GetMergeVertexLayout<VertexDataType, SkinWeightType>();
+	const bool bHasColors = MergedData.bHasVertexColors;
+
+	struct FSplicedSection
+	{
+		FIntVector Key;
+		const FMergeSectionInfo* MergeSectionInfo;
+		int32 SourceLODIdx;
+		/** Range of reused streams in the previous buffers, INDEX_NONE if the section is rebuilt */
+		int32 PreviousBaseVertexIndex;
+		int32 PreviousBaseIndex;
+	};
+	TArray<FSplicedSection> SplicedSections;
+
+	// lay the sections out in merge order, matching each against the previous merge
+	int32 NumVertices = 0;
+	int32 NumIndices = 0;
+	int32 ReusedEndVertexIndex = 0;
+	int32 ReusedEndIndex = 0;
+	for (const FNewSectionInfo& NewSectionInfo : NewSectionArray)
+	{
+		for (const FMergeSectionInfo& MergeSectionInfo : NewSectionInfo.MergeSections)
+		{
+			const int32 SourceLODIdx = GetSourceLODIdx(MergeSectionInfo.PartIdx, LODIdx);
+			const FSkeletalMeshLODRenderData& SrcLODData = MergeSectionInfo.SkelMesh->GetResourceForRendering()->LODRenderData[SourceLODIdx];
+			const FSkelMeshRenderSection& SrcSection = *MergeSectionInfo.Section;
+
+			const int32 MaxVertIdx = FMath::Min<int32>(
+				SrcSection.BaseVertexIndex + SrcSection.NumVertices,
+				SrcLODData.StaticVertexBuffers.PositionVertexBuffer.GetNumVertices()
+				);
+			const int32 MaxIndexIdx = FMath::Min<int32>(
+				SrcSection.BaseIndex + SrcSection.NumTriangles * 3,
+				SrcLODData.MultiSizeIndexContainer.GetIndexBuffer()->Num()
+				);
+			const int32 SectionNumVertices = FMath::Max<int32>(MaxVertIdx - (int32)SrcSection.BaseVertexIndex, 0);
+			const int32 SectionNumIndices = FMath::Max<int32>(MaxIndexIdx - (int32)SrcSection.BaseIndex, 0);
+
+			FSplicedSection& SplicedSection = SplicedSections[SplicedSections.AddUninitialized()];
+			SplicedSection.Key = FIntVector(MergeSectionInfo.PartIdx, LODIdx, MergeSectionInfo.SectionIdx);
+			SplicedSection.MergeSectionInfo = &MergeSectionInfo;
+			SplicedSection.SourceLODIdx = SourceLODIdx;
+			SplicedSection.PreviousBaseVertexIndex = INDEX_NONE;
+			SplicedSection.PreviousBaseIndex = INDEX_NONE;
+
+			// the previous streams are only valid if the part and everything baked into them is unchanged;
+			// they are moved in place, so they must also follow the streams reused before them
+			FSkelMeshMergeSectionCache& SectionCache = IncrementalState->Sections.Add(SplicedSection.Key);
+			const FSkelMeshMergeSectionCache* PreviousSection = PreviousSections.Find(SplicedSection.Key);
+			if (PreviousSection &&
+				PreviousSection->SkelMesh.Get() == MergeSectionInfo.SkelMesh &&
+				PreviousSection->SourceLODIdx == SourceLODIdx &&
+				PreviousSection->VertexLayout == VertexLayout &&
+				PreviousSection->bHasColors == bHasColors &&
+				PreviousSection->VerticesTransform.Equals(MergeSectionInfo.VerticesTransform, 0.f) &&
+				AreTransformsEqual(PreviousSection->UVTransforms, MergeSectionInfo.UVTransforms) &&
+				PreviousSection->BoneMapToMergedBoneMap == MergeSectionInfo.BoneMapToMergedBoneMap &&
+				PreviousSection->NumVertices == SectionNumVertices &&
+				PreviousSection->NumIndices == SectionNumIndices &&
+				PreviousSection->BaseVertexIndex >= ReusedEndVertexIndex &&
+				PreviousSection->BaseIndex >= ReusedEndIndex &&
+				PreviousSection->BaseVertexIndex + SectionNumVertices <= MergedVertexBuffer.Num() &&
+				PreviousSection->BaseIndex + SectionNumIndices <= MergedIndexBuffer.Num())
+			{
+				SectionCache = *PreviousSection;
+				SplicedSection.PreviousBaseVertexIndex = SectionCache.BaseVertexIndex;
+				SplicedSection.PreviousBaseIndex = SectionCache.BaseIndex;
+				ReusedEndVertexIndex = SectionCache.BaseVertexIndex + SectionNumVertices;
+				ReusedEndIndex = SectionCache.BaseIndex + SectionNumIndices;
+				IncrementalState->NumReusedSections++;
+			}
+			else
+			{
+				IncrementalState->NumRebuiltSections++;
+			}
+
+			SectionCache.BaseVertexIndex = NumVertices;
+			SectionCache.NumVertices = SectionNumVertices;
+			SectionCache.BaseIndex = NumIndices;
+			SectionCache.NumIndices = SectionNumIndices;
+			NumVertices += SectionNumVertices;
+			NumIndices += SectionNumIndices;
+		}
+	}
 
-				// new section entries will be created if the material for the source section was not found 
-				// or merging it with an existing entry would go over the bone limit for GPU skinning
-				if (FoundIdx == INDEX_NONE)
-				{
-					// create a new section entry
-					const FMeshUVChannelInfo& UVChannelData = SrcMesh->Materials[MaterialIndex].UVChannelData;
-					/* hack
-					FNewSectionInfo& NewSectionInfo = *new(NewSectionArray) FNewSectionInfo(Material, MaterialId, UVChannelData);
-					*/
-					FNewSectionInfo& NewSectionInfo = *new(NewSectionArray) FNewSectionInfo(MergedMaterial, MaterialId, UVChannelData);
-					// initialize the merged bonemap to simply use the original chunk bonemap
-					NewSectionInfo.MergedBoneMap = DestChunkBoneMap;
+	// grow the buffers before moving anything so no range is moved past their end
+	if (MergedVertexBuffer.Num() < NumVertices)
+	{
+		MergedVertexBuffer.AddUninitialized(NumVertices - MergedVertexBuffer.Num());
+	}
+	if (MergedSkinWeightBuffer.Num() < NumVertices)
+	{
+		MergedSkinWeightBuffer.AddUninitialized(NumVertices - MergedSkinWeightBuffer.Num());
+	}
+	if (bHasColors && MergedColorBuffer.Num() < NumVertices)
+	{
+		MergedColorBuffer.AddUninitialized(NumVertices - MergedColorBuffer.Num());
+	}
+	if (MergedIndexBuffer.Num() < NumIndices)
+	{
+		MergedIndexBuffer.AddUninitialized(NumIndices - MergedIndexBuffer.Num());
+	}
 
-					TArray<FTransform> SrcUVTransform;
-					if (MeshIdx < UVTransformsPerMesh.Num())
-					{
-						SrcUVTransform = UVTransformsPerMesh[MeshIdx];
-					}
-					// add a new merge section entry
-					FMergeSectionInfo& MergeSectionInfo = *new(NewSectionInfo.MergeSections) FMergeSectionInfo(
-						SrcMesh,
-						&SrcLODData.RenderSections[SectionIdx],
-						SrcUVTransform,
-						VerticesTransform);
-					// since merged bonemap == chunk.bonemap then remapping is just pass-through
-					MergeSectionInfo.BoneMapToMergedBoneMap.Empty(DestChunkBoneMap.Num());
-					for (int32 i = 0; i < DestChunkBoneMap.Num(); i++)
-					{
-						MergeSectionInfo.BoneMapToMergedBoneMap.Add((FBoneIndexType)i);
-					}
-				}
+	// reused ranges keep their order, so moving those that shift towards the start first to last
+	// and those that shift towards the end last to first never overwrites a range not moved yet
+	auto MoveVertexRange = [&](const FSplicedSection& SplicedSection)
+	{
+		const FSkelMeshMergeSectionCache& SectionCache = IncrementalState->Sections.FindChecked(SplicedSection.Key);
+		FMemory::Memmove(MergedVertexBuffer.GetData() + SectionCache.BaseVertexIndex, MergedVertexBuffer.GetData() + SplicedSection.PreviousBaseVertexIndex, SectionCache.NumVertices * sizeof(VertexDataType));
+		FMemory::Memmove(MergedSkinWeightBuffer.GetData() + SectionCache.BaseVertexIndex, MergedSkinWeightBuffer.GetData() + SplicedSection.PreviousBaseVertexIndex, SectionCache.NumVertices * sizeof(SkinWeightType));
+		if (bHasColors)
+		{
+			FMemory::Memmove(MergedColorBuffer.GetData() + SectionCache.BaseVertexIndex, MergedColorBuffer.GetData() + SplicedSection.PreviousBaseVertexIndex, SectionCache.NumVertices * sizeof(FColor));
+		}
+	};
+	auto MoveIndexRange = [&](const FSplicedSection& SplicedSection)
+	{
+		const FSkelMeshMergeSectionCache& SectionCache = IncrementalState->Sections.FindChecked(SplicedSection.Key);
+		FMemory::Memmove(MergedIndexBuffer.GetData() + SectionCache.BaseIndex, MergedIndexBuffer.GetData() + SplicedSection.PreviousBaseIndex, SectionCache.NumIndices * sizeof(uint32));
+	};
+	for (const FSplicedSection& SplicedSection : SplicedSections)
+	{
+		if (SplicedSection.PreviousBaseVertexIndex != INDEX_NONE)
+		{
+			const FSkelMeshMergeSectionCache& SectionCache = IncrementalState->Sections.FindChecked(SplicedSection.Key);
+			if (SectionCache.BaseVertexIndex < SplicedSection.PreviousBaseVertexIndex)
+			{
+				MoveVertexRange(SplicedSection);
+			}
+			if (SectionCache.BaseIndex < SplicedSection.PreviousBaseIndex)
+			{
+				MoveIndexRange(SplicedSection);
+			}
+		}
+	}
+	for (int32 SplicedIdx = SplicedSections.Num() - 1; SplicedIdx >= 0; SplicedIdx--)
+	{
+		const FSplicedSection& SplicedSection = SplicedSections[SplicedIdx];
+		if (SplicedSection.PreviousBaseVertexIndex != INDEX_NONE)
+		{
+			const FSkelMeshMergeSectionCache& SectionCache = IncrementalState->Sections.FindChecked(SplicedSection.Key);
+			if (SectionCache.BaseVertexIndex > SplicedSection.PreviousBaseVertexIndex)
+			{
+				MoveVertexRange(SplicedSection);
+			}
+			if (SectionCache.BaseIndex > SplicedSection.PreviousBaseIndex)
+			{
+				MoveIndexRange(SplicedSection);
 			}
 		}
 	}
-}
 
-template<typename VertexDataType>
-void FCustomSkeletalMeshMerge::CopyVertexFromSource(VertexDataType& DestVert, const FSkeletalMeshLODRenderData& SrcLODData, int32 SourceVertIdx, const FMergeSectionInfo& MergeSectionInfo)
-{
-	DestVert.Position = SrcLODData.StaticVertexBuffers.PositionVertexBuffer.VertexPosition(SourceVertIdx);
-	DestVert.Position = MergeSectionInfo.VerticesTransform.TransformFVector4(DestVert.Position);
-	DestVert.TangentX = SrcLODData.StaticVertexBuffers.StaticMeshVertexBuffer.VertexTangentX(SourceVertIdx);
-	DestVert.TangentZ = SrcLODData.StaticVertexBuffers.StaticMeshVertexBuffer.VertexTangentZ(SourceVertIdx);
+	MergedVertexBuffer.SetNum(NumVertices, false);
+	MergedSkinWeightBuffer.SetNum(NumVertices, false);
+	MergedColorBuffer.SetNum(bHasColors ? NumVertices : 0, false);
+	MergedIndexBuffer.SetNum(NumIndices, false);
 
-	// Copy all UVs that are available
-	uint32 LODNumTexCoords = SrcLODData.StaticVertexBuffers.StaticMeshVertexBuffer.GetNumTexCoords();
-	for (uint32 UVIndex = 0; UVIndex < LODNumTexCoords && UVIndex < VertexDataType::NumTexCoords; ++UVIndex)
+	for (const FSplicedSection& SplicedSection : SplicedSections)
 	{
-		FVector2D UVs = SrcLODData.StaticVertexBuffers.StaticMeshVertexBuffer.GetVertexUV_Typed<VertexDataType::StaticMeshVertexUVType>(SourceVertIdx, UVIndex);
-		if (UVIndex < (uint32)MergeSectionInfo.UVTransforms.Num())
+		FSkelMeshMergeSectionCache& SectionCache = IncrementalState->Sections.FindChecked(SplicedSection.Key);
+		if (SplicedSection.PreviousBaseVertexIndex == INDEX_NONE)
 		{
-			FVector Transformed = MergeSectionInfo.UVTransforms[UVIndex].TransformPosition(FVector(UVs, 1.f));
-			UVs = FVector2D(Transformed.X, Transformed.Y);
+			// only the ranges of changed sections are rebuilt
+			const FMergeSectionInfo& MergeSectionInfo = *SplicedSection.MergeSectionInfo;
+			const FSkeletalMeshLODRenderData& SrcLODData = MergeSectionInfo.SkelMesh->GetResourceForRendering()->LODRenderData[SplicedSection.SourceLODIdx];
+			WriteSectionStreams<VertexDataType, SkinWeightType>(SectionCache, SplicedSection.SourceLODIdx, SrcLODData, MergeSectionInfo, MergedVertexBuffer, MergedSkinWeightBuffer, MergedColorBuffer, MergedIndexBuffer);
+		}
+		else if (SectionCache.BaseVertexIndex != SplicedSection.PreviousBaseVertexIndex)
+		{
+			// rebase the indices of reused streams that moved
+			SCOPE_CYCLE_COUNTER(STAT_SkeletalMeshMerge_Indices);
+			const uint32 VertexOffset = (uint32)(SectionCache.BaseVertexIndex - SplicedSection.PreviousBaseVertexIndex);
+			uint32* Indices = MergedIndexBuffer.GetData() + SectionCache.BaseIndex;
+			for (int32 Idx = 0; Idx < SectionCache.NumIndices; Idx++)
+			{
+				Indices[Idx] += VertexOffset;
+			}
+		}
+
+		if (SectionCache.NumIndices > 0)
+		{
+			MaxIndex = FMath::Max<uint32>(MaxIndex, SectionCache.BaseVertexIndex + SectionCache.MaxRelativeIndex);
+		}
+		if (SectionCache.NumVertices > 0)
+		{
+			bSourceHasExtraBoneInfluences |= SectionCache.bSourceExtraBoneInfluence;
+			TotalNumUVs = FMath::Max(TotalNumUVs, SectionCache.NumTexCoords);
 		}
-		DestVert.UVs[UVIndex] = UVs;
 	}
 }
 
-template<typename SkinWeightType, bool bHasExtraBoneInfluences>
-void FCustomSkeletalMeshMerge::CopyWeightFromSource(SkinWeightType& DestWeight, const FSkeletalMeshLODRenderData& SrcLODData, int32 SourceVertIdx, const FMergeSectionInfo& MergeSectionInfo)
+template<typename VertexDataType, typename SkinWeightType>
+void FCustomSkeletalMeshMerge::WriteSectionStreams(FSkelMeshMergeSectionCache& SectionCache, int32 SourceLODIdx, const FSkeletalMeshLODRenderData& SrcLODData, const FMergeSectionInfo& MergeSectionInfo, TArray<VertexDataType>& MergedVertexBuffer, TArray<SkinWeightType>& MergedSkinWeightBuffer, TArray<FColor>& MergedColorBuffer, TArray<uint32>& MergedIndexBuffer)
 {
-	const TSkinWeightInfo<bHasExtraBoneInfluences>* SrcSkinWeights = SrcLODData.SkinWeightVertexBuffer.GetSkinWeightPtr<bHasExtraBoneInfluences>(SourceVertIdx);
+	SCOPE_CYCLE_COUNTER(STAT_SkeletalMeshMerge_Vertices);
+
+	const FSkelMeshRenderSection& SrcSection = *MergeSectionInfo.Section;
+
+	SectionCache.SkelMesh = const_cast<USkeletalMesh*>(MergeSectionInfo.SkelMesh);
+	SectionCache.SourceLODIdx = SourceLODIdx;
+	SectionCache.VertexLayout = GetMergeVertexLayout<VertexDataType, SkinWeightType>();
+	SectionCache.NumTexCoords = SrcLODData.StaticVertexBuffers.StaticMeshVertexBuffer.GetNumTexCoords();
+	SectionCache.bSourceExtraBoneInfluence = SrcLODData.SkinWeightVertexBuffer.HasExtraBoneInfluences();
+	SectionCache.bHasColors = MergedData.bHasVertexColors;
+	SectionCache.VerticesTransform = MergeSectionInfo.VerticesTransform;
+	SectionCache.UVTransforms = MergeSectionInfo.UVTransforms;
+	SectionCache.BoneMapToMergedBoneMap = MergeSectionInfo.BoneMapToMergedBoneMap;
+	SectionCache.MaxRelativeIndex = 0;
+
+	const int32 NumVertices = SectionCache.NumVertices;
+	VertexDataType* DestVerts = MergedVertexBuffer.GetData() + SectionCache.BaseVertexIndex;
+	SkinWeightType* DestWeights = MergedSkinWeightBuffer.GetData() + SectionCache.BaseVertexIndex;
+	FColor* DestColors = SectionCache.bHasColors ? MergedColorBuffer.GetData() + SectionCache.BaseVertexIndex : nullptr;
+	uint32* DestIndices = MergedIndexBuffer.GetData() + SectionCache.BaseIndex;
+
+	// build from the part's merge-ready streams when they are kept
+	if (SrcMeshInfo[MergeSectionInfo.PartIdx].ReadyRecord.IsValid())
+	{
+		const FSkelMeshMergeReadySectionPtr ReadySection = FindOrBuildReadySection<VertexDataType, SkinWeightType>(SourceLODIdx, SrcLODData, MergeSectionInfo);
+		check(ReadySection->Vertices.Num() == NumVertices * sizeof(VertexDataType) && ReadySection->Indices.Num() == SectionCache.NumIndices);
+
+		TransformReadySection<VertexDataType, SkinWeightType>(*ReadySection, MergeSectionInfo.VerticesTransform, MergeSectionInfo.UVTransforms, MergeSectionInfo.BoneMapToMergedBoneMap,
+			DestVerts, DestWeights);
+
+		if (DestColors)
+		{
+			for (int32 Idx = 0; Idx < NumVertices; Idx++)
+			{
+				DestColors[Idx] = Idx < ReadySection->Colors.Num() ? ReadySection->Colors[Idx] : FColor(255, 255, 255);
+			}
+		}
+
+		SCOPE_CYCLE_COUNTER(STAT_SkeletalMeshMerge_Indices);
+		for (int32 Idx = 0; Idx < SectionCache.NumIndices; Idx++)
+		{
+			const uint32 RelativeIndex = ReadySection->Indices[Idx];
+			DestIndices[Idx] = RelativeIndex + SectionCache.BaseVertexIndex;
+			SectionCache.MaxRelativeIndex = FMath::Max(SectionCache.MaxRelativeIndex, RelativeIndex);
+		}
+		return;
+	}
+
+	const int32 MaxColorIdx = SrcLODData.StaticVertexBuffers.ColorVertexBuffer.GetNumVertices();
+
+	for (int32 Idx = 0; Idx < NumVertices; Idx++)
+	{
+		const int32 VertIdx = SrcSection.BaseVertexIndex + Idx;
+		VertexDataType& DestVert = DestVerts[Idx];
+		SkinWeightType& DestWeight = DestWeights[Idx];
+
+		SkelMeshMergeKernels::CopyVertexFromSource<VertexDataType>(DestVert, SrcLODData, VertIdx, MergeSectionInfo.VerticesTransform, MergeSectionInfo.UVTransforms);
+
+		if (SectionCache.bSourceExtraBoneInfluence)
+		{
+			SkelMeshMergeKernels::CopyWeightFromSource<SkinWeightType, true>(DestWeight, SrcLODData, VertIdx);
+		}
+		else
+		{
+			SkelMeshMergeKernels::CopyWeightFromSource<SkinWeightType, false>(DestWeight, SrcLODData, VertIdx);
+		}
+
+		if (DestColors)
+		{
+			DestColors[Idx] = VertIdx < MaxColorIdx ? SrcLODData.StaticVertexBuffers.ColorVertexBuffer.VertexColor(VertIdx) : FColor(255, 255, 255);
+		}
 
-	// if source doesn't have extra influence, we have to clear the buffer
-	FMemory::Memzero(DestWeight.InfluenceBones);
-	FMemory::Memzero(DestWeight.InfluenceWeights);
+		// remap the bone index used by this vertex to match the mergedbonemap 
+		SkelMeshMergeKernels::RemapInfluenceBones(DestWeight, MergeSectionInfo.BoneMapToMergedBoneMap);
+	}
 
-	FMemory::Memcpy(DestWeight.InfluenceBones, SrcSkinWeights->InfluenceBones, sizeof(SrcSkinWeights->InfluenceBones));
-	FMemory::Memcpy(DestWeight.InfluenceWeights, SrcSkinWeights->InfluenceWeights, sizeof(SrcSkinWeights->InfluenceWeights));
+	SCOPE_CYCLE_COUNTER(STAT_SkeletalMeshMerge_Indices);
+	for (int32 Idx = 0; Idx < SectionCache.NumIndices; Idx++)
+	{
+		const uint32 SrcIndex = SrcLODData.MultiSizeIndexContainer.GetIndexBuffer()->Get(SrcSection.BaseIndex + Idx);
+		checkSlow(SrcIndex >= SrcSection.BaseVertexIndex);
+		const uint32 RelativeIndex = SrcIndex - SrcSection.BaseVertexIndex;
+		DestIndices[Idx] = RelativeIndex + SectionCache.BaseVertexIndex;
+		SectionCache.MaxRelativeIndex = FMath::Max(SectionCache.MaxRelativeIndex, RelativeIndex);
+	}
 }
 
 /**
-* Creates a new LOD model and adds the new merged sections to it. Modifies the MergedMesh.
+* Creates a new LOD model and adds the new merged sections to it. Only modifies the prepared data.
 * @param LODIdx - current LOD to process
 */
 template<typename VertexDataType, typename SkinWeightType>
 void FCustomSkeletalMeshMerge::GenerateLODModel(int32 LODIdx)
 {
-	// add the new LOD model entry
-	FSkeletalMeshRenderData* MergeResource = MergeMesh->GetResourceForRendering();
-	check(MergeResource);
+	SCOPE_CYCLE_COUNTER(STAT_SkeletalMeshMerge_GenerateLODModel);
+	SKELETALMESHMERGE_TRACE_SCOPE(SkeletalMeshMerge_GenerateLODModel);
+	SKELETALMESHMERGE_LLM_SCOPE(Geometry);
 
-	FSkeletalMeshLODRenderData& MergeLODData = *new FSkeletalMeshLODRenderData;
-	MergeResource->LODRenderData.Add(&MergeLODData);
+	// add the new LOD model entry, or refill the recycled one
+	const int32 MergeLODIdx = MergedData.LODInfo.Num();
+	if (MergeLODIdx == MergedData.LODRenderData.Num())
+	{
+		MergedData.LODRenderData.Add(new FSkeletalMeshLODRenderData);
+	}
+	FSkeletalMeshLODRenderData& MergeLODData = MergedData.LODRenderData[MergeLODIdx];
+	MergeLODData.RenderSections.Reset();
+	MergeLODData.ActiveBoneIndices.Reset();
+	MergeLODData.RequiredBones.Reset();
 	// add the new LOD info entry
-	FSkeletalMeshLODInfo& MergeLODInfo = MergeMesh->AddLODInfo();
+	FMergedLODInfo& MergeLODInfo = MergedData.LODInfo[MergedData.LODInfo.AddDefaulted()];
 	MergeLODInfo.ScreenSize = MergeLODInfo.LODHysteresis = MAX_FLT;
 
 	// generate an array with info about new sections that need to be created
@@ -854,6 +1845,18 @@ void FCustomSkeletalMeshMerge::GenerateLODModel(int32 LODIdx)
 
 	uint32 MaxIndex = 0;
 
+	// size the merged buffers once for all the source sections
+	int32 NumMergedVertices = 0;
+	int32 NumMergedIndices = 0;
+	for (const FNewSectionInfo& NewSectionInfo : NewSectionArray)
+	{
+		for (const FMergeSectionInfo& MergeSectionInfo : NewSectionInfo.MergeSections)
+		{
+			NumMergedVertices += MergeSectionInfo.Section->NumVertices;
+			NumMergedIndices += MergeSectionInfo.Section->NumTriangles * 3;
+		}
+	}
+
 	// merged vertex buffer
 	TArray< VertexDataType > MergedVertexBuffer;
 	// merged skin weight buffer
@@ -863,14 +1866,63 @@ void FCustomSkeletalMeshMerge::GenerateLODModel(int32 LODIdx)
 	// merged index buffer
 	TArray<uint32> MergedIndexBuffer;
 
+	typedef TSkelMeshMergeLODBuffers<VertexDataType, SkinWeightType> FLODBuffers;
+	if (IncrementalState)
+	{
+		// incremental merges patch the buffers of the previous merge
+		TUniquePtr<FSkelMeshMergeLODBuffers> PreviousBuffers;
+		if (TUniquePtr<FSkelMeshMergeLODBuffers>* FoundBuffers = PreviousLODBuffers.Find(LODIdx))
+		{
+			PreviousBuffers = MoveTemp(*FoundBuffers);
+		}
+		if (PreviousBuffers.IsValid() && PreviousBuffers->VertexLayout == GetMergeVertexLayout<VertexDataType, SkinWeightType>())
+		{
+			FLODBuffers& TypedBuffers = static_cast<FLODBuffers&>(*PreviousBuffers);
+			MergedVertexBuffer = MoveTemp(TypedBuffers.Vertices);
+			MergedSkinWeightBuffer = MoveTemp(TypedBuffers.SkinWeights);
+			MergedColorBuffer = MoveTemp(TypedBuffers.Colors);
+			MergedIndexBuffer = MoveTemp(TypedBuffers.Indices);
+		}
+		MergedVertexBuffer.Reserve(NumMergedVertices);
+		MergedSkinWeightBuffer.Reserve(NumMergedVertices);
+		MergedColorBuffer.Reserve(MergedData.bHasVertexColors ? NumMergedVertices : 0);
+		MergedIndexBuffer.Reserve(NumMergedIndices);
+	}
+	else
+	{
+		// the intermediate buffers reuse the allocations of earlier merges
+		MergedVertexBuffer = FCustomSkeletalMeshMergePool::AcquireScratch<VertexDataType>(NumMergedVertices);
+		MergedSkinWeightBuffer = FCustomSkeletalMeshMergePool::AcquireScratch<SkinWeightType>(NumMergedVertices);
+		MergedColorBuffer = FCustomSkeletalMeshMergePool::AcquireScratch<FColor>(MergedData.bHasVertexColors ? NumMergedVertices : 0);
+		MergedIndexBuffer = FCustomSkeletalMeshMergePool::AcquireScratch<uint32>(NumMergedIndices);
+	}
+
+	const SIZE_T ReservedBytes[] = { MergedVertexBuffer.GetAllocatedSize(), MergedSkinWeightBuffer.GetAllocatedSize(),
+		MergedColorBuffer.GetAllocatedSize(), MergedIndexBuffer.GetAllocatedSize() };
+	const SIZE_T IntermediateBytes = ReservedBytes[0] + ReservedBytes[1] + ReservedBytes[2] + ReservedBytes[3];
+	INC_MEMORY_STAT_BY(STAT_SkeletalMeshMerge_IntermediateMemory, IntermediateBytes);
+
 	// The total number of UV sets for this LOD model
 	uint32 TotalNumUVs = 0;
 
 	// true if any extra bone influence exists
 	bool bSourceHasExtraBoneInfluences = false;
 
+	if (IncrementalState)
+	{
+		// only the streams of sections that changed since the last merge are rebuilt
+		SpliceIncrementalSections<VertexDataType, SkinWeightType>(LODIdx, NewSectionArray, MergedVertexBuffer, MergedSkinWeightBuffer, MergedColorBuffer, MergedIndexBuffer,
+			MaxIndex, TotalNumUVs, bSourceHasExtraBoneInfluences);
+	}
+
+	// where the next source section starts in the merged buffers
+	int32 VertexCursor = 0;
+	int32 IndexCursor = 0;
+
 	for (int32 CreateIdx = 0; CreateIdx < NewSectionArray.Num(); CreateIdx++)
 	{
+		SKELETALMESHMERGE_TRACE_SCOPE(SkeletalMeshMerge_Section);
+
 		FNewSectionInfo& NewSectionInfo = NewSectionArray[CreateIdx];
 
 		// ActiveBoneIndices contains all the bones used by the verts from all the sections of this LOD model
@@ -891,15 +1943,15 @@ void FCustomSkeletalMeshMerge::GenerateLODModel(int32 LODIdx)
 		Section.NumVertices = 0;
 
 		// keep track of the current base vertex for this section in the merged vertex buffer
-		Section.BaseVertexIndex = MergedVertexBuffer.Num();
+		Section.BaseVertexIndex = VertexCursor;
 
 
 		// find existing material index
-		check(MergeMesh->Materials.Num() == MaterialIds.Num());
+		check(MergedData.Materials.Num() == MaterialIds.Num());
 		int32 MatIndex;
 		if (NewSectionInfo.MaterialId == -1)
 		{
-			MatIndex = MergeMesh->Materials.Find(NewSectionInfo.Material);
+			MatIndex = MergedData.Materials.Find(NewSectionInfo.Material);
 		}
 		else
 		{
@@ -911,9 +1963,9 @@ void FCustomSkeletalMeshMerge::GenerateLODModel(int32 LODIdx)
 		{
 			FSkeletalMaterial SkeletalMaterial(NewSectionInfo.Material, true);
 			SkeletalMaterial.UVChannelData = NewSectionInfo.UVChannelData;
-			MergeMesh->Materials.Add(SkeletalMaterial);
+			MergedData.Materials.Add(SkeletalMaterial);
 			MaterialIds.Add(NewSectionInfo.MaterialId);
-			Section.MaterialIndex = MergeMesh->Materials.Num() - 1;
+			Section.MaterialIndex = MergedData.Materials.Num() - 1;
 		}
 		else
 		{
@@ -923,15 +1975,17 @@ void FCustomSkeletalMeshMerge::GenerateLODModel(int32 LODIdx)
 		// init tri totals
 		Section.NumTriangles = 0;
 		// keep track of the current base index for this section in the merged index buffer
-		Section.BaseIndex = MergedIndexBuffer.Num();
+		Section.BaseIndex = IndexCursor;
 
-		FMeshUVChannelInfo& MergedUVData = MergeMesh->Materials[Section.MaterialIndex].UVChannelData;
+		FMeshUVChannelInfo& MergedUVData = MergedData.Materials[Section.MaterialIndex].UVChannelData;
 
 		// iterate over all of the sections that need to be merged together
 		for (int32 MergeIdx = 0; MergeIdx < NewSectionInfo.MergeSections.Num(); MergeIdx++)
 		{
+			SKELETALMESHMERGE_TRACE_SCOPE(SkeletalMeshMerge_SourceSection);
+
 			FMergeSectionInfo& MergeSectionInfo = NewSectionInfo.MergeSections[MergeIdx];
-			int32 SourceLODIdx = FMath::Min(LODIdx, MergeSectionInfo.SkelMesh->GetResourceForRendering()->LODRenderData.Num() - 1);
+			int32 SourceLODIdx = GetSourceLODIdx(MergeSectionInfo.PartIdx, LODIdx);
 
 			// Take the max UV density for each UVChannel between all sections that are being merged.
 			{
@@ -975,7 +2029,7 @@ void FCustomSkeletalMeshMerge::GenerateLODModel(int32 LODIdx)
 			for (int32 Idx = 0; Idx < SrcLODData.RequiredBones.Num(); Idx++)
 			{
 				FName SrcLODBoneName = MergeSectionInfo.SkelMesh->RefSkeleton.GetBoneName(SrcLODData.RequiredBones[Idx]);
-				int32 MergeBoneIndex = NewRefSkeleton.FindBoneIndex(SrcLODBoneName);
+				int32 MergeBoneIndex = MergedData.RefSkeleton.FindBoneIndex(SrcLODBoneName);
 
 				if (MergeBoneIndex != INDEX_NONE)
 				{
@@ -986,6 +2040,9 @@ void FCustomSkeletalMeshMerge::GenerateLODModel(int32 LODIdx)
 			// update vert total
 			Section.NumVertices += MergeSectionInfo.Section->NumVertices;
 
+			// update total number of triangles
+			Section.NumTriangles += MergeSectionInfo.Section->NumTriangles;
+
 			// update total number of vertices 
 			int32 NumTotalVertices = MergeSectionInfo.Section->NumVertices;
 
@@ -999,174 +2056,247 @@ void FCustomSkeletalMeshMerge::GenerateLODModel(int32 LODIdx)
 
 			// keep track of the current base vertex index before adding any new vertices
 			// this will be needed to remap the index buffer values to the new range
-			int32 CurrentBaseVertexIndex = MergedVertexBuffer.Num();
+			int32 CurrentBaseVertexIndex = VertexCursor;
 			const bool bSourceExtraBoneInfluence = SrcLODData.SkinWeightVertexBuffer.HasExtraBoneInfluences();
-			for (int32 VertIdx = MergeSectionInfo.Section->BaseVertexIndex; VertIdx < MaxVertIdx; VertIdx++)
+			if (IncrementalState)
+			{
+				// the streams of this section were spliced with the rest of the LOD
+				const FSkelMeshMergeSectionCache& SectionCache = IncrementalState->Sections.FindChecked(FIntVector(MergeSectionInfo.PartIdx, LODIdx, MergeSectionInfo.SectionIdx));
+				check(SectionCache.BaseVertexIndex == CurrentBaseVertexIndex);
+				VertexCursor += SectionCache.NumVertices;
+				IndexCursor += SectionCache.NumIndices;
+			}
+			else if (SrcMeshInfo[MergeSectionInfo.PartIdx].ReadyRecord.IsValid())
 			{
-				// add the new vertex
-				VertexDataType& DestVert = MergedVertexBuffer[MergedVertexBuffer.AddUninitialized()];
-				SkinWeightType& DestWeight = MergedSkinWeightBuffer[MergedSkinWeightBuffer.AddUninitialized()];
+				SCOPE_CYCLE_COUNTER(STAT_SkeletalMeshMerge_Vertices);
 
-				CopyVertexFromSource<VertexDataType>(DestVert, SrcLODData, VertIdx, MergeSectionInfo);
+				// concatenate the merge-ready streams of the part, converting the section on first use
+				const FSkelMeshMergeReadySectionPtr ReadySection = FindOrBuildReadySection<VertexDataType, SkinWeightType>(SourceLODIdx, SrcLODData, MergeSectionInfo);
+				AppendReadySection<VertexDataType, SkinWeightType>(*ReadySection, MergeSectionInfo, MergedVertexBuffer, MergedSkinWeightBuffer, MergedColorBuffer, MergedIndexBuffer, MaxIndex);
 
-				bSourceHasExtraBoneInfluences |= bSourceExtraBoneInfluence;
-				if (bSourceExtraBoneInfluence)
-				{
-					CopyWeightFromSource<SkinWeightType, true>(DestWeight, SrcLODData, VertIdx, MergeSectionInfo);
-				}
-				else
+				if (MaxVertIdx > (int32)MergeSectionInfo.Section->BaseVertexIndex)
 				{
-					CopyWeightFromSource<SkinWeightType, false>(DestWeight, SrcLODData, VertIdx, MergeSectionInfo);
+					bSourceHasExtraBoneInfluences |= bSourceExtraBoneInfluence;
+					TotalNumUVs = FMath::Max(TotalNumUVs, ReadySection->NumTexCoords);
 				}
+				VertexCursor = MergedVertexBuffer.Num();
+				IndexCursor = MergedIndexBuffer.Num();
+			}
+			else
+			{
+				SCOPE_CYCLE_COUNTER(STAT_SkeletalMeshMerge_Vertices);
 
-				// if the mesh uses vertex colors, copy the source color if possible or default to white
-				if (MergeMesh->bHasVertexColors)
+				for (int32 VertIdx = MergeSectionInfo.Section->BaseVertexIndex; VertIdx < MaxVertIdx; VertIdx++)
 				{
-					if (VertIdx < MaxColorIdx)
+					// add the new vertex
+					VertexDataType& DestVert = MergedVertexBuffer[MergedVertexBuffer.AddUninitialized()];
+					SkinWeightType& DestWeight = MergedSkinWeightBuffer[MergedSkinWeightBuffer.AddUninitialized()];
+
+					SkelMeshMergeKernels::CopyVertexFromSource<VertexDataType>(DestVert, SrcLODData, VertIdx, MergeSectionInfo.VerticesTransform, MergeSectionInfo.UVTransforms);
+
+					bSourceHasExtraBoneInfluences |= bSourceExtraBoneInfluence;
+					if (bSourceExtraBoneInfluence)
 					{
-						const FColor& SrcColor = SrcLODData.StaticVertexBuffers.ColorVertexBuffer.VertexColor(VertIdx);
-						MergedColorBuffer.Add(SrcColor);
+						SkelMeshMergeKernels::CopyWeightFromSource<SkinWeightType, true>(DestWeight, SrcLODData, VertIdx);
 					}
 					else
 					{
-						const FColor ColorWhite(255, 255, 255);
-						MergedColorBuffer.Add(ColorWhite);
+						SkelMeshMergeKernels::CopyWeightFromSource<SkinWeightType, false>(DestWeight, SrcLODData, VertIdx);
 					}
-				}
 
-				uint32 LODNumTexCoords = SrcLODData.StaticVertexBuffers.StaticMeshVertexBuffer.GetNumTexCoords();
-				if (TotalNumUVs < LODNumTexCoords)
-				{
-					TotalNumUVs = LODNumTexCoords;
-				}
-
-				// remap the bone index used by this vertex to match the mergedbonemap 
-				for (int32 Idx = 0; Idx < SkinWeightType::NumInfluences; Idx++)
-				{
-					if (DestWeight.InfluenceWeights[Idx] > 0)
+					// if the mesh uses vertex colors, copy the source color if possible or default to white
+					if (MergedData.bHasVertexColors)
 					{
-						checkSlow(MergeSectionInfo.BoneMapToMergedBoneMap.IsValidIndex(DestWeight.InfluenceBones[Idx]));
-						DestWeight.InfluenceBones[Idx] = (uint8)MergeSectionInfo.BoneMapToMergedBoneMap[DestWeight.InfluenceBones[Idx]];
+						if (VertIdx < MaxColorIdx)
+						{
+							const FColor& SrcColor = SrcLODData.StaticVertexBuffers.ColorVertexBuffer.VertexColor(VertIdx);
+							MergedColorBuffer.Add(SrcColor);
+						}
+						else
+						{
+							const FColor ColorWhite(255, 255, 255);
+							MergedColorBuffer.Add(ColorWhite);
+						}
 					}
-				}
-			}
-
-			// update total number of triangles
-			Section.NumTriangles += MergeSectionInfo.Section->NumTriangles;
 
-			// add the indices from the original source mesh to the merged index buffer					
-			int32 MaxIndexIdx = FMath::Min<int32>(
-				MergeSectionInfo.Section->BaseIndex + MergeSectionInfo.Section->NumTriangles * 3,
-				SrcLODData.MultiSizeIndexContainer.GetIndexBuffer()->Num()
-				);
-			for (int32 IndexIdx = MergeSectionInfo.Section->BaseIndex; IndexIdx < MaxIndexIdx; IndexIdx++)
-			{
-				uint32 SrcIndex = SrcLODData.MultiSizeIndexContainer.GetIndexBuffer()->Get(IndexIdx);
+					uint32 LODNumTexCoords = SrcLODData.StaticVertexBuffers.StaticMeshVertexBuffer.GetNumTexCoords();
+					if (TotalNumUVs < LODNumTexCoords)
+					{
+						TotalNumUVs = LODNumTexCoords;
+					}
 
-				// add offset to each index to match the new entries in the merged vertex buffer
-				checkSlow(SrcIndex >= MergeSectionInfo.Section->BaseVertexIndex);
-				uint32 DstIndex = SrcIndex - MergeSectionInfo.Section->BaseVertexIndex + CurrentBaseVertexIndex;
-				checkSlow(DstIndex < (uint32)MergedVertexBuffer.Num());
+					// remap the bone index used by this vertex to match the mergedbonemap 
+					SkelMeshMergeKernels::RemapInfluenceBones(DestWeight, MergeSectionInfo.BoneMapToMergedBoneMap);
+				}
 
-				// add the new index to the merged vertex buffer
-				MergedIndexBuffer.Add(DstIndex);
-				if (MaxIndex < DstIndex)
+				// add the indices from the original source mesh to the merged index buffer					
 				{
-					MaxIndex = DstIndex;
+					SCOPE_CYCLE_COUNTER(STAT_SkeletalMeshMerge_Indices);
+
+					int32 MaxIndexIdx = FMath::Min<int32>(
+						MergeSectionInfo.Section->BaseIndex + MergeSectionInfo.Section->NumTriangles * 3,
+						SrcLODData.MultiSizeIndexContainer.GetIndexBuffer()->Num()
+						);
+					SkelMeshMergeKernels::AppendSourceIndices(*SrcLODData.MultiSizeIndexContainer.GetIndexBuffer(), MergeSectionInfo.Section->BaseIndex, MaxIndexIdx,
+						MergeSectionInfo.Section->BaseVertexIndex, CurrentBaseVertexIndex, MergedIndexBuffer, MaxIndex);
 				}
-
+				VertexCursor = MergedVertexBuffer.Num();
+				IndexCursor = MergedIndexBuffer.Num();
 			}
 
 			{
-				if (MergeSectionInfo.Section->DuplicatedVerticesBuffer.bHasOverlappingVertices)
+				SCOPE_CYCLE_COUNTER(STAT_SkeletalMeshMerge_DuplicatedVertices);
+
+				// append the duplicated vertices of the source section, rebased to the merged vertex buffer
+				FDuplicatedVerticesBuffer& DupVerts = Section.DuplicatedVerticesBuffer;
+				FDuplicatedVerticesBuffer& SrcDupVerts = const_cast<FDuplicatedVerticesBuffer&>(MergeSectionInfo.Section->DuplicatedVerticesBuffer);
+				const int32 StartVertex = DupVerts.DupVertIndexData.Num();
+				const int32 NumNewVertices = Section.NumVertices - StartVertex;
+				DupVerts.DupVertIndexData.ResizeBuffer(Section.NumVertices);
+				FIndexLengthPair* IndexData = (FIndexLengthPair*)DupVerts.DupVertIndexData.GetDataPointer() + StartVertex;
+
+				if (SrcDupVerts.bHasOverlappingVertices)
 				{
-					if (Section.DuplicatedVerticesBuffer.bHasOverlappingVertices)
+					// sections without duplicates only hold a placeholder entry
+					const int32 StartIndex = DupVerts.bHasOverlappingVertices ? DupVerts.DupVertData.Num() : 0;
+					DupVerts.DupVertData.ResizeBuffer(StartIndex + SrcDupVerts.DupVertData.Num());
+
+					const uint32* SrcVertData = (const uint32*)SrcDupVerts.DupVertData.GetDataPointer();
+					uint32* VertData = (uint32*)DupVerts.DupVertData.GetDataPointer() + StartIndex;
+					for (int32 i = 0; i < SrcDupVerts.DupVertData.Num(); ++i)
 					{
-						// Merge
-						int32 StartIndex = Section.DuplicatedVerticesBuffer.DupVertData.Num();
-						int32 StartVertex = Section.DuplicatedVerticesBuffer.DupVertIndexData.Num();
-						Section.DuplicatedVerticesBuffer.DupVertData.ResizeBuffer(StartIndex + MergeSectionInfo.Section->DuplicatedVerticesBuffer.DupVertData.Num());
-						Section.DuplicatedVerticesBuffer.DupVertIndexData.ResizeBuffer(Section.NumVertices);
-
-						uint8* VertData = Section.DuplicatedVerticesBuffer.DupVertData.GetDataPointer();
-						uint8* IndexData = Section.DuplicatedVerticesBuffer.DupVertIndexData.GetDataPointer();
-						for (int32 i = StartIndex; i < Section.DuplicatedVerticesBuffer.DupVertData.Num(); ++i)
-						{
-							*((uint32*)(VertData + i * sizeof(uint32))) += CurrentBaseVertexIndex - MergeSectionInfo.Section->BaseVertexIndex;
-						}
-						for (uint32 i = StartVertex; i < Section.NumVertices; ++i)
-						{
-							((FIndexLengthPair*)(IndexData + i * sizeof(FIndexLengthPair)))->Index += StartIndex;
-						}
+						VertData[i] = SrcVertData[i] + CurrentBaseVertexIndex - MergeSectionInfo.Section->BaseVertexIndex;
 					}
-					else
+
+					const FIndexLengthPair* SrcIndexData = (const FIndexLengthPair*)SrcDupVerts.DupVertIndexData.GetDataPointer();
+					for (int32 i = 0; i < NumNewVertices; ++i)
 					{
-						Section.DuplicatedVerticesBuffer.DupVertData = MergeSectionInfo.Section->DuplicatedVerticesBuffer.DupVertData;
-						Section.DuplicatedVerticesBuffer.DupVertIndexData = MergeSectionInfo.Section->DuplicatedVerticesBuffer.DupVertIndexData;
-						uint8* VertData = Section.DuplicatedVerticesBuffer.DupVertData.GetDataPointer();
-						for (uint32 i = 0; i < MergeSectionInfo.Section->NumVertices; ++i)
-						{
-							*((uint32*)(VertData + i * sizeof(uint32))) += CurrentBaseVertexIndex - MergeSectionInfo.Section->BaseVertexIndex;
-						}
+						IndexData[i].Index = SrcIndexData[i].Index + StartIndex;
+						IndexData[i].Length = SrcIndexData[i].Length;
 					}
-					Section.DuplicatedVerticesBuffer.bHasOverlappingVertices = true;
+					DupVerts.bHasOverlappingVertices = true;
 				}
 				else
 				{
-					Section.DuplicatedVerticesBuffer.DupVertData.ResizeBuffer(1);
-					Section.DuplicatedVerticesBuffer.DupVertIndexData.ResizeBuffer(Section.NumVertices);
-
-					uint8* VertData = Section.DuplicatedVerticesBuffer.DupVertData.GetDataPointer();
-					uint8* IndexData = Section.DuplicatedVerticesBuffer.DupVertIndexData.GetDataPointer();
-
-					FMemory::Memzero(IndexData, Section.NumVertices * sizeof(FIndexLengthPair));
-					FMemory::Memzero(VertData, sizeof(uint32));
+					if (DupVerts.DupVertData.Num() == 0)
+					{
+						DupVerts.DupVertData.ResizeBuffer(1);
+						FMemory::Memzero(DupVerts.DupVertData.GetDataPointer(), sizeof(uint32));
+					}
+					FMemory::Memzero(IndexData, NumNewVertices * sizeof(FIndexLengthPair));
 				}
 			}
 		}
 	}
 
 	const bool bNeedsCPUAccess = (MeshBufferAccess == EMeshBufferAccess::ForceCPUAndGPU) ||
-		MergeResource->RequiresCPUSkinning(GMaxRHIFeatureLevel);
+		LODRequiresCPUSkinning(MergeLODData, bSourceHasExtraBoneInfluences);
+	MergeLODInfo.bNeedsCPUAccess = bNeedsCPUAccess;
 
 	// sort required bone array in strictly increasing order
 	MergeLODData.RequiredBones.Sort();
-	MergeMesh->RefSkeleton.EnsureParentsExistAndSort(MergeLODData.ActiveBoneIndices);
+	MergedData.RefSkeleton.EnsureParentsExistAndSort(MergeLODData.ActiveBoneIndices);
 
-	// copy the new vertices and indices to the vertex buffer for the new model
-	MergeLODData.StaticVertexBuffers.StaticMeshVertexBuffer.SetUseFullPrecisionUVs(MergeMesh->bUseFullPrecisionUVs);
+	// copy the new vertices and indices to the vertex buffer for the new model, recycled buffers of the same layout are overwritten
+	const bool bFillInPlace = CanFillVertexBuffersInPlace(MergeLODData, MergedVertexBuffer.Num(), TotalNumUVs, MergedData.bUseFullPrecisionUVs, bSourceHasExtraBoneInfluences, bNeedsCPUAccess);
+	if (!bFillInPlace)
+	{
+		MergeLODData.StaticVertexBuffers.StaticMeshVertexBuffer.SetUseFullPrecisionUVs(MergedData.bUseFullPrecisionUVs);
 
-	MergeLODData.StaticVertexBuffers.PositionVertexBuffer.Init(MergedVertexBuffer.Num(), bNeedsCPUAccess);
-	MergeLODData.StaticVertexBuffers.StaticMeshVertexBuffer.Init(MergedVertexBuffer.Num(), TotalNumUVs, bNeedsCPUAccess);
+		MergeLODData.StaticVertexBuffers.PositionVertexBuffer.Init(MergedVertexBuffer.Num(), bNeedsCPUAccess);
+		MergeLODData.StaticVertexBuffers.StaticMeshVertexBuffer.Init(MergedVertexBuffer.Num(), TotalNumUVs, bNeedsCPUAccess);
+	}
+	else if (Report)
+	{
+		Report->NumLODsFilledInPlace++;
+	}
 
-	for (int i = 0; i < MergedVertexBuffer.Num(); i++)
 	{
-		MergeLODData.StaticVertexBuffers.PositionVertexBuffer.VertexPosition(i) = MergedVertexBuffer[i].Position;
-		MergeLODData.StaticVertexBuffers.StaticMeshVertexBuffer.SetVertexTangents(i, MergedVertexBuffer[i].TangentX.ToFVector(), MergedVertexBuffer[i].GetTangentY(), MergedVertexBuffer[i].TangentZ.ToFVector());
-		for (uint32 j = 0; j < TotalNumUVs; j++)
+		SCOPE_CYCLE_COUNTER(STAT_SkeletalMeshMerge_Vertices);
+
+		for (int i = 0; i < MergedVertexBuffer.Num(); i++)
 		{
-			MergeLODData.StaticVertexBuffers.StaticMeshVertexBuffer.SetVertexUV(i, j, MergedVertexBuffer[i].UVs[j]);
+			MergeLODData.StaticVertexBuffers.PositionVertexBuffer.VertexPosition(i) = MergedVertexBuffer[i].Position;
+			MergeLODData.StaticVertexBuffers.StaticMeshVertexBuffer.SetVertexTangents(i, MergedVertexBuffer[i].TangentX.ToFVector(), MergedVertexBuffer[i].GetTangentY(), MergedVertexBuffer[i].TangentZ.ToFVector());
+			for (uint32 j = 0; j < TotalNumUVs; j++)
+			{
+				MergeLODData.StaticVertexBuffers.StaticMeshVertexBuffer.SetVertexUV(i, j, MergedVertexBuffer[i].UVs[j]);
+			}
 		}
 	}
 
-	MergeLODData.SkinWeightVertexBuffer.SetHasExtraBoneInfluences(bSourceHasExtraBoneInfluences);
-	MergeLODData.SkinWeightVertexBuffer.SetNeedsCPUAccess(bNeedsCPUAccess);
-
 	// copy vertex resource arrays
-	MergeLODData.SkinWeightVertexBuffer = MergedSkinWeightBuffer;
+	{
+		SCOPE_CYCLE_COUNTER(STAT_SkeletalMeshMerge_SkinWeights);
+		if (bFillInPlace)
+		{
+			CopySkinWeightsInPlace(MergeLODData.SkinWeightVertexBuffer, MergedSkinWeightBuffer);
+		}
+		else
+		{
+			MergeLODData.SkinWeightVertexBuffer.SetHasExtraBoneInfluences(bSourceHasExtraBoneInfluences);
+			MergeLODData.SkinWeightVertexBuffer.SetNeedsCPUAccess(bNeedsCPUAccess);
+			MergeLODData.SkinWeightVertexBuffer = MergedSkinWeightBuffer;
+		}
+	}
 
-	if (MergeMesh->bHasVertexColors)
+	if (MergedData.bHasVertexColors)
 	{
 		MergeLODData.StaticVertexBuffers.ColorVertexBuffer.InitFromColorArray(MergedColorBuffer);
 	}
+	else
+	{
+		// recycled LOD render data may still hold the colors of the previous merge
+		MergeLODData.StaticVertexBuffers.ColorVertexBuffer.CleanUp();
+	}
+
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_SkeletalMeshMerge_Indices);
+		const uint8 DataTypeSize = (MaxIndex < MAX_uint16) ? sizeof(uint16) : sizeof(uint32);
+		if (!CopyIndicesInPlace(MergeLODData.MultiSizeIndexContainer, DataTypeSize, MergedIndexBuffer))
+		{
+			MergeLODData.MultiSizeIndexContainer.RebuildIndexBuffer(DataTypeSize, MergedIndexBuffer);
+		}
+	}
 
+	if (Report)
+	{
+		// the buffers were reserved for every source section, growing past that means they were reallocated
+		const SIZE_T UsedBytes[] = { MergedVertexBuffer.GetAllocatedSize(), MergedSkinWeightBuffer.GetAllocatedSize(),
+			MergedColorBuffer.GetAllocatedSize(), MergedIndexBuffer.GetAllocatedSize() };
+		SIZE_T TotalUsedBytes = 0;
+		for (int32 BufferIdx = 0; BufferIdx < ARRAY_COUNT(UsedBytes); BufferIdx++)
+		{
+			Report->NumReallocations += UsedBytes[BufferIdx] > ReservedBytes[BufferIdx] ? 1 : 0;
+			TotalUsedBytes += UsedBytes[BufferIdx];
+		}
+		Report->PeakIntermediateBytes = FMath::Max<int64>(Report->PeakIntermediateBytes, TotalUsedBytes);
+	}
 
-	const uint8 DataTypeSize = (MaxIndex < MAX_uint16) ? sizeof(uint16) : sizeof(uint32);
-	MergeLODData.MultiSizeIndexContainer.RebuildIndexBuffer(DataTypeSize, MergedIndexBuffer);
+	DEC_MEMORY_STAT_BY(STAT_SkeletalMeshMerge_IntermediateMemory, IntermediateBytes);
+	if (IncrementalState)
+	{
+		// kept for the next merge to patch
+		TUniquePtr<FLODBuffers> KeptBuffers = MakeUnique<FLODBuffers>();
+		KeptBuffers->VertexLayout = GetMergeVertexLayout<VertexDataType, SkinWeightType>();
+		KeptBuffers->Vertices = MoveTemp(MergedVertexBuffer);
+		KeptBuffers->SkinWeights = MoveTemp(MergedSkinWeightBuffer);
+		KeptBuffers->Colors = MoveTemp(MergedColorBuffer);
+		KeptBuffers->Indices = MoveTemp(MergedIndexBuffer);
+		IncrementalState->LODBuffers.Add(LODIdx, TUniquePtr<FSkelMeshMergeLODBuffers>(MoveTemp(KeptBuffers)));
+	}
+	else
+	{
+		FCustomSkeletalMeshMergePool::ReleaseScratch(MoveTemp(MergedVertexBuffer));
+		FCustomSkeletalMeshMergePool::ReleaseScratch(MoveTemp(MergedSkinWeightBuffer));
+		FCustomSkeletalMeshMergePool::ReleaseScratch(MoveTemp(MergedColorBuffer));
+		FCustomSkeletalMeshMergePool::ReleaseScratch(MoveTemp(MergedIndexBuffer));
+	}
 }
 
 /**
-* (Re)initialize and merge skeletal mesh info from the list of source meshes to the merge mesh
+* (Re)initialize and merge skeletal mesh info from the list of source meshes into the prepared data
 * @return true if succeeded
 */
 bool FCustomSkeletalMeshMerge::ProcessMergeMesh()
@@ -1176,20 +2306,18 @@ bool FCustomSkeletalMeshMerge::ProcessMergeMesh()
 	// copy settings and bone info from src meshes
 	bool bNeedsInit = true;
 
-	MergeMesh->SkelMirrorTable.Empty();
-
-	for (int32 MeshIdx = 0; MeshIdx < SrcMeshList.Num(); MeshIdx++)
+	for (int32 MeshIdx = 0; MeshIdx < SrcParts.Num(); MeshIdx++)
 	{
-		USkeletalMesh* SrcMesh = SrcMeshList[MeshIdx];
+		USkeletalMesh* SrcMesh = SrcParts[MeshIdx].SkeletalMesh;
 		if (SrcMesh)
 		{
 			if (bNeedsInit)
 			{
 				// initialize the merged mesh with the first src mesh entry used
-				MergeMesh->SetImportedBounds(SrcMesh->GetImportedBounds());
+				MergedData.ImportedBounds = SrcMesh->GetImportedBounds();
 
-				MergeMesh->SkelMirrorAxis = SrcMesh->SkelMirrorAxis;
-				MergeMesh->SkelMirrorFlipAxis = SrcMesh->SkelMirrorFlipAxis;
+				MergedData.SkelMirrorAxis = SrcMesh->SkelMirrorAxis;
+				MergedData.SkelMirrorFlipAxis = SrcMesh->SkelMirrorFlipAxis;
 
 				// only initialize once
 				bNeedsInit = false;
@@ -1197,37 +2325,53 @@ bool FCustomSkeletalMeshMerge::ProcessMergeMesh()
 			else
 			{
 				// add bounds
-				MergeMesh->SetImportedBounds(MergeMesh->GetImportedBounds() + SrcMesh->GetImportedBounds());
+				MergedData.ImportedBounds = MergedData.ImportedBounds + SrcMesh->GetImportedBounds();
 			}
 		}
 	}
 
-	// Rebuild inverse ref pose matrices.
-	MergeMesh->RefBasesInvMatrix.Empty();
-	MergeMesh->CalculateInvRefMatrices();
-
 	return Result;
 }
 
-int32 FCustomSkeletalMeshMerge::CalculateLodCount(const TArray<USkeletalMesh*>& SourceMeshList) const
+int32 FCustomSkeletalMeshMerge::CalculateLodCount(TArrayView<const FSkelMeshMergePart> SourceParts) const
 {
 	int32 LodCount = INT_MAX;
+	int32 CutOffLodCount = INT_MAX;
+	int32 LastIncludedLod = 0;
 
-	for (int32 i = 0, MeshCount = SourceMeshList.Num(); i < MeshCount; ++i)
+	for (int32 i = 0, MeshCount = SourceParts.Num(); i < MeshCount; ++i)
 	{
-		USkeletalMesh* SourceMesh = SourceMeshList[i];
+		USkeletalMesh* SourceMesh = SourceParts[i].SkeletalMesh;
 
 		if (SourceMesh)
 		{
-			LodCount = FMath::Min<int32>(LodCount, SourceMesh->GetLODNum());
+			// parts left out past their max LOD do not limit the LODs of the other parts
+			const int32 MaxLOD = SourceParts[i].MaxLOD;
+			if (MaxLOD == INDEX_NONE)
+			{
+				LodCount = FMath::Min<int32>(LodCount, SourceMesh->GetLODNum());
+				LastIncludedLod = INT_MAX;
+			}
+			else
+			{
+				CutOffLodCount = FMath::Min<int32>(CutOffLodCount, SourceMesh->GetLODNum());
+				LastIncludedLod = FMath::Max(LastIncludedLod, StripTopLODs + MaxLOD + 1);
+			}
 		}
 	}
 
+	if (LodCount == INT_MAX)
+	{
+		LodCount = CutOffLodCount;
+	}
 	if (LodCount == INT_MAX)
 	{
 		return -1;
 	}
 
+	// Every LOD must include at least one part.
+	LodCount = FMath::Min(LodCount, LastIncludedLod);
+
 	// Decrease the number of LODs we are going to make based on StripTopLODs.
 	// But, make sure there is at least one.
 
@@ -1237,7 +2381,7 @@ int32 FCustomSkeletalMeshMerge::CalculateLodCount(const TArray<USkeletalMesh*>&
 	return LodCount;
 }
 
-void FCustomSkeletalMeshMerge::BuildReferenceSkeleton(const TArray<USkeletalMesh*>& SourceMeshList, FReferenceSkeleton& RefSkeleton, const USkeleton* SkeletonAsset)
+void FCustomSkeletalMeshMerge::BuildReferenceSkeleton(TArrayView<const FSkelMeshMergePart> SourceParts, FReferenceSkeleton& RefSkeleton, const USkeleton* SkeletonAsset)
 {
 	RefSkeleton.Empty();
 
@@ -1245,9 +2389,9 @@ void FCustomSkeletalMeshMerge::BuildReferenceSkeleton(const TArray<USkeletalMesh
 
 	FReferenceSkeletonModifier RefSkelModifier(RefSkeleton, SkeletonAsset);
 
-	for (int32 MeshIndex = 0; MeshIndex < SourceMeshList.Num(); ++MeshIndex)
+	for (int32 MeshIndex = 0; MeshIndex < SourceParts.Num(); ++MeshIndex)
 	{
-		USkeletalMesh* SourceMesh = SourceMeshList[MeshIndex];
+		USkeletalMesh* SourceMesh = SourceParts[MeshIndex].SkeletalMesh;
 
 		if (!SourceMesh)
 		{
@@ -1361,36 +2505,53 @@ void FCustomSkeletalMeshMerge::ReleaseResources(int32 Slack)
 	}
 
 	MergeMesh->ResetLODInfo();
-	MergeMesh->Materials.Empty();
+	MergeMesh->Materials.Reset();
 }
 
-bool FCustomSkeletalMeshMerge::AddSocket(const USkeletalMeshSocket* NewSocket, bool bIsSkeletonSocket)
+FMergedSocketInfo::FMergedSocketInfo(const USkeletalMeshSocket* InSourceSocket)
+	: SocketName(NAME_None)
+	, BoneName(NAME_None)
+	, RelativeLocation(FVector::ZeroVector)
+	, RelativeRotation(FRotator::ZeroRotator)
+	, RelativeScale(FVector(1.f))
+	, bForceAlwaysAnimated(true)
 {
-	TArray<USkeletalMeshSocket*>& MergeMeshSockets = MergeMesh->GetMeshOnlySocketList();
+	if (InSourceSocket)
+	{
+		SocketName = InSourceSocket->SocketName;
+		BoneName = InSourceSocket->BoneName;
+		RelativeLocation = InSourceSocket->RelativeLocation;
+		RelativeRotation = InSourceSocket->RelativeRotation;
+		RelativeScale = InSourceSocket->RelativeScale;
+		bForceAlwaysAnimated = InSourceSocket->bForceAlwaysAnimated;
+	}
+}
 
-	// Verify the socket doesn't already exist in the current Mesh list.
-	for (USkeletalMeshSocket const * const ExistingSocket : MergeMeshSockets)
+bool FCustomSkeletalMeshMerge::AddSocket(const USkeletalMeshSocket* NewSocket, bool bIsSkeletonSocket)
+{
+	if (!NewSocket)
 	{
-		if (ExistingSocket->SocketName == NewSocket->SocketName)
-		{
-			return false;
-		}
+		return false;
 	}
 
 	// The Skeleton will only be valid in cases where the passed in mesh already had a skeleton
 	// (i.e. an existing mesh was used, or a created mesh was explicitly assigned a skeleton).
 	// In either case, we want to avoid adding sockets to the Skeleton (as it is shared), but we
 	// still need to check against it to prevent duplication.
-	if (bIsSkeletonSocket && MergeMesh->Skeleton)
+	if (bIsSkeletonSocket && SkeletonSocketNames.Contains(NewSocket->SocketName))
 	{
-		for (USkeletalMeshSocket const * const ExistingSocket : MergeMesh->Skeleton->Sockets)
-		{
-			return false;
-		}
+		return false;
+	}
+
+	// Verify the socket doesn't already exist in the prepared list.
+	bool bIsAlreadyPrepared = false;
+	PreparedSocketNames.Add(NewSocket->SocketName, &bIsAlreadyPrepared);
+	if (bIsAlreadyPrepared)
+	{
+		return false;
 	}
 
-	USkeletalMeshSocket* NewSocketDuplicate = CastChecked<USkeletalMeshSocket>(StaticDuplicateObject(NewSocket, MergeMesh));
-	MergeMeshSockets.Add(NewSocketDuplicate);
+	MergedData.Sockets.Add(FMergedSocketInfo(NewSocket));
 
 	return true;
 }
@@ -1403,15 +2564,37 @@ void FCustomSkeletalMeshMerge::AddSockets(const TArray<USkeletalMeshSocket*>& Ne
 	}
 }
 
-void FCustomSkeletalMeshMerge::BuildSockets(const TArray<USkeletalMesh*>& SourceMeshList)
+void FCustomSkeletalMeshMerge::BuildSockets(TArrayView<const FSkelMeshMergePart> SourceParts)
 {
-	TArray<USkeletalMeshSocket*>& MeshSocketList = MergeMesh->GetMeshOnlySocketList();
-	MeshSocketList.Empty();
+	int32 NumSourceSockets = 0;
+	for (const FSkelMeshMergePart& SourcePart : SourceParts)
+	{
+		const USkeletalMesh* SourceMesh = SourcePart.SkeletalMesh;
+		if (SourceMesh)
+		{
+			NumSourceSockets += SourceMesh->GetMeshOnlySocketList().Num() + SourceMesh->Skeleton->Sockets.Num();
+		}
+	}
+
+	MergedData.Sockets.Empty(NumSourceSockets);
+	PreparedSocketNames.Empty(NumSourceSockets);
+	SkeletonSocketNames.Reset();
+	if (MergeMesh->Skeleton)
+	{
+		for (const USkeletalMeshSocket* ExistingSocket : MergeMesh->Skeleton->Sockets)
+		{
+			if (ExistingSocket)
+			{
+				SkeletonSocketNames.Add(ExistingSocket->SocketName);
+			}
+		}
+	}
 
 	// Iterate through the all the source MESH sockets, only adding the new sockets.
 
-	for (USkeletalMesh const * const SourceMesh : SourceMeshList)
+	for (const FSkelMeshMergePart& SourcePart : SourceParts)
 	{
+		const USkeletalMesh* SourceMesh = SourcePart.SkeletalMesh;
 		if (SourceMesh)
 		{
 			const TArray<USkeletalMeshSocket*>& NewMeshSocketList = SourceMesh->GetMeshOnlySocketList();
@@ -1421,30 +2604,30 @@ void FCustomSkeletalMeshMerge::BuildSockets(const TArray<USkeletalMesh*>& Source
 
 	// Iterate through the all the source SKELETON sockets, only adding the new sockets.
 
-	for (USkeletalMesh const * const SourceMesh : SourceMeshList)
+	for (const FSkelMeshMergePart& SourcePart : SourceParts)
 	{
+		const USkeletalMesh* SourceMesh = SourcePart.SkeletalMesh;
 		if (SourceMesh)
 		{
 			const TArray<USkeletalMeshSocket*>& NewSkeletonSocketList = SourceMesh->Skeleton->Sockets;
 			AddSockets(NewSkeletonSocketList, true);
 		}
 	}
+
+	PreparedSocketNames.Reset();
+	SkeletonSocketNames.Reset();
 }
 
 void FCustomSkeletalMeshMerge::OverrideSocket(const USkeletalMeshSocket* SourceSocket)
 {
-	TArray<USkeletalMeshSocket*>& SocketList = MergeMesh->GetMeshOnlySocketList();
-
-	for (int32 i = 0, SocketCount = SocketList.Num(); i < SocketCount; ++i)
+	for (FMergedSocketInfo& TargetSocket : MergedData.Sockets)
 	{
-		USkeletalMeshSocket* TargetSocket = SocketList[i];
-
-		if (TargetSocket->SocketName == SourceSocket->SocketName)
+		if (TargetSocket.SocketName == SourceSocket->SocketName)
 		{
-			TargetSocket->BoneName = SourceSocket->BoneName;
-			TargetSocket->RelativeLocation = SourceSocket->RelativeLocation;
-			TargetSocket->RelativeRotation = SourceSocket->RelativeRotation;
-			TargetSocket->RelativeScale = SourceSocket->RelativeScale;
+			TargetSocket.BoneName = SourceSocket->BoneName;
+			TargetSocket.RelativeLocation = SourceSocket->RelativeLocation;
+			TargetSocket.RelativeRotation = SourceSocket->RelativeRotation;
+			TargetSocket.RelativeScale = SourceSocket->RelativeScale;
 		}
 	}
 }
@@ -15,6 +15,12 @@ FCustomSkeletalMeshMerge
 #include "ReferenceSkeleton.h"
 #include "Components.h"
 #include "Materials/MaterialInstanceDynamic.h"
+#include "Engine/SkeletalMesh.h"
+#include "Rendering/SkeletalMeshLODRenderData.h"
+#include "Misc/SecureHash.h"
+#include "CustomSkeletalMeshMergePartCache.h"
+#include "CustomSkeletalMeshMergePrebake.h"
+#include "CustomSkeletalMeshMergeNative.h"
 
 class UMaterialInterface;
 class USkeletalMesh;
@@ -75,21 +81,184 @@ private:
 	friend class FCustomSkeletalMeshMerge;
 };
 
-struct FSkelMeshMergePart
+/**
+* Socket that will be created on the merged mesh.
+*/
+struct FMergedSocketInfo
+{
+	FName SocketName;
+	FName BoneName;
+	FVector RelativeLocation;
+	FRotator RelativeRotation;
+	FVector RelativeScale;
+	bool bForceAlwaysAnimated;
+
+	/** Copies the properties of the socket, or the defaults of a new socket if there is none */
+	explicit FMergedSocketInfo(const USkeletalMeshSocket* InSourceSocket);
+};
+
+/**
+* LOD settings gathered for a merged LOD.
+*/
+struct FMergedLODInfo
+{
+	/** Lowest screen size of the merged source LODs */
+	FPerPlatformFloat ScreenSize;
+
+	/** Lowest hysteresis of the merged source LODs */
+	float LODHysteresis;
+
+	/** Whether the LOD buffers keep a CPU copy */
+	bool bNeedsCPUAccess;
+
+	FMergedLODInfo()
+		: LODHysteresis(0.f)
+		, bNeedsCPUAccess(false)
+	{}
+};
+
+/**
+* Everything needed to rebuild the merged mesh, held in plain structs.
+* Built by PrepareSkeleton()/PrepareMesh() without touching the merge mesh, then
+* applied to it by CommitSkeleton()/CommitMesh() on the game thread.
+*/
+struct FMergedMeshData
+{
+	/** Reference skeleton for the merged mesh */
+	FReferenceSkeleton RefSkeleton;
+
+	/** Sockets to create on the merged mesh */
+	TArray<FMergedSocketInfo> Sockets;
+
+	/**
+	 * Fully built render data per LOD, swapped with the LOD array of the merge mesh on commit.
+	 * Holds the render data taken back by RecycleRenderData() until PrepareMesh() refills it.
+	 */
+	TIndirectArray<FSkeletalMeshLODRenderData> LODRenderData;
+
+	/** LOD info entries matching LODRenderData */
+	TArray<FMergedLODInfo> LODInfo;
+
+	/** Material slots of the merged mesh */
+	TArray<FSkeletalMaterial> Materials;
+
+	/** Union of the source mesh imported bounds */
+	FBoxSphereBounds ImportedBounds;
+
+	TEnumAsByte<EAxis::Type> SkelMirrorAxis;
+	TEnumAsByte<EAxis::Type> SkelMirrorFlipAxis;
+
+	bool bHasVertexColors;
+	bool bUseFullPrecisionUVs;
+
+	FMergedMeshData()
+		: ImportedBounds(ForceInit)
+		, SkelMirrorAxis(EAxis::None)
+		, SkelMirrorFlipAxis(EAxis::None)
+		, bHasVertexColors(false)
+		, bUseFullPrecisionUVs(false)
+	{}
+};
+
+/**
+* Where the streams of one source section were written by a previous merge, and what they were built from.
+* The streams themselves are only kept once, in the merged buffers of their LOD.
+*/
+struct FSkelMeshMergeSectionCache
 {
-	USkeletalMesh* SkeletalMesh;
-	FName AttachedBoneName;
+	/** Source mesh the streams were built from */
+	TWeakObjectPtr<USkeletalMesh> SkelMesh;
+	int32 SourceLODIdx;
+
+	/** Vertex and skin weight layout the streams were built with */
+	uint32 VertexLayout;
+
+	/** Number of UV channels of the source LOD */
+	uint32 NumTexCoords;
+
+	/** Whether the source skin weights use extra bone influences */
+	bool bSourceExtraBoneInfluence;
+
+	/** Whether vertex colors were gathered */
+	bool bHasColors;
+
+	/** Transform applied to the positions */
 	FTransform VerticesTransform;
+
+	/** Atlas transforms applied to the UVs */
+	TArray<FTransform> UVTransforms;
+
+	/** Mapping applied to the bone indices of the skin weights */
+	TArray<FBoneIndexType> BoneMapToMergedBoneMap;
+
+	/** Range of the section in the merged buffers of its LOD */
+	int32 BaseVertexIndex;
+	int32 NumVertices;
+	int32 BaseIndex;
+	int32 NumIndices;
+
+	/** Largest index of the section, relative to its first vertex */
+	uint32 MaxRelativeIndex;
+
+	FSkelMeshMergeSectionCache()
+		: SourceLODIdx(INDEX_NONE)
+		, VertexLayout(0)
+		, NumTexCoords(0)
+		, bSourceExtraBoneInfluence(false)
+		, bHasColors(false)
+		, BaseVertexIndex(0)
+		, NumVertices(0)
+		, BaseIndex(0)
+		, NumIndices(0)
+		, MaxRelativeIndex(0)
+	{}
 };
 
 /**
-* Info to map all the sections from a single source skeletal mesh to
-* a final section entry int he merged skeletal mesh
+* Merged buffers of one LOD from a previous merge, patched in place by the next one.
 */
-struct FSkelMeshMergeSectionMapping
+struct FSkelMeshMergeLODBuffers
 {
-	/** indices to final section entries of the merged skel mesh */
-	TArray<int32> SectionIDs;
+	/** Vertex and skin weight layout of the typed buffers */
+	uint32 VertexLayout;
+
+	TArray<FColor> Colors;
+	TArray<uint32> Indices;
+
+	FSkelMeshMergeLODBuffers()
+		: VertexLayout(0)
+	{}
+	virtual ~FSkelMeshMergeLODBuffers() {}
+};
+
+template<typename VertexDataType, typename SkinWeightType>
+struct TSkelMeshMergeLODBuffers : public FSkelMeshMergeLODBuffers
+{
+	TArray<VertexDataType> Vertices;
+	TArray<SkinWeightType> SkinWeights;
+};
+
+/**
+* Per part processed data kept between merges of the same character.
+* Passing it to a re-merge lets sections of parts that did not change stay where they are in the
+* merged buffers, so only the ranges of changed parts are rebuilt.
+*/
+struct FSkelMeshMergeIncrementalState
+{
+	/** Cached sections, keyed by (part index, merged LOD index, source section index) */
+	TMap<FIntVector, FSkelMeshMergeSectionCache> Sections;
+
+	/** Merged buffers of the last merge, keyed by merged LOD index */
+	TMap<int32, TUniquePtr<FSkelMeshMergeLODBuffers>> LODBuffers;
+
+	/** Number of sections reused and rebuilt by the last merge */
+	int32 NumReusedSections;
+	int32 NumRebuiltSections;
+
+	FSkelMeshMergeIncrementalState()
+		: NumReusedSections(0)
+		, NumRebuiltSections(0)
+	{}
 };
 
 /**
@@ -101,7 +270,7 @@ public:
 	/**
 	* Constructor
 	* @param InMergeMesh - destination mesh to merge to
-	* @param InSrcMeshList - array of source meshes to merge
+	* @param InSrcParts - source meshes to merge, referenced and not copied so they must outlive the merger
 	* @param InForceSectionMapping - optional array to map sections from the source meshes to merged section entries
 	* @param StripTopLODs - number of high LODs to remove from input meshes
 	* @param bMeshNeedsCPUAccess - (optional) if the resulting mesh needs to be accessed by the CPU for any reason (e.g. for spawning particle effects).
@@ -110,14 +279,15 @@ public:
 	FCustomSkeletalMeshMerge(
 		USkeletalMesh* InMergeMesh,
 		UMaterialInterface* InBaseMaterial,
-		const TArray<FSkelMeshMergePart>& InSrcMeshList,
-		const TArray<FSkelMeshMergeSectionMapping>& InForceSectionMapping,
+		TArrayView<const FSkelMeshMergePart> InSrcParts,
+		TArrayView<const FSkelMeshMergeSectionMapping> InForceSectionMapping,
 		int32 StripTopLODs,
 		EMeshBufferAccess MeshBufferAccess = EMeshBufferAccess::Default
 	);
 
 	/**
 	 * Merge/Composite skeleton and meshes together from the list of source meshes.
+	 * All merged data is prepared first and then applied to the merge mesh in a single commit.
 	 * @param RefPoseOverrides - An optional override for the merged skeleton's reference pose.
 	 * @return true if succeeded
 	 */
@@ -126,20 +296,140 @@ public:
 	void MergeMaterial();
 
 	/**
-	 * Create the 'MergedMesh' reference skeleton from the skeletons in the 'SrcMeshList'.
+	 * Create the 'MergedMesh' reference skeleton from the skeletons in the 'SrcParts'.
 	 * Use when the reference skeleton is needed prior to finalizing the merged meshes (do not use with DoMerge()).
 	 * @param RefPoseOverrides - An optional override for the merged skeleton's reference pose.
 	 */
 	void MergeSkeleton(const TArray<FRefPoseOverride>* RefPoseOverrides = nullptr);
 
 	/**
-	 * Creates the merged mesh from the 'SrcMeshList' (note, this should only be called after MergeSkeleton()).
+	 * Creates the merged mesh from the 'SrcParts' (note, this should only be called after MergeSkeleton()).
 	 * Use when the reference skeleton is needed prior to finalizing the merged meshes (do not use with DoMerge()).
 	 * @return 'true' if successful; 'false' otherwise.
 	 */
 	bool FinalizeMesh();
 
+	/**
+	 * Builds the merged reference skeleton and socket list into the prepared data.
+	 * Does not modify the merge mesh, so it may run off the game thread.
+	 * @param RefPoseOverrides - An optional override for the merged skeleton's reference pose.
+	 */
+	void PrepareSkeleton(const TArray<FRefPoseOverride>* RefPoseOverrides = nullptr);
+
+	/**
+	 * Builds the render data, LOD info and material slots of every merged LOD into the prepared data
+	 * (note, this should only be called after PrepareSkeleton()).
+	 * Does not modify the merge mesh, so it may run off the game thread.
+	 * @return 'true' if successful; 'false' otherwise.
+	 */
+	bool PrepareMesh();
+
+	/**
+	 * Prepares everything DoMerge() commits, loading it from the persistent cache when possible
+	 * (note, this should only be called after MergeMaterial()).
+	 * Does not modify the merge mesh, so it may run off the game thread.
+	 * @param RefPoseOverrides - An optional override for the merged skeleton's reference pose.
+	 * @return 'true' if successful; 'false' otherwise.
+	 */
+	bool PrepareMerge(TArray<FRefPoseOverride>* RefPoseOverrides = nullptr);
+
+	/**
+	 * Applies the data prepared by PrepareMerge() to the merge mesh, like DoMerge() does.
+	 * Must be called on the game thread.
+	 */
+	void CommitMerge();
+
+	/**
+	 * Releases the merge mesh render resources and applies the prepared reference skeleton and sockets.
+	 * Must be called on the game thread.
+	 */
+	void CommitSkeleton();
+
+	/**
+	 * Moves the prepared LOD render data, LOD info and materials into the merge mesh and reinitializes its resources.
+	 * Must be called on the game thread.
+	 */
+	void CommitMesh();
+
+	/** @return Seconds spent in the last game thread commit. */
+	double GetLastCommitTime() const { return LastCommitTime; }
+
+	/**
+	 * Takes the LOD render data of a previously merged mesh back from the merge mesh, so PrepareMesh()
+	 * refills those objects, and their CPU buffers when the new LOD has the same layout, instead of
+	 * allocating new ones. Releases the render resources of the merge mesh and waits for them, so the
+	 * mesh must not be shown until the merge is committed. Must be called on the game thread.
+	 */
+	void RecycleRenderData();
+
+	/**
+	 * Lets DoMerge() read and write the merged data in the persistent cache.
+	 * @param InCacheKey - content key of this merge request
+	 */
+	void SetCacheKey(const FSHAHash& InCacheKey);
+
+	/**
+	 * Reuses the sections of parts that did not change since the merge that filled the state,
+	 * and records the sections of this merge into it.
+	 * @param InIncrementalState - state kept by the caller between merges, or nullptr to disable
+	 */
+	void SetIncrementalState(FSkelMeshMergeIncrementalState* InIncrementalState) { IncrementalState = InIncrementalState; }
+
+	/**
+	 * Records stage timings, atlas usage, LOD sizes and intermediate buffer usage of DoMerge() or
+	 * CommitPrebaked() into a report.
+	 * @param InReport - report owned by the caller that outlives the merge, or nullptr to disable
+	 */
+	void SetReport(FCustomSkeletalMeshMergeReport* InReport) { Report = InReport; }
+
+	/** @return Material built by the last MergeMaterial(), referenced by nothing until the merge is committed. */
+	UMaterialInstanceDynamic* GetMergedMaterial() const { return MergedMaterial; }
+
+	/** @return Key of the atlas used by the merged material, or nullptr if atlases are not cached. */
+	const FSHAHash* GetAtlasKey() const { return bHasAtlasKey ? &AtlasKey : nullptr; }
+
+	/** Gets the exact CPU and GPU size of the buffers of the last committed merge. */
+	void GetMergedMeshSize(SIZE_T& OutCPUBytes, SIZE_T& OutGPUBytes) const
+	{
+		OutCPUBytes = MergedCPUBytes;
+		OutGPUBytes = MergedGPUBytes;
+	}
+
+	/**
+	 * Lets MergeMaterial() skip compositing the atlas textures on the GPU. The atlas layout and the
+	 * UV transforms are still computed, so the result can be baked without a renderer.
+	 */
+	void SetCompositeAtlas(bool bInCompositeAtlas) { bCompositeAtlas = bInCompositeAtlas; }
+
+	/** Gets the source materials and atlas regions computed by the last MergeMaterial(). */
+	void GetAtlasLayout(FCustomSkeletalMeshMergeAtlasLayout& OutLayout) const;
+
+	/** @return Package guids of the source meshes, used to detect stale cached and prebaked data. */
+	TArray<FGuid> GetSourceGuids() const;
+
+	/** @return Data built by PrepareSkeleton() and PrepareMesh(), not yet committed. */
+	FMergedMeshData& GetPreparedData() { return MergedData; }
+
+	/**
+	 * Commits merged data baked by the prebake commandlet instead of merging.
+	 * Must be called on the game thread.
+	 * @param Data - serialized merged data
+	 * @param Material - baked atlas material bound to every merged material slot
+	 * @return 'false' if the data could not be read, e.g. it was baked with an older format.
+	 */
+	bool CommitPrebaked(const TArray<uint8>& Data, UMaterialInterface* Material);
+
 private:
+	/**
+	 * Applies the prepared data to the merge mesh and records how long it took.
+	 * @param bIncludeSkeleton - also commit the prepared reference skeleton and sockets
+	 */
+	void CommitPreparedData(bool bIncludeSkeleton);
+
+	/** @return Whether the merge result can be stored in or loaded from the persistent cache. */
+	bool CanUsePersistentCache(const TArray<FRefPoseOverride>* RefPoseOverrides) const;
+
+
 	/** Destination merged mesh */
 	USkeletalMesh* MergeMesh;
 
@@ -147,12 +437,8 @@ private:
 
 	UMaterialInstanceDynamic* MergedMaterial;
 
-	/** Array of source skeletal meshes  */
-	TArray<USkeletalMesh*> SrcMeshList;
-
-	TArray<FName> SrcMeshAttachedBoneNameList;
-
-	TArray<FTransform> VerticesTransformList;
+	/** Source skeletal meshes, owned by the caller */
+	TArrayView<const FSkelMeshMergePart> SrcParts;
 
 	/** Number of high LODs to remove from input meshes. */
 	int32 StripTopLODs;
@@ -165,16 +451,67 @@ private:
 	{
 		/** Mapping from RefSkeleton bone index in source mesh to output bone index. */
 		TArray<int32> SrcToDestRefSkeletonMap;
+
+		/** Merge-ready data of the source mesh, only valid if the part cache is enabled. */
+		FSkelMeshMergeReadyRecordPtr ReadyRecord;
+
+		/** Bone mapping of the source mesh to the merged skeleton, only valid with ReadyRecord. */
+		FSkelMeshMergeReadyBoneMapPtr ReadyBoneMap;
+
+		/** Transform of the source vertices, bound to the attached bone of the part if it has one. */
+		FTransform VerticesTransform;
 	};
 
 	/** Array of source mesh info structs. */
 	TArray<FMergeMeshInfo> SrcMeshInfo;
 
-	/** New reference skeleton, made from creating union of each part's skeleton. */
-	FReferenceSkeleton NewRefSkeleton;
+	/** Data prepared for the merge mesh; its RefSkeleton is the union of each part's skeleton. */
+	FMergedMeshData MergedData;
+
+	/** Names of the prepared sockets, only filled while building them */
+	TSet<FName> PreparedSocketNames;
+
+	/** Names of the sockets the merge mesh gets from its skeleton, only filled while building the sockets */
+	TSet<FName> SkeletonSocketNames;
+
+	/** Seconds spent in the last commit to the merge mesh */
+	double LastCommitTime;
+
+	/** Content key of this merge, only valid if bHasCacheKey */
+	FSHAHash CacheKey;
+	bool bHasCacheKey;
+
+	/** Key of the merged material atlas, only valid if bHasAtlasKey */
+	FSHAHash AtlasKey;
+	bool bHasAtlasKey;
+
+	/** Whether MergeMaterial() composites the atlas textures */
+	bool bCompositeAtlas;
+
+	/** Source materials packed into the atlas and their regions, in atlas texels */
+	TArray<UMaterialInterface*> AtlasMaterials;
+	TArray<FBox2D> AtlasBoxes;
+
+	/** Size of the textures composited for the atlas */
+	SIZE_T AtlasCPUBytes;
+	SIZE_T AtlasGPUBytes;
+
+	/** Size of the committed LOD buffers */
+	SIZE_T MergedCPUBytes;
+	SIZE_T MergedGPUBytes;
+
+	/** Optional state used to reuse unchanged parts from a previous merge */
+	FSkelMeshMergeIncrementalState* IncrementalState;
+
+	/** Optional report filled while merging */
+	FCustomSkeletalMeshMergeReport* Report;
+
+	/** Sections and merged buffers recorded by the previous merge, consumed while preparing this one */
+	TMap<FIntVector, FSkelMeshMergeSectionCache> PreviousSections;
+	TMap<int32, TUniquePtr<FSkelMeshMergeLODBuffers>> PreviousLODBuffers;
 
 	/** array to map sections from the source meshes to merged section entries */
-	const TArray<FSkelMeshMergeSectionMapping>& ForceSectionMapping;
+	TArrayView<const FSkelMeshMergeSectionMapping> ForceSectionMapping;
 
 	/** optional array to transform UVs in each source mesh */
 	TArray<TArray<FTransform>> UVTransformsPerMesh;
@@ -195,12 +532,17 @@ private:
 		TArray<FTransform> UVTransforms;
 		/** transform from the original Positons */
 		FTransform VerticesTransform;
+		/** index of the source part and of the section in its LOD */
+		int32 PartIdx;
+		int32 SectionIdx;
 
-		FMergeSectionInfo(const USkeletalMesh* InSkelMesh, const FSkelMeshRenderSection* InSection, TArray<FTransform> & InUVTransforms, const FTransform& InVerticesTransform)
+		FMergeSectionInfo(const USkeletalMesh* InSkelMesh, const FSkelMeshRenderSection* InSection, TArray<FTransform> & InUVTransforms, const FTransform& InVerticesTransform, int32 InPartIdx, int32 InSectionIdx)
 			: SkelMesh(InSkelMesh)
 			, Section(InSection)
 			, UVTransforms(InUVTransforms)
 			, VerticesTransform(InVerticesTransform)
+			, PartIdx(InPartIdx)
+			, SectionIdx(InSectionIdx)
 		{}
 	};
 
@@ -231,16 +573,7 @@ private:
 	};
 
 	/**
-	* Merge a bonemap with an existing bonemap and keep track of remapping
-	* (a bonemap is a list of indices of bones in the USkeletalMesh::RefSkeleton array)
-	* @param MergedBoneMap - out merged bonemap
-	* @param BoneMapToMergedBoneMap - out of mapping from original bonemap to new merged bonemap
-	* @param BoneMap - input bonemap to merge
-	*/
-	void MergeBoneMap(TArray<FBoneIndexType>& MergedBoneMap, TArray<FBoneIndexType>& BoneMapToMergedBoneMap, const TArray<FBoneIndexType>& BoneMap);
-
-	/**
-	* Creates a new LOD model and adds the new merged sections to it. Modifies the MergedMesh.
+	* Creates a new LOD model and adds the new merged sections to it. Only modifies the prepared data.
 	* @param LODIdx - current LOD to process
 	*/
 	template<typename VertexDataType, typename SkinWeightType>
@@ -254,20 +587,26 @@ private:
 	void GenerateNewSectionArray(TArray<FNewSectionInfo>& NewSectionArray, int32 LODIdx);
 
 	/**
-	* (Re)initialize and merge skeletal mesh info from the list of source meshes to the merge mesh
+	* (Re)initialize and merge skeletal mesh info from the list of source meshes into the prepared data
 	* @return true if succeeded
 	*/
 	bool ProcessMergeMesh();
 
 	/**
-	 * Returns the number of LODs that can be supported by the meshes in 'SourceMeshList'.
+	 * Returns the number of LODs that can be supported by the meshes in 'SourceParts'.
 	 */
-	int32 CalculateLodCount(const TArray<USkeletalMesh*>& SourceMeshList) const;
+	int32 CalculateLodCount(TArrayView<const FSkelMeshMergePart> SourceParts) const;
 
 	/**
-	 * Builds a new 'RefSkeleton' from the reference skeletons in the 'SourceMeshList'.
+	 * Returns the LOD of source part 'PartIdx' merged into 'LODIdx', counting the stripped top LODs,
+	 * or INDEX_NONE if the part is left out of that LOD.
 	 */
-	static void BuildReferenceSkeleton(const TArray<USkeletalMesh*>& SourceMeshList, FReferenceSkeleton& RefSkeleton, const USkeleton* SkeletonAsset);
+	int32 GetSourceLODIdx(int32 PartIdx, int32 LODIdx) const;
+
+	/**
+	 * Builds a new 'RefSkeleton' from the reference skeletons in the 'SourceParts'.
+	 */
+	static void BuildReferenceSkeleton(TArrayView<const FSkelMeshMergePart> SourceParts, FReferenceSkeleton& RefSkeleton, const USkeleton* SkeletonAsset);
 
 	/**
 	 * Overrides the 'TargetSkeleton' bone poses with the bone poses specified in the 'PoseOverrides' array.
@@ -286,25 +625,26 @@ private:
 	void ReleaseResources(int32 Slack = 0);
 
 	/**
-	 * Copies and adds the 'NewSocket' to the MergeMesh's MeshOnlySocketList only if the socket does not already exist.
+	 * Adds the 'NewSocket' to the prepared socket list only if no socket of that name exists yet.
+	 * Skeleton sockets are also skipped when the skeleton of the merge mesh already has them.
 	 * @return 'true' if the socket is added; 'false' otherwise.
 	 */
 	bool AddSocket(const USkeletalMeshSocket* NewSocket, bool bIsSkeletonSocket);
 
 	/**
-	 * Adds only the new sockets from the 'NewSockets' array to the 'ExistingSocketList'.
+	 * Adds only the new sockets from the 'NewSockets' array to the prepared socket list.
 	 */
 	void AddSockets(const TArray<USkeletalMeshSocket*>& NewSockets, bool bAreSkeletonSockets);
 
 	/**
-	 * Builds a new 'SocketList' from the sockets in the 'SourceMeshList'.
+	 * Builds a new 'SocketList' from the sockets in the 'SourceParts'.
 	 */
-	void BuildSockets(const TArray<USkeletalMesh*>& SourceMeshList);
+	void BuildSockets(TArrayView<const FSkelMeshMergePart> SourceParts);
 
 	//void OverrideSockets(const TArray<FRefPoseOverride>& PoseOverrides);
 
 	/**
-	 * Override the corresponding 'MergeMesh' socket with 'SourceSocket'.
+	 * Override the corresponding prepared socket with 'SourceSocket'.
 	 */
 	void OverrideSocket(const USkeletalMeshSocket* SourceSocket);
 
@@ -318,13 +658,27 @@ private:
 	 */
 	void OverrideMergedSockets(const TArray<FRefPoseOverride>& PoseOverrides);
 
-	/*
-	 * Copy Vertex Buffer from Source LOD Model
+	/**
+	 * Patches the merged buffers of the previous merge for the sections of a LOD. Sections of unchanged parts keep their
+	 * streams, moved only if the sections before them changed size; the ranges of the other sections are rebuilt.
+	 * @param LODIdx - merged LOD being processed
 	 */
-	template<typename VertexDataType>
-	void CopyVertexFromSource(VertexDataType& DestVert, const FSkeletalMeshLODRenderData& SrcLODData, int32 SourceVertIdx, const FMergeSectionInfo& MergeSectionInfo);
+	template<typename VertexDataType, typename SkinWeightType>
+	void SpliceIncrementalSections(int32 LODIdx, const TArray<FNewSectionInfo>& NewSectionArray, TArray<VertexDataType>& MergedVertexBuffer, TArray<SkinWeightType>& MergedSkinWeightBuffer, TArray<FColor>& MergedColorBuffer, TArray<uint32>& MergedIndexBuffer, uint32& MaxIndex, uint32& TotalNumUVs, bool& bSourceHasExtraBoneInfluences);
+
+	/** Returns the merge-ready streams of a source section from its part's record, converting the section on first use. */
+	template<typename VertexDataType, typename SkinWeightType>
+	FSkelMeshMergeReadySectionPtr FindOrBuildReadySection(int32 SourceLODIdx, const FSkeletalMeshLODRenderData& SrcLODData, const FMergeSectionInfo& MergeSectionInfo);
+
+	/** Converts a source section to the merged vertex layout without applying any merge specific transform */
+	template<typename VertexDataType, typename SkinWeightType>
+	void BuildReadySection(FSkelMeshMergeReadySection& ReadySection, const FSkeletalMeshLODRenderData& SrcLODData, const FMergeSectionInfo& MergeSectionInfo);
+
+	/** Appends merge-ready streams to the merged buffers, applying the vertex and UV transforms, bone remapping and vertex offset */
+	template<typename VertexDataType, typename SkinWeightType>
+	void AppendReadySection(const FSkelMeshMergeReadySection& ReadySection, const FMergeSectionInfo& MergeSectionInfo, TArray<VertexDataType>& MergedVertexBuffer, TArray<SkinWeightType>& MergedSkinWeightBuffer, TArray<FColor>& MergedColorBuffer, TArray<uint32>& MergedIndexBuffer, uint32& MaxIndex);
 
-	/** Copy skin weight info from source LOD model - templatized per SourceLODModel extra bone influence */
-	template<typename SkinWeightType, bool bHasExtraBoneInfluences>
-	void CopyWeightFromSource(SkinWeightType& DestWeight, const FSkeletalMeshLODRenderData& SrcLODData, int32 SourceVertIdx, const FMergeSectionInfo& MergeSectionInfo);
+	/** Writes the streams of a source section to its range of the merged buffers, applying the vertex and UV transforms, bone remapping and vertex offset */
+	template<typename VertexDataType, typename SkinWeightType>
+	void WriteSectionStreams(FSkelMeshMergeSectionCache& SectionCache, int32 SourceLODIdx, const FSkeletalMeshLODRenderData& SrcLODData, const FMergeSectionInfo& MergeSectionInfo, TArray<VertexDataType>& MergedVertexBuffer, TArray<SkinWeightType>& MergedSkinWeightBuffer, TArray<FColor>& MergedColorBuffer, TArray<uint32>& MergedIndexBuffer);
 };
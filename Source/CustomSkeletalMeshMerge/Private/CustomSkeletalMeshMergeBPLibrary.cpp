@@ -3,26 +3,17 @@
 #include "CustomSkeletalMeshMergeBPLibrary.h"
 #include "CustomSkeletalMeshMergeModule.h"
 #include "CustomSkeletalMeshMerge.h"
-#include "Engine/SkeletalMeshSocket.h"
+#include "CustomSkeletalMeshMergeCache.h"
+#include "CustomSkeletalMeshMergeJob.h"
+#include "CustomSkeletalMeshMergeNative.h"
+#include "CustomSkeletalMeshMergePool.h"
+#include "CustomSkeletalMeshMergeRequest.h"
 #include "Engine/SkeletalMesh.h"
-#include "Animation/Skeleton.h"
 
-static void ToMergeParams(const TArray<FCustomSkelMeshMergeSectionMapping_BP>& InSectionMappings, TArray<FSkelMeshMergeSectionMapping>& OutSectionMappings)
+FSkelMeshMergeRequest::FSkelMeshMergeRequest(const FCustomSkeletalMeshMergeParams& Params)
 {
-	if (InSectionMappings.Num() > 0)
-	{
-		OutSectionMappings.AddUninitialized(InSectionMappings.Num());
-		for (int32 i = 0; i < InSectionMappings.Num(); ++i)
-		{
-			OutSectionMappings[i].SectionIDs = InSectionMappings[i].SectionIDs;
-		}
-	}
-};
-
-USkeletalMesh* UCustomSkeletalMeshMergeBPLibrary::MergeMeshes(const FCustomSkeletalMeshMergeParams& Params)
-{
-	TArray<FSkelMeshMergePart> MeshesToMergeCopy;
 	FSkelMeshMergePart Part;
+	Parts.Reserve(Params.MeshesToMerge.Num());
 	for (int32 i = 0; i < Params.MeshesToMerge.Num(); i++)
 	{
 		if (Params.MeshesToMerge[i].SkeletalMesh)
@@ -30,79 +21,127 @@ USkeletalMesh* UCustomSkeletalMeshMergeBPLibrary::MergeMeshes(const FCustomSkele
 			Part.SkeletalMesh = Params.MeshesToMerge[i].SkeletalMesh;
 			Part.AttachedBoneName = Params.MeshesToMerge[i].AttachedBoneName;
 			Part.VerticesTransform = Params.MeshesToMerge[i].VerticesTransform;
-			MeshesToMergeCopy.Add(Part);
+			Part.LODBias = Params.MeshesToMerge[i].LODBias;
+			Part.MaxLOD = Params.MeshesToMerge[i].MaxLOD;
+			Parts.Add(Part);
 		}
 	}
-	if (MeshesToMergeCopy.Num() <= 1)
-	{
-		UE_LOG(LogTemp, Warning, TEXT("Must provide multiple valid Skeletal Meshes in order to perform a merge."));
-		return nullptr;
-	}
-	EMeshBufferAccess BufferAccess = Params.bNeedsCpuAccess ?
+	MeshBufferAccess = Params.bNeedsCpuAccess ?
 		EMeshBufferAccess::ForceCPUAndGPU :
 		EMeshBufferAccess::Default;
-	TArray<FSkelMeshMergeSectionMapping> SectionMappings;
-	ToMergeParams(Params.MeshSectionMappings, SectionMappings);
-	bool bRunDuplicateCheck = false;
-	USkeletalMesh* BaseMesh = NewObject<USkeletalMesh>();
-	if (Params.Skeleton && Params.bSkeletonBefore)
+	if (Params.MeshSectionMappings.Num() > 0)
 	{
-		BaseMesh->Skeleton = Params.Skeleton;
-		bRunDuplicateCheck = true;
-		for (USkeletalMeshSocket* Socket : BaseMesh->GetMeshOnlySocketList())
-		{
-			if (Socket)
-			{
-				UE_LOG(LogTemp, Warning, TEXT("SkelMeshSocket: %s"), *(Socket->SocketName.ToString()));
-			}
-		}
-		for (USkeletalMeshSocket* Socket : BaseMesh->Skeleton->Sockets)
+		SectionMappings.AddDefaulted(Params.MeshSectionMappings.Num());
+		for (int32 i = 0; i < Params.MeshSectionMappings.Num(); ++i)
 		{
-			if (Socket)
-			{
-				UE_LOG(LogTemp, Warning, TEXT("SkelSocket: %s"), *(Socket->SocketName.ToString()));
-			}
+			SectionMappings[i].SectionIDs = Params.MeshSectionMappings[i].SectionIDs;
 		}
 	}
-	FCustomSkeletalMeshMerge Merger(BaseMesh, Params.BaseMaterial, MeshesToMergeCopy, SectionMappings, Params.StripTopLODS, BufferAccess);
-	if (!Merger.DoMerge())
+}
+
+FCustomSkeletalMeshMergeNativeParams FSkelMeshMergeRequest::ToNativeParams(const FCustomSkeletalMeshMergeParams& Params) const
+{
+	FCustomSkeletalMeshMergeNativeParams NativeParams;
+	NativeParams.Parts = Parts;
+	NativeParams.SectionMappings = SectionMappings;
+	NativeParams.StripTopLODs = Params.StripTopLODS;
+	NativeParams.MeshBufferAccess = MeshBufferAccess;
+	NativeParams.Skeleton = Params.Skeleton;
+	NativeParams.bSkeletonBefore = Params.bSkeletonBefore;
+	NativeParams.BaseMaterial = Params.BaseMaterial;
+	NativeParams.bIncremental = Params.bIncremental;
+	NativeParams.PreviousMergedMesh = Params.PreviousMergedMesh;
+	NativeParams.bMergeInPlace = Params.bMergeInPlace;
+	return NativeParams;
+}
+
+FSHAHash FSkelMeshMergeRequest::ComputeKey(const FCustomSkeletalMeshMergeParams& Params) const
+{
+	return ComputeKey(ToNativeParams(Params));
+}
+
+FSHAHash FSkelMeshMergeRequest::ComputeKey(const FCustomSkeletalMeshMergeNativeParams& Params)
+{
+	FSkelMeshMergeKeyParams KeyParams;
+	KeyParams.Parts = Params.Parts;
+	KeyParams.SectionMappings = Params.SectionMappings;
+	KeyParams.StripTopLODs = Params.StripTopLODs;
+	KeyParams.MeshBufferAccess = Params.MeshBufferAccess;
+	KeyParams.Skeleton = Params.Skeleton;
+	KeyParams.bSkeletonBefore = Params.bSkeletonBefore;
+	KeyParams.BaseMaterial = Params.BaseMaterial;
+	return FCustomSkeletalMeshMergeCache::ComputeKey(KeyParams);
+}
+
+/** Merges the meshes of a request, filling the report if one is passed */
+static USkeletalMesh* MergeMeshesInternal(const FCustomSkeletalMeshMergeNativeParams& Params, FCustomSkeletalMeshMergeReport* Report)
+{
+	FSkelMeshMergeJob Job(Params, Report);
+	if (!Job.Start())
+	{
+		return Job.GetMergedMesh();
+	}
+	Job.Prepare();
+	return Job.Finish();
+}
+
+USkeletalMesh* FCustomSkeletalMeshMergeNative::MergeMeshes(const FCustomSkeletalMeshMergeNativeParams& Params, FCustomSkeletalMeshMergeReport* OutReport)
+{
+	if (!OutReport)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Merge failed!"));
-		return nullptr;
+		return MergeMeshesInternal(Params, nullptr);
 	}
-	if (Params.Skeleton && !Params.bSkeletonBefore)
+
+	*OutReport = FCustomSkeletalMeshMergeReport();
+
+	const double StartTime = FPlatformTime::Seconds();
+	USkeletalMesh* MergedMesh = MergeMeshesInternal(Params, OutReport);
+	OutReport->TotalMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+	return MergedMesh;
+}
+
+USkeletalMesh* UCustomSkeletalMeshMergeBPLibrary::MergeMeshes(const FCustomSkeletalMeshMergeParams& Params)
+{
+	const FSkelMeshMergeRequest Request(Params);
+	return FCustomSkeletalMeshMergeNative::MergeMeshes(Request.ToNativeParams(Params));
+}
+
+USkeletalMesh* UCustomSkeletalMeshMergeBPLibrary::MergeMeshesWithReport(const FCustomSkeletalMeshMergeParams& Params, FCustomSkeletalMeshMergeReport& OutReport)
+{
+	const FSkelMeshMergeRequest Request(Params);
+	return FCustomSkeletalMeshMergeNative::MergeMeshes(Request.ToNativeParams(Params), &OutReport);
+}
+
+bool UCustomSkeletalMeshMergeBPLibrary::ReleaseMergedMesh(USkeletalMesh* MergedMesh)
+{
+	return FCustomSkeletalMeshMergeNative::ReleaseMergedMesh(MergedMesh);
+}
+
+bool FCustomSkeletalMeshMergeNative::ReleaseMergedMesh(USkeletalMesh* MergedMesh)
+{
+	if (!MergedMesh)
 	{
-		BaseMesh->Skeleton = Params.Skeleton;
+		return false;
 	}
-	if (bRunDuplicateCheck)
+	// shared meshes go back to the pool once evicted, other merged meshes right away
+	if (FCustomSkeletalMeshMergeCache::Get().Release(MergedMesh))
 	{
-		TArray<FName> SkelMeshSockets;
-		TArray<FName> SkelSockets;
-		for (USkeletalMeshSocket* Socket : BaseMesh->GetMeshOnlySocketList())
-		{
-			if (Socket)
-			{
-				SkelMeshSockets.Add(Socket->GetFName());
-				UE_LOG(LogTemp, Warning, TEXT("SkelMeshSocket: %s"), *(Socket->SocketName.ToString()));
-			}
-		}
-		for (USkeletalMeshSocket* Socket : BaseMesh->Skeleton->Sockets)
-		{
-			if (Socket)
-			{
-				SkelSockets.Add(Socket->GetFName());
-				UE_LOG(LogTemp, Warning, TEXT("SkelSocket: %s"), *(Socket->SocketName.ToString()));
-			}
-		}
-		TSet<FName> UniqueSkelMeshSockets;
-		TSet<FName> UniqueSkelSockets;
-		UniqueSkelMeshSockets.Append(SkelMeshSockets);
-		UniqueSkelSockets.Append(SkelSockets);
-		int32 Total = SkelSockets.Num() + SkelMeshSockets.Num();
-		int32 UniqueTotal = UniqueSkelMeshSockets.Num() + UniqueSkelSockets.Num();
-		UE_LOG(LogTemp, Warning, TEXT("SkelMeshSocketCount: %d | SkelSocketCount: %d | Combined: %d"), SkelMeshSockets.Num(), SkelSockets.Num(), Total);
-		UE_LOG(LogTemp, Warning, TEXT("SkelMeshSocketCount: %d | SkelSocketCount: %d | Combined: %d"), UniqueSkelMeshSockets.Num(), UniqueSkelSockets.Num(), UniqueTotal);
-		UE_LOG(LogTemp, Warning, TEXT("Found Duplicates: %s"), *((Total != UniqueTotal) ? FString("True") : FString("False")));
+		return true;
 	}
-	return BaseMesh;
+	return FCustomSkeletalMeshMergePool::Get().Release(MergedMesh);
+}
+
+FCustomSkeletalMeshMergeCacheStats UCustomSkeletalMeshMergeBPLibrary::GetMergeCacheStats()
+{
+	const FSkelMeshMergeCacheStats CacheStats = FCustomSkeletalMeshMergeCache::Get().GetStats();
+
+	FCustomSkeletalMeshMergeCacheStats Stats;
+	Stats.NumMeshes = CacheStats.NumMeshes;
+	Stats.NumAtlases = CacheStats.NumAtlases;
+	Stats.CPUBytes = CacheStats.CPUBytes;
+	Stats.GPUBytes = CacheStats.GPUBytes;
+	Stats.BudgetBytes = CacheStats.BudgetBytes;
+	Stats.NumEvictions = CacheStats.NumEvictions;
+	return Stats;
 }
@@ -0,0 +1,227 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+/*=============================================================================
+	CustomSkeletalMeshMergeBenchmark.cpp: Console benchmark of the merge pipeline.
+=============================================================================*/
+
+#include "CustomSkeletalMeshMerge.h"
+#include "CustomSkeletalMeshMergePool.h"
+#include "CustomSkeletalMeshMergePrebake.h"
+#include "CustomSkeletalMeshMergeRequest.h"
+#include "Animation/Skeleton.h"
+#include "Async/ParallelFor.h"
+#include "Engine/SkeletalMesh.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/PackageName.h"
+
+namespace
+{
+	/** One merge of a benchmark batch */
+	struct FBenchmarkMerge
+	{
+		/** Referenced by the merger, so it must not move */
+		FSkelMeshMergeRequest Request;
+		USkeletalMesh* Mesh;
+		FCustomSkeletalMeshMergeReport Report;
+		TUniquePtr<FCustomSkeletalMeshMerge> Merger;
+		bool bPrepared;
+
+		explicit FBenchmarkMerge(const FCustomSkeletalMeshMergeParams& Params)
+			: Request(Params)
+			, Mesh(nullptr)
+			, bPrepared(false)
+		{}
+	};
+
+	/** Latencies of one stage over the whole run, in milliseconds */
+	struct FStageLatencies
+	{
+		const TCHAR* Name;
+		TArray<float> Samples;
+
+		float GetPercentile(float Percentile) const
+		{
+			if (Samples.Num() == 0)
+			{
+				return 0.0f;
+			}
+			const int32 Index = FMath::Clamp(FMath::CeilToInt(Percentile * Samples.Num()) - 1, 0, Samples.Num() - 1);
+			return Samples[Index];
+		}
+	};
+
+	/** Turns the atlas and part caches off for the lifetime of the object */
+	class FScopedCacheBypass
+	{
+	public:
+		explicit FScopedCacheBypass(bool bBypass)
+		{
+			if (!bBypass)
+			{
+				return;
+			}
+			const TCHAR* CacheVariableNames[] = { TEXT("SkeletalMeshMerge.Cache"), TEXT("SkeletalMeshMerge.PartCache") };
+			for (const TCHAR* Name : CacheVariableNames)
+			{
+				IConsoleVariable* Variable = IConsoleManager::Get().FindConsoleVariable(Name);
+				if (Variable)
+				{
+					SavedValues.Add(TPair<IConsoleVariable*, int32>(Variable, Variable->GetInt()));
+					Variable->Set(0, ECVF_SetByCode);
+				}
+			}
+		}
+
+		~FScopedCacheBypass()
+		{
+			for (const TPair<IConsoleVariable*, int32>& SavedValue : SavedValues)
+			{
+				SavedValue.Key->Set(SavedValue.Value, ECVF_SetByCode);
+			}
+		}
+
+	private:
+		TArray<TPair<IConsoleVariable*, int32>> SavedValues;
+	};
+
+	void RunBenchmark(const TArray<FString>& Args)
+	{
+		check(IsInGameThread());
+
+		TArray<FString> Values;
+		bool bNoCache = false;
+		for (const FString& Arg : Args)
+		{
+			if (Arg.Equals(TEXT("-NoCache"), ESearchCase::IgnoreCase))
+			{
+				bNoCache = true;
+			}
+			else
+			{
+				Values.Add(Arg);
+			}
+		}
+
+		if (Values.Num() < 1)
+		{
+			UE_LOG(LogSkeletalMesh, Warning, TEXT("Usage: SkeletalMeshMerge.Benchmark <Manifest> [Iterations=10] [Threads=1] [-NoCache]"));
+			return;
+		}
+
+		FString ManifestPath = Values[0];
+		if (!ManifestPath.Contains(TEXT(".")))
+		{
+			ManifestPath += TEXT(".") + FPackageName::GetShortName(ManifestPath);
+		}
+		UCustomSkeletalMeshMergePrebakeManifest* Manifest = LoadObject<UCustomSkeletalMeshMergePrebakeManifest>(nullptr, *ManifestPath);
+		if (!Manifest || Manifest->Combinations.Num() == 0)
+		{
+			UE_LOG(LogSkeletalMesh, Warning, TEXT("SkeletalMeshMerge.Benchmark: %s is not a prebake manifest with combinations"), *ManifestPath);
+			return;
+		}
+
+		const int32 NumIterations = Values.Num() > 1 ? FMath::Max(FCString::Atoi(*Values[1]), 1) : 10;
+		const int32 NumThreads = Values.Num() > 2 ? FMath::Max(FCString::Atoi(*Values[2]), 1) : 1;
+
+		FScopedCacheBypass CacheBypass(bNoCache);
+		FCustomSkeletalMeshMergePool& MergePool = FCustomSkeletalMeshMergePool::Get();
+
+		FStageLatencies Stages[] = {
+			{ TEXT("Total") },
+			{ TEXT("MergeMaterial") },
+			{ TEXT("TextureWait") },
+			{ TEXT("MergeSkeleton") },
+			{ TEXT("MergeMesh") },
+			{ TEXT("Commit") },
+		};
+		int32 NumMerges = 0;
+		int32 NumFailed = 0;
+
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Iteration = 0; Iteration < NumIterations; Iteration++)
+		{
+			// merges of a batch prepare their skeleton and render data at the same time, like concurrent spawns
+			for (int32 BatchStart = 0; BatchStart < Manifest->Combinations.Num(); BatchStart += NumThreads)
+			{
+				const int32 BatchSize = FMath::Min(NumThreads, Manifest->Combinations.Num() - BatchStart);
+
+				TArray<TUniquePtr<FBenchmarkMerge>> Batch;
+				for (int32 BatchIdx = 0; BatchIdx < BatchSize; BatchIdx++)
+				{
+					const FCustomSkeletalMeshMergeParams& Params = Manifest->Combinations[BatchStart + BatchIdx];
+					TUniquePtr<FBenchmarkMerge> Merge = MakeUnique<FBenchmarkMerge>(Params);
+					if (Merge->Request.Parts.Num() <= 1)
+					{
+						NumFailed++;
+						continue;
+					}
+
+					Merge->Mesh = MergePool.Acquire();
+					if (Params.Skeleton && Params.bSkeletonBefore)
+					{
+						Merge->Mesh->Skeleton = Params.Skeleton;
+					}
+					Merge->Merger = MakeUnique<FCustomSkeletalMeshMerge>(Merge->Mesh, Params.BaseMaterial, Merge->Request.Parts,
+						Merge->Request.SectionMappings, Params.StripTopLODS, Merge->Request.MeshBufferAccess);
+					Merge->Merger->SetReport(&Merge->Report);
+					Merge->Merger->MergeMaterial();
+					Batch.Add(MoveTemp(Merge));
+				}
+
+				ParallelFor(Batch.Num(), [&Batch](int32 BatchIdx)
+				{
+					FCustomSkeletalMeshMerge& Merger = *Batch[BatchIdx]->Merger;
+					Merger.PrepareSkeleton();
+					Batch[BatchIdx]->bPrepared = Merger.PrepareMesh();
+				}, Batch.Num() <= 1);
+
+				for (TUniquePtr<FBenchmarkMerge>& Merge : Batch)
+				{
+					if (Merge->bPrepared)
+					{
+						const double CommitStartTime = FPlatformTime::Seconds();
+						Merge->Merger->CommitSkeleton();
+						Merge->Merger->CommitMesh();
+						Merge->Report.CommitMs = (FPlatformTime::Seconds() - CommitStartTime) * 1000.0;
+
+						const FCustomSkeletalMeshMergeReport& Report = Merge->Report;
+						Stages[0].Samples.Add(Report.MergeMaterialMs + Report.MergeSkeletonMs + Report.MergeMeshMs + Report.CommitMs);
+						Stages[1].Samples.Add(Report.MergeMaterialMs);
+						Stages[2].Samples.Add(Report.TextureWaitMs);
+						Stages[3].Samples.Add(Report.MergeSkeletonMs);
+						Stages[4].Samples.Add(Report.MergeMeshMs);
+						Stages[5].Samples.Add(Report.CommitMs);
+						NumMerges++;
+					}
+					else
+					{
+						NumFailed++;
+					}
+
+					Merge->Merger.Reset();
+					MergePool.Release(Merge->Mesh);
+				}
+			}
+		}
+		const double ElapsedTime = FPlatformTime::Seconds() - StartTime;
+
+		UE_LOG(LogSkeletalMesh, Display, TEXT("SkeletalMeshMerge.Benchmark: %d merges (%d failed) of %d combinations in %.2f s, %.2f merges/s, %d threads, caches %s"),
+			NumMerges, NumFailed, Manifest->Combinations.Num(), ElapsedTime, ElapsedTime > 0.0 ? NumMerges / ElapsedTime : 0.0,
+			NumThreads, bNoCache ? TEXT("bypassed") : TEXT("enabled"));
+
+		for (FStageLatencies& Stage : Stages)
+		{
+			Stage.Samples.Sort();
+			UE_LOG(LogSkeletalMesh, Display, TEXT("  %-14s p50 %8.3f ms  p95 %8.3f ms  p99 %8.3f ms"),
+				Stage.Name, Stage.GetPercentile(0.5f), Stage.GetPercentile(0.95f), Stage.GetPercentile(0.99f));
+		}
+	}
+}
+
+static FAutoConsoleCommand BenchmarkCommand(
+	TEXT("SkeletalMeshMerge.Benchmark"),
+	TEXT("Merges every combination of a prebake manifest in a loop and prints the merge throughput and per stage latencies.\n")
+	TEXT("Usage: SkeletalMeshMerge.Benchmark <Manifest> [Iterations=10] [Threads=1] [-NoCache]\n")
+	TEXT("Threads: number of merges whose skeleton and render data are prepared at the same time on worker threads.\n")
+	TEXT("-NoCache: turns the atlas and part caches off for the run. Merged meshes are never shared or loaded from the persistent cache."),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&RunBenchmark));
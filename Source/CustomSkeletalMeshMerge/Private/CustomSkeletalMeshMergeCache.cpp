@@ -0,0 +1,511 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+/*=============================================================================
+	CustomSkeletalMeshMergeCache.cpp: Content addressed cache of merged skeletal meshes and atlases.
+=============================================================================*/
+
+#include "CustomSkeletalMeshMergeCache.h"
+#include "CustomSkeletalMeshMerge.h"
+#include "CustomSkeletalMeshMergePartCache.h"
+#include "CustomSkeletalMeshMergePool.h"
+#include "CustomSkeletalMeshMergeSharedCache.h"
+#include "Animation/Skeleton.h"
+#include "Engine/SkeletalMesh.h"
+#include "Materials/MaterialInterface.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "Engine/Texture.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarMergeCacheEnabled(
+	TEXT("SkeletalMeshMerge.Cache"),
+	1,
+	TEXT("Determines whether identical merge requests share one merged skeletal mesh and atlas.\n")
+	TEXT("0: Always merge\n")
+	TEXT("1: Share identical merges"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarMergeCacheBudgetMB(
+	TEXT("SkeletalMeshMerge.CacheBudgetMB"),
+	256,
+	TEXT("CPU plus GPU memory, in MB, that merged meshes, atlases and the merge-ready data of source meshes may keep alive.\n")
+	TEXT("Least recently used unreferenced entries and source mesh records are evicted once the budget is exceeded."),
+	ECVF_Default);
+
+static FAutoConsoleCommand CacheStatsCommand(
+	TEXT("SkeletalMeshMerge.CacheStats"),
+	TEXT("Prints the footprint and eviction count of the merged mesh and atlas cache."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		const FSkelMeshMergeCacheStats Stats = FCustomSkeletalMeshMergeCache::Get().GetStats();
+		UE_LOG(LogSkeletalMesh, Display, TEXT("SkeletalMeshMerge cache: %d meshes, %d atlases, CPU %.2f MB, GPU %.2f MB, budget %.2f MB, %d evictions"),
+			Stats.NumMeshes, Stats.NumAtlases, Stats.CPUBytes / (1024.0 * 1024.0), Stats.GPUBytes / (1024.0 * 1024.0),
+			Stats.BudgetBytes / (1024.0 * 1024.0), Stats.NumEvictions);
+
+		int32 NumRecords = 0;
+		SIZE_T RecordBytes = 0;
+		FCustomSkeletalMeshMergePartCache::Get().GetStats(NumRecords, RecordBytes);
+		UE_LOG(LogSkeletalMesh, Display, TEXT("SkeletalMeshMerge part cache: %d source meshes, %.2f MB"),
+			NumRecords, RecordBytes / (1024.0 * 1024.0));
+
+		if (FCustomSkeletalMeshMergeSharedCache::IsEnabled())
+		{
+			int32 NumSharedEntries = 0;
+			SIZE_T SharedUsedBytes = 0;
+			SIZE_T SharedRegionBytes = 0;
+			FCustomSkeletalMeshMergeSharedCache::Get().GetStats(NumSharedEntries, SharedUsedBytes, SharedRegionBytes);
+			UE_LOG(LogSkeletalMesh, Display, TEXT("SkeletalMeshMerge shared cache: %d merges, %.2f of %.2f MB"),
+				NumSharedEntries, SharedUsedBytes / (1024.0 * 1024.0), SharedRegionBytes / (1024.0 * 1024.0));
+		}
+	}));
+
+FCustomSkeletalMeshMergeCache* FCustomSkeletalMeshMergeCache::Instance = nullptr;
+
+namespace
+{
+	void HashObject(FSHA1& Sha, const UObject* Object)
+	{
+		const FString PathName = Object ? Object->GetPathName() : FString();
+		Sha.UpdateWithString(*PathName, PathName.Len());
+	}
+
+	void HashName(FSHA1& Sha, const FName& Name)
+	{
+		const FString NameString = Name.ToString();
+		Sha.UpdateWithString(*NameString, NameString.Len());
+	}
+
+	template<typename ValueType>
+	void HashValue(FSHA1& Sha, const ValueType& Value)
+	{
+		Sha.Update(reinterpret_cast<const uint8*>(&Value), sizeof(ValueType));
+	}
+
+	void HashTransform(FSHA1& Sha, const FTransform& Transform)
+	{
+		HashValue(Sha, Transform.GetTranslation());
+		HashValue(Sha, Transform.GetRotation());
+		HashValue(Sha, Transform.GetScale3D());
+	}
+
+	/**
+	 * Hashes a material by identity, plus the texture parameter values of dynamic instances in its parent chain,
+	 * which can change after the instance was created while its path stays the same.
+	 */
+	void HashMaterial(FSHA1& Sha, const UMaterialInterface* Material)
+	{
+		HashObject(Sha, Material);
+
+		const UMaterialInstanceDynamic* DynamicInstance = Cast<UMaterialInstanceDynamic>(Material);
+		while (DynamicInstance)
+		{
+			HashValue(Sha, DynamicInstance->TextureParameterValues.Num());
+			for (const FTextureParameterValue& TextureParameter : DynamicInstance->TextureParameterValues)
+			{
+				HashName(Sha, TextureParameter.ParameterInfo.Name);
+				HashValue(Sha, static_cast<uint8>(TextureParameter.ParameterInfo.Association));
+				HashValue(Sha, TextureParameter.ParameterInfo.Index);
+				HashObject(Sha, TextureParameter.ParameterValue);
+			}
+			HashObject(Sha, DynamicInstance->Parent);
+			DynamicInstance = Cast<UMaterialInstanceDynamic>(DynamicInstance->Parent);
+		}
+	}
+
+	FSHAHash FinalizeHash(FSHA1& Sha)
+	{
+		Sha.Final();
+
+		FSHAHash Key;
+		Sha.GetHash(Key.Hash);
+		return Key;
+	}
+}
+
+FCustomSkeletalMeshMergeCache::FCustomSkeletalMeshMergeCache()
+	: TotalCPUBytes(0)
+	, TotalGPUBytes(0)
+	, NumEvictions(0)
+{
+}
+
+FCustomSkeletalMeshMergeCache& FCustomSkeletalMeshMergeCache::Get()
+{
+	if (!Instance)
+	{
+		Instance = new FCustomSkeletalMeshMergeCache();
+	}
+	return *Instance;
+}
+
+void FCustomSkeletalMeshMergeCache::Shutdown()
+{
+	delete Instance;
+	Instance = nullptr;
+}
+
+bool FCustomSkeletalMeshMergeCache::IsEnabled()
+{
+	return CVarMergeCacheEnabled.GetValueOnGameThread() != 0;
+}
+
+FSHAHash FCustomSkeletalMeshMergeCache::ComputeKey(const FSkelMeshMergeKeyParams& Params)
+{
+	FSHA1 Sha;
+
+	HashValue(Sha, Params.Parts.Num());
+	for (const FSkelMeshMergePart& Part : Params.Parts)
+	{
+		HashObject(Sha, Part.SkeletalMesh);
+		HashName(Sha, Part.AttachedBoneName);
+		HashTransform(Sha, Part.VerticesTransform);
+		HashValue(Sha, Part.LODBias);
+		HashValue(Sha, Part.MaxLOD);
+
+		// the atlas layout and merged material depend on the textures of the part materials
+		if (Part.SkeletalMesh)
+		{
+			HashValue(Sha, Part.SkeletalMesh->Materials.Num());
+			for (const FSkeletalMaterial& Material : Part.SkeletalMesh->Materials)
+			{
+				HashMaterial(Sha, Material.MaterialInterface);
+			}
+		}
+	}
+
+	HashValue(Sha, Params.SectionMappings.Num());
+	for (const FSkelMeshMergeSectionMapping& SectionMapping : Params.SectionMappings)
+	{
+		const TArray<int32>& SectionIDs = SectionMapping.SectionIDs;
+		HashValue(Sha, SectionIDs.Num());
+		Sha.Update(reinterpret_cast<const uint8*>(SectionIDs.GetData()), SectionIDs.Num() * sizeof(int32));
+	}
+
+	HashValue(Sha, Params.StripTopLODs);
+	HashValue(Sha, static_cast<uint8>(Params.MeshBufferAccess));
+	HashObject(Sha, Params.Skeleton);
+	HashValue(Sha, static_cast<uint8>(Params.bSkeletonBefore));
+	HashObject(Sha, Params.BaseMaterial);
+
+	return FinalizeHash(Sha);
+}
+
+FSHAHash FCustomSkeletalMeshMergeCache::ComputeAtlasKey(const UMaterialInterface* BaseMaterial, const TArray<UMaterialInterface*>& Materials)
+{
+	FSHA1 Sha;
+
+	// Keep atlas keys apart from merge keys
+	HashName(Sha, TEXT("Atlas"));
+	HashObject(Sha, BaseMaterial);
+
+	HashValue(Sha, Materials.Num());
+	for (const UMaterialInterface* Material : Materials)
+	{
+		HashMaterial(Sha, Material);
+	}
+
+	return FinalizeHash(Sha);
+}
+
+USkeletalMesh* FCustomSkeletalMeshMergeCache::FindAndAddRef(const FSHAHash& Key)
+{
+	check(IsInGameThread());
+
+	FEntry* Entry = Entries.Find(Key);
+	if (!Entry || Entry->Type != EEntryType::Mesh)
+	{
+		return nullptr;
+	}
+
+	USkeletalMesh* MergedMesh = Cast<USkeletalMesh>(Entry->Object.Get());
+	if (!MergedMesh)
+	{
+		// The mesh has been garbage collected while callers still referenced it
+		RemoveEntry(Key);
+		return nullptr;
+	}
+
+	AddRef(*Entry);
+	return MergedMesh;
+}
+
+void FCustomSkeletalMeshMergeCache::Add(const FSHAHash& Key, USkeletalMesh* MergedMesh, SIZE_T CPUBytes, SIZE_T GPUBytes, const FSHAHash* AtlasKey)
+{
+	check(IsInGameThread());
+	check(MergedMesh);
+
+	if (Entries.Contains(Key))
+	{
+		RemoveEntry(Key);
+	}
+
+	FEntry& Entry = Entries.Add(Key);
+	Entry.Object = MergedMesh;
+	Entry.Type = EEntryType::Mesh;
+	Entry.CPUBytes = CPUBytes;
+	Entry.GPUBytes = GPUBytes;
+	AddRef(Entry);
+
+	// Keep the atlas alive for as long as the mesh is cached
+	if (AtlasKey)
+	{
+		if (FEntry* AtlasEntry = Entries.Find(*AtlasKey))
+		{
+			AddRef(*AtlasEntry);
+			Entry.AtlasKey = *AtlasKey;
+			Entry.bHasAtlas = true;
+		}
+	}
+
+	ObjectToKey.Add(MergedMesh, Key);
+	TotalCPUBytes += CPUBytes;
+	TotalGPUBytes += GPUBytes;
+
+	EvictToBudget();
+}
+
+bool FCustomSkeletalMeshMergeCache::Release(USkeletalMesh* MergedMesh)
+{
+	check(IsInGameThread());
+
+	const FSHAHash* Key = ObjectToKey.Find(MergedMesh);
+	if (!Key)
+	{
+		return false;
+	}
+
+	FEntry* Entry = Entries.Find(*Key);
+	if (!Entry || Entry->Object.Get() != MergedMesh || Entry->RefCount <= 0)
+	{
+		return false;
+	}
+
+	RemoveRef(*Entry);
+	EvictToBudget();
+
+	return true;
+}
+
+bool FCustomSkeletalMeshMergeCache::RemoveForRebuild(USkeletalMesh* MergedMesh)
+{
+	check(IsInGameThread());
+
+	const FSHAHash* FoundKey = ObjectToKey.Find(MergedMesh);
+	const FEntry* Entry = FoundKey ? Entries.Find(*FoundKey) : nullptr;
+	if (!Entry || Entry->Object.Get() != MergedMesh)
+	{
+		return true;
+	}
+
+	if (Entry->RefCount > 1)
+	{
+		return false;
+	}
+
+	const FSHAHash Key = *FoundKey;
+	RemoveEntry(Key);
+
+	return true;
+}
+
+UMaterialInstanceDynamic* FCustomSkeletalMeshMergeCache::FindAtlas(const FSHAHash& AtlasKey)
+{
+	check(IsInGameThread());
+
+	FEntry* Entry = Entries.Find(AtlasKey);
+	if (!Entry || Entry->Type != EEntryType::Atlas)
+	{
+		return nullptr;
+	}
+
+	UMaterialInstanceDynamic* AtlasMaterial = Cast<UMaterialInstanceDynamic>(Entry->Object.Get());
+	if (!AtlasMaterial)
+	{
+		RemoveEntry(AtlasKey);
+		return nullptr;
+	}
+
+	Entry->LastUsed = FPlatformTime::Cycles64();
+	return AtlasMaterial;
+}
+
+void FCustomSkeletalMeshMergeCache::AddAtlas(const FSHAHash& AtlasKey, UMaterialInstanceDynamic* AtlasMaterial, SIZE_T CPUBytes, SIZE_T GPUBytes)
+{
+	check(IsInGameThread());
+	check(AtlasMaterial);
+
+	if (Entries.Contains(AtlasKey))
+	{
+		return;
+	}
+
+	FEntry& Entry = Entries.Add(AtlasKey);
+	Entry.Object = AtlasMaterial;
+	Entry.RetainedObject = AtlasMaterial;
+	Entry.Type = EEntryType::Atlas;
+	Entry.CPUBytes = CPUBytes;
+	Entry.GPUBytes = GPUBytes;
+	Entry.LastUsed = FPlatformTime::Cycles64();
+
+	ObjectToKey.Add(AtlasMaterial, AtlasKey);
+	TotalCPUBytes += CPUBytes;
+	TotalGPUBytes += GPUBytes;
+
+	EvictToBudget();
+}
+
+FSkelMeshMergeCacheStats FCustomSkeletalMeshMergeCache::GetStats() const
+{
+	FSkelMeshMergeCacheStats Stats;
+
+	for (const TPair<FSHAHash, FEntry>& Pair : Entries)
+	{
+		if (Pair.Value.Type == EEntryType::Mesh)
+		{
+			Stats.NumMeshes++;
+		}
+		else
+		{
+			Stats.NumAtlases++;
+		}
+	}
+
+	Stats.CPUBytes = TotalCPUBytes;
+	Stats.GPUBytes = TotalGPUBytes;
+	Stats.BudgetBytes = (int64)FMath::Max(CVarMergeCacheBudgetMB.GetValueOnGameThread(), 0) * 1024 * 1024;
+	Stats.NumEvictions = NumEvictions;
+
+	return Stats;
+}
+
+void FCustomSkeletalMeshMergeCache::EvictToBudget()
+{
+	// Drop entries whose objects were collected while callers still referenced them
+	TArray<FSHAHash> StaleKeys;
+	for (const TPair<FSHAHash, FEntry>& Pair : Entries)
+	{
+		if (!Pair.Value.Object.IsValid())
+		{
+			StaleKeys.Add(Pair.Key);
+		}
+	}
+	for (const FSHAHash& StaleKey : StaleKeys)
+	{
+		RemoveEntry(StaleKey);
+	}
+
+	const SIZE_T BudgetBytes = (SIZE_T)FMath::Max(CVarMergeCacheBudgetMB.GetValueOnGameThread(), 0) * 1024 * 1024;
+
+	// merge-ready records of source meshes share the budget and the least recently used order
+	FCustomSkeletalMeshMergePartCache& PartCache = FCustomSkeletalMeshMergePartCache::Get();
+	SIZE_T PartCacheBytes = PartCache.GetAllocatedSize();
+
+	while (TotalCPUBytes + TotalGPUBytes + PartCacheBytes > BudgetBytes)
+	{
+		// Find the least recently used entry nobody references
+		const FSHAHash* EvictKey = nullptr;
+		uint64 OldestUse = MAX_uint64;
+
+		for (const TPair<FSHAHash, FEntry>& Pair : Entries)
+		{
+			if (Pair.Value.RefCount <= 0 && Pair.Value.LastUsed < OldestUse)
+			{
+				EvictKey = &Pair.Key;
+				OldestUse = Pair.Value.LastUsed;
+			}
+		}
+
+		SIZE_T FreedBytes = 0;
+		if (PartCache.EvictLeastRecentlyUsed(OldestUse, FreedBytes))
+		{
+			PartCacheBytes -= FMath::Min(FreedBytes, PartCacheBytes);
+			NumEvictions++;
+			continue;
+		}
+
+		if (!EvictKey)
+		{
+			break;
+		}
+
+		RemoveEntry(FSHAHash(*EvictKey));
+		NumEvictions++;
+	}
+}
+
+void FCustomSkeletalMeshMergeCache::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	for (TPair<FSHAHash, FEntry>& Pair : Entries)
+	{
+		if (Pair.Value.RetainedObject)
+		{
+			Collector.AddReferencedObject(Pair.Value.RetainedObject);
+		}
+	}
+}
+
+FString FCustomSkeletalMeshMergeCache::GetReferencerName() const
+{
+	return TEXT("FCustomSkeletalMeshMergeCache");
+}
+
+void FCustomSkeletalMeshMergeCache::AddRef(FEntry& Entry)
+{
+	Entry.RefCount++;
+	Entry.LastUsed = FPlatformTime::Cycles64();
+
+	// Referenced entries are kept alive by whoever holds them
+	Entry.RetainedObject = nullptr;
+}
+
+void FCustomSkeletalMeshMergeCache::RemoveRef(FEntry& Entry)
+{
+	check(Entry.RefCount > 0);
+
+	if (--Entry.RefCount == 0)
+	{
+		Entry.RetainedObject = Entry.Object.Get();
+	}
+}
+
+void FCustomSkeletalMeshMergeCache::RemoveEntry(const FSHAHash& Key)
+{
+	FEntry Entry;
+	if (!Entries.RemoveAndCopyValue(Key, Entry))
+	{
+		return;
+	}
+
+	TotalCPUBytes -= Entry.CPUBytes;
+	TotalGPUBytes -= Entry.GPUBytes;
+
+	if (const UObject* Object = Entry.Object.Get())
+	{
+		ObjectToKey.Remove(Object);
+	}
+	else
+	{
+		// The object is gone, drop the stale reverse lookup by key
+		for (auto It = ObjectToKey.CreateIterator(); It; ++It)
+		{
+			if (It.Value() == Key)
+			{
+				It.RemoveCurrent();
+				break;
+			}
+		}
+	}
+
+	if (Entry.bHasAtlas)
+	{
+		if (FEntry* AtlasEntry = Entries.Find(Entry.AtlasKey))
+		{
+			RemoveRef(*AtlasEntry);
+		}
+	}
+
+	// nobody uses an unreferenced mesh any more, let a later merge write into it
+	if (Entry.Type == EEntryType::Mesh && Entry.RefCount <= 0 && Entry.RetainedObject)
+	{
+		FCustomSkeletalMeshMergePool::Get().Release(CastChecked<USkeletalMesh>(Entry.RetainedObject));
+	}
+}
@@ -0,0 +1,202 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+/*=============================================================================
+	CustomSkeletalMeshMergeCache.h: Content addressed cache of merged skeletal meshes and atlases.
+=============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/SecureHash.h"
+#include "UObject/WeakObjectPtr.h"
+#include "UObject/GCObject.h"
+#include "Engine/EngineTypes.h"
+#include "CustomSkeletalMeshMergeNative.h"
+
+class USkeletalMesh;
+class USkeleton;
+class UMaterialInterface;
+class UMaterialInstanceDynamic;
+
+/**
+* Everything that determines the result of a merge, used to build the merge content key.
+*/
+struct FSkelMeshMergeKeyParams
+{
+	TArrayView<const FSkelMeshMergePart> Parts;
+	TArrayView<const FSkelMeshMergeSectionMapping> SectionMappings;
+	int32 StripTopLODs;
+	EMeshBufferAccess MeshBufferAccess;
+	const USkeleton* Skeleton;
+	bool bSkeletonBefore;
+	const UMaterialInterface* BaseMaterial;
+
+	FSkelMeshMergeKeyParams()
+		: StripTopLODs(0)
+		, MeshBufferAccess(EMeshBufferAccess::Default)
+		, Skeleton(nullptr)
+		, bSkeletonBefore(false)
+		, BaseMaterial(nullptr)
+	{}
+};
+
+/**
+* Current footprint and activity of the merge cache.
+*/
+struct FSkelMeshMergeCacheStats
+{
+	int32 NumMeshes;
+	int32 NumAtlases;
+	int64 CPUBytes;
+	int64 GPUBytes;
+	int64 BudgetBytes;
+	int32 NumEvictions;
+
+	FSkelMeshMergeCacheStats()
+		: NumMeshes(0)
+		, NumAtlases(0)
+		, CPUBytes(0)
+		, GPUBytes(0)
+		, BudgetBytes(0)
+		, NumEvictions(0)
+	{}
+};
+
+/**
+* Shares merged meshes and material atlases between identical merge requests.
+* Entries handed out to callers are held weakly and reference counted; entries nobody references
+* are kept alive until the combined CPU and GPU size goes over budget, least recently used first.
+*/
+class FCustomSkeletalMeshMergeCache : public FGCObject
+{
+public:
+	static FCustomSkeletalMeshMergeCache& Get();
+
+	/** Destroys the cache, dropping every entry. */
+	static void Shutdown();
+
+	/** @return Whether merged meshes and atlases should be looked up and shared at all. */
+	static bool IsEnabled();
+
+	/**
+	 * Hashes the parts and their materials, attach bones, vertex transforms, section mappings, LOD settings,
+	 * skeleton and base material of a merge request.
+	 */
+	static FSHAHash ComputeKey(const FSkelMeshMergeKeyParams& Params);
+
+	/**
+	 * Hashes the base material and the ordered source materials that are packed into an atlas.
+	 * Dynamic material instances are hashed with their texture parameter values.
+	 */
+	static FSHAHash ComputeAtlasKey(const UMaterialInterface* BaseMaterial, const TArray<UMaterialInterface*>& Materials);
+
+	/**
+	 * Finds a live merged mesh for the key and adds a reference to it.
+	 * @return The shared mesh, or nullptr if the merge has not been produced yet.
+	 */
+	USkeletalMesh* FindAndAddRef(const FSHAHash& Key);
+
+	/**
+	 * Registers a freshly merged mesh for the key, holding one reference.
+	 * @param AtlasKey - optional atlas used by the mesh, kept alive as long as the mesh is cached
+	 */
+	void Add(const FSHAHash& Key, USkeletalMesh* MergedMesh, SIZE_T CPUBytes, SIZE_T GPUBytes, const FSHAHash* AtlasKey);
+
+	/**
+	 * Drops one reference to a merged mesh; once unreferenced it becomes a candidate for eviction.
+	 * @return 'true' if the mesh was known to the cache.
+	 */
+	bool Release(USkeletalMesh* MergedMesh);
+
+	/**
+	 * Drops the entry of a merged mesh so its only user can rebuild it with different content.
+	 * @return 'false' if other callers share the mesh, which must then be left untouched.
+	 */
+	bool RemoveForRebuild(USkeletalMesh* MergedMesh);
+
+	/** @return The cached atlas material for the key, or nullptr. */
+	UMaterialInstanceDynamic* FindAtlas(const FSHAHash& AtlasKey);
+
+	/** Registers a freshly composited atlas material. */
+	void AddAtlas(const FSHAHash& AtlasKey, UMaterialInstanceDynamic* AtlasMaterial, SIZE_T CPUBytes, SIZE_T GPUBytes);
+
+	/** @return Current footprint, budget and eviction count. */
+	FSkelMeshMergeCacheStats GetStats() const;
+
+	/**
+	 * Evicts unreferenced entries and source mesh records of the part cache, least recently used first,
+	 * until their combined footprint fits the budget.
+	 */
+	void EvictToBudget();
+
+	//~ Begin FGCObject Interface
+	virtual void AddReferencedObjects(FReferenceCollector& Collector) override;
+	virtual FString GetReferencerName() const override;
+	//~ End FGCObject Interface
+
+private:
+	enum class EEntryType : uint8
+	{
+		Mesh,
+		Atlas,
+	};
+
+	struct FEntry
+	{
+		/** Cached mesh or atlas material */
+		TWeakObjectPtr<UObject> Object;
+
+		/** Strong reference kept only while no caller references the entry */
+		UObject* RetainedObject;
+
+		EEntryType Type;
+
+		/** Exact size of the cached buffers and textures */
+		SIZE_T CPUBytes;
+		SIZE_T GPUBytes;
+
+		/** Number of outstanding references, from callers or from meshes using an atlas */
+		int32 RefCount;
+
+		/** FPlatformTime::Cycles64() value when the entry was last touched, ordered with the part cache records */
+		uint64 LastUsed;
+
+		/** Atlas referenced by a mesh entry */
+		FSHAHash AtlasKey;
+		bool bHasAtlas;
+
+		FEntry()
+			: RetainedObject(nullptr)
+			, Type(EEntryType::Mesh)
+			, CPUBytes(0)
+			, GPUBytes(0)
+			, RefCount(0)
+			, LastUsed(0)
+			, bHasAtlas(false)
+		{}
+	};
+
+	/** Adjusts an entry's reference count, retaining its object while unreferenced */
+	void AddRef(FEntry& Entry);
+	void RemoveRef(FEntry& Entry);
+
+	/** Removes an entry and updates the footprint */
+	void RemoveEntry(const FSHAHash& Key);
+
+	/** Entries by merge content key or atlas key */
+	TMap<FSHAHash, FEntry> Entries;
+
+	/** Reverse lookup used when releasing a mesh */
+	TMap<const UObject*, FSHAHash> ObjectToKey;
+
+	/** Footprint of all entries */
+	SIZE_T TotalCPUBytes;
+	SIZE_T TotalGPUBytes;
+
+	/** Number of entries evicted to stay in budget */
+	int32 NumEvictions;
+
+	FCustomSkeletalMeshMergeCache();
+
+	static FCustomSkeletalMeshMergeCache* Instance;
+};
@@ -0,0 +1,255 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "CustomSkeletalMeshMergeComponent.h"
+#include "CustomSkeletalMeshMergeJob.h"
+#include "CustomSkeletalMeshMergeNative.h"
+#include "CustomSkeletalMeshMergeRequest.h"
+#include "CustomSkeletalMeshMergeStats.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/SkeletalMesh.h"
+#include "Async/Async.h"
+
+UCustomSkeletalMeshMergeComponent::UCustomSkeletalMeshMergeComponent()
+	: Target(nullptr)
+	, MergedMesh(nullptr)
+{
+	// only ticks while a merge is pending
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+}
+
+void UCustomSkeletalMeshMergeComponent::StartMerge(USkeletalMeshComponent* TargetComponent, const FCustomSkeletalMeshMergeParams& Params)
+{
+	check(IsInGameThread());
+
+	if (!TargetComponent)
+	{
+		UE_LOG(LogSkeletalMesh, Warning, TEXT("Must provide a Skeletal Mesh Component to show the merged mesh."));
+		return;
+	}
+
+	CancelMerge();
+	if (Target && Target != TargetComponent)
+	{
+		DestroyFollowers();
+	}
+	Target = TargetComponent;
+
+	PendingParams = Params;
+	if ((PendingParams.bIncremental || PendingParams.bMergeInPlace) && !PendingParams.PreviousMergedMesh)
+	{
+		PendingParams.PreviousMergedMesh = MergedMesh;
+	}
+	PendingRequest = MakeShared<FSkelMeshMergeRequest, ESPMode::ThreadSafe>(PendingParams);
+	PendingJob = MakeShared<FSkelMeshMergeJob, ESPMode::ThreadSafe>(PendingRequest->ToNativeParams(PendingParams), nullptr);
+
+	// the previous mesh can only be rebuilt in place once the target no longer shows it
+	if (PendingParams.bMergeInPlace)
+	{
+		ShowParts();
+	}
+
+	if (!PendingJob->Start())
+	{
+		// shared, prebaked or failed, there is nothing left to prepare
+		USkeletalMesh* NewMergedMesh = PendingJob->GetMergedMesh();
+		PendingJob.Reset();
+		PendingRequest.Reset();
+		PendingParams = FCustomSkeletalMeshMergeParams();
+		if (NewMergedMesh)
+		{
+			ShowMergedMesh(NewMergedMesh);
+		}
+		OnMerged.Broadcast(NewMergedMesh);
+		return;
+	}
+
+	// the parts stand in for the merged mesh until the worker is done
+	if (!PendingParams.bMergeInPlace)
+	{
+		ShowParts();
+	}
+	if (PendingJob->IsMergingInPlace() && PendingParams.PreviousMergedMesh == MergedMesh)
+	{
+		// the job owns the mesh it rebuilds, and releases it if the merge fails
+		MergedMesh = nullptr;
+	}
+
+	TSharedPtr<FSkelMeshMergeJob, ESPMode::ThreadSafe> Job = PendingJob;
+	TSharedPtr<FSkelMeshMergeRequest, ESPMode::ThreadSafe> Request = PendingRequest;
+	const double QueuedTime = FPlatformTime::Seconds();
+	PendingPrepare = Async(EAsyncExecution::ThreadPool, [Job, Request, QueuedTime]()
+	{
+		CSV_CUSTOM_STAT(SkeletalMeshMerge, QueueWaitMs, (float)((FPlatformTime::Seconds() - QueuedTime) * 1000.0), ECsvCustomStatOp::Accumulate);
+		Job->Prepare();
+	});
+	SetComponentTickEnabled(true);
+}
+
+bool UCustomSkeletalMeshMergeComponent::IsMergePending() const
+{
+	return PendingJob.IsValid();
+}
+
+void UCustomSkeletalMeshMergeComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (!PendingJob.IsValid())
+	{
+		SetComponentTickEnabled(false);
+		return;
+	}
+	if (PendingPrepare.IsReady())
+	{
+		FinishMerge();
+	}
+}
+
+void UCustomSkeletalMeshMergeComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	CancelMerge();
+
+	// the target and the followers must not keep showing the meshes once they are released
+	if (Target)
+	{
+		Target->SetSkeletalMesh(nullptr);
+	}
+	DestroyFollowers();
+	if (MergedMesh)
+	{
+		FCustomSkeletalMeshMergeNative::ReleaseMergedMesh(MergedMesh);
+		MergedMesh = nullptr;
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UCustomSkeletalMeshMergeComponent::OnComponentDestroyed(bool bDestroyingHierarchy)
+{
+	CancelMerge();
+	DestroyFollowers();
+
+	Super::OnComponentDestroyed(bDestroyingHierarchy);
+}
+
+void UCustomSkeletalMeshMergeComponent::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)
+{
+	UCustomSkeletalMeshMergeComponent* This = CastChecked<UCustomSkeletalMeshMergeComponent>(InThis);
+	if (This->PendingJob.IsValid())
+	{
+		This->PendingJob->AddReferencedObjects(Collector);
+	}
+
+	Super::AddReferencedObjects(InThis, Collector);
+}
+
+void UCustomSkeletalMeshMergeComponent::ShowParts()
+{
+	DestroyFollowers();
+
+	const TArray<FSkelMeshMergePart>& Parts = PendingRequest->Parts;
+
+	// the target shows the first part following its own skeleton, the other parts follow its pose
+	int32 TargetPartIdx = Parts.IndexOfByPredicate([](const FSkelMeshMergePart& Part) { return Part.AttachedBoneName == NAME_None; });
+	if (TargetPartIdx == INDEX_NONE)
+	{
+		TargetPartIdx = 0;
+	}
+	Target->SetSkeletalMesh(Parts[TargetPartIdx].SkeletalMesh);
+
+	Followers.Reserve(Parts.Num() - 1);
+	for (int32 PartIdx = 0; PartIdx < Parts.Num(); ++PartIdx)
+	{
+		if (PartIdx == TargetPartIdx)
+		{
+			continue;
+		}
+		const FSkelMeshMergePart& Part = Parts[PartIdx];
+
+		USkeletalMeshComponent* Follower = NewObject<USkeletalMeshComponent>(Target->GetOwner(), NAME_None, RF_Transient);
+		Follower->SetSkeletalMesh(Part.SkeletalMesh);
+		if (Part.AttachedBoneName != NAME_None && Target->GetBoneIndex(Part.AttachedBoneName) != INDEX_NONE)
+		{
+			// same placement as the merged vertices, the part root bound to the bone
+			const TArray<FTransform>& RefBonePose = Part.SkeletalMesh->RefSkeleton.GetRefBonePose();
+			const FTransform SrcInvTransform = RefBonePose.Num() > 0 ? RefBonePose[0].Inverse() : FTransform::Identity;
+			Follower->SetupAttachment(Target, Part.AttachedBoneName);
+			Follower->SetRelativeTransform(Part.VerticesTransform * SrcInvTransform);
+		}
+		else
+		{
+			Follower->SetupAttachment(Target);
+			Follower->SetRelativeTransform(Part.VerticesTransform);
+			Follower->SetMasterPoseComponent(Target);
+		}
+		Follower->RegisterComponent();
+		Followers.Add(Follower);
+	}
+}
+
+void UCustomSkeletalMeshMergeComponent::ShowMergedMesh(USkeletalMesh* NewMergedMesh)
+{
+	// switch and destroy the followers in the same frame, so the parts are never shown twice or not at all
+	Target->SetSkeletalMesh(NewMergedMesh);
+	DestroyFollowers();
+
+	if (MergedMesh && MergedMesh != NewMergedMesh)
+	{
+		FCustomSkeletalMeshMergeNative::ReleaseMergedMesh(MergedMesh);
+	}
+	MergedMesh = NewMergedMesh;
+}
+
+void UCustomSkeletalMeshMergeComponent::FinishMerge()
+{
+	TSharedPtr<FSkelMeshMergeJob, ESPMode::ThreadSafe> Job = PendingJob;
+	PendingJob.Reset();
+	PendingRequest.Reset();
+	PendingPrepare = TFuture<void>();
+	SetComponentTickEnabled(false);
+
+	USkeletalMesh* NewMergedMesh = Job->Finish();
+	if (NewMergedMesh)
+	{
+		ShowMergedMesh(NewMergedMesh);
+	}
+	else
+	{
+		UE_LOG(LogSkeletalMesh, Warning, TEXT("Merge failed, the parts stay shown."));
+	}
+	PendingParams = FCustomSkeletalMeshMergeParams();
+
+	OnMerged.Broadcast(NewMergedMesh);
+}
+
+void UCustomSkeletalMeshMergeComponent::CancelMerge()
+{
+	if (!PendingJob.IsValid())
+	{
+		return;
+	}
+	if (PendingPrepare.IsValid())
+	{
+		PendingPrepare.Wait();
+	}
+	PendingJob->Cancel();
+
+	PendingJob.Reset();
+	PendingRequest.Reset();
+	PendingPrepare = TFuture<void>();
+	PendingParams = FCustomSkeletalMeshMergeParams();
+	SetComponentTickEnabled(false);
+}
+
+void UCustomSkeletalMeshMergeComponent::DestroyFollowers()
+{
+	for (USkeletalMeshComponent* Follower : Followers)
+	{
+		if (Follower)
+		{
+			Follower->DestroyComponent();
+		}
+	}
+	Followers.Reset();
+}
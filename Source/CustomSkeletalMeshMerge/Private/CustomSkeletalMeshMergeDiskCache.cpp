@@ -0,0 +1,755 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+/*=============================================================================
+	CustomSkeletalMeshMergeDiskCache.cpp: Persistent cache of merged render data.
+=============================================================================*/
+
+#include "CustomSkeletalMeshMergeDiskCache.h"
+#include "CustomSkeletalMeshMerge.h"
+#include "CustomSkeletalMeshMergeSharedCache.h"
+#include "CustomSkeletalMeshMergeStats.h"
+#include "Async/Async.h"
+#include "Async/Future.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Async/MappedFileHandle.h"
+#include "Misc/Crc.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Guid.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "RHI.h"
+#include "Serialization/BufferReader.h"
+#include "Serialization/MemoryWriter.h"
+
+static TAutoConsoleVariable<int32> CVarMergeDiskCacheEnabled(
+	TEXT("SkeletalMeshMerge.DiskCache"),
+	1,
+	TEXT("Determines whether merged render data is cached on disk between sessions.\n")
+	TEXT("0: Turned Off\n")
+	TEXT("1: Turned On"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarMergeDiskCacheMaxMB(
+	TEXT("SkeletalMeshMerge.DiskCacheMaxMB"),
+	512,
+	TEXT("Size of the merge disk cache directory in megabytes above which the least recently used blobs are deleted.\n")
+	TEXT("0 disables the limit."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarMergeWarmupConcurrency(
+	TEXT("SkeletalMeshMerge.WarmupConcurrency"),
+	2,
+	TEXT("Number of background tasks reading recently used merges from the disk cache at startup.\n")
+	TEXT("0 disables the warm-up."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarMergeWarmupKeys(
+	TEXT("SkeletalMeshMerge.WarmupKeys"),
+	64,
+	TEXT("Number of most recently used merges recorded for the warm-up of the next session."),
+	ECVF_Default);
+
+namespace
+{
+	const uint32 MergedDataMagic = 0x434D4D53; // 'SMMC'
+	const uint32 MergedDataVersion = 3;
+
+	/** Magic, version and payload checksum */
+	const int64 MergedDataHeaderSize = 3 * sizeof(uint32);
+
+	/**
+	 * Combines a merge key with the RHI settings the merged render data depends on, so blobs
+	 * written under one RHI configuration are not loaded under another.
+	 */
+	FSHAHash GetConfigKey(const FSHAHash& Key)
+	{
+		const uint8 FeatureLevel = static_cast<uint8>(GMaxRHIFeatureLevel);
+		const uint32 MaxGPUSkinBones = GetFeatureLevelMaxNumberOfBones(GMaxRHIFeatureLevel);
+		const uint8 bHalfUVs = GVertexElementTypeSupport.IsSupported(VET_Half2) ? 1 : 0;
+
+		FSHA1 Sha;
+		Sha.Update(Key.Hash, sizeof(Key.Hash));
+		Sha.Update(&FeatureLevel, sizeof(FeatureLevel));
+		Sha.Update(reinterpret_cast<const uint8*>(&MaxGPUSkinBones), sizeof(MaxGPUSkinBones));
+		Sha.Update(&bHalfUVs, sizeof(bHalfUVs));
+		Sha.Final();
+
+		FSHAHash ConfigKey;
+		Sha.GetHash(ConfigKey.Hash);
+		return ConfigKey;
+	}
+
+	/**
+	 * Combines a config key with the package guids of the source meshes. Shared memory entries can
+	 * not be replaced, so a resaved source mesh must publish its blob under a key of its own.
+	 */
+	FSHAHash GetSharedKey(const FSHAHash& ConfigKey, const TArray<FGuid>& SourceGuids)
+	{
+		FSHA1 Sha;
+		Sha.Update(ConfigKey.Hash, sizeof(ConfigKey.Hash));
+		Sha.Update(reinterpret_cast<const uint8*>(SourceGuids.GetData()), SourceGuids.Num() * sizeof(FGuid));
+		Sha.Final();
+
+		FSHAHash SharedKey;
+		Sha.GetHash(SharedKey.Hash);
+		return SharedKey;
+	}
+
+	/**
+	 * Serializes an element count, failing the load if it is negative or its elements can not
+	 * fit in the rest of the archive, so a corrupt count never sizes an allocation.
+	 */
+	bool SerializeCount(FArchive& Ar, int32& Count, int64 MinElementSize)
+	{
+		Ar << Count;
+		if (Ar.IsLoading() && (Count < 0 || Count * MinElementSize > Ar.TotalSize() - Ar.Tell()))
+		{
+			Ar.SetError();
+		}
+		return !Ar.IsError();
+	}
+
+	/** Deletes the least recently used blobs until the cache directory fits in its size limit */
+	void TrimCacheDirectory()
+	{
+		const int64 MaxBytes = static_cast<int64>(FMath::Max(CVarMergeDiskCacheMaxMB.GetValueOnAnyThread(), 0)) * 1024 * 1024;
+		if (MaxBytes == 0)
+		{
+			return;
+		}
+
+		struct FCachedBlob
+		{
+			FString Filename;
+			FDateTime TimeStamp;
+			int64 Size;
+		};
+		TArray<FCachedBlob> CachedBlobs;
+		int64 TotalBytes = 0;
+
+		IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+		PlatformFile.IterateDirectoryStat(*FCustomSkeletalMeshMergeDiskCache::GetCacheDirectory(), [&CachedBlobs, &TotalBytes](const TCHAR* Filename, const FFileStatData& StatData)
+		{
+			if (!StatData.bIsDirectory && FPaths::GetExtension(Filename) == TEXT("smm"))
+			{
+				CachedBlobs.Add({ Filename, StatData.ModificationTime, StatData.FileSize });
+				TotalBytes += StatData.FileSize;
+			}
+			return true;
+		});
+
+		if (TotalBytes <= MaxBytes)
+		{
+			return;
+		}
+
+		// Loads touch their blob, so the oldest modification time is the least recently used
+		CachedBlobs.Sort([](const FCachedBlob& A, const FCachedBlob& B) { return A.TimeStamp < B.TimeStamp; });
+		for (const FCachedBlob& CachedBlob : CachedBlobs)
+		{
+			if (TotalBytes <= MaxBytes)
+			{
+				break;
+			}
+			// blobs mapped by a load may not be deletable yet, they are trimmed by a later save
+			if (PlatformFile.DeleteFile(*CachedBlob.Filename))
+			{
+				TotalBytes -= CachedBlob.Size;
+			}
+		}
+	}
+
+	/** Marks a blob as used for the size limit */
+	void TouchBlob(const FString& Filename)
+	{
+		IFileManager::Get().SetTimeStamp(*Filename, FDateTime::UtcNow());
+	}
+
+	/** Blobs read ahead at startup and merges used during this session */
+	struct FWarmupState
+	{
+		FCriticalSection Lock;
+
+		/** Keys still to be read, most recent last */
+		TArray<FSHAHash> PendingKeys;
+
+		/** Blobs read ahead, each is handed to the first Load() of its key */
+		TMap<FSHAHash, TArray<uint8>> Blobs;
+
+		/** Keys loaded or saved, most recent last */
+		TArray<FSHAHash> RecentKeys;
+
+		TArray<TFuture<void>> Tasks;
+
+		bool bCancelled;
+
+		FWarmupState()
+			: bCancelled(false)
+		{}
+	};
+
+	FWarmupState& GetWarmupState()
+	{
+		static FWarmupState State;
+		return State;
+	}
+
+	void RecordUse(const FSHAHash& Key)
+	{
+		FWarmupState& State = GetWarmupState();
+		FScopeLock ScopeLock(&State.Lock);
+
+		State.RecentKeys.Remove(Key);
+		State.RecentKeys.Add(Key);
+
+		const int32 MaxKeys = FMath::Max(CVarMergeWarmupKeys.GetValueOnAnyThread(), 0);
+		if (State.RecentKeys.Num() > MaxKeys)
+		{
+			State.RecentKeys.RemoveAt(0, State.RecentKeys.Num() - MaxKeys, false);
+		}
+	}
+
+	bool TakeWarmBlob(const FSHAHash& Key, TArray<uint8>& OutBlob)
+	{
+		FWarmupState& State = GetWarmupState();
+		FScopeLock ScopeLock(&State.Lock);
+
+		return State.Blobs.RemoveAndCopyValue(Key, OutBlob);
+	}
+
+	/** Reads pending blobs, most recently used first, until none are left or the warm-up is stopped */
+	void RunWarmupTask()
+	{
+		FWarmupState& State = GetWarmupState();
+
+		for (;;)
+		{
+			FSHAHash Key;
+			{
+				FScopeLock ScopeLock(&State.Lock);
+				if (State.bCancelled || State.PendingKeys.Num() == 0)
+				{
+					return;
+				}
+				Key = State.PendingKeys.Pop(false);
+			}
+
+			TArray<uint8> Blob;
+			if (FFileHelper::LoadFileToArray(Blob, *FCustomSkeletalMeshMergeDiskCache::GetCacheFilename(Key), FILEREAD_Silent))
+			{
+				FScopeLock ScopeLock(&State.Lock);
+				State.Blobs.Add(Key, MoveTemp(Blob));
+			}
+		}
+	}
+
+	/** Names are stored as strings since raw buffer readers do not serialize FName */
+	void SerializeName(FArchive& Ar, FName& Name)
+	{
+		FString NameString = Name.ToString();
+		Ar << NameString;
+		if (Ar.IsLoading())
+		{
+			Name = FName(*NameString);
+		}
+	}
+
+	void SerializeRefSkeleton(FArchive& Ar, FReferenceSkeleton& RefSkeleton, const USkeleton* Skeleton)
+	{
+		int32 NumBones = RefSkeleton.GetRawBoneNum();
+		if (!SerializeCount(Ar, NumBones, sizeof(int32) + sizeof(FQuat) + 2 * sizeof(FVector)))
+		{
+			return;
+		}
+
+		if (Ar.IsLoading())
+		{
+			RefSkeleton.Empty(NumBones);
+			FReferenceSkeletonModifier RefSkelModifier(RefSkeleton, Skeleton);
+
+			for (int32 BoneIdx = 0; BoneIdx < NumBones && !Ar.IsError(); BoneIdx++)
+			{
+				FName BoneName;
+				int32 ParentIndex = INDEX_NONE;
+				FQuat Rotation;
+				FVector Translation;
+				FVector Scale;
+
+				SerializeName(Ar, BoneName);
+				Ar << ParentIndex << Rotation << Translation << Scale;
+
+				RefSkelModifier.Add(FMeshBoneInfo(BoneName, BoneName.ToString(), ParentIndex), FTransform(Rotation, Translation, Scale));
+			}
+		}
+		else
+		{
+			const TArray<FMeshBoneInfo>& BoneInfos = RefSkeleton.GetRawRefBoneInfo();
+			const TArray<FTransform>& BonePoses = RefSkeleton.GetRawRefBonePose();
+
+			for (int32 BoneIdx = 0; BoneIdx < NumBones; BoneIdx++)
+			{
+				FName BoneName = BoneInfos[BoneIdx].Name;
+				int32 ParentIndex = BoneInfos[BoneIdx].ParentIndex;
+				FQuat Rotation = BonePoses[BoneIdx].GetRotation();
+				FVector Translation = BonePoses[BoneIdx].GetTranslation();
+				FVector Scale = BonePoses[BoneIdx].GetScale3D();
+
+				SerializeName(Ar, BoneName);
+				Ar << ParentIndex << Rotation << Translation << Scale;
+			}
+		}
+	}
+
+	void SerializeSockets(FArchive& Ar, TArray<FMergedSocketInfo>& Sockets)
+	{
+		int32 NumSockets = Sockets.Num();
+		if (!SerializeCount(Ar, NumSockets, 3 * sizeof(FVector)))
+		{
+			return;
+		}
+
+		if (Ar.IsLoading())
+		{
+			Sockets.Empty(NumSockets);
+			for (int32 SocketIdx = 0; SocketIdx < NumSockets; SocketIdx++)
+			{
+				Sockets.Add(FMergedSocketInfo(nullptr));
+			}
+		}
+
+		for (FMergedSocketInfo& Socket : Sockets)
+		{
+			if (Ar.IsError())
+			{
+				return;
+			}
+			SerializeName(Ar, Socket.SocketName);
+			SerializeName(Ar, Socket.BoneName);
+			Ar << Socket.RelativeLocation << Socket.RelativeRotation << Socket.RelativeScale;
+			Ar << Socket.bForceAlwaysAnimated;
+		}
+	}
+
+	void SerializeDuplicatedVertices(FArchive& Ar, FDuplicatedVerticesBuffer& Buffer)
+	{
+		Ar << Buffer.bHasOverlappingVertices;
+
+		int32 NumDupVerts = Buffer.DupVertData.Num();
+		int32 NumDupIndices = Buffer.DupVertIndexData.Num();
+		if (!SerializeCount(Ar, NumDupVerts, sizeof(uint32)) || !SerializeCount(Ar, NumDupIndices, sizeof(FIndexLengthPair)))
+		{
+			return;
+		}
+
+		if (Ar.IsLoading())
+		{
+			Buffer.DupVertData.ResizeBuffer(NumDupVerts);
+			Buffer.DupVertIndexData.ResizeBuffer(NumDupIndices);
+		}
+
+		if (NumDupVerts > 0)
+		{
+			Ar.Serialize(Buffer.DupVertData.GetDataPointer(), NumDupVerts * sizeof(uint32));
+		}
+		if (NumDupIndices > 0)
+		{
+			Ar.Serialize(Buffer.DupVertIndexData.GetDataPointer(), NumDupIndices * sizeof(FIndexLengthPair));
+		}
+	}
+
+	void SerializeRenderSection(FArchive& Ar, FSkelMeshRenderSection& Section)
+	{
+		Ar << Section.MaterialIndex;
+		Ar << Section.BaseIndex;
+		Ar << Section.NumTriangles;
+		Ar << Section.bRecomputeTangent;
+		Ar << Section.bCastShadow;
+		Ar << Section.BaseVertexIndex;
+		Ar << Section.BoneMap;
+		Ar << Section.NumVertices;
+		Ar << Section.MaxBoneInfluences;
+		Ar << Section.bDisabled;
+		SerializeDuplicatedVertices(Ar, Section.DuplicatedVerticesBuffer);
+	}
+
+	void SerializeLODRenderData(FArchive& Ar, FSkeletalMeshLODRenderData& LODData, bool bNeedsCPUAccess)
+	{
+		int32 NumSections = LODData.RenderSections.Num();
+		if (!SerializeCount(Ar, NumSections, 8 * sizeof(int32)))
+		{
+			return;
+		}
+
+		if (Ar.IsLoading())
+		{
+			LODData.RenderSections.Empty(NumSections);
+			LODData.RenderSections.AddDefaulted(NumSections);
+		}
+
+		for (FSkelMeshRenderSection& Section : LODData.RenderSections)
+		{
+			if (Ar.IsError())
+			{
+				return;
+			}
+			SerializeRenderSection(Ar, Section);
+		}
+
+		Ar << LODData.RequiredBones;
+		Ar << LODData.ActiveBoneIndices;
+
+		LODData.StaticVertexBuffers.PositionVertexBuffer.Serialize(Ar, bNeedsCPUAccess);
+		LODData.StaticVertexBuffers.StaticMeshVertexBuffer.Serialize(Ar, bNeedsCPUAccess);
+		LODData.StaticVertexBuffers.ColorVertexBuffer.Serialize(Ar, bNeedsCPUAccess);
+
+		LODData.SkinWeightVertexBuffer.SetNeedsCPUAccess(bNeedsCPUAccess);
+		Ar << LODData.SkinWeightVertexBuffer;
+
+		LODData.MultiSizeIndexContainer.Serialize(Ar, bNeedsCPUAccess);
+	}
+
+	void SerializeMaterials(FArchive& Ar, TArray<FSkeletalMaterial>& Materials, UMaterialInterface* Material)
+	{
+		int32 NumMaterials = Materials.Num();
+		if (!SerializeCount(Ar, NumMaterials, MAX_TEXCOORDS * sizeof(float)))
+		{
+			return;
+		}
+
+		if (Ar.IsLoading())
+		{
+			Materials.Empty(NumMaterials);
+			for (int32 MaterialIdx = 0; MaterialIdx < NumMaterials; MaterialIdx++)
+			{
+				Materials.Add(FSkeletalMaterial(Material, true));
+			}
+		}
+
+		for (FSkeletalMaterial& SkeletalMaterial : Materials)
+		{
+			FMeshUVChannelInfo& UVChannelData = SkeletalMaterial.UVChannelData;
+			Ar << UVChannelData.bInitialized;
+			Ar << UVChannelData.bOverrideDensities;
+			for (int32 UVIndex = 0; UVIndex < MAX_TEXCOORDS; UVIndex++)
+			{
+				Ar << UVChannelData.LocalUVDensities[UVIndex];
+			}
+		}
+	}
+}
+
+bool FCustomSkeletalMeshMergeDiskCache::IsEnabled()
+{
+	return CVarMergeDiskCacheEnabled.GetValueOnAnyThread() != 0;
+}
+
+FString FCustomSkeletalMeshMergeDiskCache::GetCacheDirectory()
+{
+	return FPaths::ProjectSavedDir() / TEXT("SkeletalMeshMerge") / TEXT("Cache");
+}
+
+FString FCustomSkeletalMeshMergeDiskCache::GetCacheFilename(const FSHAHash& Key)
+{
+	return GetCacheDirectory() / (Key.ToString() + TEXT(".smm"));
+}
+
+FString FCustomSkeletalMeshMergeDiskCache::GetUsageManifestFilename()
+{
+	return GetCacheDirectory() / TEXT("RecentMerges.txt");
+}
+
+void FCustomSkeletalMeshMergeDiskCache::StartWarmup()
+{
+	const int32 Concurrency = CVarMergeWarmupConcurrency.GetValueOnGameThread();
+	if (!IsEnabled() || Concurrency <= 0)
+	{
+		return;
+	}
+
+	TArray<FString> Lines;
+	if (!FFileHelper::LoadFileToStringArray(Lines, *GetUsageManifestFilename()))
+	{
+		return;
+	}
+
+	FWarmupState& State = GetWarmupState();
+	FScopeLock ScopeLock(&State.Lock);
+
+	for (const FString& Line : Lines)
+	{
+		if (Line.Len() == 40)
+		{
+			FSHAHash Key;
+			Key.FromString(Line);
+			State.PendingKeys.Add(Key);
+		}
+	}
+
+	// Carried over so a session that merges nothing keeps the manifest
+	State.RecentKeys = State.PendingKeys;
+
+	const int32 NumTasks = FMath::Min(Concurrency, State.PendingKeys.Num());
+	for (int32 TaskIdx = 0; TaskIdx < NumTasks; TaskIdx++)
+	{
+		State.Tasks.Add(Async(EAsyncExecution::Thread, []() { RunWarmupTask(); }));
+	}
+}
+
+void FCustomSkeletalMeshMergeDiskCache::Shutdown()
+{
+	FWarmupState& State = GetWarmupState();
+
+	TArray<TFuture<void>> Tasks;
+	{
+		FScopeLock ScopeLock(&State.Lock);
+		State.bCancelled = true;
+		Tasks = MoveTemp(State.Tasks);
+	}
+
+	for (TFuture<void>& Task : Tasks)
+	{
+		Task.Wait();
+	}
+
+	FScopeLock ScopeLock(&State.Lock);
+
+	if (IsEnabled() && State.RecentKeys.Num() > 0)
+	{
+		TArray<FString> Lines;
+		for (const FSHAHash& Key : State.RecentKeys)
+		{
+			Lines.Add(Key.ToString());
+		}
+		FFileHelper::SaveStringArrayToFile(Lines, *GetUsageManifestFilename());
+	}
+
+	State.PendingKeys.Empty();
+	State.Blobs.Empty();
+	State.RecentKeys.Empty();
+}
+
+bool FCustomSkeletalMeshMergeDiskCache::SerializeMergedData(FArchive& Ar, FMergedMeshData& Data, TArray<FGuid>& SourceGuids, const USkeleton* Skeleton, UMaterialInterface* Material)
+{
+	// Reject blobs built from different source assets
+	TArray<FGuid> BlobSourceGuids = SourceGuids;
+	Ar << BlobSourceGuids;
+
+	if (Ar.IsError() || BlobSourceGuids != SourceGuids)
+	{
+		return false;
+	}
+
+	SerializeRefSkeleton(Ar, Data.RefSkeleton, Skeleton);
+	SerializeSockets(Ar, Data.Sockets);
+
+	int32 NumLODs = Data.LODRenderData.Num();
+	if (!SerializeCount(Ar, NumLODs, 3 * sizeof(int32)))
+	{
+		return false;
+	}
+
+	if (Ar.IsLoading())
+	{
+		Data.LODRenderData.Empty(NumLODs);
+		Data.LODInfo.Empty(NumLODs);
+		Data.LODInfo.AddDefaulted(NumLODs);
+		for (int32 LODIdx = 0; LODIdx < NumLODs; LODIdx++)
+		{
+			Data.LODRenderData.Add(new FSkeletalMeshLODRenderData);
+		}
+	}
+
+	check(Data.LODInfo.Num() == NumLODs);
+
+	for (int32 LODIdx = 0; LODIdx < NumLODs && !Ar.IsError(); LODIdx++)
+	{
+		FMergedLODInfo& LODInfo = Data.LODInfo[LODIdx];
+		Ar << LODInfo.ScreenSize.Default;
+		Ar << LODInfo.LODHysteresis;
+		Ar << LODInfo.bNeedsCPUAccess;
+
+		SerializeLODRenderData(Ar, Data.LODRenderData[LODIdx], LODInfo.bNeedsCPUAccess);
+	}
+
+	SerializeMaterials(Ar, Data.Materials, Material);
+
+	Ar << Data.ImportedBounds;
+	Ar << Data.SkelMirrorAxis;
+	Ar << Data.SkelMirrorFlipAxis;
+	Ar << Data.bHasVertexColors;
+	Ar << Data.bUseFullPrecisionUVs;
+
+	return !Ar.IsError();
+}
+
+void FCustomSkeletalMeshMergeDiskCache::Save(const FSHAHash& Key, const TArray<FGuid>& SourceGuids, FMergedMeshData& Data)
+{
+	if (!IsEnabled())
+	{
+		return;
+	}
+
+	TArray<uint8> Blob;
+	if (!SaveToMemory(Data, SourceGuids, Blob))
+	{
+		return;
+	}
+
+	const FSHAHash ConfigKey = GetConfigKey(Key);
+	const FString Filename = GetCacheFilename(ConfigKey);
+	RecordUse(ConfigKey);
+
+	if (FCustomSkeletalMeshMergeSharedCache::IsEnabled())
+	{
+		FCustomSkeletalMeshMergeSharedCache::Get().Add(GetSharedKey(ConfigKey, SourceGuids), Blob.GetData(), Blob.Num());
+	}
+
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [Blob, Filename]()
+	{
+		// Write next to the final file and move it in place so readers never see a partial blob,
+		// under a name of its own so concurrent saves of the key do not write the same file
+		const FString TempFilename = FString::Printf(TEXT("%s.%s.tmp"), *Filename, *FGuid::NewGuid().ToString());
+		if (FFileHelper::SaveArrayToFile(Blob, *TempFilename))
+		{
+			if (!IFileManager::Get().Move(*Filename, *TempFilename, true, true))
+			{
+				IFileManager::Get().Delete(*TempFilename, false, false, true);
+			}
+		}
+		TrimCacheDirectory();
+	});
+}
+
+bool FCustomSkeletalMeshMergeDiskCache::SaveToMemory(FMergedMeshData& Data, const TArray<FGuid>& SourceGuids, TArray<uint8>& OutBlob)
+{
+	OutBlob.Reset();
+	FMemoryWriter Writer(OutBlob, true);
+
+	uint32 Magic = MergedDataMagic;
+	uint32 Version = MergedDataVersion;
+	uint32 PayloadCrc = 0;
+	Writer << Magic << Version << PayloadCrc;
+
+	TArray<FGuid> BlobSourceGuids = SourceGuids;
+	if (!SerializeMergedData(Writer, Data, BlobSourceGuids, nullptr, nullptr))
+	{
+		return false;
+	}
+
+	// the checksum is written last, it covers everything after the header
+	PayloadCrc = FCrc::MemCrc32(OutBlob.GetData() + MergedDataHeaderSize, static_cast<int32>(OutBlob.Num() - MergedDataHeaderSize));
+	Writer.Seek(2 * sizeof(uint32));
+	Writer << PayloadCrc;
+	return true;
+}
+
+bool FCustomSkeletalMeshMergeDiskCache::Load(const FSHAHash& Key, const TArray<FGuid>& SourceGuids, const USkeleton* Skeleton, UMaterialInterface* Material, FMergedMeshData& OutData)
+{
+	if (!IsEnabled())
+	{
+		return false;
+	}
+
+	const FSHAHash ConfigKey = GetConfigKey(Key);
+	const FString Filename = GetCacheFilename(ConfigKey);
+
+	// Blobs read ahead at startup are used once, later loads map the file again
+	TArray<uint8> WarmBlob;
+	if (TakeWarmBlob(ConfigKey, WarmBlob))
+	{
+		RecordUse(ConfigKey);
+		TouchBlob(Filename);
+		return LoadFromMemory(WarmBlob.GetData(), WarmBlob.Num(), SourceGuids, Skeleton, Material, OutData);
+	}
+
+	// Other processes of the host may have merged or loaded it already
+	const bool bUseSharedCache = FCustomSkeletalMeshMergeSharedCache::IsEnabled();
+	const FSHAHash SharedKey = bUseSharedCache ? GetSharedKey(ConfigKey, SourceGuids) : FSHAHash();
+	if (bUseSharedCache)
+	{
+		const uint8* SharedData = nullptr;
+		int64 SharedDataSize = 0;
+		if (FCustomSkeletalMeshMergeSharedCache::Get().Find(SharedKey, SharedData, SharedDataSize))
+		{
+			RecordUse(ConfigKey);
+			if (LoadFromMemory(SharedData, SharedDataSize, SourceGuids, Skeleton, Material, OutData))
+			{
+				return true;
+			}
+			// a rejected entry stays in the region, the blob on disk may still be good
+		}
+	}
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	if (!PlatformFile.FileExists(*Filename))
+	{
+		return false;
+	}
+	RecordUse(ConfigKey);
+	TouchBlob(Filename);
+
+	// Prefer reading straight from a mapping of the file
+	TUniquePtr<IMappedFileHandle> MappedFile(PlatformFile.OpenMapped(*Filename));
+	TUniquePtr<IMappedFileRegion> MappedRegion(MappedFile ? MappedFile->MapRegion() : nullptr);
+
+	// Only blobs that loaded are published, other processes must not pick up a stale or corrupt one
+	if (MappedRegion)
+	{
+		if (!LoadFromMemory(MappedRegion->GetMappedPtr(), MappedRegion->GetMappedSize(), SourceGuids, Skeleton, Material, OutData))
+		{
+			return false;
+		}
+		if (bUseSharedCache)
+		{
+			FCustomSkeletalMeshMergeSharedCache::Get().Add(SharedKey, MappedRegion->GetMappedPtr(), MappedRegion->GetMappedSize());
+		}
+		return true;
+	}
+
+	TArray<uint8> Blob;
+	if (!FFileHelper::LoadFileToArray(Blob, *Filename))
+	{
+		return false;
+	}
+
+	if (!LoadFromMemory(Blob.GetData(), Blob.Num(), SourceGuids, Skeleton, Material, OutData))
+	{
+		return false;
+	}
+	if (bUseSharedCache)
+	{
+		FCustomSkeletalMeshMergeSharedCache::Get().Add(SharedKey, Blob.GetData(), Blob.Num());
+	}
+	return true;
+}
+
+bool FCustomSkeletalMeshMergeDiskCache::LoadFromMemory(const uint8* Data, int64 DataSize, const TArray<FGuid>& SourceGuids, const USkeleton* Skeleton, UMaterialInterface* Material, FMergedMeshData& OutData)
+{
+	SKELETALMESHMERGE_LLM_SCOPE(Geometry);
+
+	FBufferReader Reader(const_cast<uint8*>(Data), DataSize, false);
+	TArray<FGuid> ExpectedSourceGuids = SourceGuids;
+
+	// Corrupt blobs are rejected before any count they hold is read
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	uint32 PayloadCrc = 0;
+	if (DataSize >= MergedDataHeaderSize)
+	{
+		Reader << Magic << Version << PayloadCrc;
+	}
+	const bool bValidHeader = Magic == MergedDataMagic && Version == MergedDataVersion &&
+		PayloadCrc == FCrc::MemCrc32(Data + MergedDataHeaderSize, static_cast<int32>(DataSize - MergedDataHeaderSize));
+
+	if (!bValidHeader || !SerializeMergedData(Reader, OutData, ExpectedSourceGuids, Skeleton, Material))
+	{
+		UE_LOG(LogSkeletalMesh, Verbose, TEXT("FCustomSkeletalMeshMergeDiskCache: Discarding stale or invalid merged data"));
+		OutData = FMergedMeshData();
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,80 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+/*=============================================================================
+	CustomSkeletalMeshMergeDiskCache.h: Persistent cache of merged render data.
+=============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/SecureHash.h"
+
+class FArchive;
+class USkeleton;
+class UMaterialInterface;
+struct FMergedMeshData;
+
+/**
+* Stores merged mesh data in a versioned binary blob per merge content key and RHI configuration,
+* so a later identical merge can skip building the LOD render data. The directory is kept within
+* SkeletalMeshMerge.DiskCacheMaxMB by deleting the least recently used blobs.
+*/
+class FCustomSkeletalMeshMergeDiskCache
+{
+public:
+	/** @return Whether merged data should be read from and written to the cache directory. */
+	static bool IsEnabled();
+
+	/** @return Directory holding the cached blobs. */
+	static FString GetCacheDirectory();
+
+	/** @return Path of the blob for a cache key, the merge content key combined with the RHI configuration. */
+	static FString GetCacheFilename(const FSHAHash& Key);
+
+	/** @return Path of the list of merge keys recently used, read by the warm-up of the next session. */
+	static FString GetUsageManifestFilename();
+
+	/**
+	 * Reads the blobs listed in the usage manifest into memory on background tasks,
+	 * so the first merges of the session do not wait on the disk.
+	 */
+	static void StartWarmup();
+
+	/** Stops the warm-up, writes the usage manifest of this session and drops blobs that were not used. */
+	static void Shutdown();
+
+	/**
+	 * Serializes merged data to the binary format, then writes it to the cache directory in the background.
+	 * @param SourceGuids - package guids of the source meshes, used to detect stale blobs
+	 */
+	static void Save(const FSHAHash& Key, const TArray<FGuid>& SourceGuids, FMergedMeshData& Data);
+
+	/**
+	 * Reads the blob for the key, memory mapping it where the platform allows.
+	 * @param SourceGuids - package guids of the source meshes, the blob is rejected if they changed
+	 * @param Skeleton - skeleton asset used to rebuild the reference skeleton
+	 * @param Material - material bound to every merged material slot
+	 * @return 'true' if OutData was filled from the cache.
+	 */
+	static bool Load(const FSHAHash& Key, const TArray<FGuid>& SourceGuids, const USkeleton* Skeleton, UMaterialInterface* Material, FMergedMeshData& OutData);
+
+	/**
+	 * Same as Load() but reads a blob that is already in memory.
+	 * Blobs with a wrong checksum are rejected before they are parsed.
+	 */
+	static bool LoadFromMemory(const uint8* Data, int64 DataSize, const TArray<FGuid>& SourceGuids, const USkeleton* Skeleton, UMaterialInterface* Material, FMergedMeshData& OutData);
+
+	/**
+	 * Writes merged data to a blob in the binary format, as read by LoadFromMemory().
+	 * @param SourceGuids - package guids of the source meshes, used to detect stale blobs
+	 * @return 'false' if the data could not be written.
+	 */
+	static bool SaveToMemory(FMergedMeshData& Data, const TArray<FGuid>& SourceGuids, TArray<uint8>& OutBlob);
+
+private:
+	/**
+	 * Reads or writes the merged data following the blob header.
+	 * @return 'false' if loading failed or the blob does not match the source guids.
+	 */
+	static bool SerializeMergedData(FArchive& Ar, FMergedMeshData& Data, TArray<FGuid>& SourceGuids, const USkeleton* Skeleton, UMaterialInterface* Material);
+};
@@ -0,0 +1,226 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "CustomSkeletalMeshMergeJob.h"
+#include "CustomSkeletalMeshMergeCache.h"
+#include "CustomSkeletalMeshMergeDiskCache.h"
+#include "CustomSkeletalMeshMergePool.h"
+#include "CustomSkeletalMeshMergePrebake.h"
+#include "CustomSkeletalMeshMergeRequest.h"
+#include "Engine/SkeletalMesh.h"
+#include "Animation/Skeleton.h"
+#include "Components/SkinnedMeshComponent.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "UObject/UObjectIterator.h"
+
+/** Processed parts of incremental merges, keyed by the merged mesh they produced */
+static TMap<TWeakObjectPtr<USkeletalMesh>, TSharedPtr<FSkelMeshMergeIncrementalState>> IncrementalStates;
+
+/** @return Whether a component still renders the mesh, whose LOD render data then must not be recycled */
+static bool IsMeshShown(const USkeletalMesh* Mesh)
+{
+	for (TObjectIterator<USkinnedMeshComponent> It; It; ++It)
+	{
+		if (It->SkeletalMesh == Mesh && It->IsRenderStateCreated())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+FSkelMeshMergeJob::FSkelMeshMergeJob(const FCustomSkeletalMeshMergeNativeParams& InParams, FCustomSkeletalMeshMergeReport* InReport)
+	: Params(InParams)
+	, Report(InReport)
+	, bNeedsKey(false)
+	, BaseMesh(nullptr)
+	, bMergeInPlace(false)
+	, bPrepared(false)
+	, MergedMesh(nullptr)
+{
+}
+
+bool FSkelMeshMergeJob::Start()
+{
+	check(IsInGameThread());
+
+	if (Params.Parts.Num() <= 1)
+	{
+		UE_LOG(LogSkeletalMesh, Warning, TEXT("Must provide multiple valid Skeletal Meshes in order to perform a merge."));
+		return false;
+	}
+	for (const FSkelMeshMergePart& Part : Params.Parts)
+	{
+		if (!Part.SkeletalMesh)
+		{
+			UE_LOG(LogSkeletalMesh, Warning, TEXT("Every merged part must have a Skeletal Mesh."));
+			return false;
+		}
+	}
+
+	// Identical requests share the mesh produced by the first one
+	FCustomSkeletalMeshMergeCache& MergeCache = FCustomSkeletalMeshMergeCache::Get();
+	const bool bUsePrebake = FCustomSkeletalMeshMergePrebake::GetTable() != nullptr;
+	bNeedsKey = FCustomSkeletalMeshMergeCache::IsEnabled() || bUsePrebake || FCustomSkeletalMeshMergeDiskCache::IsEnabled();
+	if (bNeedsKey)
+	{
+		MergeKey = FSkelMeshMergeRequest::ComputeKey(Params);
+
+		USkeletalMesh* SharedMesh = FCustomSkeletalMeshMergeCache::IsEnabled() ? MergeCache.FindAndAddRef(MergeKey) : nullptr;
+		if (SharedMesh)
+		{
+			if (Report)
+			{
+				Report->Source = ECustomSkeletalMeshMergeSource::SharedMesh;
+			}
+			MergedMesh = SharedMesh;
+			return false;
+		}
+	}
+
+	FCustomSkeletalMeshMergePool& MergePool = FCustomSkeletalMeshMergePool::Get();
+
+	// An unshared previous mesh that is no longer shown is rebuilt in place, refilling its LOD render data
+	bMergeInPlace = Params.bMergeInPlace && Params.PreviousMergedMesh && MergePool.IsIssued(Params.PreviousMergedMesh)
+		&& !IsMeshShown(Params.PreviousMergedMesh) && MergeCache.RemoveForRebuild(Params.PreviousMergedMesh);
+	if (bMergeInPlace)
+	{
+		BaseMesh = Params.PreviousMergedMesh;
+		BaseMesh->Skeleton = nullptr;
+	}
+	else
+	{
+		BaseMesh = MergePool.Acquire();
+	}
+	if (Params.Skeleton && Params.bSkeletonBefore)
+	{
+		BaseMesh->Skeleton = Params.Skeleton;
+	}
+	Merger = MakeUnique<FCustomSkeletalMeshMerge>(BaseMesh, Params.BaseMaterial, Params.Parts, Params.SectionMappings, Params.StripTopLODs, Params.MeshBufferAccess);
+	if (bNeedsKey)
+	{
+		Merger->SetCacheKey(MergeKey);
+	}
+	Merger->SetReport(Report);
+	// a pooled or rebuilt mesh still holds the LOD render data of its previous merge, which is refilled instead of reallocated
+	Merger->RecycleRenderData();
+	if (Params.bIncremental)
+	{
+		// take over the state of the previous merge, dropping states of meshes that were destroyed
+		if (Params.PreviousMergedMesh)
+		{
+			IncrementalStates.RemoveAndCopyValue(Params.PreviousMergedMesh, IncrementalState);
+		}
+		for (auto It = IncrementalStates.CreateIterator(); It; ++It)
+		{
+			if (!It.Key().IsValid())
+			{
+				It.RemoveCurrent();
+			}
+		}
+		if (!IncrementalState.IsValid())
+		{
+			IncrementalState = MakeShared<FSkelMeshMergeIncrementalState>();
+		}
+		Merger->SetIncrementalState(IncrementalState.Get());
+	}
+
+	// Common combinations are baked at cook time and only cost an asset load
+	UCustomSkeletalMeshMergePrebakedMesh* Prebaked = bUsePrebake ? FCustomSkeletalMeshMergePrebake::FindPrebakedMesh(MergeKey) : nullptr;
+	if (Prebaked)
+	{
+		if (Merger->CommitPrebaked(Prebaked->MergedData, Prebaked->Material))
+		{
+			Complete();
+			return false;
+		}
+	}
+
+	Merger->MergeMaterial();
+	return true;
+}
+
+void FSkelMeshMergeJob::Prepare()
+{
+	check(Merger.IsValid());
+	bPrepared = Merger->PrepareMerge();
+}
+
+USkeletalMesh* FSkelMeshMergeJob::Finish()
+{
+	check(IsInGameThread());
+	check(Merger.IsValid());
+
+	if (!bPrepared)
+	{
+		UE_LOG(LogSkeletalMesh, Warning, TEXT("Merge failed!"));
+		Abandon();
+		return nullptr;
+	}
+
+	Merger->CommitMerge();
+	Complete();
+	return MergedMesh;
+}
+
+void FSkelMeshMergeJob::Cancel()
+{
+	check(IsInGameThread());
+
+	if (Merger.IsValid())
+	{
+		Abandon();
+	}
+}
+
+void FSkelMeshMergeJob::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	Collector.AddReferencedObject(BaseMesh);
+	if (Merger.IsValid())
+	{
+		UMaterialInstanceDynamic* MergedMaterial = Merger->GetMergedMaterial();
+		Collector.AddReferencedObject(MergedMaterial);
+	}
+}
+
+void FSkelMeshMergeJob::RemoveIncrementalState(USkeletalMesh* MergedMesh)
+{
+	check(IsInGameThread());
+
+	IncrementalStates.Remove(MergedMesh);
+}
+
+void FSkelMeshMergeJob::Complete()
+{
+	if (IncrementalState.IsValid())
+	{
+		IncrementalStates.Add(BaseMesh, IncrementalState);
+	}
+	if (Params.Skeleton && !Params.bSkeletonBefore)
+	{
+		BaseMesh->Skeleton = Params.Skeleton;
+	}
+	if (FCustomSkeletalMeshMergeCache::IsEnabled())
+	{
+		SIZE_T CPUBytes = 0;
+		SIZE_T GPUBytes = 0;
+		Merger->GetMergedMeshSize(CPUBytes, GPUBytes);
+		FCustomSkeletalMeshMergeCache::Get().Add(MergeKey, BaseMesh, CPUBytes, GPUBytes, Merger->GetAtlasKey());
+	}
+	else
+	{
+		// the merge may have added source mesh records that count towards the budget
+		FCustomSkeletalMeshMergeCache::Get().EvictToBudget();
+	}
+
+	MergedMesh = BaseMesh;
+	BaseMesh = nullptr;
+	Merger.Reset();
+}
+
+void FSkelMeshMergeJob::Abandon()
+{
+	// a mesh rebuilt in place lost its LOD render data to the merge as well, so it goes back to the pool too
+	FCustomSkeletalMeshMergePool::Get().Release(BaseMesh);
+	BaseMesh = nullptr;
+	Merger.Reset();
+}
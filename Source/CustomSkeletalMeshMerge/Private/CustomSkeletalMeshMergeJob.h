@@ -0,0 +1,88 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+/*=============================================================================
+	CustomSkeletalMeshMergeJob.h: A merge request through the caches, pool and prebaked meshes.
+=============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/SecureHash.h"
+#include "CustomSkeletalMeshMerge.h"
+#include "CustomSkeletalMeshMergeNative.h"
+
+class FReferenceCollector;
+
+/**
+* Merges a request the way MergeMeshes does, split in stages so the skeleton and render data can be
+* prepared on a worker thread while the game thread keeps running.
+*/
+class FSkelMeshMergeJob
+{
+public:
+	/**
+	 * @param InParams - the parts and section mappings are referenced and must outlive the job
+	 * @param InReport - (optional) report owned by the caller that outlives the job
+	 */
+	FSkelMeshMergeJob(const FCustomSkeletalMeshMergeNativeParams& InParams, FCustomSkeletalMeshMergeReport* InReport);
+
+	/**
+	 * Looks for a shared or prebaked result and merges the material otherwise.
+	 * Must be called on the game thread.
+	 * @return 'true' if the merge still has to be prepared and finished; 'false' if it is done, see GetMergedMesh().
+	 */
+	bool Start();
+
+	/**
+	 * Prepares the merged skeleton and render data of a started job.
+	 * Does not modify the merge mesh, so it may run off the game thread.
+	 */
+	void Prepare();
+
+	/**
+	 * Commits the prepared data to the merge mesh. Must be called on the game thread.
+	 * @return The merged mesh, or nullptr if the merge failed.
+	 */
+	USkeletalMesh* Finish();
+
+	/** Gives back the merge mesh of a job that was started but not finished. Must be called on the game thread. */
+	void Cancel();
+
+	/** @return The merged mesh of a done job, or nullptr if it failed. */
+	USkeletalMesh* GetMergedMesh() const { return MergedMesh; }
+
+	/** @return Whether the started job rebuilds PreviousMergedMesh, which it then owns until it is done. */
+	bool IsMergingInPlace() const { return bMergeInPlace; }
+
+	/** Keeps the merge mesh and merged material of a pending job alive. */
+	void AddReferencedObjects(FReferenceCollector& Collector);
+
+	/** Drops the incremental state kept for a merged mesh, once the mesh no longer holds that merge. Must be called on the game thread. */
+	static void RemoveIncrementalState(USkeletalMesh* MergedMesh);
+
+private:
+	/** Registers a committed merge and makes it the job result */
+	void Complete();
+
+	/** Hands back the merge mesh of a merge that was not committed */
+	void Abandon();
+
+	FCustomSkeletalMeshMergeNativeParams Params;
+	FCustomSkeletalMeshMergeReport* Report;
+
+	/** Content key, only valid if bNeedsKey */
+	FSHAHash MergeKey;
+	bool bNeedsKey;
+
+	/** Mesh the merge is committed to, a pooled mesh or the previous mesh when merging in place */
+	USkeletalMesh* BaseMesh;
+	bool bMergeInPlace;
+
+	TUniquePtr<FCustomSkeletalMeshMerge> Merger;
+	TSharedPtr<FSkelMeshMergeIncrementalState> IncrementalState;
+
+	/** Whether Prepare() succeeded */
+	bool bPrepared;
+
+	USkeletalMesh* MergedMesh;
+};
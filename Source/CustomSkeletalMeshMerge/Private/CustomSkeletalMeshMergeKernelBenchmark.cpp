@@ -0,0 +1,225 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+/*=============================================================================
+	CustomSkeletalMeshMergeKernelBenchmark.cpp: Console benchmark of the merge inner loops.
+=============================================================================*/
+
+#include "CustomSkeletalMeshMergeKernels.h"
+#include "GPUSkinVertexFactory.h"
+#include "SkeletalMeshTypes.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+
+namespace
+{
+	/** Vertex layout of the source buffers, the merge picks it for sources with full precision UVs */
+	typedef TGPUSkinVertexFloat32Uvs<2> FBenchmarkVertex;
+	typedef TSkinWeightInfo<false> FBenchmarkSkinWeight;
+
+	/** Bones of the generated section, a GPU skinning sized bone map */
+	const int32 NumSectionBones = 64;
+
+	/** Textures of a generated atlas, the size of the usual part set */
+	const int32 NumAtlasTextures = 16;
+
+	/**
+	 * Runs a kernel once to warm the caches, then times it once per iteration.
+	 * @return Median time of an iteration, in nanoseconds
+	 */
+	template<typename KernelType>
+	double MeasureKernel(int32 NumIterations, KernelType Kernel)
+	{
+		Kernel();
+
+		TArray<double> Samples;
+		for (int32 Iteration = 0; Iteration < NumIterations; Iteration++)
+		{
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			Kernel();
+			Samples.Add(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) * 1000000.0);
+		}
+
+		Samples.Sort();
+		return Samples[Samples.Num() / 2];
+	}
+
+	void LogKernel(const TCHAR* Name, double IterationNs, int64 NumElements, const TCHAR* ElementName)
+	{
+		UE_LOG(LogSkeletalMesh, Display, TEXT("  %-22s %10.2f ns/%s  (%lld %ss per iteration)"),
+			Name, NumElements > 0 ? IterationNs / NumElements : 0.0, ElementName, NumElements, ElementName);
+	}
+
+	/** A single section skinned to NumSectionBones bones, with indices in a random order like an optimized mesh */
+	void BuildSourceLOD(FSkeletalMeshLODRenderData& LODData, int32 NumVertices, FRandomStream& Random)
+	{
+		TArray<FVector> Positions;
+		Positions.Reserve(NumVertices);
+		for (int32 VertIdx = 0; VertIdx < NumVertices; VertIdx++)
+		{
+			Positions.Add(Random.GetUnitVector() * 100.0f);
+		}
+		LODData.StaticVertexBuffers.PositionVertexBuffer.Init(Positions, true);
+
+		FStaticMeshVertexBuffer& StaticMeshVertexBuffer = LODData.StaticVertexBuffers.StaticMeshVertexBuffer;
+		StaticMeshVertexBuffer.SetUseFullPrecisionUVs(true);
+		StaticMeshVertexBuffer.Init(NumVertices, FBenchmarkVertex::NumTexCoords, true);
+		for (int32 VertIdx = 0; VertIdx < NumVertices; VertIdx++)
+		{
+			StaticMeshVertexBuffer.SetVertexTangents(VertIdx, FVector::ForwardVector, FVector::RightVector, FVector::UpVector);
+			for (uint32 UVIndex = 0; UVIndex < FBenchmarkVertex::NumTexCoords; UVIndex++)
+			{
+				StaticMeshVertexBuffer.SetVertexUV(VertIdx, UVIndex, FVector2D(Random.GetFraction(), Random.GetFraction()));
+			}
+		}
+
+		// every influence is used, so the remap never skips one
+		TArray<FBenchmarkSkinWeight> Weights;
+		Weights.AddZeroed(NumVertices);
+		for (FBenchmarkSkinWeight& Weight : Weights)
+		{
+			for (int32 InfluenceIdx = 0; InfluenceIdx < MAX_INFLUENCES_PER_STREAM; InfluenceIdx++)
+			{
+				Weight.InfluenceBones[InfluenceIdx] = (uint8)Random.RandHelper(NumSectionBones);
+				Weight.InfluenceWeights[InfluenceIdx] = InfluenceIdx == 0 ? 255 - 3 * 16 : 16;
+			}
+		}
+		LODData.SkinWeightVertexBuffer.SetHasExtraBoneInfluences(false);
+		LODData.SkinWeightVertexBuffer.SetNeedsCPUAccess(true);
+		LODData.SkinWeightVertexBuffer = Weights;
+
+		TArray<uint32> Indices;
+		Indices.Reserve(NumVertices * 3);
+		for (int32 Idx = 0; Idx < NumVertices * 3; Idx++)
+		{
+			Indices.Add(Random.RandHelper(NumVertices));
+		}
+		const uint8 IndexSize = NumVertices <= MAX_uint16 ? sizeof(uint16) : sizeof(uint32);
+		LODData.MultiSizeIndexContainer.RebuildIndexBuffer(IndexSize, Indices);
+	}
+
+	void RunKernelBenchmark(const TArray<FString>& Args)
+	{
+		const int32 NumVertices = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 100000;
+		const int32 NumIterations = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 20;
+
+		FRandomStream Random(0x5eed);
+		FSkeletalMeshLODRenderData SrcLODData;
+		BuildSourceLOD(SrcLODData, NumVertices, Random);
+
+		const FTransform VerticesTransform(FRotator(0.0f, 90.0f, 0.0f), FVector(10.0f, 0.0f, 0.0f));
+		TArray<FTransform> UVTransforms;
+		UVTransforms.Add(FTransform(FRotator::ZeroRotator, FVector(0.5f, 0.25f, 0.0f), FVector(0.5f, 0.25f, 1.0f)));
+		UVTransforms.Add(FTransform(FRotator::ZeroRotator, FVector(0.0f, 0.5f, 0.0f), FVector(0.25f, 0.5f, 1.0f)));
+
+		// a permutation, so remapping the same weights every iteration keeps valid bone indices
+		TArray<FBoneIndexType> BoneMapToMergedBoneMap;
+		for (int32 BoneIdx = 0; BoneIdx < NumSectionBones; BoneIdx++)
+		{
+			BoneMapToMergedBoneMap.Add((FBoneIndexType)((BoneIdx * 37) % NumSectionBones));
+		}
+
+		TArray<FBenchmarkVertex> DestVertices;
+		DestVertices.SetNumUninitialized(NumVertices);
+		TArray<FBenchmarkSkinWeight> DestWeights;
+		DestWeights.SetNumUninitialized(NumVertices);
+
+		UE_LOG(LogSkeletalMesh, Display, TEXT("SkeletalMeshMerge.KernelBenchmark: %d vertices, %d iterations, median of the iterations"), NumVertices, NumIterations);
+
+		const double CopyVertexNs = MeasureKernel(NumIterations, [&]()
+		{
+			for (int32 VertIdx = 0; VertIdx < NumVertices; VertIdx++)
+			{
+				SkelMeshMergeKernels::CopyVertexFromSource<FBenchmarkVertex>(DestVertices[VertIdx], SrcLODData, VertIdx, VerticesTransform, UVTransforms);
+			}
+		});
+		LogKernel(TEXT("CopyVertexFromSource"), CopyVertexNs, NumVertices, TEXT("vertex"));
+
+		const double CopyWeightNs = MeasureKernel(NumIterations, [&]()
+		{
+			for (int32 VertIdx = 0; VertIdx < NumVertices; VertIdx++)
+			{
+				SkelMeshMergeKernels::CopyWeightFromSource<FBenchmarkSkinWeight, false>(DestWeights[VertIdx], SrcLODData, VertIdx);
+			}
+		});
+		LogKernel(TEXT("CopyWeightFromSource"), CopyWeightNs, NumVertices, TEXT("vertex"));
+
+		const double RemapBonesNs = MeasureKernel(NumIterations, [&]()
+		{
+			for (int32 VertIdx = 0; VertIdx < NumVertices; VertIdx++)
+			{
+				SkelMeshMergeKernels::RemapInfluenceBones(DestWeights[VertIdx], BoneMapToMergedBoneMap);
+			}
+		});
+		LogKernel(TEXT("RemapInfluenceBones"), RemapBonesNs, NumVertices, TEXT("vertex"));
+
+		// the merged index buffer keeps its allocation between iterations, as the pooled scratch buffers do
+		const FRawStaticIndexBuffer16or32Interface& SrcIndexBuffer = *SrcLODData.MultiSizeIndexContainer.GetIndexBuffer();
+		const int32 NumIndices = SrcIndexBuffer.Num();
+		TArray<uint32> MergedIndexBuffer;
+		MergedIndexBuffer.Reserve(NumIndices);
+		uint32 MaxIndex = 0;
+
+		const double SourceIndicesNs = MeasureKernel(NumIterations, [&]()
+		{
+			MergedIndexBuffer.Reset();
+			SkelMeshMergeKernels::AppendSourceIndices(SrcIndexBuffer, 0, NumIndices, 0, NumVertices, MergedIndexBuffer, MaxIndex);
+		});
+		LogKernel(TEXT("AppendSourceIndices"), SourceIndicesNs, NumIndices, TEXT("index"));
+
+		const TArray<uint32> SectionIndices(MergedIndexBuffer);
+		const double SectionIndicesNs = MeasureKernel(NumIterations, [&]()
+		{
+			MergedIndexBuffer.Reset();
+			SkelMeshMergeKernels::AppendSectionIndices(SectionIndices, NumVertices, MergedIndexBuffer, MaxIndex);
+		});
+		LogKernel(TEXT("AppendSectionIndices"), SectionIndicesNs, NumIndices, TEXT("index"));
+
+		// a section bone map half shared with the merged bone map, as for parts of the same skeleton
+		TArray<FBoneIndexType> MergedBoneMap;
+		TArray<FBoneIndexType> SectionBoneMap;
+		for (int32 BoneIdx = 0; BoneIdx < NumSectionBones; BoneIdx++)
+		{
+			MergedBoneMap.Add((FBoneIndexType)BoneIdx);
+			SectionBoneMap.Add((FBoneIndexType)(BoneIdx + NumSectionBones / 2));
+		}
+		const int32 NumBoneMapMerges = FMath::Max(NumVertices / NumSectionBones, 1);
+		TArray<FBoneIndexType> TempMergedBoneMap;
+		TArray<FBoneIndexType> TempBoneMapToMergedBoneMap;
+
+		const double MergeBoneMapNs = MeasureKernel(NumIterations, [&]()
+		{
+			for (int32 MergeIdx = 0; MergeIdx < NumBoneMapMerges; MergeIdx++)
+			{
+				TempMergedBoneMap = MergedBoneMap;
+				TempBoneMapToMergedBoneMap.Reset();
+				SkelMeshMergeKernels::MergeBoneMap(TempMergedBoneMap, TempBoneMapToMergedBoneMap, SectionBoneMap);
+			}
+		});
+		LogKernel(TEXT("MergeBoneMap"), MergeBoneMapNs, (int64)NumBoneMapMerges * NumSectionBones, TEXT("bone"));
+
+		// power of two tiles of mixed sizes, packed into the atlas size used by the merged material
+		TArray<FVector2D> TextureSizes;
+		for (int32 TextureIdx = 0; TextureIdx < NumAtlasTextures; TextureIdx++)
+		{
+			TextureSizes.Add(FVector2D(64 << Random.RandHelper(4), 64 << Random.RandHelper(4)));
+		}
+		const int32 NumPacks = FMath::Max(NumVertices / 1000, 1);
+		TArray<FBox2D> Boxes;
+
+		const double PackingNs = MeasureKernel(NumIterations, [&]()
+		{
+			for (int32 PackIdx = 0; PackIdx < NumPacks; PackIdx++)
+			{
+				SkelMeshMergeKernels::GeneratedBinnedTextureSquares(FVector2D(1024.0f, 1024.0f), TextureSizes, Boxes);
+			}
+		});
+		LogKernel(TEXT("BinnedTextureSquares"), PackingNs, (int64)NumPacks * NumAtlasTextures, TEXT("texture"));
+	}
+}
+
+static FAutoConsoleCommand KernelBenchmarkCommand(
+	TEXT("SkeletalMeshMerge.KernelBenchmark"),
+	TEXT("Times the inner loops of the mesh merge on generated buffers and prints the median cost per element.\n")
+	TEXT("Usage: SkeletalMeshMerge.KernelBenchmark [Vertices=100000] [Iterations=20]\n")
+	TEXT("No asset is loaded and no UObject is created, so the numbers only depend on the kernels."),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&RunKernelBenchmark));
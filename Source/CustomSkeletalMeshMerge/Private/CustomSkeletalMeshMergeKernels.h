@@ -0,0 +1,277 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+/*=============================================================================
+	CustomSkeletalMeshMergeKernels.h: Per element loops of the skeletal mesh merge.
+=============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RawIndexBuffer.h"
+#include "Rendering/SkeletalMeshLODRenderData.h"
+
+/**
+* The inner loops of the merge. They only work on render data buffers and plain arrays, so the kernel
+* benchmark runs them without any UObject.
+*/
+namespace SkelMeshMergeKernels
+{
+	/*
+	 * Copy Vertex Buffer from Source LOD Model
+	 */
+	template<typename VertexDataType>
+	FORCEINLINE void CopyVertexFromSource(VertexDataType& DestVert, const FSkeletalMeshLODRenderData& SrcLODData, int32 SourceVertIdx, const FTransform& VerticesTransform, const TArray<FTransform>& UVTransforms)
+	{
+		DestVert.Position = SrcLODData.StaticVertexBuffers.PositionVertexBuffer.VertexPosition(SourceVertIdx);
+		DestVert.Position = VerticesTransform.TransformFVector4(DestVert.Position);
+		DestVert.TangentX = SrcLODData.StaticVertexBuffers.StaticMeshVertexBuffer.VertexTangentX(SourceVertIdx);
+		DestVert.TangentZ = SrcLODData.StaticVertexBuffers.StaticMeshVertexBuffer.VertexTangentZ(SourceVertIdx);
+
+		// Copy all UVs that are available
+		uint32 LODNumTexCoords = SrcLODData.StaticVertexBuffers.StaticMeshVertexBuffer.GetNumTexCoords();
+		for (uint32 UVIndex = 0; UVIndex < LODNumTexCoords && UVIndex < VertexDataType::NumTexCoords; ++UVIndex)
+		{
+			FVector2D UVs = SrcLODData.StaticVertexBuffers.StaticMeshVertexBuffer.GetVertexUV_Typed<VertexDataType::StaticMeshVertexUVType>(SourceVertIdx, UVIndex);
+			if (UVIndex < (uint32)UVTransforms.Num())
+			{
+				FVector Transformed = UVTransforms[UVIndex].TransformPosition(FVector(UVs, 1.f));
+				UVs = FVector2D(Transformed.X, Transformed.Y);
+			}
+			DestVert.UVs[UVIndex] = UVs;
+		}
+	}
+
+	/** Copy skin weight info from source LOD model - templatized per SourceLODModel extra bone influence */
+	template<typename SkinWeightType, bool bHasExtraBoneInfluences>
+	FORCEINLINE void CopyWeightFromSource(SkinWeightType& DestWeight, const FSkeletalMeshLODRenderData& SrcLODData, int32 SourceVertIdx)
+	{
+		const TSkinWeightInfo<bHasExtraBoneInfluences>* SrcSkinWeights = SrcLODData.SkinWeightVertexBuffer.GetSkinWeightPtr<bHasExtraBoneInfluences>(SourceVertIdx);
+
+		// if source doesn't have extra influence, we have to clear the buffer
+		FMemory::Memzero(DestWeight.InfluenceBones);
+		FMemory::Memzero(DestWeight.InfluenceWeights);
+
+		FMemory::Memcpy(DestWeight.InfluenceBones, SrcSkinWeights->InfluenceBones, sizeof(SrcSkinWeights->InfluenceBones));
+		FMemory::Memcpy(DestWeight.InfluenceWeights, SrcSkinWeights->InfluenceWeights, sizeof(SrcSkinWeights->InfluenceWeights));
+	}
+
+	/** Remaps the bone indices used by a vertex from its source section bone map to the merged bone map */
+	template<typename SkinWeightType>
+	FORCEINLINE void RemapInfluenceBones(SkinWeightType& DestWeight, const TArray<FBoneIndexType>& BoneMapToMergedBoneMap)
+	{
+		for (int32 Idx = 0; Idx < SkinWeightType::NumInfluences; Idx++)
+		{
+			if (DestWeight.InfluenceWeights[Idx] > 0)
+			{
+				checkSlow(BoneMapToMergedBoneMap.IsValidIndex(DestWeight.InfluenceBones[Idx]));
+				DestWeight.InfluenceBones[Idx] = (uint8)BoneMapToMergedBoneMap[DestWeight.InfluenceBones[Idx]];
+			}
+		}
+	}
+
+	/**
+	 * Adds the indices of a source section to the merged index buffer, moved from the section's first source vertex
+	 * to its first merged vertex.
+	 * @param FirstIndex - first index of the section in the source index buffer
+	 * @param LastIndex - end of the section in the source index buffer
+	 */
+	inline void AppendSourceIndices(const FRawStaticIndexBuffer16or32Interface& SrcIndexBuffer, int32 FirstIndex, int32 LastIndex, uint32 SrcBaseVertexIndex, uint32 DestBaseVertexIndex, TArray<uint32>& MergedIndexBuffer, uint32& MaxIndex)
+	{
+		for (int32 IndexIdx = FirstIndex; IndexIdx < LastIndex; IndexIdx++)
+		{
+			uint32 SrcIndex = SrcIndexBuffer.Get(IndexIdx);
+
+			// add offset to each index to match the new entries in the merged vertex buffer
+			checkSlow(SrcIndex >= SrcBaseVertexIndex);
+			uint32 DstIndex = SrcIndex - SrcBaseVertexIndex + DestBaseVertexIndex;
+
+			// add the new index to the merged vertex buffer
+			MergedIndexBuffer.Add(DstIndex);
+			if (MaxIndex < DstIndex)
+			{
+				MaxIndex = DstIndex;
+			}
+		}
+	}
+
+	/** Adds section relative indices to the merged index buffer, offset to the section's first merged vertex. */
+	inline void AppendSectionIndices(const TArray<uint32>& SectionIndices, uint32 BaseVertexIndex, TArray<uint32>& MergedIndexBuffer, uint32& MaxIndex)
+	{
+		const int32 FirstIndex = MergedIndexBuffer.AddUninitialized(SectionIndices.Num());
+		uint32* DestIndices = MergedIndexBuffer.GetData() + FirstIndex;
+		for (int32 Idx = 0; Idx < SectionIndices.Num(); Idx++)
+		{
+			const uint32 DstIndex = SectionIndices[Idx] + BaseVertexIndex;
+			DestIndices[Idx] = DstIndex;
+			if (MaxIndex < DstIndex)
+			{
+				MaxIndex = DstIndex;
+			}
+		}
+	}
+
+	/**
+	* Merge a bonemap with an existing bonemap and keep track of remapping
+	* (a bonemap is a list of indices of bones in the USkeletalMesh::RefSkeleton array)
+	* @param MergedBoneMap - out merged bonemap
+	* @param BoneMapToMergedBoneMap - out of mapping from original bonemap to new merged bonemap
+	* @param BoneMap - input bonemap to merge
+	*/
+	inline void MergeBoneMap(TArray<FBoneIndexType>& MergedBoneMap, TArray<FBoneIndexType>& BoneMapToMergedBoneMap, const TArray<FBoneIndexType>& BoneMap)
+	{
+		BoneMapToMergedBoneMap.AddUninitialized(BoneMap.Num());
+		for (int32 IdxB = 0; IdxB < BoneMap.Num(); IdxB++)
+		{
+			BoneMapToMergedBoneMap[IdxB] = MergedBoneMap.AddUnique(BoneMap[IdxB]);
+		}
+	}
+
+	/**
+	 * Packs textures into an atlas of DestinationSize, larger textures first, shrinking all of them until they fit.
+	 * @param OutGeneratedBoxes - region of every texture in the atlas, in pixels
+	 */
+	inline void GeneratedBinnedTextureSquares(const FVector2D DestinationSize, TArray<FVector2D>& InTexureSize, TArray<FBox2D>& OutGeneratedBoxes)
+	{
+		typedef FBox2D FTextureArea;
+		struct FWeightedTexture
+		{
+			FTextureArea Area;
+			int32 TextureIndex;
+			float Weight;
+		};
+
+		TArray<FWeightedTexture> WeightedTextures;
+		const float TotalArea = DestinationSize.X * DestinationSize.Y;
+		// Generate textures with their size calculated according to their weight
+		for (int32 TextureIndex = 0; TextureIndex < InTexureSize.Num(); ++TextureIndex)
+		{
+			FWeightedTexture Texture;
+			const FVector2D& TextureSize = InTexureSize[TextureIndex];
+			Texture.Area = FTextureArea(FVector2D(0.0f, 0.0f), TextureSize);
+			Texture.TextureIndex = TextureIndex;
+			Texture.Weight = TextureSize.X / DestinationSize.X;
+			WeightedTextures.Add(Texture);
+		}
+
+		// Sort textures by their weight (high to low) which influences the insert order
+		WeightedTextures.Sort([](const FWeightedTexture& One, const FWeightedTexture& Two) { return One.Weight > Two.Weight; });
+
+		TArray<FWeightedTexture> InsertedTextures;
+		typedef FBox2D FUnusedArea;
+		TArray<FUnusedArea> UnusedAreas;
+
+		bool bSuccess = true;
+		do
+		{
+			// Reset state
+			bSuccess = true;
+			UnusedAreas.Empty();
+			InsertedTextures.Empty();
+			FUnusedArea StartArea(FVector2D(0, 0), DestinationSize);
+			UnusedAreas.Add(StartArea);
+
+			for (const FWeightedTexture& Texture : WeightedTextures)
+			{
+				int32 BestAreaIndex = -1;
+				float RemainingArea = FLT_MAX;
+				FVector2D TextureSize = Texture.Area.GetSize();
+				float TextureSurface = TextureSize.X * TextureSize.Y;
+
+				// Find best area to insert this texture in (determined by tightest fit)
+				for (int32 AreaIndex = 0; AreaIndex < UnusedAreas.Num(); ++AreaIndex)
+				{
+					const FUnusedArea& UnusedArea = UnusedAreas[AreaIndex];
+					if (UnusedArea.GetSize() >= TextureSize)
+					{
+						const float Remainder = UnusedArea.GetArea() - TextureSurface;
+						if (Remainder < RemainingArea && Remainder >= 0)
+						{
+							BestAreaIndex = AreaIndex;
+							RemainingArea = Remainder;
+						}
+					}
+				}
+
+				// Insert the texture in case we found an appropriate area
+				if (BestAreaIndex != -1)
+				{
+					FUnusedArea& UnusedArea = UnusedAreas[BestAreaIndex];
+					FVector2D UnusedSize = UnusedArea.GetSize();
+
+					// Push back texture
+					FWeightedTexture WeightedTexture;
+					WeightedTexture.Area = FTextureArea(UnusedArea.Min, UnusedArea.Min + TextureSize);
+					WeightedTexture.TextureIndex = Texture.TextureIndex;
+					InsertedTextures.Add(WeightedTexture);
+
+					// Generate two new resulting unused areas from splitting up the result
+					/*
+						___________
+						|	  |   |
+						|	  | V |
+						|_____|   |
+						|  H  |   |
+						|_____|___|
+					*/
+					FUnusedArea HorizontalArea, VerticalArea;
+					HorizontalArea.Min.X = UnusedArea.Min.X;
+					HorizontalArea.Min.Y = UnusedArea.Min.Y + TextureSize.Y;
+					HorizontalArea.Max.X = HorizontalArea.Min.X + TextureSize.X;
+					HorizontalArea.Max.Y = HorizontalArea.Min.Y + (UnusedSize.Y - TextureSize.Y);
+
+					VerticalArea.Min.X = UnusedArea.Min.X + TextureSize.X;
+					VerticalArea.Min.Y = UnusedArea.Min.Y;
+					VerticalArea.Max.X = VerticalArea.Min.X + (UnusedSize.X - TextureSize.X);
+					VerticalArea.Max.Y = UnusedSize.Y;
+
+					// Append valid new areas to list (replace original one with either one of the new ones)
+					const bool bValidHorizontal = HorizontalArea.GetArea() > 0.0f;
+					const bool bValidVertical = VerticalArea.GetArea() > 0.0f;
+					if (bValidVertical && bValidHorizontal)
+					{
+						UnusedAreas[BestAreaIndex] = HorizontalArea;
+						UnusedAreas.Add(VerticalArea);
+					}
+					else if (bValidVertical)
+					{
+						UnusedAreas[BestAreaIndex] = VerticalArea;
+					}
+					else if (bValidHorizontal)
+					{
+						UnusedAreas[BestAreaIndex] = HorizontalArea;
+					}
+					else
+					{
+						// Make sure we remove the area entry
+						UnusedAreas.RemoveAtSwap(BestAreaIndex);
+					}
+				}
+				else
+				{
+					bSuccess = false;
+					break;
+				}
+			}
+
+			// This means we failed to find a fit, in this case we resize the textures and try again until we find one
+			if (bSuccess == false)
+			{
+				for (FWeightedTexture& Texture : WeightedTextures)
+				{
+					Texture.Area.Max *= .99f;
+				}
+			}
+		} while (!bSuccess);
+
+		// Now generate boxes
+		OutGeneratedBoxes.Empty(InTexureSize.Num());
+		OutGeneratedBoxes.AddZeroed(InTexureSize.Num());
+
+		// Generate boxes according to the inserted textures
+		for (const FWeightedTexture& Texture : InsertedTextures)
+		{
+			FBox2D& Box = OutGeneratedBoxes[Texture.TextureIndex];
+			Box = Texture.Area;
+		}
+	}
+}
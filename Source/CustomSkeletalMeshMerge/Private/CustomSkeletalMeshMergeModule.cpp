@@ -1,6 +1,14 @@
 // Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
 
 #include "CustomSkeletalMeshMergeModule.h"
+#include "CustomSkeletalMeshMergeCache.h"
+#include "CustomSkeletalMeshMergeDiskCache.h"
+#include "CustomSkeletalMeshMergePartCache.h"
+#include "CustomSkeletalMeshMergePool.h"
+#include "CustomSkeletalMeshMergePrebake.h"
+#include "CustomSkeletalMeshMergeSharedCache.h"
+#include "CustomSkeletalMeshMergeStats.h"
+#include "Misc/CoreDelegates.h"
 
 #define LOCTEXT_NAMESPACE "FCustomSkeletalMeshMergeModule"
 
@@ -8,6 +16,9 @@ void FCustomSkeletalMeshMergeModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
 
+	RegisterSkeletalMeshMergeLLMTags();
+	FCustomSkeletalMeshMergeDiskCache::StartWarmup();
+	PostEngineInitHandle = FCoreDelegates::OnPostEngineInit.AddRaw(this, &FCustomSkeletalMeshMergeModule::OnPostEngineInit);
 }
 
 void FCustomSkeletalMeshMergeModule::ShutdownModule()
@@ -15,6 +26,22 @@ void FCustomSkeletalMeshMergeModule::ShutdownModule()
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
 
+	FCoreDelegates::OnPostEngineInit.Remove(PostEngineInitHandle);
+	FCustomSkeletalMeshMergeDiskCache::Shutdown();
+	FCustomSkeletalMeshMergeCache::Shutdown();
+	FCustomSkeletalMeshMergePartCache::Shutdown();
+	FCustomSkeletalMeshMergePool::Shutdown();
+	FCustomSkeletalMeshMergePrebake::Shutdown();
+	FCustomSkeletalMeshMergeSharedCache::Shutdown();
+}
+
+void FCustomSkeletalMeshMergeModule::OnPostEngineInit()
+{
+	// commandlets such as the prebake one rewrite the table instead of using it
+	if (!IsRunningCommandlet())
+	{
+		FCustomSkeletalMeshMergePrebake::WarmAtlasCache();
+	}
 }
 
 #undef LOCTEXT_NAMESPACE
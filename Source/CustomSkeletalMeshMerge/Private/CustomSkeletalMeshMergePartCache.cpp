@@ -0,0 +1,158 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+/*=============================================================================
+	CustomSkeletalMeshMergePartCache.cpp: Merge-ready data of source skeletal meshes.
+=============================================================================*/
+
+#include "CustomSkeletalMeshMergePartCache.h"
+#include "Engine/SkeletalMesh.h"
+#include "UObject/Package.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarMergePartCacheEnabled(
+	TEXT("SkeletalMeshMerge.PartCache"),
+	1,
+	TEXT("Determines whether source meshes are converted to the merged layout once and reused by later merges.\n")
+	TEXT("0: Read the source buffers on every merge\n")
+	TEXT("1: Keep merge-ready data per source mesh"),
+	ECVF_Default);
+
+static FAutoConsoleCommand FlushPartCacheCommand(
+	TEXT("SkeletalMeshMerge.FlushPartCache"),
+	TEXT("Drops the merge-ready data kept for source meshes."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		FCustomSkeletalMeshMergePartCache::Get().Empty();
+	}));
+
+FCustomSkeletalMeshMergePartCache* FCustomSkeletalMeshMergePartCache::Instance = nullptr;
+
+SIZE_T FSkelMeshMergeReadyRecord::GetAllocatedSize() const
+{
+	FScopeLock ScopeLock(&Lock);
+
+	SIZE_T Size = ComponentSpaceRefPose.GetAllocatedSize() + Sections.GetAllocatedSize() + BoneMaps.GetAllocatedSize();
+	for (const TPair<TTuple<int32, int32, uint32>, FSkelMeshMergeReadySectionPtr>& Pair : Sections)
+	{
+		Size += sizeof(FSkelMeshMergeReadySection) + Pair.Value->GetAllocatedSize();
+	}
+	for (const TPair<uint64, FSkelMeshMergeReadyBoneMapPtr>& Pair : BoneMaps)
+	{
+		Size += sizeof(FSkelMeshMergeReadyBoneMap) + Pair.Value->GetAllocatedSize();
+	}
+	return Size;
+}
+
+FCustomSkeletalMeshMergePartCache& FCustomSkeletalMeshMergePartCache::Get()
+{
+	if (!Instance)
+	{
+		Instance = new FCustomSkeletalMeshMergePartCache();
+	}
+	return *Instance;
+}
+
+void FCustomSkeletalMeshMergePartCache::Shutdown()
+{
+	delete Instance;
+	Instance = nullptr;
+}
+
+bool FCustomSkeletalMeshMergePartCache::IsEnabled()
+{
+	return CVarMergePartCacheEnabled.GetValueOnAnyThread() != 0;
+}
+
+FCustomSkeletalMeshMergePartCache::FRecordKey FCustomSkeletalMeshMergePartCache::MakeRecordKey(const USkeletalMesh* SkelMesh)
+{
+	return FRecordKey(SkelMesh->GetOutermost()->GetGuid(), SkelMesh->GetFName());
+}
+
+FSkelMeshMergeReadyRecordPtr FCustomSkeletalMeshMergePartCache::FindRecord(const USkeletalMesh* SkelMesh)
+{
+	FScopeLock ScopeLock(&Lock);
+
+	const FRecordKey Key = MakeRecordKey(SkelMesh);
+	FRecordEntry* Entry = Records.Find(Key);
+	if (!Entry)
+	{
+		return nullptr;
+	}
+
+	// a cooked package holds the same data for as long as its GUID is unchanged; editor reimports and
+	// transient meshes change their data under the same GUID, their records are only valid for their render data
+	const UPackage* Package = SkelMesh->GetOutermost();
+	const bool bMutablePackage = GIsEditor || !Package->GetGuid().IsValid() || Package == GetTransientPackage();
+	if (bMutablePackage && Entry->Record->GetRenderData() != const_cast<USkeletalMesh*>(SkelMesh)->GetResourceForRendering())
+	{
+		Records.Remove(Key);
+		return nullptr;
+	}
+
+	Entry->LastUsed = FPlatformTime::Cycles64();
+	return Entry->Record;
+}
+
+void FCustomSkeletalMeshMergePartCache::AddRecord(const USkeletalMesh* SkelMesh, const FSkelMeshMergeReadyRecordPtr& Record)
+{
+	FScopeLock ScopeLock(&Lock);
+
+	FRecordEntry& Entry = Records.Add(MakeRecordKey(SkelMesh));
+	Entry.Record = Record;
+	Entry.LastUsed = FPlatformTime::Cycles64();
+}
+
+bool FCustomSkeletalMeshMergePartCache::EvictLeastRecentlyUsed(uint64 UsedBefore, SIZE_T& OutFreedBytes)
+{
+	FScopeLock ScopeLock(&Lock);
+
+	const FRecordKey* EvictKey = nullptr;
+	uint64 OldestUse = UsedBefore;
+	for (const TPair<FRecordKey, FRecordEntry>& Pair : Records)
+	{
+		if (Pair.Value.LastUsed < OldestUse)
+		{
+			EvictKey = &Pair.Key;
+			OldestUse = Pair.Value.LastUsed;
+		}
+	}
+
+	if (!EvictKey)
+	{
+		OutFreedBytes = 0;
+		return false;
+	}
+
+	// merges still using the record keep it alive until they are done
+	const FRecordKey Key = *EvictKey;
+	OutFreedBytes = sizeof(FSkelMeshMergeReadyRecord) + Records[Key].Record->GetAllocatedSize();
+	Records.Remove(Key);
+	return true;
+}
+
+SIZE_T FCustomSkeletalMeshMergePartCache::GetAllocatedSize() const
+{
+	int32 NumRecords = 0;
+	SIZE_T Bytes = 0;
+	GetStats(NumRecords, Bytes);
+	return Bytes;
+}
+
+void FCustomSkeletalMeshMergePartCache::Empty()
+{
+	FScopeLock ScopeLock(&Lock);
+
+	Records.Empty();
+}
+
+void FCustomSkeletalMeshMergePartCache::GetStats(int32& OutNumRecords, SIZE_T& OutBytes) const
+{
+	FScopeLock ScopeLock(&Lock);
+
+	OutNumRecords = Records.Num();
+	OutBytes = Records.GetAllocatedSize();
+	for (const TPair<FRecordKey, FRecordEntry>& Pair : Records)
+	{
+		OutBytes += sizeof(FSkelMeshMergeReadyRecord) + Pair.Value.Record->GetAllocatedSize();
+	}
+}
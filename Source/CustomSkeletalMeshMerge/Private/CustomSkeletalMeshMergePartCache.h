@@ -0,0 +1,229 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+/*=============================================================================
+	CustomSkeletalMeshMergePartCache.h: Merge-ready data of source skeletal meshes.
+=============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/Guid.h"
+#include "Templates/SharedPointer.h"
+#include "Misc/ScopeLock.h"
+
+class USkeletalMesh;
+class FSkeletalMeshRenderData;
+
+/**
+* Streams of one source section converted to a merged vertex layout, before any
+* merge specific vertex transform, UV transform or bone remapping is applied.
+*/
+struct FSkelMeshMergeReadySection
+{
+	/** Vertex and skin weight layout the streams were converted to */
+	uint32 VertexLayout;
+
+	/** Number of UV channels of the source LOD */
+	uint32 NumTexCoords;
+
+	/** Whether the source skin weights use extra bone influences */
+	bool bExtraBoneInfluence;
+
+	/** Source vertices in the merged vertex type; their UVs are taken from 'UVs' */
+	TArray<uint8> Vertices;
+
+	/**
+	 * Source UVs at full precision, the UV channels the merged vertex type keeps for each vertex.
+	 * The atlas transform is applied before they are narrowed to the merged UV type, as it is without the cache.
+	 */
+	TArray<FVector2D> UVs;
+
+	/** Source skin weights in the merged skin weight type, indexing the section bone map */
+	TArray<uint8> SkinWeights;
+
+	/** Source vertex colors; may be shorter than the vertex count */
+	TArray<FColor> Colors;
+
+	/** Indices relative to the first vertex of the section */
+	TArray<uint32> Indices;
+
+	FSkelMeshMergeReadySection()
+		: VertexLayout(0)
+		, NumTexCoords(0)
+		, bExtraBoneInfluence(false)
+	{}
+
+	SIZE_T GetAllocatedSize() const
+	{
+		return Vertices.GetAllocatedSize() + UVs.GetAllocatedSize() + SkinWeights.GetAllocatedSize() + Colors.GetAllocatedSize() + Indices.GetAllocatedSize();
+	}
+};
+
+/**
+* Mapping of a source mesh's bones to the bones of one merged reference skeleton.
+*/
+struct FSkelMeshMergeReadyBoneMap
+{
+	/** Mapping from RefSkeleton bone index in source mesh to output bone index */
+	TArray<int32> SrcToDestRefSkeletonMap;
+
+	/** Section bone maps converted to output bone indices, per [LOD][Section] */
+	TArray<TArray<TArray<FBoneIndexType>>> DestChunkBoneMaps;
+
+	SIZE_T GetAllocatedSize() const
+	{
+		SIZE_T Size = SrcToDestRefSkeletonMap.GetAllocatedSize() + DestChunkBoneMaps.GetAllocatedSize();
+		for (const TArray<TArray<FBoneIndexType>>& LODBoneMaps : DestChunkBoneMaps)
+		{
+			Size += LODBoneMaps.GetAllocatedSize();
+			for (const TArray<FBoneIndexType>& BoneMap : LODBoneMaps)
+			{
+				Size += BoneMap.GetAllocatedSize();
+			}
+		}
+		return Size;
+	}
+};
+
+typedef TSharedPtr<const FSkelMeshMergeReadySection, ESPMode::ThreadSafe> FSkelMeshMergeReadySectionPtr;
+typedef TSharedPtr<const FSkelMeshMergeReadyBoneMap, ESPMode::ThreadSafe> FSkelMeshMergeReadyBoneMapPtr;
+
+/**
+* Merge-ready data of one source mesh. Built lazily by the merges that use the mesh,
+* so that later merges only have to concatenate the streams and fix up offsets.
+*/
+class FSkelMeshMergeReadyRecord
+{
+public:
+	FSkelMeshMergeReadyRecord(const FSkeletalMeshRenderData* InRenderData, TArray<FTransform>&& InComponentSpaceRefPose)
+		: RenderData(InRenderData)
+		, ComponentSpaceRefPose(MoveTemp(InComponentSpaceRefPose))
+	{}
+
+	/** @return Render data the record was built from. */
+	const FSkeletalMeshRenderData* GetRenderData() const { return RenderData; }
+
+	/** @return Component space reference pose of the mesh. */
+	const TArray<FTransform>& GetComponentSpaceRefPose() const { return ComponentSpaceRefPose; }
+
+	/** @return The converted section, or nullptr if it was not built for this layout yet. */
+	FSkelMeshMergeReadySectionPtr FindSection(int32 LODIdx, int32 SectionIdx, uint32 VertexLayout) const
+	{
+		FScopeLock ScopeLock(&Lock);
+		return Sections.FindRef(MakeTuple(LODIdx, SectionIdx, VertexLayout));
+	}
+
+	/** Stores a converted section; if another merge stored it first, that one is kept and returned. */
+	FSkelMeshMergeReadySectionPtr AddSection(int32 LODIdx, int32 SectionIdx, uint32 VertexLayout, const FSkelMeshMergeReadySectionPtr& Section)
+	{
+		FScopeLock ScopeLock(&Lock);
+		const TTuple<int32, int32, uint32> Key(LODIdx, SectionIdx, VertexLayout);
+		if (const FSkelMeshMergeReadySectionPtr* Existing = Sections.Find(Key))
+		{
+			return *Existing;
+		}
+		Sections.Add(Key, Section);
+		return Section;
+	}
+
+	/** @return The bone mapping for a merged skeleton signature, or nullptr if it was not built yet. */
+	FSkelMeshMergeReadyBoneMapPtr FindBoneMap(uint64 SkeletonSignature) const
+	{
+		FScopeLock ScopeLock(&Lock);
+		return BoneMaps.FindRef(SkeletonSignature);
+	}
+
+	/** Stores the bone mapping for a merged skeleton signature; an existing mapping is kept and returned. */
+	FSkelMeshMergeReadyBoneMapPtr AddBoneMap(uint64 SkeletonSignature, const FSkelMeshMergeReadyBoneMapPtr& BoneMap)
+	{
+		FScopeLock ScopeLock(&Lock);
+		if (const FSkelMeshMergeReadyBoneMapPtr* Existing = BoneMaps.Find(SkeletonSignature))
+		{
+			return *Existing;
+		}
+		BoneMaps.Add(SkeletonSignature, BoneMap);
+		return BoneMap;
+	}
+
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	const FSkeletalMeshRenderData* RenderData;
+
+	TArray<FTransform> ComponentSpaceRefPose;
+
+	/** Guards the lazily filled maps, records are shared by merges on any thread */
+	mutable FCriticalSection Lock;
+
+	/** Converted sections keyed by (source LOD, section, vertex layout) */
+	TMap<TTuple<int32, int32, uint32>, FSkelMeshMergeReadySectionPtr> Sections;
+
+	/** Bone mappings keyed by merged skeleton and attach bone signature */
+	TMap<uint64, FSkelMeshMergeReadyBoneMapPtr> BoneMaps;
+};
+
+typedef TSharedPtr<FSkelMeshMergeReadyRecord, ESPMode::ThreadSafe> FSkelMeshMergeReadyRecordPtr;
+
+/**
+* Keeps a merge-ready record for every source mesh used by a merge, keyed on the source package GUID so that
+* records outlive their mesh and are picked up again when it is reloaded. Records share the memory budget of the
+* merge cache, which evicts them least recently used first.
+*/
+class FCustomSkeletalMeshMergePartCache
+{
+public:
+	static FCustomSkeletalMeshMergePartCache& Get();
+
+	/** Destroys the cache, dropping every record. */
+	static void Shutdown();
+
+	/** @return Whether source meshes should be converted once and reused by later merges. */
+	static bool IsEnabled();
+
+	/** @return The record of the mesh, or nullptr if there is none or it was built from older data. */
+	FSkelMeshMergeReadyRecordPtr FindRecord(const USkeletalMesh* SkelMesh);
+
+	/** Stores a new record for the mesh, replacing an older one. */
+	void AddRecord(const USkeletalMesh* SkelMesh, const FSkelMeshMergeReadyRecordPtr& Record);
+
+	/**
+	 * Drops the least recently used record if it was last used before a point in time.
+	 * @param UsedBefore - FPlatformTime::Cycles64() value the record must be older than
+	 * @param OutFreedBytes - memory held by the dropped record
+	 * @return 'true' if a record was dropped.
+	 */
+	bool EvictLeastRecentlyUsed(uint64 UsedBefore, SIZE_T& OutFreedBytes);
+
+	/** @return Memory held by every record. */
+	SIZE_T GetAllocatedSize() const;
+
+	/** Drops every record. */
+	void Empty();
+
+	/** Gets the number of records and the memory they hold. */
+	void GetStats(int32& OutNumRecords, SIZE_T& OutBytes) const;
+
+private:
+	/** Source package GUID and mesh name */
+	typedef TTuple<FGuid, FName> FRecordKey;
+
+	struct FRecordEntry
+	{
+		FSkelMeshMergeReadyRecordPtr Record;
+
+		/** FPlatformTime::Cycles64() value when the record was last found or added */
+		uint64 LastUsed;
+
+		FRecordEntry()
+			: LastUsed(0)
+		{}
+	};
+
+	static FRecordKey MakeRecordKey(const USkeletalMesh* SkelMesh);
+
+	mutable FCriticalSection Lock;
+
+	TMap<FRecordKey, FRecordEntry> Records;
+
+	static FCustomSkeletalMeshMergePartCache* Instance;
+};
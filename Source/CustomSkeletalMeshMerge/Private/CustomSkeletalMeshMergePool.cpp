@@ -0,0 +1,99 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+/*=============================================================================
+	CustomSkeletalMeshMergePool.cpp: Recycling of merged meshes and merge scratch buffers.
+=============================================================================*/
+
+#include "CustomSkeletalMeshMergePool.h"
+#include "CustomSkeletalMeshMergeJob.h"
+#include "Engine/SkeletalMesh.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarMergePoolSize(
+	TEXT("SkeletalMeshMerge.PoolSize"),
+	8,
+	TEXT("Number of unused merged meshes kept for reuse by later merges,\n")
+	TEXT("and of intermediate merge buffers kept per element type. 0 disables pooling."),
+	ECVF_Default);
+
+FCustomSkeletalMeshMergePool* FCustomSkeletalMeshMergePool::Instance = nullptr;
+
+FCustomSkeletalMeshMergePool& FCustomSkeletalMeshMergePool::Get()
+{
+	if (!Instance)
+	{
+		Instance = new FCustomSkeletalMeshMergePool();
+	}
+	return *Instance;
+}
+
+void FCustomSkeletalMeshMergePool::Shutdown()
+{
+	delete Instance;
+	Instance = nullptr;
+}
+
+int32 FCustomSkeletalMeshMergePool::GetMaxPoolSize()
+{
+	return FMath::Max(CVarMergePoolSize.GetValueOnAnyThread(), 0);
+}
+
+USkeletalMesh* FCustomSkeletalMeshMergePool::Acquire()
+{
+	check(IsInGameThread());
+
+	// forget meshes that were collected without being handed back
+	for (auto It = IssuedMeshes.CreateIterator(); It; ++It)
+	{
+		if (!It->IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	USkeletalMesh* Mesh = PooledMeshes.Num() > 0 ? PooledMeshes.Pop(false) : nullptr;
+	if (Mesh)
+	{
+		// the merge rebuilds skeleton, sockets, LODs and materials; only the skeleton asset is set by the caller
+		Mesh->Skeleton = nullptr;
+	}
+	else
+	{
+		Mesh = NewObject<USkeletalMesh>();
+	}
+
+	IssuedMeshes.Add(Mesh);
+	return Mesh;
+}
+
+bool FCustomSkeletalMeshMergePool::Release(USkeletalMesh* MergedMesh)
+{
+	check(IsInGameThread());
+
+	if (!MergedMesh || IssuedMeshes.Remove(MergedMesh) == 0)
+	{
+		return false;
+	}
+
+	// free the GPU buffers now, the LOD render data stays with the mesh and is refilled by the next merge into it
+	MergedMesh->ReleaseResources();
+
+	// the next merge into the mesh must not splice into the sections of this one
+	FSkelMeshMergeJob::RemoveIncrementalState(MergedMesh);
+
+	if (PooledMeshes.Num() < GetMaxPoolSize())
+	{
+		PooledMeshes.Add(MergedMesh);
+	}
+	return true;
+}
+
+void FCustomSkeletalMeshMergePool::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	Collector.AddReferencedObjects(PooledMeshes);
+}
+
+FString FCustomSkeletalMeshMergePool::GetReferencerName() const
+{
+	return TEXT("FCustomSkeletalMeshMergePool");
+}
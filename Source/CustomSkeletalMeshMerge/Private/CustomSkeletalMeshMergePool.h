@@ -0,0 +1,116 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+/*=============================================================================
+	CustomSkeletalMeshMergePool.h: Recycling of merged meshes and merge scratch buffers.
+=============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtr.h"
+#include "UObject/GCObject.h"
+#include "Misc/ScopeLock.h"
+#include "CustomSkeletalMeshMergeStats.h"
+
+class USkeletalMesh;
+
+/**
+* Keeps merged meshes that are no longer used so later merges can be written into them
+* instead of creating new objects, and recycles the intermediate buffers of GenerateLODModel.
+*/
+class FCustomSkeletalMeshMergePool : public FGCObject
+{
+public:
+	static FCustomSkeletalMeshMergePool& Get();
+
+	/** Destroys the pool, letting the pooled meshes be collected. */
+	static void Shutdown();
+
+	/** @return Maximum number of pooled meshes, and of pooled scratch buffers per element type. */
+	static int32 GetMaxPoolSize();
+
+	/**
+	 * Returns an unused merged mesh from the pool, or a new one if the pool is empty.
+	 * The mesh is tracked so it can be handed back with Release().
+	 */
+	USkeletalMesh* Acquire();
+
+	/**
+	 * Hands back a mesh returned by Acquire() that is no longer used. Its render resources are released
+	 * and it is kept for reuse if the pool has room.
+	 * @return 'true' if the mesh came from Acquire().
+	 */
+	bool Release(USkeletalMesh* MergedMesh);
+
+	/** @return Whether the mesh was returned by Acquire() and not handed back yet. */
+	bool IsIssued(USkeletalMesh* MergedMesh) const { return IssuedMeshes.Contains(MergedMesh); }
+
+	/** @return Number of meshes waiting in the pool. */
+	int32 GetNumPooledMeshes() const { return PooledMeshes.Num(); }
+
+	/**
+	 * Returns an empty array, reusing the allocation of a previously released one when there is.
+	 * @param MinCapacity - number of elements the array should have room for
+	 */
+	template<typename ElementType>
+	static TArray<ElementType> AcquireScratch(int32 MinCapacity)
+	{
+		SKELETALMESHMERGE_LLM_SCOPE(Scratch);
+
+		TArray<ElementType> Scratch;
+		{
+			TScratchList<ElementType>& List = GetScratchList<ElementType>();
+			FScopeLock ScopeLock(&List.Lock);
+			if (List.Arrays.Num() > 0)
+			{
+				Scratch = List.Arrays.Pop(false);
+				DEC_MEMORY_STAT_BY(STAT_SkeletalMeshMerge_PooledMemory, Scratch.GetAllocatedSize());
+			}
+		}
+		Scratch.Reserve(MinCapacity);
+		return Scratch;
+	}
+
+	/** Returns an array from AcquireScratch(), keeping its allocation for the next merge if the pool has room. */
+	template<typename ElementType>
+	static void ReleaseScratch(TArray<ElementType>&& Scratch)
+	{
+		Scratch.Reset();
+
+		TScratchList<ElementType>& List = GetScratchList<ElementType>();
+		FScopeLock ScopeLock(&List.Lock);
+		if (List.Arrays.Num() < GetMaxPoolSize())
+		{
+			INC_MEMORY_STAT_BY(STAT_SkeletalMeshMerge_PooledMemory, Scratch.GetAllocatedSize());
+			List.Arrays.Add(MoveTemp(Scratch));
+		}
+	}
+
+	//~ Begin FGCObject Interface
+	virtual void AddReferencedObjects(FReferenceCollector& Collector) override;
+	virtual FString GetReferencerName() const override;
+	//~ End FGCObject Interface
+
+private:
+	template<typename ElementType>
+	struct TScratchList
+	{
+		FCriticalSection Lock;
+		TArray<TArray<ElementType>> Arrays;
+	};
+
+	template<typename ElementType>
+	static TScratchList<ElementType>& GetScratchList()
+	{
+		static TScratchList<ElementType> List;
+		return List;
+	}
+
+	/** Unused meshes ready to be merged into */
+	TArray<USkeletalMesh*> PooledMeshes;
+
+	/** Meshes handed out by Acquire() */
+	TSet<TWeakObjectPtr<USkeletalMesh>> IssuedMeshes;
+
+	static FCustomSkeletalMeshMergePool* Instance;
+};
@@ -0,0 +1,171 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+/*=============================================================================
+	CustomSkeletalMeshMergePrebake.cpp: Merges baked at cook time.
+=============================================================================*/
+
+#include "CustomSkeletalMeshMergePrebake.h"
+#include "CustomSkeletalMeshMerge.h"
+#include "CustomSkeletalMeshMergeCache.h"
+#include "CustomSkeletalMeshMergeDiskCache.h"
+#include "CustomSkeletalMeshMergeRequest.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/Texture.h"
+#include "HAL/IConsoleManager.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "Misc/PackageName.h"
+#include "UObject/StrongObjectPtr.h"
+
+static TAutoConsoleVariable<FString> CVarMergePrebakeTable(
+	TEXT("SkeletalMeshMerge.PrebakeTable"),
+	TEXT("/Game/MergePrebake/MergePrebakeTable"),
+	TEXT("Package of the table written by the CustomSkeletalMeshMergePrebake commandlet.\n")
+	TEXT("Merges found in it are loaded instead of merged. Empty disables the lookup."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarMergePrebakeAtlasWarmup(
+	TEXT("SkeletalMeshMerge.PrebakeAtlasWarmup"),
+	64,
+	TEXT("Number of baked atlas materials registered with the merge cache after engine init,\n")
+	TEXT("so merges of the same source materials do not composite their atlas. 0 disables it."),
+	ECVF_Default);
+
+const TCHAR* const FCustomSkeletalMeshMergePrebake::DefaultOutputPath = TEXT("/Game/MergePrebake");
+const TCHAR* const FCustomSkeletalMeshMergePrebake::TableName = TEXT("MergePrebakeTable");
+
+namespace
+{
+	/** Loaded table and the package it was loaded from */
+	TStrongObjectPtr<UCustomSkeletalMeshMergePrebakeTable> LoadedTable;
+	FString LoadedTablePath;
+}
+
+void UCustomSkeletalMeshMergePrebakedMesh::Serialize(FArchive& Ar)
+{
+	Super::Serialize(Ar);
+
+	Ar << MergedData;
+}
+
+UCustomSkeletalMeshMergePrebakeTable* FCustomSkeletalMeshMergePrebake::GetTable()
+{
+	check(IsInGameThread());
+
+	const FString TablePath = CVarMergePrebakeTable.GetValueOnGameThread();
+	if (TablePath != LoadedTablePath)
+	{
+		LoadedTablePath = TablePath;
+		LoadedTable.Reset();
+
+		// the table only exists once the commandlet ran, do not warn about it missing
+		if (!TablePath.IsEmpty() && FPackageName::DoesPackageExist(TablePath))
+		{
+			const FString ObjectPath = TablePath + TEXT(".") + FPackageName::GetShortName(TablePath);
+			LoadedTable.Reset(LoadObject<UCustomSkeletalMeshMergePrebakeTable>(nullptr, *ObjectPath));
+		}
+	}
+
+	return LoadedTable.Get();
+}
+
+UCustomSkeletalMeshMergePrebakedMesh* FCustomSkeletalMeshMergePrebake::FindPrebakedMesh(const FSHAHash& Key)
+{
+	UCustomSkeletalMeshMergePrebakeTable* Table = GetTable();
+	const TSoftObjectPtr<UCustomSkeletalMeshMergePrebakedMesh>* Entry = Table ? Table->Entries.Find(Key.ToString()) : nullptr;
+
+	return Entry ? Entry->LoadSynchronous() : nullptr;
+}
+
+void FCustomSkeletalMeshMergePrebake::WarmAtlasCache()
+{
+	check(IsInGameThread());
+
+	const int32 MaxAtlases = CVarMergePrebakeAtlasWarmup.GetValueOnGameThread();
+	UCustomSkeletalMeshMergePrebakeTable* Table = MaxAtlases > 0 && FCustomSkeletalMeshMergeCache::IsEnabled() ? GetTable() : nullptr;
+	if (!Table)
+	{
+		return;
+	}
+
+	FCustomSkeletalMeshMergeCache& MergeCache = FCustomSkeletalMeshMergeCache::Get();
+	int32 NumAtlases = 0;
+	for (const TPair<FString, TSoftObjectPtr<UCustomSkeletalMeshMergePrebakedMesh>>& Entry : Table->Entries)
+	{
+		if (NumAtlases >= MaxAtlases)
+		{
+			break;
+		}
+
+		// entries baked before the atlas key was recorded can not be matched with runtime merges
+		UCustomSkeletalMeshMergePrebakedMesh* Prebaked = Entry.Value.LoadSynchronous();
+		if (!Prebaked || !Prebaked->Material || Prebaked->AtlasKey.IsEmpty())
+		{
+			continue;
+		}
+
+		// combinations of the same source materials share one atlas
+		FSHAHash AtlasKey;
+		AtlasKey.FromString(Prebaked->AtlasKey);
+		if (MergeCache.FindAtlas(AtlasKey))
+		{
+			continue;
+		}
+
+		// the baked atlas textures are assets, only their GPU memory counts towards the cache budget
+		TArray<UTexture*> AtlasTextures;
+		Prebaked->Material->GetUsedTextures(AtlasTextures, EMaterialQualityLevel::Num, true, GMaxRHIFeatureLevel, true);
+		SIZE_T GPUBytes = 0;
+		for (UTexture* Texture : AtlasTextures)
+		{
+			if (Texture)
+			{
+				GPUBytes += Texture->CalcTextureMemorySizeEnum(TMC_AllMips);
+			}
+		}
+
+		UMaterialInstanceDynamic* AtlasMaterial = UMaterialInstanceDynamic::Create(Prebaked->Material, nullptr);
+		MergeCache.AddAtlas(AtlasKey, AtlasMaterial, 0, GPUBytes);
+		NumAtlases++;
+	}
+
+	UE_LOG(LogSkeletalMesh, Log, TEXT("Registered %d baked atlases with the merge cache."), NumAtlases);
+}
+
+void FCustomSkeletalMeshMergePrebake::Shutdown()
+{
+	LoadedTable.Reset();
+	LoadedTablePath.Empty();
+}
+
+#if WITH_EDITOR
+bool FCustomSkeletalMeshMergePrebake::Bake(const FCustomSkeletalMeshMergeParams& Params, FSHAHash& OutKey, TArray<uint8>& OutMergedData, FCustomSkeletalMeshMergeAtlasLayout& OutAtlasLayout)
+{
+	const FSkelMeshMergeRequest Request(Params);
+	if (Request.Parts.Num() <= 1)
+	{
+		return false;
+	}
+	OutKey = Request.ComputeKey(Params);
+
+	// Only provides the skeleton asset to the merge, the prepared data is never committed to it
+	USkeletalMesh* BakeMesh = NewObject<USkeletalMesh>();
+	if (Params.Skeleton && Params.bSkeletonBefore)
+	{
+		BakeMesh->Skeleton = Params.Skeleton;
+	}
+
+	FCustomSkeletalMeshMerge Merger(BakeMesh, Params.BaseMaterial, Request.Parts, Request.SectionMappings, Params.StripTopLODS, Request.MeshBufferAccess);
+	Merger.SetCompositeAtlas(false);
+	Merger.MergeMaterial();
+	Merger.PrepareSkeleton();
+	if (!Merger.PrepareMesh())
+	{
+		return false;
+	}
+	Merger.GetAtlasLayout(OutAtlasLayout);
+	OutAtlasLayout.Key = FCustomSkeletalMeshMergeCache::ComputeAtlasKey(OutAtlasLayout.BaseMaterial, OutAtlasLayout.Materials);
+
+	// The source guids let the runtime reject baked data of parts saved since the bake
+	return FCustomSkeletalMeshMergeDiskCache::SaveToMemory(Merger.GetPreparedData(), Merger.GetSourceGuids(), OutMergedData);
+}
+#endif
@@ -0,0 +1,38 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+/*=============================================================================
+	CustomSkeletalMeshMergeRequest.h: Native form of a Blueprint merge request.
+=============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/SecureHash.h"
+#include "CustomSkeletalMeshMerge.h"
+
+struct FCustomSkeletalMeshMergeParams;
+
+/**
+* Merge parts, section mappings and buffer access of FCustomSkeletalMeshMergeParams,
+* as passed to FCustomSkeletalMeshMerge.
+*/
+struct FSkelMeshMergeRequest
+{
+	/** Parts with a valid mesh, in request order */
+	TArray<FSkelMeshMergePart> Parts;
+
+	TArray<FSkelMeshMergeSectionMapping> SectionMappings;
+
+	EMeshBufferAccess MeshBufferAccess;
+
+	explicit FSkelMeshMergeRequest(const FCustomSkeletalMeshMergeParams& Params);
+
+	/** @return Native params of the request, viewing its parts and section mappings. */
+	FCustomSkeletalMeshMergeNativeParams ToNativeParams(const FCustomSkeletalMeshMergeParams& Params) const;
+
+	/** @return Content key of the request, identical for every request producing the same merge. */
+	FSHAHash ComputeKey(const FCustomSkeletalMeshMergeParams& Params) const;
+
+	/** @return Content key of native params, identical to the key of the matching Blueprint request. */
+	static FSHAHash ComputeKey(const FCustomSkeletalMeshMergeNativeParams& Params);
+};
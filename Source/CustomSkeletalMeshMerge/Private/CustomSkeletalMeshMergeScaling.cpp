@@ -0,0 +1,158 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+/*=============================================================================
+	CustomSkeletalMeshMergeScaling.cpp: Merge cost of generated parts of a given size.
+=============================================================================*/
+
+#include "CustomSkeletalMeshMergeScaling.h"
+#include "CustomSkeletalMeshMerge.h"
+#include "CustomSkeletalMeshMergePool.h"
+#include "CustomSkeletalMeshMergeTestParts.h"
+#include "Animation/Skeleton.h"
+#include "Engine/SkeletalMesh.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformMemory.h"
+#include "Materials/Material.h"
+#include "UObject/Package.h"
+
+namespace
+{
+	/** Bones of a generated section, kept under the GPU skinning limit of every feature level */
+	const int32 MaxBonesPerSection = 64;
+
+	float GetMedian(TArray<float>& Samples)
+	{
+		if (Samples.Num() == 0)
+		{
+			return 0.0f;
+		}
+		Samples.Sort();
+		return Samples[Samples.Num() / 2];
+	}
+
+	/**
+	 * Physical memory the process reached during a stage that started with the given process peak.
+	 * The process peak cannot be reset, so when the stage did not raise it the memory the stage left in use is taken.
+	 */
+	int64 GetStagePeakUsedPhysical(uint64 PeakUsedPhysicalBefore)
+	{
+		const FPlatformMemoryStats Stats = FPlatformMemory::GetStats();
+		return (int64)(Stats.PeakUsedPhysical > PeakUsedPhysicalBefore ? Stats.PeakUsedPhysical : Stats.UsedPhysical);
+	}
+}
+
+bool FCustomSkeletalMeshMergeScaling::Measure(const FCustomSkeletalMeshMergeScalingConfig& Config, int32 NumIterations, FCustomSkeletalMeshMergeScalingResult& OutResult)
+{
+	check(IsInGameThread());
+	OutResult = FCustomSkeletalMeshMergeScalingResult();
+
+	// the process peak is set by whichever configuration ran before, so memory is measured from here
+	const int64 UsedPhysicalBefore = (int64)FPlatformMemory::GetStats().UsedPhysical;
+	int64 StagePeakUsedPhysical[4] = { UsedPhysicalBefore, UsedPhysicalBefore, UsedPhysicalBefore, UsedPhysicalBefore };
+
+	// the chain carries every bone but the root, sections split it so their bone maps stay small
+	FSkelMeshMergeTestPartDesc PartDesc = {};
+	PartDesc.Name = TEXT("Part");
+	PartDesc.NumChainBones = FMath::Max(Config.NumBones - 1, 1);
+	PartDesc.NumSections = FMath::DivideAndRoundUp(PartDesc.NumChainBones, MaxBonesPerSection);
+	PartDesc.NumTexCoords = 1;
+	PartDesc.NumQuads = FMath::Max(Config.NumVerticesPerPart / 4, PartDesc.NumSections);
+	PartDesc.NumLODs = FMath::Max(Config.NumLODs, 1);
+
+	USkeleton* Skeleton = NewObject<USkeleton>(GetTransientPackage(), NAME_None, RF_Transient);
+	UMaterialInterface* BaseMaterial = UMaterial::GetDefaultMaterial(MD_Surface);
+
+	TArray<FSkelMeshMergePart> MergeParts;
+	for (int32 PartIdx = 0; PartIdx < FMath::Max(Config.NumParts, 2); PartIdx++)
+	{
+		FSkelMeshMergePart& MergePart = MergeParts[MergeParts.AddDefaulted()];
+		MergePart.SkeletalMesh = BuildSkelMeshMergeTestPart(PartDesc, Skeleton, BaseMaterial, PartIdx * 100.0f);
+		MergePart.AttachedBoneName = NAME_None;
+		MergePart.VerticesTransform = FTransform::Identity;
+	}
+
+	IConsoleVariable* PartCacheVariable = IConsoleManager::Get().FindConsoleVariable(TEXT("SkeletalMeshMerge.PartCache"));
+	check(PartCacheVariable);
+	const int32 SavedPartCache = PartCacheVariable->GetInt();
+	PartCacheVariable->Set(0, ECVF_SetByCode);
+
+	TArray<float> StageSamples[5];
+	FCustomSkeletalMeshMergePool& MergePool = FCustomSkeletalMeshMergePool::Get();
+	const TArray<FSkelMeshMergeSectionMapping> NoSectionMappings;
+	bool bSucceeded = true;
+
+	for (int32 Iteration = 0; Iteration < FMath::Max(NumIterations, 1) && bSucceeded; Iteration++)
+	{
+		USkeletalMesh* MergeMesh = MergePool.Acquire();
+		MergeMesh->Skeleton = Skeleton;
+
+		FCustomSkeletalMeshMergeReport Report;
+		FCustomSkeletalMeshMerge Merger(MergeMesh, BaseMaterial, MergeParts, NoSectionMappings, 0);
+		Merger.SetCompositeAtlas(false);
+		Merger.SetReport(&Report);
+		Merger.RecycleRenderData();
+
+		uint64 PeakUsedPhysicalBefore = FPlatformMemory::GetStats().PeakUsedPhysical;
+		Merger.MergeMaterial();
+		StagePeakUsedPhysical[0] = FMath::Max(StagePeakUsedPhysical[0], GetStagePeakUsedPhysical(PeakUsedPhysicalBefore));
+
+		PeakUsedPhysicalBefore = FPlatformMemory::GetStats().PeakUsedPhysical;
+		Merger.PrepareSkeleton();
+		StagePeakUsedPhysical[1] = FMath::Max(StagePeakUsedPhysical[1], GetStagePeakUsedPhysical(PeakUsedPhysicalBefore));
+
+		PeakUsedPhysicalBefore = FPlatformMemory::GetStats().PeakUsedPhysical;
+		bSucceeded = Merger.PrepareMesh();
+		StagePeakUsedPhysical[2] = FMath::Max(StagePeakUsedPhysical[2], GetStagePeakUsedPhysical(PeakUsedPhysicalBefore));
+
+		if (bSucceeded)
+		{
+			if (Iteration == 0)
+			{
+				for (const FSkeletalMeshLODRenderData& LODData : Merger.GetPreparedData().LODRenderData)
+				{
+					OutResult.NumMergedVertices += LODData.StaticVertexBuffers.PositionVertexBuffer.GetNumVertices();
+					OutResult.NumMergedSections += LODData.RenderSections.Num();
+				}
+			}
+
+			PeakUsedPhysicalBefore = FPlatformMemory::GetStats().PeakUsedPhysical;
+			const double CommitStartTime = FPlatformTime::Seconds();
+			Merger.CommitSkeleton();
+			Merger.CommitMesh();
+			Report.CommitMs = (FPlatformTime::Seconds() - CommitStartTime) * 1000.0;
+			StagePeakUsedPhysical[3] = FMath::Max(StagePeakUsedPhysical[3], GetStagePeakUsedPhysical(PeakUsedPhysicalBefore));
+
+			SIZE_T MergedCPUBytes = 0;
+			SIZE_T MergedGPUBytes = 0;
+			Merger.GetMergedMeshSize(MergedCPUBytes, MergedGPUBytes);
+			OutResult.MergedCPUBytes = MergedCPUBytes;
+			OutResult.MergedGPUBytes = MergedGPUBytes;
+			OutResult.PeakIntermediateBytes = FMath::Max(OutResult.PeakIntermediateBytes, Report.PeakIntermediateBytes);
+			OutResult.NumReallocations = FMath::Max(OutResult.NumReallocations, Report.NumReallocations);
+
+			StageSamples[0].Add(Report.MergeMaterialMs);
+			StageSamples[1].Add(Report.MergeSkeletonMs);
+			StageSamples[2].Add(Report.MergeMeshMs);
+			StageSamples[3].Add(Report.CommitMs);
+			StageSamples[4].Add(Report.MergeMaterialMs + Report.MergeSkeletonMs + Report.MergeMeshMs + Report.CommitMs);
+		}
+
+		MergePool.Release(MergeMesh);
+	}
+
+	PartCacheVariable->Set(SavedPartCache, ECVF_SetByCode);
+
+	OutResult.MergeMaterialMs = GetMedian(StageSamples[0]);
+	OutResult.MergeSkeletonMs = GetMedian(StageSamples[1]);
+	OutResult.MergeMeshMs = GetMedian(StageSamples[2]);
+	OutResult.CommitMs = GetMedian(StageSamples[3]);
+	OutResult.TotalMs = GetMedian(StageSamples[4]);
+	OutResult.MergeMaterialPeakBytes = StagePeakUsedPhysical[0] - UsedPhysicalBefore;
+	OutResult.MergeSkeletonPeakBytes = StagePeakUsedPhysical[1] - UsedPhysicalBefore;
+	OutResult.MergeMeshPeakBytes = StagePeakUsedPhysical[2] - UsedPhysicalBefore;
+	OutResult.CommitPeakBytes = StagePeakUsedPhysical[3] - UsedPhysicalBefore;
+	OutResult.PeakUsedPhysicalDelta = FMath::Max(FMath::Max(OutResult.MergeMaterialPeakBytes, OutResult.MergeSkeletonPeakBytes),
+		FMath::Max(OutResult.MergeMeshPeakBytes, OutResult.CommitPeakBytes));
+
+	return bSucceeded;
+}
@@ -0,0 +1,303 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+/*=============================================================================
+	CustomSkeletalMeshMergeSharedCache.cpp: Merged data shared by the processes of one host.
+=============================================================================*/
+
+#include "CustomSkeletalMeshMergeSharedCache.h"
+#include "Engine/SkeletalMesh.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/App.h"
+#include "Misc/CoreMisc.h"
+
+static TAutoConsoleVariable<int32> CVarMergeSharedCache(
+	TEXT("SkeletalMeshMerge.SharedCache"),
+	-1,
+	TEXT("Determines whether merged data is shared with the other processes of the host through shared memory.\n")
+	TEXT("-1: Dedicated servers only\n")
+	TEXT(" 0: Turned Off\n")
+	TEXT(" 1: Turned On"),
+	ECVF_ReadOnly);
+
+static TAutoConsoleVariable<int32> CVarMergeSharedCacheSizeMB(
+	TEXT("SkeletalMeshMerge.SharedCacheSizeMB"),
+	256,
+	TEXT("Size of the shared memory region holding merged data, in megabytes. Every process of the host must use the same size."),
+	ECVF_ReadOnly);
+
+static TAutoConsoleVariable<int32> CVarMergeSharedCacheLockTimeoutMs(
+	TEXT("SkeletalMeshMerge.SharedCacheLockTimeoutMs"),
+	100,
+	TEXT("Milliseconds a process waits for the interprocess lock of the shared cache before it gives up publishing."),
+	ECVF_Default);
+
+FCustomSkeletalMeshMergeSharedCache* FCustomSkeletalMeshMergeSharedCache::Instance = nullptr;
+
+namespace
+{
+	const uint32 SharedCacheMagic = 0x53534D4D; // 'MMSS'
+	const uint32 SharedCacheVersion = 1;
+	const uint64 SharedEntryAlignment = 16;
+
+	/** Start of the region */
+	struct FSharedCacheHeader
+	{
+		uint32 Magic;
+		uint32 Version;
+
+		/** Number of published entries, written last by an insertion */
+		volatile int32 NumEntries;
+		uint32 Padding;
+
+		/** Bytes used by the header and the published entries */
+		uint64 UsedBytes;
+	};
+
+	/** Precedes the blob of every entry */
+	struct FSharedCacheEntry
+	{
+		uint8 Key[20];
+		uint32 Padding;
+		uint64 DataSize;
+	};
+
+	FSharedCacheHeader* GetHeader(FPlatformMemory::FSharedMemoryRegion* Region)
+	{
+		return static_cast<FSharedCacheHeader*>(Region->GetAddress());
+	}
+
+	uint64 GetEntrySize(uint64 DataSize)
+	{
+		return Align(sizeof(FSharedCacheEntry) + DataSize, SharedEntryAlignment);
+	}
+
+	/** Region and lock names are scoped to the project so unrelated games on the host do not share */
+	FString GetSharedName(const TCHAR* Suffix)
+	{
+		return FString::Printf(TEXT("SkeletalMeshMerge_%s_%u_%s"), FApp::GetProjectName(), SharedCacheVersion, Suffix);
+	}
+}
+
+FCustomSkeletalMeshMergeSharedCache& FCustomSkeletalMeshMergeSharedCache::Get()
+{
+	if (!Instance)
+	{
+		Instance = new FCustomSkeletalMeshMergeSharedCache();
+	}
+	return *Instance;
+}
+
+void FCustomSkeletalMeshMergeSharedCache::Shutdown()
+{
+	delete Instance;
+	Instance = nullptr;
+}
+
+bool FCustomSkeletalMeshMergeSharedCache::IsEnabled()
+{
+	const int32 Mode = CVarMergeSharedCache.GetValueOnAnyThread();
+	return Mode > 0 || (Mode < 0 && IsRunningDedicatedServer());
+}
+
+FCustomSkeletalMeshMergeSharedCache::FCustomSkeletalMeshMergeSharedCache()
+	: Region(nullptr)
+	, InterprocessLock(nullptr)
+	, bCreatedLock(false)
+	, NumIndexedEntries(0)
+	, NextEntryOffset(Align(sizeof(FSharedCacheHeader), SharedEntryAlignment))
+	, bReportedFull(false)
+	, bReportedLockTimeout(false)
+{
+	const SIZE_T RegionSize = (SIZE_T)FMath::Max(CVarMergeSharedCacheSizeMB.GetValueOnAnyThread(), 1) * 1024 * 1024;
+
+	// Opens the lock of a process that already runs, or creates it. Only the creator removes the name
+	// on exit, so a process leaving early does not pull the lock from under the ones still running.
+	const FString LockName = GetSharedName(TEXT("Lock"));
+	InterprocessLock = FPlatformProcess::NewInterprocessSynchObject(LockName, false);
+	if (!InterprocessLock)
+	{
+		InterprocessLock = FPlatformProcess::NewInterprocessSynchObject(LockName, true);
+		bCreatedLock = InterprocessLock != nullptr;
+	}
+	if (!InterprocessLock)
+	{
+		UE_LOG(LogSkeletalMesh, Warning, TEXT("FCustomSkeletalMeshMergeSharedCache: Could not create the interprocess lock, merged data is not shared"));
+		return;
+	}
+
+	// Same for the region, which is created zero filled. Unmapping a region removes its name only
+	// in the process that created it.
+	const FString RegionName = GetSharedName(TEXT("Data"));
+	const uint32 RegionAccess = FPlatformMemory::ESharedMemoryAccess::Read | FPlatformMemory::ESharedMemoryAccess::Write;
+	Region = FPlatformMemory::MapNamedSharedMemoryRegion(RegionName, false, RegionAccess, RegionSize);
+	if (!Region)
+	{
+		Region = FPlatformMemory::MapNamedSharedMemoryRegion(RegionName, true, RegionAccess, RegionSize);
+	}
+	if (!Region || Region->GetSize() < RegionSize)
+	{
+		UE_LOG(LogSkeletalMesh, Warning, TEXT("FCustomSkeletalMeshMergeSharedCache: Could not map %llu bytes of shared memory, merged data is not shared"), (uint64)RegionSize);
+		if (Region)
+		{
+			FPlatformMemory::UnmapNamedSharedMemoryRegion(Region);
+			Region = nullptr;
+		}
+		return;
+	}
+
+	if (!TryLockInterprocess())
+	{
+		FPlatformMemory::UnmapNamedSharedMemoryRegion(Region);
+		Region = nullptr;
+		return;
+	}
+	FSharedCacheHeader* Header = GetHeader(Region);
+	if (Header->Magic != SharedCacheMagic || Header->Version != SharedCacheVersion)
+	{
+		Header->Version = SharedCacheVersion;
+		Header->NumEntries = 0;
+		Header->UsedBytes = NextEntryOffset;
+		FPlatformMisc::MemoryBarrier();
+		Header->Magic = SharedCacheMagic;
+	}
+	InterprocessLock->Unlock();
+}
+
+FCustomSkeletalMeshMergeSharedCache::~FCustomSkeletalMeshMergeSharedCache()
+{
+	if (Region)
+	{
+		FPlatformMemory::UnmapNamedSharedMemoryRegion(Region);
+	}
+	if (InterprocessLock)
+	{
+		if (bCreatedLock)
+		{
+			FPlatformProcess::DeleteInterprocessSynchObject(InterprocessLock);
+		}
+		else
+		{
+			// closes the handle, leaving the name to the process that created it
+			delete InterprocessLock;
+		}
+	}
+}
+
+bool FCustomSkeletalMeshMergeSharedCache::TryLockInterprocess()
+{
+	const uint64 TimeoutNs = (uint64)FMath::Max(CVarMergeSharedCacheLockTimeoutMs.GetValueOnAnyThread(), 0) * 1000000;
+	if (InterprocessLock->TryLock(TimeoutNs))
+	{
+		return true;
+	}
+
+	if (!bReportedLockTimeout)
+	{
+		UE_LOG(LogSkeletalMesh, Warning, TEXT("FCustomSkeletalMeshMergeSharedCache: Timed out waiting for the interprocess lock, merged data is not published"));
+		bReportedLockTimeout = true;
+	}
+	return false;
+}
+
+void FCustomSkeletalMeshMergeSharedCache::UpdateIndex()
+{
+	const FSharedCacheHeader* Header = GetHeader(Region);
+	const int32 NumEntries = FPlatformAtomics::AtomicRead(&Header->NumEntries);
+	FPlatformMisc::MemoryBarrier();
+
+	const uint8* RegionData = static_cast<const uint8*>(Region->GetAddress());
+	for (; NumIndexedEntries < NumEntries; NumIndexedEntries++)
+	{
+		const FSharedCacheEntry* Entry = reinterpret_cast<const FSharedCacheEntry*>(RegionData + NextEntryOffset);
+
+		FSHAHash Key;
+		FMemory::Memcpy(Key.Hash, Entry->Key, sizeof(Key.Hash));
+		Index.Add(Key, TPair<uint64, uint64>(NextEntryOffset + sizeof(FSharedCacheEntry), Entry->DataSize));
+
+		NextEntryOffset += GetEntrySize(Entry->DataSize);
+	}
+}
+
+bool FCustomSkeletalMeshMergeSharedCache::Find(const FSHAHash& Key, const uint8*& OutData, int64& OutDataSize)
+{
+	if (!Region)
+	{
+		return false;
+	}
+
+	FScopeLock ScopeLock(&Lock);
+	UpdateIndex();
+
+	const TPair<uint64, uint64>* Location = Index.Find(Key);
+	if (!Location)
+	{
+		return false;
+	}
+
+	OutData = static_cast<const uint8*>(Region->GetAddress()) + Location->Key;
+	OutDataSize = (int64)Location->Value;
+	return true;
+}
+
+void FCustomSkeletalMeshMergeSharedCache::Add(const FSHAHash& Key, const uint8* Data, int64 DataSize)
+{
+	if (!Region || DataSize <= 0)
+	{
+		return;
+	}
+
+	FScopeLock ScopeLock(&Lock);
+	if (!TryLockInterprocess())
+	{
+		return;
+	}
+
+	// Pick up what other processes published while we were merging
+	UpdateIndex();
+
+	FSharedCacheHeader* Header = GetHeader(Region);
+	const uint64 EntrySize = GetEntrySize(DataSize);
+
+	if (!Index.Contains(Key))
+	{
+		if (Header->UsedBytes + EntrySize <= Region->GetSize())
+		{
+			uint8* EntryData = static_cast<uint8*>(Region->GetAddress()) + Header->UsedBytes;
+			FSharedCacheEntry* Entry = reinterpret_cast<FSharedCacheEntry*>(EntryData);
+			FMemory::Memcpy(Entry->Key, Key.Hash, sizeof(Entry->Key));
+			Entry->Padding = 0;
+			Entry->DataSize = (uint64)DataSize;
+			FMemory::Memcpy(EntryData + sizeof(FSharedCacheEntry), Data, DataSize);
+			Header->UsedBytes += EntrySize;
+
+			// Readers only look at published entries, so the entry must be complete before the count moves
+			FPlatformMisc::MemoryBarrier();
+			FPlatformAtomics::InterlockedIncrement(&Header->NumEntries);
+
+			UpdateIndex();
+		}
+		else if (!bReportedFull)
+		{
+			UE_LOG(LogSkeletalMesh, Warning, TEXT("FCustomSkeletalMeshMergeSharedCache: Region is full, raise SkeletalMeshMerge.SharedCacheSizeMB on every process"));
+			bReportedFull = true;
+		}
+	}
+
+	InterprocessLock->Unlock();
+}
+
+void FCustomSkeletalMeshMergeSharedCache::GetStats(int32& OutNumEntries, SIZE_T& OutUsedBytes, SIZE_T& OutRegionBytes)
+{
+	OutNumEntries = 0;
+	OutUsedBytes = 0;
+	OutRegionBytes = 0;
+
+	if (Region)
+	{
+		const FSharedCacheHeader* Header = GetHeader(Region);
+		OutNumEntries = FPlatformAtomics::AtomicRead(&Header->NumEntries);
+		OutUsedBytes = Header->UsedBytes;
+		OutRegionBytes = Region->GetSize();
+	}
+}
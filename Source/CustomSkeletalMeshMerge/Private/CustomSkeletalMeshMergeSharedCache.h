@@ -0,0 +1,89 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+/*=============================================================================
+	CustomSkeletalMeshMergeSharedCache.h: Merged data shared by the processes of one host.
+=============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/SecureHash.h"
+#include "Misc/ScopeLock.h"
+#include "HAL/PlatformMemory.h"
+
+class FSemaphore;
+
+/**
+* Keeps merged data blobs in a named shared memory region, so every process of the host that
+* merges the same parts (e.g. several dedicated servers) reads a single copy instead of merging
+* or loading it again. Entries are append only: insertions are serialized by an interprocess lock,
+* lookups are lock free and only read entries that were published.
+*/
+class FCustomSkeletalMeshMergeSharedCache
+{
+public:
+	static FCustomSkeletalMeshMergeSharedCache& Get();
+
+	/**
+	 * Unmaps the region; entries stay available to the other processes that still map it.
+	 * Only the process that created the region and lock removes their names.
+	 */
+	static void Shutdown();
+
+	/** @return Whether merged data should be shared through the host region in this process. */
+	static bool IsEnabled();
+
+	/**
+	 * Finds the blob of a merge content key.
+	 * @param OutData - set to the blob inside the shared region, valid until Shutdown()
+	 * @return 'true' if another process, or this one, published the blob.
+	 */
+	bool Find(const FSHAHash& Key, const uint8*& OutData, int64& OutDataSize);
+
+	/**
+	 * Publishes a blob for the other processes. Does nothing if the key is already present,
+	 * the region is full or the interprocess lock could not be taken in time.
+	 */
+	void Add(const FSHAHash& Key, const uint8* Data, int64 DataSize);
+
+	/** Gets the number of published entries and the bytes of the region they use. */
+	void GetStats(int32& OutNumEntries, SIZE_T& OutUsedBytes, SIZE_T& OutRegionBytes);
+
+private:
+	FCustomSkeletalMeshMergeSharedCache();
+	~FCustomSkeletalMeshMergeSharedCache();
+
+	/** Indexes the entries published since the last call */
+	void UpdateIndex();
+
+	/**
+	 * Takes the interprocess lock, giving up after SkeletalMeshMerge.SharedCacheLockTimeoutMs
+	 * so a process that died holding it does not stall the others.
+	 * @return 'true' if the lock was taken.
+	 */
+	bool TryLockInterprocess();
+
+	/** Mapped region, nullptr if it could not be created */
+	FPlatformMemory::FSharedMemoryRegion* Region;
+
+	/** Serializes insertions across processes */
+	FSemaphore* InterprocessLock;
+
+	/** Whether this process created the lock, rather than opening the lock of a process already running */
+	bool bCreatedLock;
+
+	/** Guards the index of this process */
+	FCriticalSection Lock;
+
+	/** Offset of each indexed entry's blob in the region */
+	TMap<FSHAHash, TPair<uint64, uint64>> Index;
+
+	/** Number of entries in Index, and region offset of the next entry to index */
+	int32 NumIndexedEntries;
+	uint64 NextEntryOffset;
+
+	bool bReportedFull;
+	bool bReportedLockTimeout;
+
+	static FCustomSkeletalMeshMergeSharedCache* Instance;
+};
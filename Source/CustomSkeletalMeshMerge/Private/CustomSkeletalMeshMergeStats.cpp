@@ -0,0 +1,66 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+/*=============================================================================
+	CustomSkeletalMeshMergeStats.cpp: Stats of the skeletal mesh merge pipeline.
+=============================================================================*/
+
+#include "CustomSkeletalMeshMergeStats.h"
+#include "HAL/LowLevelMemStats.h"
+
+DEFINE_STAT(STAT_SkeletalMeshMerge_MergeMaterial);
+DEFINE_STAT(STAT_SkeletalMeshMerge_AtlasPacking);
+DEFINE_STAT(STAT_SkeletalMeshMerge_StreamingWait);
+DEFINE_STAT(STAT_SkeletalMeshMerge_Compositing);
+DEFINE_STAT(STAT_SkeletalMeshMerge_MergeSkeleton);
+DEFINE_STAT(STAT_SkeletalMeshMerge_BoneRemap);
+DEFINE_STAT(STAT_SkeletalMeshMerge_GenerateNewSectionArray);
+DEFINE_STAT(STAT_SkeletalMeshMerge_GenerateLODModel);
+DEFINE_STAT(STAT_SkeletalMeshMerge_Vertices);
+DEFINE_STAT(STAT_SkeletalMeshMerge_Indices);
+DEFINE_STAT(STAT_SkeletalMeshMerge_SkinWeights);
+DEFINE_STAT(STAT_SkeletalMeshMerge_DuplicatedVertices);
+DEFINE_STAT(STAT_SkeletalMeshMerge_InitResources);
+
+DEFINE_STAT(STAT_SkeletalMeshMerge_IntermediateMemory);
+DEFINE_STAT(STAT_SkeletalMeshMerge_PooledMemory);
+
+DEFINE_STAT(STAT_SkeletalMeshMerge_NumVertices);
+DEFINE_STAT(STAT_SkeletalMeshMerge_NumIndices);
+DEFINE_STAT(STAT_SkeletalMeshMerge_NumSections);
+DEFINE_STAT(STAT_SkeletalMeshMerge_NumBones);
+DEFINE_STAT(STAT_SkeletalMeshMerge_NumAtlasTiles);
+
+CSV_DEFINE_CATEGORY(SkeletalMeshMerge, true);
+
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+DECLARE_LLM_MEMORY_STAT(TEXT("SkeletalMeshMerge"), STAT_SkeletalMeshMergeLLM_Summary, STATGROUP_LLM);
+DECLARE_LLM_MEMORY_STAT(TEXT("SkeletalMeshMerge Scratch"), STAT_SkeletalMeshMergeLLM_Scratch, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("SkeletalMeshMerge Geometry"), STAT_SkeletalMeshMergeLLM_Geometry, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("SkeletalMeshMerge Atlas"), STAT_SkeletalMeshMergeLLM_Atlas, STATGROUP_LLMFULL);
+#endif
+
+void RegisterSkeletalMeshMergeLLMTags()
+{
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+	FLowLevelMemTracker& MemTracker = FLowLevelMemTracker::Get();
+	const FName SummaryStatName = GET_STATFNAME(STAT_SkeletalMeshMergeLLM_Summary);
+	MemTracker.RegisterProjectTag((int32)ESkeletalMeshMergeLLMTag::Scratch, TEXT("SkeletalMeshMerge Scratch"), GET_STATFNAME(STAT_SkeletalMeshMergeLLM_Scratch), SummaryStatName);
+	MemTracker.RegisterProjectTag((int32)ESkeletalMeshMergeLLMTag::Geometry, TEXT("SkeletalMeshMerge Geometry"), GET_STATFNAME(STAT_SkeletalMeshMergeLLM_Geometry), SummaryStatName);
+	MemTracker.RegisterProjectTag((int32)ESkeletalMeshMergeLLMTag::Atlas, TEXT("SkeletalMeshMerge Atlas"), GET_STATFNAME(STAT_SkeletalMeshMergeLLM_Atlas), SummaryStatName);
+#endif
+}
+
+void RecordSkeletalMeshMergeCsvTime(double StartTime)
+{
+#if CSV_PROFILER
+	const float StageMs = (float)((FPlatformTime::Seconds() - StartTime) * 1000.0);
+	if (IsInGameThread())
+	{
+		CSV_CUSTOM_STAT(SkeletalMeshMerge, GameThreadMs, StageMs, ECsvCustomStatOp::Accumulate);
+	}
+	else
+	{
+		CSV_CUSTOM_STAT(SkeletalMeshMerge, WorkerMs, StageMs, ECsvCustomStatOp::Accumulate);
+	}
+#endif
+}
@@ -0,0 +1,93 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+/*=============================================================================
+	CustomSkeletalMeshMergeStats.h: Stats of the skeletal mesh merge pipeline.
+=============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Runtime/Launch/Resources/Version.h"
+#include "HAL/LowLevelMemTracker.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+DECLARE_STATS_GROUP(TEXT("SkeletalMeshMerge"), STATGROUP_SkeletalMeshMerge, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("MergeMaterial"), STAT_SkeletalMeshMerge_MergeMaterial, STATGROUP_SkeletalMeshMerge, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("MergeMaterial Packing"), STAT_SkeletalMeshMerge_AtlasPacking, STATGROUP_SkeletalMeshMerge, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("MergeMaterial Streaming Wait"), STAT_SkeletalMeshMerge_StreamingWait, STATGROUP_SkeletalMeshMerge, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("MergeMaterial Compositing"), STAT_SkeletalMeshMerge_Compositing, STATGROUP_SkeletalMeshMerge, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("MergeSkeleton"), STAT_SkeletalMeshMerge_MergeSkeleton, STATGROUP_SkeletalMeshMerge, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("FinalizeMesh Bone Remap"), STAT_SkeletalMeshMerge_BoneRemap, STATGROUP_SkeletalMeshMerge, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("GenerateNewSectionArray"), STAT_SkeletalMeshMerge_GenerateNewSectionArray, STATGROUP_SkeletalMeshMerge, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("GenerateLODModel"), STAT_SkeletalMeshMerge_GenerateLODModel, STATGROUP_SkeletalMeshMerge, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("GenerateLODModel Vertices"), STAT_SkeletalMeshMerge_Vertices, STATGROUP_SkeletalMeshMerge, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("GenerateLODModel Indices"), STAT_SkeletalMeshMerge_Indices, STATGROUP_SkeletalMeshMerge, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("GenerateLODModel Skin Weights"), STAT_SkeletalMeshMerge_SkinWeights, STATGROUP_SkeletalMeshMerge, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("GenerateLODModel Duplicated Vertices"), STAT_SkeletalMeshMerge_DuplicatedVertices, STATGROUP_SkeletalMeshMerge, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("InitResources"), STAT_SkeletalMeshMerge_InitResources, STATGROUP_SkeletalMeshMerge, );
+
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Intermediate Buffers"), STAT_SkeletalMeshMerge_IntermediateMemory, STATGROUP_SkeletalMeshMerge, );
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Pooled Intermediate Buffers"), STAT_SkeletalMeshMerge_PooledMemory, STATGROUP_SkeletalMeshMerge, );
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Merged Vertices"), STAT_SkeletalMeshMerge_NumVertices, STATGROUP_SkeletalMeshMerge, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Merged Indices"), STAT_SkeletalMeshMerge_NumIndices, STATGROUP_SkeletalMeshMerge, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Merged Sections"), STAT_SkeletalMeshMerge_NumSections, STATGROUP_SkeletalMeshMerge, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Merged Bones"), STAT_SkeletalMeshMerge_NumBones, STATGROUP_SkeletalMeshMerge, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Atlas Tiles"), STAT_SkeletalMeshMerge_NumAtlasTiles, STATGROUP_SkeletalMeshMerge, );
+
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+
+/** First of the project LLM tags used by the merge; a project that already uses these tags can move them. */
+#ifndef SKELETALMESHMERGE_LLM_TAG_BASE
+#define SKELETALMESHMERGE_LLM_TAG_BASE ((int32)ELLMTag::ProjectTagStart + 90)
+#endif
+
+enum class ESkeletalMeshMergeLLMTag : int32
+{
+	/** Intermediate buffers of a merge */
+	Scratch = SKELETALMESHMERGE_LLM_TAG_BASE,
+	/** Render data of merged meshes */
+	Geometry,
+	/** Composited atlas textures */
+	Atlas,
+};
+
+#define SKELETALMESHMERGE_LLM_SCOPE(Tag) LLM_SCOPE((ELLMTag)ESkeletalMeshMergeLLMTag::Tag)
+
+#else
+
+#define SKELETALMESHMERGE_LLM_SCOPE(Tag)
+
+#endif
+
+/** Registers the LLM tags of the merge, so memory reports show them by name. */
+void RegisterSkeletalMeshMergeLLMTags();
+
+/**
+* Timeline scopes of the merge pipeline. Engines with the trace CPU profiler show them in Unreal Insights
+* on the thread that ran the merge, older ones emit named events for external profilers.
+*/
+#if ENGINE_MAJOR_VERSION > 4 || ENGINE_MINOR_VERSION >= 25
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#define SKELETALMESHMERGE_TRACE_SCOPE(Name) TRACE_CPUPROFILER_EVENT_SCOPE(Name)
+#else
+#define SKELETALMESHMERGE_TRACE_SCOPE(Name) SCOPED_NAMED_EVENT(Name, FColor::Turquoise)
+#endif
+
+/** Trace counters only exist from 4.26, the stat counters above cover older engines. */
+#define SKELETALMESHMERGE_WITH_TRACE_COUNTERS (ENGINE_MAJOR_VERSION > 4 || ENGINE_MINOR_VERSION >= 26)
+#if SKELETALMESHMERGE_WITH_TRACE_COUNTERS
+#include "ProfilingDebugging/CountersTrace.h"
+#endif
+
+/**
+* Per frame merge load for CSV captures, in the SkeletalMeshMerge category: merges committed, stage time
+* on the game thread and on workers, the wait of queued merges for a worker, texture streaming waits and the
+* bytes of merged meshes and atlases.
+*/
+CSV_DECLARE_CATEGORY_EXTERN(SkeletalMeshMerge);
+
+/** Adds the time since StartTime to the game thread or worker time of the frame, depending on the calling thread. */
+void RecordSkeletalMeshMergeCsvTime(double StartTime);
@@ -0,0 +1,264 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+/*=============================================================================
+	CustomSkeletalMeshMergeTestParts.cpp: Skeletal mesh parts generated in memory.
+=============================================================================*/
+
+#include "CustomSkeletalMeshMergeTestParts.h"
+#include "Animation/Skeleton.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/Texture2D.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "Rendering/SkeletalMeshLODRenderData.h"
+#include "Rendering/SkeletalMeshRenderData.h"
+#include "UObject/Package.h"
+
+namespace
+{
+	/** Size of every quad, and height of every bone of the chain */
+	const float SegmentHeight = 10.0f;
+
+	template<bool bExtraBoneInfluences>
+	void InitSkinWeights(FSkinWeightVertexBuffer& SkinWeights, const TArray<FIntPoint>& VertexBones)
+	{
+		// the second influence goes to the extra stream when there is one
+		const int32 SecondarySlot = bExtraBoneInfluences ? MAX_INFLUENCES_PER_STREAM : 1;
+
+		TArray<TSkinWeightInfo<bExtraBoneInfluences>> Weights;
+		Weights.AddZeroed(VertexBones.Num());
+		for (int32 VertIdx = 0; VertIdx < VertexBones.Num(); VertIdx++)
+		{
+			Weights[VertIdx].InfluenceBones[0] = (uint8)VertexBones[VertIdx].X;
+			Weights[VertIdx].InfluenceWeights[0] = SkelMeshMergeTestPrimaryWeight;
+			Weights[VertIdx].InfluenceBones[SecondarySlot] = (uint8)VertexBones[VertIdx].Y;
+			Weights[VertIdx].InfluenceWeights[SecondarySlot] = SkelMeshMergeTestSecondaryWeight;
+		}
+
+		SkinWeights.SetHasExtraBoneInfluences(bExtraBoneInfluences);
+		SkinWeights.SetNeedsCPUAccess(true);
+		SkinWeights = Weights;
+	}
+
+	/**
+	 * Builds one LOD of a part.
+	 * @param QuadBones - bones skinning the quads, chain bones first
+	 * @param NumQuads - quads of the LOD, spread evenly over QuadBones
+	 * @return Bounds of the LOD vertices
+	 */
+	FBox BuildLOD(FSkeletalMeshLODRenderData& LODData, const FSkelMeshMergeTestPartDesc& Desc, const FReferenceSkeleton& RefSkeleton, const TArray<int32>& QuadBones, int32 NumQuads, float OffsetX)
+	{
+		TArray<FVector> Positions;
+		TArray<FVector2D> UVs;
+		TArray<FColor> Colors;
+		TArray<FIntPoint> VertexBones;
+		TArray<uint32> Indices;
+		Positions.Reserve(NumQuads * 4);
+		UVs.Reserve(NumQuads * 4 * Desc.NumTexCoords);
+		VertexBones.Reserve(NumQuads * 4);
+		Indices.Reserve(NumQuads * 6);
+
+		// quads of the same bone stand side by side along X
+		int32 PrevBoneIdx = INDEX_NONE;
+		int32 SideIdx = 0;
+
+		for (int32 SectionIdx = 0; SectionIdx < Desc.NumSections; SectionIdx++)
+		{
+			const int32 FirstQuad = (int32)((int64)SectionIdx * NumQuads / Desc.NumSections);
+			const int32 LastQuad = (int32)((int64)(SectionIdx + 1) * NumQuads / Desc.NumSections);
+
+			FSkelMeshRenderSection& Section = *new(LODData.RenderSections) FSkelMeshRenderSection;
+			Section.MaterialIndex = SectionIdx;
+			Section.BaseIndex = Indices.Num();
+			Section.NumTriangles = (LastQuad - FirstQuad) * 2;
+			Section.BaseVertexIndex = Positions.Num();
+			Section.NumVertices = (LastQuad - FirstQuad) * 4;
+			Section.MaxBoneInfluences = Desc.bExtraBoneInfluences ? MAX_TOTAL_INFLUENCES : MAX_INFLUENCES_PER_STREAM;
+
+			// the bottom edge of a quad duplicates the top edge of the quad right below it
+			TArray<TArray<uint32>> Overlaps;
+			Overlaps.SetNum(Section.NumVertices);
+			int32 NumOverlaps = 0;
+			TMap<FIntPoint, int32> QuadAtCell;
+
+			for (int32 QuadIdx = FirstQuad; QuadIdx < LastQuad; QuadIdx++)
+			{
+				const int32 BoneIdx = (int32)((int64)QuadIdx * QuadBones.Num() / NumQuads);
+				const int32 BoneIndex = QuadBones[BoneIdx];
+				const int32 ParentIndex = RefSkeleton.GetParentIndex(BoneIndex);
+				const int32 LocalBone = Section.BoneMap.AddUnique((FBoneIndexType)BoneIndex);
+				const int32 LocalParent = Section.BoneMap.AddUnique((FBoneIndexType)ParentIndex);
+
+				SideIdx = (BoneIdx == PrevBoneIdx) ? SideIdx + 1 : 0;
+				PrevBoneIdx = BoneIdx;
+
+				// chain quads are stacked, the missing bone's quads stand aside
+				const bool bChainQuad = BoneIdx < Desc.NumChainBones;
+				const FIntPoint Cell(bChainQuad ? SideIdx : -1 - SideIdx, bChainQuad ? BoneIdx : 0);
+				const float QuadX = OffsetX + Cell.X * SegmentHeight + (bChainQuad ? 0.0f : -40.0f);
+				const float QuadZ = Cell.Y * SegmentHeight;
+
+				// bottom left, bottom right, top left, top right
+				const uint32 FirstVertex = Positions.Num();
+				for (int32 Corner = 0; Corner < 4; Corner++)
+				{
+					const int32 CornerX = Corner & 1;
+					const int32 CornerZ = Corner >> 1;
+					Positions.Add(FVector(QuadX + CornerX * SegmentHeight, 0.0f, QuadZ + CornerZ * SegmentHeight));
+					for (int32 UVIndex = 0; UVIndex < Desc.NumTexCoords; UVIndex++)
+					{
+						UVs.Add(FVector2D(0.1f + 0.8f * CornerX, 0.1f + 0.1f * UVIndex + 0.6f * CornerZ));
+					}
+					Colors.Add(FColor((uint8)(Positions.Num() >> 8), (uint8)Positions.Num(), (uint8)(Corner * 64), 255));
+					VertexBones.Add(FIntPoint(LocalBone, LocalParent));
+				}
+
+				const uint32 QuadIndices[] = { 0, 2, 1, 1, 2, 3 };
+				for (uint32 QuadIndex : QuadIndices)
+				{
+					Indices.Add(FirstVertex + QuadIndex);
+				}
+
+				if (Desc.bDuplicatedVertices && bChainQuad)
+				{
+					const int32* QuadBelow = QuadAtCell.Find(FIntPoint(Cell.X, Cell.Y - 1));
+					if (QuadBelow)
+					{
+						const int32 Bottom = (QuadIdx - FirstQuad) * 4;
+						const int32 TopBelow = (*QuadBelow - FirstQuad) * 4 + 2;
+						for (int32 Corner = 0; Corner < 2; Corner++)
+						{
+							Overlaps[Bottom + Corner].Add(Section.BaseVertexIndex + TopBelow + Corner);
+							Overlaps[TopBelow + Corner].Add(Section.BaseVertexIndex + Bottom + Corner);
+							NumOverlaps += 2;
+						}
+					}
+					QuadAtCell.Add(Cell, QuadIdx);
+				}
+			}
+
+			// section relative vertices index into absolute duplicate vertex indices, as imported meshes do
+			FDuplicatedVerticesBuffer& DupVerts = Section.DuplicatedVerticesBuffer;
+			DupVerts.DupVertData.ResizeBuffer(FMath::Max(NumOverlaps, 1));
+			DupVerts.DupVertIndexData.ResizeBuffer(Section.NumVertices);
+			uint32* VertData = (uint32*)DupVerts.DupVertData.GetDataPointer();
+			FIndexLengthPair* IndexData = (FIndexLengthPair*)DupVerts.DupVertIndexData.GetDataPointer();
+			VertData[0] = 0;
+
+			int32 NextOverlap = 0;
+			for (uint32 VertIdx = 0; VertIdx < Section.NumVertices; VertIdx++)
+			{
+				IndexData[VertIdx].Index = NextOverlap;
+				IndexData[VertIdx].Length = Overlaps[VertIdx].Num();
+				for (uint32 Overlap : Overlaps[VertIdx])
+				{
+					VertData[NextOverlap++] = Overlap;
+				}
+			}
+			DupVerts.bHasOverlappingVertices = NumOverlaps > 0;
+		}
+
+		const int32 NumVertices = Positions.Num();
+		LODData.StaticVertexBuffers.PositionVertexBuffer.Init(Positions, true);
+
+		FStaticMeshVertexBuffer& StaticMeshVertexBuffer = LODData.StaticVertexBuffers.StaticMeshVertexBuffer;
+		StaticMeshVertexBuffer.SetUseFullPrecisionUVs(true);
+		StaticMeshVertexBuffer.Init(NumVertices, Desc.NumTexCoords, true);
+		for (int32 VertIdx = 0; VertIdx < NumVertices; VertIdx++)
+		{
+			StaticMeshVertexBuffer.SetVertexTangents(VertIdx, FVector::ForwardVector, FVector::RightVector, FVector::UpVector);
+			for (int32 UVIndex = 0; UVIndex < Desc.NumTexCoords; UVIndex++)
+			{
+				StaticMeshVertexBuffer.SetVertexUV(VertIdx, UVIndex, UVs[VertIdx * Desc.NumTexCoords + UVIndex]);
+			}
+		}
+
+		if (Desc.bVertexColors)
+		{
+			LODData.StaticVertexBuffers.ColorVertexBuffer.InitFromColorArray(Colors);
+		}
+
+		if (Desc.bExtraBoneInfluences)
+		{
+			InitSkinWeights<true>(LODData.SkinWeightVertexBuffer, VertexBones);
+		}
+		else
+		{
+			InitSkinWeights<false>(LODData.SkinWeightVertexBuffer, VertexBones);
+		}
+
+		const uint8 IndexSize = NumVertices <= MAX_uint16 ? sizeof(uint16) : sizeof(uint32);
+		LODData.MultiSizeIndexContainer.RebuildIndexBuffer(IndexSize, Indices);
+
+		for (int32 BoneIndex = 0; BoneIndex < RefSkeleton.GetRawBoneNum(); BoneIndex++)
+		{
+			LODData.RequiredBones.Add((FBoneIndexType)BoneIndex);
+			LODData.ActiveBoneIndices.Add((FBoneIndexType)BoneIndex);
+		}
+
+		return FBox(Positions);
+	}
+}
+
+USkeletalMesh* BuildSkelMeshMergeTestPart(const FSkelMeshMergeTestPartDesc& Desc, USkeleton* Skeleton, UMaterialInterface* BaseMaterial, float OffsetX)
+{
+	USkeletalMesh* Mesh = NewObject<USkeletalMesh>(GetTransientPackage(), NAME_None, RF_Transient);
+	Mesh->Skeleton = Skeleton;
+
+	// Root, the missing bone, then the chain; the missing bone shifts the chain indices away from the merged ones
+	TArray<int32> QuadBones;
+	{
+		FReferenceSkeletonModifier RefSkelModifier(Mesh->RefSkeleton, Skeleton);
+		RefSkelModifier.Add(FMeshBoneInfo(TEXT("Root"), TEXT("Root"), INDEX_NONE), FTransform::Identity);
+		int32 NumBones = 1;
+
+		int32 MissingBoneIndex = INDEX_NONE;
+		if (Desc.bMissingBone)
+		{
+			const FString BoneName = FString::Printf(TEXT("%s_Missing"), Desc.Name);
+			RefSkelModifier.Add(FMeshBoneInfo(*BoneName, BoneName, 0), FTransform::Identity);
+			MissingBoneIndex = NumBones++;
+		}
+
+		int32 ParentIndex = 0;
+		for (int32 ChainIdx = 1; ChainIdx <= Desc.NumChainBones; ChainIdx++)
+		{
+			const FString BoneName = FString::Printf(TEXT("Bone_%d"), ChainIdx);
+			RefSkelModifier.Add(FMeshBoneInfo(*BoneName, BoneName, ParentIndex), FTransform(FVector(0.0f, 0.0f, ChainIdx > 1 ? SegmentHeight : 0.0f)));
+			ParentIndex = NumBones++;
+			QuadBones.Add(ParentIndex);
+		}
+
+		if (MissingBoneIndex != INDEX_NONE)
+		{
+			QuadBones.Add(MissingBoneIndex);
+		}
+	}
+
+	const int32 NumQuads = Desc.NumQuads > 0 ? Desc.NumQuads : QuadBones.Num();
+	check(Desc.NumSections >= 1 && Desc.NumSections <= NumQuads);
+
+	for (int32 SectionIdx = 0; SectionIdx < Desc.NumSections; SectionIdx++)
+	{
+		// textures of different sizes get different atlas regions
+		UTexture2D* Texture = UTexture2D::CreateTransient(64 << (SectionIdx % 4), 64);
+		UMaterialInstanceDynamic* Material = UMaterialInstanceDynamic::Create(BaseMaterial, GetTransientPackage());
+		Material->SetTextureParameterValue(TEXT("MainTexture"), Texture);
+		Mesh->Materials.Add(FSkeletalMaterial(Material));
+	}
+
+	Mesh->AllocateResourceForRendering();
+	FSkeletalMeshRenderData* RenderData = Mesh->GetResourceForRendering();
+	FBox Bounds(ForceInit);
+	for (int32 LODIdx = 0; LODIdx < FMath::Max(Desc.NumLODs, 1); LODIdx++)
+	{
+		FSkeletalMeshLODRenderData* LODData = new FSkeletalMeshLODRenderData();
+		RenderData->LODRenderData.Add(LODData);
+		Mesh->AddLODInfo();
+
+		Bounds += BuildLOD(*LODData, Desc, Mesh->RefSkeleton, QuadBones, FMath::Max(NumQuads >> LODIdx, Desc.NumSections), OffsetX);
+	}
+
+	Mesh->bHasVertexColors = Desc.bVertexColors;
+	Mesh->SetImportedBounds(FBoxSphereBounds(Bounds));
+	return Mesh;
+}
@@ -0,0 +1,53 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+/*=============================================================================
+	CustomSkeletalMeshMergeTestParts.h: Skeletal mesh parts generated in memory.
+=============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UMaterialInterface;
+class USkeletalMesh;
+class USkeleton;
+
+/** Shape of a generated part */
+struct FSkelMeshMergeTestPartDesc
+{
+	const TCHAR* Name;
+
+	/** Bones of the chain below the root, named the same in every part. Bones past the first part's chain are missing from the merged skeleton. */
+	int32 NumChainBones;
+
+	/** Adds a bone, named after the part, that is missing from the merged skeleton and skins quads of its own */
+	bool bMissingBone;
+
+	/** Sections, each with a material of its own, splitting the quads evenly */
+	int32 NumSections;
+
+	int32 NumTexCoords;
+	bool bExtraBoneInfluences;
+	bool bVertexColors;
+
+	/** Quads stacked on consecutive chain bones share their edges within a section */
+	bool bDuplicatedVertices;
+
+	/** Quads of LOD 0, spread evenly over the bones; 0 gives every bone one quad */
+	int32 NumQuads;
+
+	/** LODs, each with half the quads of the previous one; 0 is one LOD */
+	int32 NumLODs;
+};
+
+/** Weights of the two influences of every generated vertex */
+const uint8 SkelMeshMergeTestPrimaryWeight = 191;
+const uint8 SkelMeshMergeTestSecondaryWeight = 255 - SkelMeshMergeTestPrimaryWeight;
+
+/**
+ * Builds a transient part skinned to a chain of bones: quads stacked along Z, each skinned to its bone and the bone's parent.
+ * The render data keeps a CPU copy of every buffer and is never initialized, so no renderer is needed.
+ * @param BaseMaterial - parent of the section materials, which get a MainTexture of their own
+ * @param OffsetX - moves the quads so the parts of a merge do not overlap
+ */
+USkeletalMesh* BuildSkelMeshMergeTestPart(const FSkelMeshMergeTestPartDesc& Desc, USkeleton* Skeleton, UMaterialInterface* BaseMaterial, float OffsetX);
@@ -0,0 +1,1109 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+/*=============================================================================
+	CustomSkeletalMeshMergeValidation.cpp: Merges of generated parts checked against their sources.
+=============================================================================*/
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "CustomSkeletalMeshMerge.h"
+#include "CustomSkeletalMeshMergePartCache.h"
+#include "CustomSkeletalMeshMergePrebake.h"
+#include "CustomSkeletalMeshMergeTestParts.h"
+#include "Animation/Skeleton.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/SkeletalMeshSocket.h"
+#include "Engine/Texture2D.h"
+#include "HAL/IConsoleManager.h"
+#include "Materials/Material.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "Rendering/SkeletalMeshLODRenderData.h"
+#include "Rendering/SkeletalMeshRenderData.h"
+#include "UObject/Package.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	/** Mismatches logged per merge, the rest are only counted */
+	const int32 MaxReportedErrors = 10;
+
+	/** Tolerance of UVs stored at half precision */
+	const float UVTolerance = 1.0e-3f;
+
+	/** Parts merged together; the first part provides the merged skeleton */
+	struct FValidationCase
+	{
+		const TCHAR* Name;
+		TArray<FSkelMeshMergeTestPartDesc> Parts;
+	};
+
+	TArray<FValidationCase> GetValidationCases()
+	{
+		// Name, chain bones, missing bone, sections, UV sets, extra influences, colors, duplicated vertices
+		return {
+			{ TEXT("SingleSection"), {
+				{ TEXT("Body"), 6, false, 1, 1, false, false, false },
+				{ TEXT("Head"), 4, false, 1, 1, false, false, false } } },
+			{ TEXT("MultiSection"), {
+				{ TEXT("Body"), 6, false, 3, 2, false, false, false },
+				{ TEXT("Legs"), 6, false, 2, 1, false, false, false },
+				{ TEXT("Hands"), 2, false, 1, 3, false, false, false } } },
+			{ TEXT("ExtraBoneInfluences"), {
+				{ TEXT("Body"), 6, false, 2, 1, false, false, false },
+				{ TEXT("Cloak"), 6, false, 1, 1, true, false, false } } },
+			{ TEXT("VertexColors"), {
+				{ TEXT("Body"), 6, false, 1, 1, false, true, false },
+				{ TEXT("Head"), 4, false, 1, 1, false, false, false },
+				{ TEXT("Hair"), 3, false, 1, 1, false, true, false } } },
+			{ TEXT("DuplicatedVertices"), {
+				{ TEXT("Body"), 6, false, 2, 1, false, false, true },
+				{ TEXT("Head"), 4, false, 1, 1, false, false, false },
+				{ TEXT("Legs"), 6, false, 3, 1, false, false, true } } },
+			{ TEXT("MissingBones"), {
+				{ TEXT("Body"), 4, false, 1, 1, false, false, false },
+				{ TEXT("Tail"), 9, true, 2, 1, false, false, false } } },
+			{ TEXT("Mixed"), {
+				{ TEXT("Body"), 5, true, 2, 2, true, true, true },
+				{ TEXT("Tail"), 8, true, 3, 1, false, false, true },
+				{ TEXT("Head"), 3, false, 1, 3, true, false, false } } },
+		};
+	}
+
+	/** Mismatches found in one merge, reported as errors of the running test */
+	struct FValidationRun
+	{
+		FAutomationTestBase& Test;
+		FString Name;
+		int32 NumErrors;
+
+		FValidationRun(FAutomationTestBase& InTest, const FString& InName)
+			: Test(InTest)
+			, Name(InName)
+			, NumErrors(0)
+		{}
+
+		template <typename FmtType, typename... Types>
+		void Fail(const FmtType& Fmt, Types... Args)
+		{
+			if (NumErrors++ < MaxReportedErrors)
+			{
+				Test.AddError(FString::Printf(TEXT("%s: %s"), *Name, *FString::Printf(Fmt, Args...)));
+			}
+		}
+	};
+
+	/** Merged bone a part bone is skinned to: the bone of the same name, else its closest ancestor within three parents, else the root */
+	int32 GetExpectedMergedBone(const FReferenceSkeleton& PartRefSkeleton, int32 PartBoneIndex, const FReferenceSkeleton& MergedRefSkeleton)
+	{
+		int32 BoneIndex = PartBoneIndex;
+		for (int32 Depth = 0; Depth <= 3 && BoneIndex != INDEX_NONE; Depth++)
+		{
+			const int32 MergedBoneIndex = MergedRefSkeleton.FindBoneIndex(PartRefSkeleton.GetBoneName(BoneIndex));
+			if (MergedBoneIndex != INDEX_NONE)
+			{
+				return MergedBoneIndex;
+			}
+			BoneIndex = PartRefSkeleton.GetParentIndex(BoneIndex);
+		}
+		return 0;
+	}
+
+	/** Reads the influences of a vertex, the extra stream left zeroed if the buffer has none */
+	void GetInfluences(const FSkinWeightVertexBuffer& SkinWeights, uint32 VertIdx, uint8 (&OutBones)[MAX_TOTAL_INFLUENCES], uint8 (&OutWeights)[MAX_TOTAL_INFLUENCES])
+	{
+		FMemory::Memzero(OutBones);
+		FMemory::Memzero(OutWeights);
+		if (SkinWeights.HasExtraBoneInfluences())
+		{
+			const TSkinWeightInfo<true>* Weights = SkinWeights.GetSkinWeightPtr<true>(VertIdx);
+			FMemory::Memcpy(OutBones, Weights->InfluenceBones, sizeof(Weights->InfluenceBones));
+			FMemory::Memcpy(OutWeights, Weights->InfluenceWeights, sizeof(Weights->InfluenceWeights));
+		}
+		else
+		{
+			const TSkinWeightInfo<false>* Weights = SkinWeights.GetSkinWeightPtr<false>(VertIdx);
+			FMemory::Memcpy(OutBones, Weights->InfluenceBones, sizeof(Weights->InfluenceBones));
+			FMemory::Memcpy(OutWeights, Weights->InfluenceWeights, sizeof(Weights->InfluenceWeights));
+		}
+	}
+
+	/**
+	 * Checks the prepared LOD against the parts: every source section is expected in the single merged
+	 * section, in part and section order, with its indices rebased, its bones remapped by name and its
+	 * UVs moved into the atlas region of its material.
+	 */
+	void ValidatePreparedData(FValidationRun& Run, const TArray<USkeletalMesh*>& Parts, const FMergedMeshData& Data, const FCustomSkeletalMeshMergeAtlasLayout& AtlasLayout)
+	{
+		if (Data.LODRenderData.Num() != 1)
+		{
+			Run.Fail(TEXT("%d merged LODs, expected 1"), Data.LODRenderData.Num());
+			return;
+		}
+
+		const FSkeletalMeshLODRenderData& MergedLOD = Data.LODRenderData[0];
+		if (MergedLOD.RenderSections.Num() != 1)
+		{
+			Run.Fail(TEXT("%d merged sections, the parts are sized to merge into one"), MergedLOD.RenderSections.Num());
+			return;
+		}
+
+		// the merged skeleton is the skeleton of the first part
+		const FReferenceSkeleton& MergedRefSkeleton = Data.RefSkeleton;
+		if (MergedRefSkeleton.GetRawBoneNum() != Parts[0]->RefSkeleton.GetRawBoneNum())
+		{
+			Run.Fail(TEXT("%d merged bones, expected the %d of the first part"), MergedRefSkeleton.GetRawBoneNum(), Parts[0]->RefSkeleton.GetRawBoneNum());
+		}
+
+		const FSkelMeshRenderSection& MergedSection = MergedLOD.RenderSections[0];
+		const FStaticMeshVertexBuffers& MergedBuffers = MergedLOD.StaticVertexBuffers;
+		const FRawStaticIndexBuffer16or32Interface* MergedIndices = MergedLOD.MultiSizeIndexContainer.GetIndexBuffer();
+
+		uint32 NumVertices = 0;
+		uint32 NumIndices = 0;
+		bool bHasVertexColors = false;
+		bool bHasOverlappingVertices = false;
+		for (USkeletalMesh* Part : Parts)
+		{
+			for (const FSkelMeshRenderSection& Section : Part->GetResourceForRendering()->LODRenderData[0].RenderSections)
+			{
+				NumVertices += Section.NumVertices;
+				NumIndices += Section.NumTriangles * 3;
+				bHasOverlappingVertices |= Section.DuplicatedVerticesBuffer.bHasOverlappingVertices;
+			}
+			bHasVertexColors |= Part->bHasVertexColors;
+		}
+
+		if (MergedBuffers.PositionVertexBuffer.GetNumVertices() != NumVertices || MergedSection.NumVertices != NumVertices)
+		{
+			Run.Fail(TEXT("%u merged vertices, expected %u"), MergedBuffers.PositionVertexBuffer.GetNumVertices(), NumVertices);
+			return;
+		}
+		if (MergedIndices->Num() != (int32)NumIndices || MergedSection.NumTriangles * 3 != NumIndices)
+		{
+			Run.Fail(TEXT("%d merged indices, expected %u"), MergedIndices->Num(), NumIndices);
+			return;
+		}
+		if (Data.bHasVertexColors != bHasVertexColors || (MergedBuffers.ColorVertexBuffer.GetNumVertices() > 0) != bHasVertexColors)
+		{
+			Run.Fail(TEXT("Merged vertex colors %d, expected %d"), MergedBuffers.ColorVertexBuffer.GetNumVertices() > 0 ? 1 : 0, bHasVertexColors ? 1 : 0);
+			return;
+		}
+
+		FDuplicatedVerticesBuffer& MergedDupVerts = const_cast<FDuplicatedVerticesBuffer&>(MergedSection.DuplicatedVerticesBuffer);
+		if (MergedDupVerts.bHasOverlappingVertices != bHasOverlappingVertices || MergedDupVerts.DupVertIndexData.Num() != (int32)NumVertices)
+		{
+			Run.Fail(TEXT("Merged duplicated vertices %d with %d entries, expected %d with %u"),
+				MergedDupVerts.bHasOverlappingVertices ? 1 : 0, MergedDupVerts.DupVertIndexData.Num(), bHasOverlappingVertices ? 1 : 0, NumVertices);
+			return;
+		}
+		const uint32* MergedDupVertData = (const uint32*)MergedDupVerts.DupVertData.GetDataPointer();
+		const FIndexLengthPair* MergedDupIndexData = (const FIndexLengthPair*)MergedDupVerts.DupVertIndexData.GetDataPointer();
+
+		const FVector2D AtlasSize(AtlasLayout.Properties[0].Size);
+		const uint32 NumMergedTexCoords = MergedBuffers.StaticMeshVertexBuffer.GetNumTexCoords();
+
+		uint32 MergedBaseVertex = 0;
+		uint32 MergedBaseIndex = 0;
+		int32 FirstAtlasBox = 0;
+		for (int32 PartIdx = 0; PartIdx < Parts.Num(); PartIdx++)
+		{
+			USkeletalMesh* Part = Parts[PartIdx];
+			const FSkeletalMeshLODRenderData& PartLOD = Part->GetResourceForRendering()->LODRenderData[0];
+			const FStaticMeshVertexBuffers& PartBuffers = PartLOD.StaticVertexBuffers;
+			const uint32 NumPartTexCoords = PartBuffers.StaticMeshVertexBuffer.GetNumTexCoords();
+
+			if (NumMergedTexCoords < NumPartTexCoords)
+			{
+				Run.Fail(TEXT("%u merged UV sets, part %d has %u"), NumMergedTexCoords, PartIdx, NumPartTexCoords);
+			}
+
+			for (int32 SectionIdx = 0; SectionIdx < PartLOD.RenderSections.Num(); SectionIdx++)
+			{
+				const FSkelMeshRenderSection& Section = PartLOD.RenderSections[SectionIdx];
+				FDuplicatedVerticesBuffer& DupVerts = const_cast<FDuplicatedVerticesBuffer&>(Section.DuplicatedVerticesBuffer);
+				const uint32* DupVertData = (const uint32*)DupVerts.DupVertData.GetDataPointer();
+				const FIndexLengthPair* DupIndexData = (const FIndexLengthPair*)DupVerts.DupVertIndexData.GetDataPointer();
+
+				for (uint32 VertIdx = 0; VertIdx < Section.NumVertices; VertIdx++)
+				{
+					const uint32 SrcVertex = Section.BaseVertexIndex + VertIdx;
+					const uint32 DstVertex = MergedBaseVertex + VertIdx;
+
+					const FVector& SrcPosition = PartBuffers.PositionVertexBuffer.VertexPosition(SrcVertex);
+					const FVector& DstPosition = MergedBuffers.PositionVertexBuffer.VertexPosition(DstVertex);
+					if (!DstPosition.Equals(SrcPosition, KINDA_SMALL_NUMBER))
+					{
+						Run.Fail(TEXT("Part %d section %d vertex %u: position %s, expected %s"), PartIdx, SectionIdx, VertIdx, *DstPosition.ToString(), *SrcPosition.ToString());
+					}
+
+					// MergeMaterial keeps one atlas transform per part material, applied to the UV set of the same index
+					for (uint32 UVIndex = 0; UVIndex < NumPartTexCoords && UVIndex < NumMergedTexCoords; UVIndex++)
+					{
+						FVector2D ExpectedUV = PartBuffers.StaticMeshVertexBuffer.GetVertexUV(SrcVertex, UVIndex);
+						if ((int32)UVIndex < Part->Materials.Num())
+						{
+							const FBox2D& Box = AtlasLayout.Boxes[FirstAtlasBox + UVIndex];
+							ExpectedUV = Box.Min / AtlasSize + ExpectedUV * (Box.GetSize() / AtlasSize);
+						}
+						const FVector2D DstUV = MergedBuffers.StaticMeshVertexBuffer.GetVertexUV(DstVertex, UVIndex);
+						if (!DstUV.Equals(ExpectedUV, UVTolerance))
+						{
+							Run.Fail(TEXT("Part %d section %d vertex %u: UV %u %s, expected %s"), PartIdx, SectionIdx, VertIdx, UVIndex, *DstUV.ToString(), *ExpectedUV.ToString());
+						}
+					}
+
+					// influences keep their slot, their bones are remapped through the merged section bone map
+					uint8 SrcBones[MAX_TOTAL_INFLUENCES];
+					uint8 SrcWeights[MAX_TOTAL_INFLUENCES];
+					uint8 DstBones[MAX_TOTAL_INFLUENCES];
+					uint8 DstWeights[MAX_TOTAL_INFLUENCES];
+					GetInfluences(PartLOD.SkinWeightVertexBuffer, SrcVertex, SrcBones, SrcWeights);
+					GetInfluences(MergedLOD.SkinWeightVertexBuffer, DstVertex, DstBones, DstWeights);
+					for (int32 Slot = 0; Slot < MAX_TOTAL_INFLUENCES; Slot++)
+					{
+						if (DstWeights[Slot] != SrcWeights[Slot])
+						{
+							Run.Fail(TEXT("Part %d section %d vertex %u: influence %d weight %u, expected %u"), PartIdx, SectionIdx, VertIdx, Slot, DstWeights[Slot], SrcWeights[Slot]);
+						}
+						else if (SrcWeights[Slot] > 0)
+						{
+							const int32 ExpectedBone = GetExpectedMergedBone(Part->RefSkeleton, Section.BoneMap[SrcBones[Slot]], MergedRefSkeleton);
+							const int32 DstBone = MergedSection.BoneMap.IsValidIndex(DstBones[Slot]) ? MergedSection.BoneMap[DstBones[Slot]] : INDEX_NONE;
+							if (DstBone != ExpectedBone)
+							{
+								Run.Fail(TEXT("Part %d section %d vertex %u: influence %d skinned to merged bone %d, expected %d (%s)"), PartIdx, SectionIdx, VertIdx, Slot,
+									DstBone, ExpectedBone, *MergedRefSkeleton.GetBoneName(ExpectedBone).ToString());
+							}
+						}
+					}
+
+					if (bHasVertexColors)
+					{
+						const FColor ExpectedColor = SrcVertex < PartBuffers.ColorVertexBuffer.GetNumVertices() ? PartBuffers.ColorVertexBuffer.VertexColor(SrcVertex) : FColor::White;
+						const FColor& DstColor = MergedBuffers.ColorVertexBuffer.VertexColor(DstVertex);
+						if (DstColor != ExpectedColor)
+						{
+							Run.Fail(TEXT("Part %d section %d vertex %u: color %s, expected %s"), PartIdx, SectionIdx, VertIdx, *DstColor.ToString(), *ExpectedColor.ToString());
+						}
+					}
+
+					// duplicates keep pointing at the same vertices, rebased to the merged vertex buffer
+					const uint32 ExpectedLength = DupVerts.bHasOverlappingVertices ? DupIndexData[VertIdx].Length : 0;
+					const FIndexLengthPair& DstPair = MergedDupIndexData[DstVertex];
+					if (DstPair.Length != ExpectedLength || (int32)(DstPair.Index + DstPair.Length) > MergedDupVerts.DupVertData.Num())
+					{
+						Run.Fail(TEXT("Part %d section %d vertex %u: %u duplicates at %u, expected %u"), PartIdx, SectionIdx, VertIdx, DstPair.Length, DstPair.Index, ExpectedLength);
+						continue;
+					}
+					for (uint32 DupIdx = 0; DupIdx < ExpectedLength; DupIdx++)
+					{
+						const uint32 ExpectedDup = DupVertData[DupIndexData[VertIdx].Index + DupIdx] - Section.BaseVertexIndex + MergedBaseVertex;
+						const uint32 DstDup = MergedDupVertData[DstPair.Index + DupIdx];
+						if (DstDup != ExpectedDup)
+						{
+							Run.Fail(TEXT("Part %d section %d vertex %u: duplicate %u is vertex %u, expected %u"), PartIdx, SectionIdx, VertIdx, DupIdx, DstDup, ExpectedDup);
+						}
+					}
+				}
+
+				const FRawStaticIndexBuffer16or32Interface* PartIndices = PartLOD.MultiSizeIndexContainer.GetIndexBuffer();
+				for (uint32 IndexIdx = 0; IndexIdx < Section.NumTriangles * 3; IndexIdx++)
+				{
+					const uint32 ExpectedIndex = PartIndices->Get(Section.BaseIndex + IndexIdx) - Section.BaseVertexIndex + MergedBaseVertex;
+					const uint32 DstIndex = MergedIndices->Get(MergedBaseIndex + IndexIdx);
+					if (DstIndex != ExpectedIndex)
+					{
+						Run.Fail(TEXT("Part %d section %d index %u: %u, expected %u"), PartIdx, SectionIdx, IndexIdx, DstIndex, ExpectedIndex);
+					}
+				}
+
+				MergedBaseVertex += Section.NumVertices;
+				MergedBaseIndex += Section.NumTriangles * 3;
+			}
+
+			FirstAtlasBox += Part->Materials.Num();
+		}
+	}
+
+	/** Gathers the UVs of the first merged LOD, all UV sets of a vertex after another */
+	void GetMergedUVs(const FMergedMeshData& Data, TArray<FVector2D>& OutUVs)
+	{
+		OutUVs.Reset();
+		if (Data.LODRenderData.Num() == 0)
+		{
+			return;
+		}
+
+		const FStaticMeshVertexBuffer& MergedVertices = Data.LODRenderData[0].StaticVertexBuffers.StaticMeshVertexBuffer;
+		OutUVs.Reserve(MergedVertices.GetNumVertices() * MergedVertices.GetNumTexCoords());
+		for (uint32 VertIdx = 0; VertIdx < MergedVertices.GetNumVertices(); VertIdx++)
+		{
+			for (uint32 UVIndex = 0; UVIndex < MergedVertices.GetNumTexCoords(); UVIndex++)
+			{
+				OutUVs.Add(MergedVertices.GetVertexUV(VertIdx, UVIndex));
+			}
+		}
+	}
+
+	/** Checks that UVs merged through the part cache are bit for bit the UVs of a merge without it */
+	void CompareUVs(FValidationRun& Run, const TArray<FVector2D>& UncachedUVs, const TArray<FVector2D>& UVs)
+	{
+		if (UVs.Num() != UncachedUVs.Num())
+		{
+			Run.Fail(TEXT("%d merged UVs, %d without the part cache"), UVs.Num(), UncachedUVs.Num());
+			return;
+		}
+		for (int32 UVIdx = 0; UVIdx < UVs.Num(); UVIdx++)
+		{
+			if (FMemory::Memcmp(&UVs[UVIdx], &UncachedUVs[UVIdx], sizeof(FVector2D)) != 0)
+			{
+				Run.Fail(TEXT("UV %d: %s, %s without the part cache"), UVIdx, *UVs[UVIdx].ToString(), *UncachedUVs[UVIdx].ToString());
+			}
+		}
+	}
+
+	/**
+	 * Merges the parts and checks the prepared data against them.
+	 * @param OutUVs - UVs of the first merged LOD
+	 */
+	void MergeAndValidate(FValidationRun& Run, const TArray<USkeletalMesh*>& Parts, USkeleton* Skeleton, UMaterialInterface* BaseMaterial, TArray<FVector2D>& OutUVs)
+	{
+		TArray<FSkelMeshMergePart> MergeParts;
+		for (USkeletalMesh* Part : Parts)
+		{
+			FSkelMeshMergePart& MergePart = MergeParts[MergeParts.AddDefaulted()];
+			MergePart.SkeletalMesh = Part;
+			MergePart.AttachedBoneName = NAME_None;
+			MergePart.VerticesTransform = FTransform::Identity;
+		}
+
+		// Only provides the skeleton asset to the merge, the prepared data is never committed to it
+		USkeletalMesh* MergeMesh = NewObject<USkeletalMesh>(GetTransientPackage(), NAME_None, RF_Transient);
+		MergeMesh->Skeleton = Skeleton;
+
+		const TArray<FSkelMeshMergeSectionMapping> NoSectionMappings;
+		FCustomSkeletalMeshMerge Merger(MergeMesh, BaseMaterial, MergeParts, NoSectionMappings, 0, EMeshBufferAccess::ForceCPUAndGPU);
+		Merger.SetCompositeAtlas(false);
+		Merger.MergeMaterial();
+		Merger.PrepareSkeleton();
+		if (!Merger.PrepareMesh())
+		{
+			Run.Fail(TEXT("PrepareMesh failed"));
+			return;
+		}
+
+		FCustomSkeletalMeshMergeAtlasLayout AtlasLayout;
+		Merger.GetAtlasLayout(AtlasLayout);
+		ValidatePreparedData(Run, Parts, Merger.GetPreparedData(), AtlasLayout);
+		GetMergedUVs(Merger.GetPreparedData(), OutUVs);
+	}
+
+	/** Adds a socket on the first chain bone, which every part and the merged skeleton have */
+	USkeletalMeshSocket* AddTestSocket(UObject* Outer, TArray<USkeletalMeshSocket*>& Sockets, const TCHAR* SocketName, float OffsetX)
+	{
+		USkeletalMeshSocket* Socket = NewObject<USkeletalMeshSocket>(Outer);
+		Socket->SocketName = SocketName;
+		Socket->BoneName = TEXT("Bone_1");
+		Socket->RelativeLocation = FVector(OffsetX, 0.0f, 0.0f);
+		Sockets.Add(Socket);
+		return Socket;
+	}
+
+	/**
+	 * Merges parts with mesh and skeleton sockets and commits the merged skeleton twice to the same mesh.
+	 * Every source socket must be found on the merged mesh with its bone and transform, the first part
+	 * winning sockets of the same name. Sockets the merged mesh lists must be objects of its own, and the
+	 * second commit must rewrite the objects of the first one.
+	 * @param bMergeMeshSkeleton - the merged mesh has the skeleton of the parts, which then provides the skeleton sockets
+	 */
+	void ValidateSockets(FValidationRun& Run, UMaterialInterface* BaseMaterial, bool bMergeMeshSkeleton)
+	{
+		USkeleton* Skeleton = NewObject<USkeleton>(GetTransientPackage(), NAME_None, RF_Transient);
+		const FSkelMeshMergeTestPartDesc PartDescs[] = {
+			{ TEXT("Body"), 6, false, 1, 1, false, false, false },
+			{ TEXT("Head"), 4, false, 1, 1, false, false, false } };
+
+		TArray<USkeletalMesh*> Parts;
+		TArray<FSkelMeshMergePart> MergeParts;
+		for (int32 PartIdx = 0; PartIdx < ARRAY_COUNT(PartDescs); PartIdx++)
+		{
+			USkeletalMesh* Part = BuildSkelMeshMergeTestPart(PartDescs[PartIdx], Skeleton, BaseMaterial, PartIdx * 100.0f);
+			Parts.Add(Part);
+
+			FSkelMeshMergePart& MergePart = MergeParts[MergeParts.AddDefaulted()];
+			MergePart.SkeletalMesh = Part;
+			MergePart.AttachedBoneName = NAME_None;
+			MergePart.VerticesTransform = FTransform::Identity;
+		}
+
+		// socket name to the source socket the merged mesh must reproduce
+		TMap<FName, const USkeletalMeshSocket*> ExpectedSockets;
+		for (int32 PartIdx = 0; PartIdx < Parts.Num(); PartIdx++)
+		{
+			TArray<USkeletalMeshSocket*>& MeshSockets = Parts[PartIdx]->GetMeshOnlySocketList();
+			const FString SocketName = FString::Printf(TEXT("%s_Socket"), PartDescs[PartIdx].Name);
+			const USkeletalMeshSocket* MeshSocket = AddTestSocket(Parts[PartIdx], MeshSockets, *SocketName, 1.0f + PartIdx);
+			ExpectedSockets.Add(MeshSocket->SocketName, MeshSocket);
+
+			const USkeletalMeshSocket* SharedSocket = AddTestSocket(Parts[PartIdx], MeshSockets, TEXT("Shared_Socket"), 10.0f + PartIdx);
+			if (PartIdx == 0)
+			{
+				ExpectedSockets.Add(SharedSocket->SocketName, SharedSocket);
+			}
+		}
+		const TCHAR* SkeletonSocketNames[] = { TEXT("Skeleton_Socket_A"), TEXT("Skeleton_Socket_B") };
+		TSet<const USkeletalMeshSocket*> SkeletonSockets;
+		for (const TCHAR* SocketName : SkeletonSocketNames)
+		{
+			const USkeletalMeshSocket* SkeletonSocket = AddTestSocket(Skeleton, Skeleton->Sockets, SocketName, 20.0f + SkeletonSockets.Num());
+			ExpectedSockets.Add(SkeletonSocket->SocketName, SkeletonSocket);
+			SkeletonSockets.Add(SkeletonSocket);
+		}
+
+		USkeletalMesh* MergeMesh = NewObject<USkeletalMesh>(GetTransientPackage(), NAME_None, RF_Transient);
+		MergeMesh->Skeleton = bMergeMeshSkeleton ? Skeleton : nullptr;
+
+		const TArray<FSkelMeshMergeSectionMapping> NoSectionMappings;
+		TArray<USkeletalMeshSocket*> FirstCommitSockets;
+		for (int32 CommitIdx = 0; CommitIdx < 2; CommitIdx++)
+		{
+			FCustomSkeletalMeshMerge Merger(MergeMesh, BaseMaterial, MergeParts, NoSectionMappings, 0, EMeshBufferAccess::ForceCPUAndGPU);
+			Merger.SetCompositeAtlas(false);
+			Merger.MergeMaterial();
+			Merger.PrepareSkeleton();
+			Merger.CommitSkeleton();
+
+			const TArray<USkeletalMeshSocket*>& MergedSockets = MergeMesh->GetMeshOnlySocketList();
+			const int32 NumExpectedMeshSockets = ExpectedSockets.Num() - (bMergeMeshSkeleton ? SkeletonSockets.Num() : 0);
+			if (MergedSockets.Num() != NumExpectedMeshSockets)
+			{
+				Run.Fail(TEXT("Commit %d: %d merged mesh sockets, expected %d"), CommitIdx, MergedSockets.Num(), NumExpectedMeshSockets);
+			}
+			for (const USkeletalMeshSocket* MergedSocket : MergedSockets)
+			{
+				if (!MergedSocket || MergedSocket->GetOuter() != MergeMesh)
+				{
+					Run.Fail(TEXT("Commit %d: merged mesh socket %s is not an object of the merged mesh"), CommitIdx, MergedSocket ? *MergedSocket->SocketName.ToString() : TEXT("None"));
+				}
+			}
+
+			for (const TPair<FName, const USkeletalMeshSocket*>& Expected : ExpectedSockets)
+			{
+				const USkeletalMeshSocket* SourceSocket = Expected.Value;
+				const USkeletalMeshSocket* MergedSocket = MergeMesh->FindSocket(Expected.Key);
+				if (!MergedSocket)
+				{
+					Run.Fail(TEXT("Commit %d: socket %s was dropped"), CommitIdx, *Expected.Key.ToString());
+					continue;
+				}
+
+				// only the merged mesh's own skeleton may provide a socket without a copy
+				const bool bFromMergedSkeleton = bMergeMeshSkeleton && SkeletonSockets.Contains(SourceSocket);
+				if (MergedSocket == SourceSocket && !bFromMergedSkeleton)
+				{
+					Run.Fail(TEXT("Commit %d: socket %s is the source socket, not a copy"), CommitIdx, *Expected.Key.ToString());
+				}
+				if (MergedSocket->BoneName != SourceSocket->BoneName || !MergedSocket->RelativeLocation.Equals(SourceSocket->RelativeLocation)
+					|| !MergedSocket->RelativeRotation.Equals(SourceSocket->RelativeRotation) || !MergedSocket->RelativeScale.Equals(SourceSocket->RelativeScale))
+				{
+					Run.Fail(TEXT("Commit %d: socket %s on %s at %s, expected on %s at %s"), CommitIdx, *Expected.Key.ToString(),
+						*MergedSocket->BoneName.ToString(), *MergedSocket->RelativeLocation.ToString(), *SourceSocket->BoneName.ToString(), *SourceSocket->RelativeLocation.ToString());
+				}
+			}
+
+			if (CommitIdx == 0)
+			{
+				FirstCommitSockets = MergedSockets;
+			}
+			else if (MergedSockets != FirstCommitSockets)
+			{
+				Run.Fail(TEXT("Merging again created new socket objects instead of rewriting the ones of the merged mesh"));
+			}
+		}
+	}
+
+	/** Part of a LOD case, merged with its own LOD bias and max LOD */
+	struct FLODValidationPart
+	{
+		FSkelMeshMergeTestPartDesc Desc;
+		int32 LODBias;
+		int32 MaxLOD;
+	};
+
+	/** Parts with per-part LOD settings, and the source LOD each part contributes to each merged LOD */
+	struct FLODValidationCase
+	{
+		const TCHAR* Name;
+		int32 StripTopLODs;
+		TArray<FLODValidationPart> Parts;
+
+		/** Source LOD of every part per merged LOD, INDEX_NONE where the part is left out */
+		TArray<TArray<int32>> ExpectedSourceLODs;
+	};
+
+	TArray<FLODValidationCase> GetLODValidationCases()
+	{
+		// Parts of four LODs, each LOD with half the quads of the previous one, so every source LOD has a vertex count of its own
+		const FSkelMeshMergeTestPartDesc Body = { TEXT("Body"), 6, false, 1, 1, false, false, false, 32, 4 };
+		const FSkelMeshMergeTestPartDesc Hat = { TEXT("Hat"), 3, false, 1, 1, false, false, false, 12, 4 };
+		const FSkelMeshMergeTestPartDesc Ring = { TEXT("Ring"), 2, false, 1, 1, false, false, false, 8, 4 };
+
+		// Name, StripTopLODs, { part, LOD bias, max LOD }, source LODs per merged LOD
+		return {
+			{ TEXT("LODBias"), 0,
+				{ { Body, 0, INDEX_NONE }, { Hat, 1, INDEX_NONE } },
+				{ { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 3 } } },
+			{ TEXT("MaxLOD"), 0,
+				{ { Body, 0, INDEX_NONE }, { Ring, 0, 1 } },
+				{ { 0, 0 }, { 1, 1 }, { 2, INDEX_NONE }, { 3, INDEX_NONE } } },
+			{ TEXT("StripTopLODsWithBias"), 1,
+				{ { Body, 0, INDEX_NONE }, { Hat, 1, INDEX_NONE }, { Ring, 0, 1 } },
+				{ { 1, 2, 1 }, { 2, 3, 2 }, { 3, 3, INDEX_NONE } } },
+		};
+	}
+
+	/**
+	 * Merges parts with LOD biases, max LODs and stripped top LODs, and checks that every merged LOD
+	 * holds exactly the vertices and triangles of the expected source LODs, in a single section.
+	 */
+	void ValidateLODs(FValidationRun& Run, const FLODValidationCase& Case, UMaterialInterface* BaseMaterial)
+	{
+		USkeleton* Skeleton = NewObject<USkeleton>(GetTransientPackage(), NAME_None, RF_Transient);
+		TArray<USkeletalMesh*> Parts;
+		TArray<FSkelMeshMergePart> MergeParts;
+		for (int32 PartIdx = 0; PartIdx < Case.Parts.Num(); PartIdx++)
+		{
+			USkeletalMesh* Part = BuildSkelMeshMergeTestPart(Case.Parts[PartIdx].Desc, Skeleton, BaseMaterial, PartIdx * 100.0f);
+			Parts.Add(Part);
+
+			FSkelMeshMergePart& MergePart = MergeParts[MergeParts.AddDefaulted()];
+			MergePart.SkeletalMesh = Part;
+			MergePart.AttachedBoneName = NAME_None;
+			MergePart.VerticesTransform = FTransform::Identity;
+			MergePart.LODBias = Case.Parts[PartIdx].LODBias;
+			MergePart.MaxLOD = Case.Parts[PartIdx].MaxLOD;
+		}
+
+		USkeletalMesh* MergeMesh = NewObject<USkeletalMesh>(GetTransientPackage(), NAME_None, RF_Transient);
+		MergeMesh->Skeleton = Skeleton;
+
+		const TArray<FSkelMeshMergeSectionMapping> NoSectionMappings;
+		FCustomSkeletalMeshMerge Merger(MergeMesh, BaseMaterial, MergeParts, NoSectionMappings, Case.StripTopLODs, EMeshBufferAccess::ForceCPUAndGPU);
+		Merger.SetCompositeAtlas(false);
+		Merger.MergeMaterial();
+		Merger.PrepareSkeleton();
+		if (!Merger.PrepareMesh())
+		{
+			Run.Fail(TEXT("PrepareMesh failed"));
+			return;
+		}
+
+		const FMergedMeshData& Data = Merger.GetPreparedData();
+		if (Data.LODRenderData.Num() != Case.ExpectedSourceLODs.Num())
+		{
+			Run.Fail(TEXT("%d merged LODs, expected %d"), Data.LODRenderData.Num(), Case.ExpectedSourceLODs.Num());
+			return;
+		}
+
+		for (int32 LODIdx = 0; LODIdx < Data.LODRenderData.Num(); LODIdx++)
+		{
+			uint32 NumVertices = 0;
+			uint32 NumTriangles = 0;
+			for (int32 PartIdx = 0; PartIdx < Parts.Num(); PartIdx++)
+			{
+				const int32 SourceLODIdx = Case.ExpectedSourceLODs[LODIdx][PartIdx];
+				if (SourceLODIdx == INDEX_NONE)
+				{
+					continue;
+				}
+				for (const FSkelMeshRenderSection& Section : Parts[PartIdx]->GetResourceForRendering()->LODRenderData[SourceLODIdx].RenderSections)
+				{
+					NumVertices += Section.NumVertices;
+					NumTriangles += Section.NumTriangles;
+				}
+			}
+
+			const FSkeletalMeshLODRenderData& MergedLOD = Data.LODRenderData[LODIdx];
+			if (MergedLOD.RenderSections.Num() != 1)
+			{
+				Run.Fail(TEXT("LOD %d: %d merged sections, the parts are sized to merge into one"), LODIdx, MergedLOD.RenderSections.Num());
+				continue;
+			}
+
+			const FSkelMeshRenderSection& MergedSection = MergedLOD.RenderSections[0];
+			const uint32 NumMergedVertices = MergedLOD.StaticVertexBuffers.PositionVertexBuffer.GetNumVertices();
+			if (NumMergedVertices != NumVertices || MergedSection.NumVertices != NumVertices)
+			{
+				Run.Fail(TEXT("LOD %d: %u merged vertices, %u in the section, expected %u"), LODIdx, NumMergedVertices, MergedSection.NumVertices, NumVertices);
+			}
+			const int32 NumMergedIndices = MergedLOD.MultiSizeIndexContainer.GetIndexBuffer()->Num();
+			if (NumMergedIndices != (int32)NumTriangles * 3 || MergedSection.NumTriangles != NumTriangles)
+			{
+				Run.Fail(TEXT("LOD %d: %d merged indices, %u triangles in the section, expected %u triangles"), LODIdx, NumMergedIndices, MergedSection.NumTriangles, NumTriangles);
+			}
+		}
+	}
+
+	/** A re-merge of a character, the second merge splicing into the buffers of the first one */
+	struct FIncrementalValidationCase
+	{
+		const TCHAR* Name;
+
+		/** Parts built for the case, merged in the order given by the two index lists */
+		TArray<FSkelMeshMergeTestPartDesc> Parts;
+		TArray<int32> FirstMerge;
+		TArray<int32> SecondMerge;
+
+		/** Gives the first part of the second merge a larger texture before it is merged, moving the atlas regions */
+		bool bChangeAtlas;
+	};
+
+	TArray<FIncrementalValidationCase> GetIncrementalValidationCases()
+	{
+		// Name, chain bones, missing bone, sections, UV sets, extra influences, colors, duplicated vertices, quads, LODs
+		const TArray<FSkelMeshMergeTestPartDesc> Parts = {
+			{ TEXT("Body"), 6, false, 2, 1, false, true, true, 0, 2 },
+			{ TEXT("Head"), 4, false, 1, 2, false, false, false, 0, 2 },
+			{ TEXT("Helmet"), 4, false, 1, 2, false, false, false, 24, 2 },
+			{ TEXT("Legs"), 6, false, 2, 1, true, false, true, 0, 2 } };
+
+		return {
+			{ TEXT("SwapDifferentSize"), Parts, { 0, 1, 3 }, { 0, 2, 3 }, false },
+			{ TEXT("RemovePart"), Parts, { 0, 1, 3 }, { 0, 3 }, false },
+			{ TEXT("AtlasChange"), Parts, { 1, 0, 3 }, { 1, 0, 3 }, true },
+		};
+	}
+
+	/** Merge of parts whose prepared data stays valid as long as it lives, the merger viewing the parts */
+	struct FValidationMerge
+	{
+		TArray<FSkelMeshMergePart> MergeParts;
+		TArray<FSkelMeshMergeSectionMapping> SectionMappings;
+		TUniquePtr<FCustomSkeletalMeshMerge> Merger;
+
+		bool Prepare(const TArray<USkeletalMesh*>& Parts, USkeleton* Skeleton, UMaterialInterface* BaseMaterial, FSkelMeshMergeIncrementalState* IncrementalState)
+		{
+			for (USkeletalMesh* Part : Parts)
+			{
+				FSkelMeshMergePart& MergePart = MergeParts[MergeParts.AddDefaulted()];
+				MergePart.SkeletalMesh = Part;
+				MergePart.AttachedBoneName = NAME_None;
+				MergePart.VerticesTransform = FTransform::Identity;
+			}
+
+			USkeletalMesh* MergeMesh = NewObject<USkeletalMesh>(GetTransientPackage(), NAME_None, RF_Transient);
+			MergeMesh->Skeleton = Skeleton;
+
+			Merger = MakeUnique<FCustomSkeletalMeshMerge>(MergeMesh, BaseMaterial, MergeParts, SectionMappings, 0, EMeshBufferAccess::ForceCPUAndGPU);
+			Merger->SetCompositeAtlas(false);
+			Merger->SetIncrementalState(IncrementalState);
+			Merger->MergeMaterial();
+			Merger->PrepareSkeleton();
+			return Merger->PrepareMesh();
+		}
+	};
+
+	/** Checks that two prepared meshes have the same sections and bit for bit the same buffers */
+	void CompareMergedData(FValidationRun& Run, const FMergedMeshData& Full, const FMergedMeshData& Incremental)
+	{
+		if (Incremental.LODRenderData.Num() != Full.LODRenderData.Num() || Incremental.Materials.Num() != Full.Materials.Num()
+			|| Incremental.RefSkeleton.GetRawBoneNum() != Full.RefSkeleton.GetRawBoneNum() || Incremental.bHasVertexColors != Full.bHasVertexColors)
+		{
+			Run.Fail(TEXT("%d LODs, %d materials and %d bones, the full merge has %d, %d and %d"), Incremental.LODRenderData.Num(), Incremental.Materials.Num(),
+				Incremental.RefSkeleton.GetRawBoneNum(), Full.LODRenderData.Num(), Full.Materials.Num(), Full.RefSkeleton.GetRawBoneNum());
+			return;
+		}
+
+		for (int32 LODIdx = 0; LODIdx < Full.LODRenderData.Num(); LODIdx++)
+		{
+			const FSkeletalMeshLODRenderData& FullLOD = Full.LODRenderData[LODIdx];
+			const FSkeletalMeshLODRenderData& IncrementalLOD = Incremental.LODRenderData[LODIdx];
+
+			if (IncrementalLOD.RenderSections.Num() != FullLOD.RenderSections.Num())
+			{
+				Run.Fail(TEXT("LOD %d: %d sections, the full merge has %d"), LODIdx, IncrementalLOD.RenderSections.Num(), FullLOD.RenderSections.Num());
+				continue;
+			}
+			for (int32 SectionIdx = 0; SectionIdx < FullLOD.RenderSections.Num(); SectionIdx++)
+			{
+				const FSkelMeshRenderSection& FullSection = FullLOD.RenderSections[SectionIdx];
+				const FSkelMeshRenderSection& IncrementalSection = IncrementalLOD.RenderSections[SectionIdx];
+				if (IncrementalSection.MaterialIndex != FullSection.MaterialIndex || IncrementalSection.BaseIndex != FullSection.BaseIndex
+					|| IncrementalSection.NumTriangles != FullSection.NumTriangles || IncrementalSection.BaseVertexIndex != FullSection.BaseVertexIndex
+					|| IncrementalSection.NumVertices != FullSection.NumVertices || IncrementalSection.MaxBoneInfluences != FullSection.MaxBoneInfluences
+					|| IncrementalSection.BoneMap != FullSection.BoneMap)
+				{
+					Run.Fail(TEXT("LOD %d section %d: %u vertices and %u triangles at %u and %u, the full merge has %u and %u at %u and %u, or another material or bone map"),
+						LODIdx, SectionIdx, IncrementalSection.NumVertices, IncrementalSection.NumTriangles, IncrementalSection.BaseVertexIndex, IncrementalSection.BaseIndex,
+						FullSection.NumVertices, FullSection.NumTriangles, FullSection.BaseVertexIndex, FullSection.BaseIndex);
+				}
+
+				FDuplicatedVerticesBuffer& FullDupVerts = const_cast<FDuplicatedVerticesBuffer&>(FullSection.DuplicatedVerticesBuffer);
+				FDuplicatedVerticesBuffer& IncrementalDupVerts = const_cast<FDuplicatedVerticesBuffer&>(IncrementalSection.DuplicatedVerticesBuffer);
+				if (IncrementalDupVerts.bHasOverlappingVertices != FullDupVerts.bHasOverlappingVertices
+					|| IncrementalDupVerts.DupVertData.Num() != FullDupVerts.DupVertData.Num() || IncrementalDupVerts.DupVertIndexData.Num() != FullDupVerts.DupVertIndexData.Num()
+					|| FMemory::Memcmp(IncrementalDupVerts.DupVertData.GetDataPointer(), FullDupVerts.DupVertData.GetDataPointer(), FullDupVerts.DupVertData.Num() * sizeof(uint32)) != 0
+					|| FMemory::Memcmp(IncrementalDupVerts.DupVertIndexData.GetDataPointer(), FullDupVerts.DupVertIndexData.GetDataPointer(), FullDupVerts.DupVertIndexData.Num() * sizeof(FIndexLengthPair)) != 0)
+				{
+					Run.Fail(TEXT("LOD %d section %d: duplicated vertices differ from the full merge"), LODIdx, SectionIdx);
+				}
+			}
+
+			const FStaticMeshVertexBuffers& FullBuffers = FullLOD.StaticVertexBuffers;
+			const FStaticMeshVertexBuffers& IncrementalBuffers = IncrementalLOD.StaticVertexBuffers;
+			const uint32 NumVertices = FullBuffers.PositionVertexBuffer.GetNumVertices();
+			const uint32 NumTexCoords = FullBuffers.StaticMeshVertexBuffer.GetNumTexCoords();
+			if (IncrementalBuffers.PositionVertexBuffer.GetNumVertices() != NumVertices || IncrementalBuffers.StaticMeshVertexBuffer.GetNumTexCoords() != NumTexCoords
+				|| IncrementalBuffers.ColorVertexBuffer.GetNumVertices() != FullBuffers.ColorVertexBuffer.GetNumVertices()
+				|| IncrementalLOD.SkinWeightVertexBuffer.HasExtraBoneInfluences() != FullLOD.SkinWeightVertexBuffer.HasExtraBoneInfluences())
+			{
+				Run.Fail(TEXT("LOD %d: %u vertices with %u UV sets, the full merge has %u with %u, or other colors or influences"), LODIdx,
+					IncrementalBuffers.PositionVertexBuffer.GetNumVertices(), IncrementalBuffers.StaticMeshVertexBuffer.GetNumTexCoords(), NumVertices, NumTexCoords);
+				continue;
+			}
+
+			const bool bHasColors = FullBuffers.ColorVertexBuffer.GetNumVertices() > 0;
+			for (uint32 VertIdx = 0; VertIdx < NumVertices; VertIdx++)
+			{
+				bool bSame = FMemory::Memcmp(&IncrementalBuffers.PositionVertexBuffer.VertexPosition(VertIdx), &FullBuffers.PositionVertexBuffer.VertexPosition(VertIdx), sizeof(FVector)) == 0
+					&& IncrementalBuffers.StaticMeshVertexBuffer.VertexTangentX(VertIdx) == FullBuffers.StaticMeshVertexBuffer.VertexTangentX(VertIdx)
+					&& IncrementalBuffers.StaticMeshVertexBuffer.VertexTangentZ(VertIdx) == FullBuffers.StaticMeshVertexBuffer.VertexTangentZ(VertIdx);
+				for (uint32 UVIndex = 0; UVIndex < NumTexCoords; UVIndex++)
+				{
+					const FVector2D FullUV = FullBuffers.StaticMeshVertexBuffer.GetVertexUV(VertIdx, UVIndex);
+					const FVector2D IncrementalUV = IncrementalBuffers.StaticMeshVertexBuffer.GetVertexUV(VertIdx, UVIndex);
+					bSame &= FMemory::Memcmp(&IncrementalUV, &FullUV, sizeof(FVector2D)) == 0;
+				}
+
+				uint8 FullBones[MAX_TOTAL_INFLUENCES];
+				uint8 FullWeights[MAX_TOTAL_INFLUENCES];
+				uint8 IncrementalBones[MAX_TOTAL_INFLUENCES];
+				uint8 IncrementalWeights[MAX_TOTAL_INFLUENCES];
+				GetInfluences(FullLOD.SkinWeightVertexBuffer, VertIdx, FullBones, FullWeights);
+				GetInfluences(IncrementalLOD.SkinWeightVertexBuffer, VertIdx, IncrementalBones, IncrementalWeights);
+				bSame &= FMemory::Memcmp(IncrementalBones, FullBones, sizeof(FullBones)) == 0 && FMemory::Memcmp(IncrementalWeights, FullWeights, sizeof(FullWeights)) == 0;
+
+				if (bHasColors)
+				{
+					bSame &= IncrementalBuffers.ColorVertexBuffer.VertexColor(VertIdx) == FullBuffers.ColorVertexBuffer.VertexColor(VertIdx);
+				}
+
+				if (!bSame)
+				{
+					Run.Fail(TEXT("LOD %d vertex %u differs from the full merge"), LODIdx, VertIdx);
+				}
+			}
+
+			const FRawStaticIndexBuffer16or32Interface* FullIndices = FullLOD.MultiSizeIndexContainer.GetIndexBuffer();
+			const FRawStaticIndexBuffer16or32Interface* IncrementalIndices = IncrementalLOD.MultiSizeIndexContainer.GetIndexBuffer();
+			if (IncrementalIndices->Num() != FullIndices->Num())
+			{
+				Run.Fail(TEXT("LOD %d: %d indices, the full merge has %d"), LODIdx, IncrementalIndices->Num(), FullIndices->Num());
+				continue;
+			}
+			for (int32 IndexIdx = 0; IndexIdx < FullIndices->Num(); IndexIdx++)
+			{
+				if (IncrementalIndices->Get(IndexIdx) != FullIndices->Get(IndexIdx))
+				{
+					Run.Fail(TEXT("LOD %d index %d: %u, the full merge has %u"), LODIdx, IndexIdx, IncrementalIndices->Get(IndexIdx), FullIndices->Get(IndexIdx));
+				}
+			}
+
+			if (IncrementalLOD.ActiveBoneIndices != FullLOD.ActiveBoneIndices || IncrementalLOD.RequiredBones != FullLOD.RequiredBones)
+			{
+				Run.Fail(TEXT("LOD %d: active or required bones differ from the full merge"), LODIdx);
+			}
+		}
+	}
+
+	/** @return Whether two atlas layouts place the same regions on atlases of the same size. */
+	bool AreAtlasLayoutsEqual(const FCustomSkeletalMeshMergeAtlasLayout& A, const FCustomSkeletalMeshMergeAtlasLayout& B)
+	{
+		if (A.Boxes.Num() != B.Boxes.Num() || A.Properties.Num() != B.Properties.Num())
+		{
+			return false;
+		}
+		for (int32 BoxIdx = 0; BoxIdx < A.Boxes.Num(); BoxIdx++)
+		{
+			if (A.Boxes[BoxIdx].Min != B.Boxes[BoxIdx].Min || A.Boxes[BoxIdx].Max != B.Boxes[BoxIdx].Max)
+			{
+				return false;
+			}
+		}
+		for (int32 PropertyIdx = 0; PropertyIdx < A.Properties.Num(); PropertyIdx++)
+		{
+			if (A.Properties[PropertyIdx].Size != B.Properties[PropertyIdx].Size)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * Merges the first part list, re-merges the second one incrementally into the buffers of the first
+	 * merge, then merges the second part list from scratch. The incremental re-merge must give the
+	 * prepared data of the full merge, and must have reused sections of parts it kept.
+	 */
+	void ValidateIncrementalMerge(FValidationRun& Run, const FIncrementalValidationCase& Case, UMaterialInterface* BaseMaterial)
+	{
+		USkeleton* Skeleton = NewObject<USkeleton>(GetTransientPackage(), NAME_None, RF_Transient);
+		TArray<USkeletalMesh*> Parts;
+		for (int32 PartIdx = 0; PartIdx < Case.Parts.Num(); PartIdx++)
+		{
+			Parts.Add(BuildSkelMeshMergeTestPart(Case.Parts[PartIdx], Skeleton, BaseMaterial, PartIdx * 100.0f));
+		}
+
+		TArray<USkeletalMesh*> FirstParts;
+		for (int32 PartIdx : Case.FirstMerge)
+		{
+			FirstParts.Add(Parts[PartIdx]);
+		}
+		TArray<USkeletalMesh*> SecondParts;
+		for (int32 PartIdx : Case.SecondMerge)
+		{
+			SecondParts.Add(Parts[PartIdx]);
+		}
+
+		FSkelMeshMergeIncrementalState IncrementalState;
+		FValidationMerge FirstMerge;
+		if (!FirstMerge.Prepare(FirstParts, Skeleton, BaseMaterial, &IncrementalState))
+		{
+			Run.Fail(TEXT("PrepareMesh of the first merge failed"));
+			return;
+		}
+
+		if (Case.bChangeAtlas)
+		{
+			UMaterialInstanceDynamic* Material = CastChecked<UMaterialInstanceDynamic>(SecondParts[0]->Materials[0].MaterialInterface);
+			Material->SetTextureParameterValue(TEXT("MainTexture"), UTexture2D::CreateTransient(512, 512));
+		}
+
+		FValidationMerge IncrementalMerge;
+		if (!IncrementalMerge.Prepare(SecondParts, Skeleton, BaseMaterial, &IncrementalState))
+		{
+			Run.Fail(TEXT("PrepareMesh of the incremental merge failed"));
+			return;
+		}
+		const int32 NumReusedSections = IncrementalState.NumReusedSections;
+
+		FValidationMerge FullMerge;
+		if (!FullMerge.Prepare(SecondParts, Skeleton, BaseMaterial, nullptr))
+		{
+			Run.Fail(TEXT("PrepareMesh of the full merge failed"));
+			return;
+		}
+
+		FCustomSkeletalMeshMergeAtlasLayout FirstLayout;
+		FCustomSkeletalMeshMergeAtlasLayout SecondLayout;
+		FirstMerge.Merger->GetAtlasLayout(FirstLayout);
+		IncrementalMerge.Merger->GetAtlasLayout(SecondLayout);
+		if (Case.bChangeAtlas && AreAtlasLayoutsEqual(FirstLayout, SecondLayout))
+		{
+			Run.Fail(TEXT("The larger texture did not change the atlas layout"));
+		}
+		if (!Case.bChangeAtlas && NumReusedSections == 0)
+		{
+			Run.Fail(TEXT("The incremental merge reused no section of the parts it kept"));
+		}
+
+		CompareMergedData(Run, FullMerge.Merger->GetPreparedData(), IncrementalMerge.Merger->GetPreparedData());
+	}
+
+	/**
+	 * Merges three times into the same mesh, each merge recycling the LOD render data committed by the previous
+	 * one: parts of other vertex counts first, then the same parts twice. Every merge must refill the recycled
+	 * LODs and give the data of a merge into a new mesh; only the repeated merge may write its buffers in place.
+	 */
+	void ValidateRecycledMerge(FValidationRun& Run, UMaterialInterface* BaseMaterial)
+	{
+		USkeleton* Skeleton = NewObject<USkeleton>(GetTransientPackage(), NAME_None, RF_Transient);
+		const FSkelMeshMergeTestPartDesc PartDescs[] = {
+			{ TEXT("Body"), 6, false, 2, 2, false, true, false, 32, 2 },
+			{ TEXT("Head"), 4, false, 1, 1, false, true, false, 8, 2 },
+			{ TEXT("Hat"), 3, false, 1, 1, false, true, false, 12, 2 } };
+
+		TArray<USkeletalMesh*> Parts;
+		for (int32 PartIdx = 0; PartIdx < ARRAY_COUNT(PartDescs); PartIdx++)
+		{
+			Parts.Add(BuildSkelMeshMergeTestPart(PartDescs[PartIdx], Skeleton, BaseMaterial, PartIdx * 100.0f));
+		}
+		const TArray<USkeletalMesh*> MergedParts[] = { { Parts[0], Parts[2] }, { Parts[0], Parts[1] }, { Parts[0], Parts[1] } };
+
+		USkeletalMesh* MergeMesh = NewObject<USkeletalMesh>(GetTransientPackage(), NAME_None, RF_Transient);
+		MergeMesh->Skeleton = Skeleton;
+
+		const TArray<FSkelMeshMergeSectionMapping> NoSectionMappings;
+		TArray<const FSkeletalMeshLODRenderData*> CommittedLODs;
+		for (int32 MergeIdx = 0; MergeIdx < ARRAY_COUNT(MergedParts); MergeIdx++)
+		{
+			TArray<FSkelMeshMergePart> MergeParts;
+			for (USkeletalMesh* Part : MergedParts[MergeIdx])
+			{
+				FSkelMeshMergePart& MergePart = MergeParts[MergeParts.AddDefaulted()];
+				MergePart.SkeletalMesh = Part;
+				MergePart.AttachedBoneName = NAME_None;
+				MergePart.VerticesTransform = FTransform::Identity;
+			}
+
+			FCustomSkeletalMeshMergeReport Report;
+			FCustomSkeletalMeshMerge Merger(MergeMesh, BaseMaterial, MergeParts, NoSectionMappings, 0, EMeshBufferAccess::ForceCPUAndGPU);
+			Merger.SetCompositeAtlas(false);
+			Merger.SetReport(&Report);
+			Merger.RecycleRenderData();
+			Merger.MergeMaterial();
+			Merger.PrepareSkeleton();
+			if (!Merger.PrepareMesh())
+			{
+				Run.Fail(TEXT("Merge %d: PrepareMesh failed"), MergeIdx);
+				return;
+			}
+
+			const FMergedMeshData& Data = Merger.GetPreparedData();
+			for (int32 LODIdx = 0; LODIdx < FMath::Min(CommittedLODs.Num(), Data.LODRenderData.Num()); LODIdx++)
+			{
+				if (&Data.LODRenderData[LODIdx] != CommittedLODs[LODIdx])
+				{
+					Run.Fail(TEXT("Merge %d: LOD %d was allocated again instead of recycled"), MergeIdx, LODIdx);
+				}
+			}
+			const int32 ExpectedLODsFilledInPlace = (MergeIdx == 2) ? Data.LODRenderData.Num() : 0;
+			if (Report.NumLODsFilledInPlace != ExpectedLODsFilledInPlace)
+			{
+				Run.Fail(TEXT("Merge %d: %d LODs filled in place, expected %d"), MergeIdx, Report.NumLODsFilledInPlace, ExpectedLODsFilledInPlace);
+			}
+
+			FValidationMerge NewMeshMerge;
+			if (!NewMeshMerge.Prepare(MergedParts[MergeIdx], Skeleton, BaseMaterial, nullptr))
+			{
+				Run.Fail(TEXT("Merge %d: PrepareMesh into a new mesh failed"), MergeIdx);
+				return;
+			}
+			CompareMergedData(Run, NewMeshMerge.Merger->GetPreparedData(), Data);
+
+			CommittedLODs.Reset();
+			for (const FSkeletalMeshLODRenderData& LODData : Data.LODRenderData)
+			{
+				CommittedLODs.Add(&LODData);
+			}
+			Merger.CommitMerge();
+		}
+	}
+}
+
+/**
+* Builds skeletal mesh parts in memory, with varied bones, sections, UV sets, bone influences,
+* vertex colors and duplicated vertices, merges them and checks the prepared data against the parts.
+* Every case is merged with the part cache turned off, cold and warm, the cached merges giving the exact
+* UVs of the uncached one. The sockets of the parts and their skeleton are checked on the committed
+* merged mesh, and parts with LOD biases and max LODs are checked for the source LODs each merged LOD
+* takes. Incremental re-merges that swap a part, remove one or move the atlas regions must give the
+* data of a full merge, as must merges that refill the LOD render data recycled from the previous content
+* of the merged mesh. Needs no content and no renderer, so it runs with -nullrhi on a build machine:
+*
+*   -ExecCmds="Automation RunTests SkeletalMeshMerge.Validation; Quit" -unattended -nullrhi
+*/
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCustomSkeletalMeshMergeValidationTest, "SkeletalMeshMerge.Validation",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FCustomSkeletalMeshMergeValidationTest::RunTest(const FString& Parameters)
+{
+	IConsoleVariable* PartCacheVariable = IConsoleManager::Get().FindConsoleVariable(TEXT("SkeletalMeshMerge.PartCache"));
+	check(PartCacheVariable);
+	const int32 SavedPartCache = PartCacheVariable->GetInt();
+
+	FCustomSkeletalMeshMergePartCache& PartCache = FCustomSkeletalMeshMergePartCache::Get();
+	UMaterialInterface* BaseMaterial = UMaterial::GetDefaultMaterial(MD_Surface);
+
+	// the part cache converts the sources once and splices them on later merges, both paths must agree with the uncached one
+	const TCHAR* PartCacheModes[] = { TEXT("off"), TEXT("cold"), TEXT("warm") };
+
+	int32 NumRuns = 0;
+	int32 NumFailed = 0;
+	auto CountRun = [this, &NumRuns, &NumFailed](const FValidationRun& Run)
+	{
+		NumRuns++;
+		if (Run.NumErrors > 0)
+		{
+			AddError(FString::Printf(TEXT("%s failed with %d mismatches"), *Run.Name, Run.NumErrors));
+			NumFailed++;
+		}
+	};
+
+	for (const FValidationCase& Case : GetValidationCases())
+	{
+		USkeleton* Skeleton = NewObject<USkeleton>(GetTransientPackage(), NAME_None, RF_Transient);
+		TArray<USkeletalMesh*> Parts;
+		for (int32 PartIdx = 0; PartIdx < Case.Parts.Num(); PartIdx++)
+		{
+			Parts.Add(BuildSkelMeshMergeTestPart(Case.Parts[PartIdx], Skeleton, BaseMaterial, PartIdx * 100.0f));
+		}
+
+		PartCache.Empty();
+		TArray<FVector2D> UncachedUVs;
+		for (int32 ModeIdx = 0; ModeIdx < ARRAY_COUNT(PartCacheModes); ModeIdx++)
+		{
+			PartCacheVariable->Set(ModeIdx > 0 ? 1 : 0, ECVF_SetByCode);
+
+			FValidationRun Run(*this, FString::Printf(TEXT("%s, part cache %s"), Case.Name, PartCacheModes[ModeIdx]));
+			TArray<FVector2D> UVs;
+			MergeAndValidate(Run, Parts, Skeleton, BaseMaterial, UVs);
+
+			// the UVs are rounded to the merged UV type, the cache must round them exactly the same way
+			if (ModeIdx == 0)
+			{
+				UncachedUVs = MoveTemp(UVs);
+			}
+			else
+			{
+				CompareUVs(Run, UncachedUVs, UVs);
+			}
+
+			CountRun(Run);
+		}
+	}
+
+	// re-merges must splice the same buffers whether the spliced sections come from the part cache or not
+	for (const FIncrementalValidationCase& Case : GetIncrementalValidationCases())
+	{
+		for (int32 ModeIdx = 0; ModeIdx < 2; ModeIdx++)
+		{
+			PartCacheVariable->Set(ModeIdx, ECVF_SetByCode);
+			PartCache.Empty();
+
+			FValidationRun Run(*this, FString::Printf(TEXT("Incremental, %s, part cache %s"), Case.Name, PartCacheModes[ModeIdx]));
+			ValidateIncrementalMerge(Run, Case, BaseMaterial);
+			CountRun(Run);
+		}
+	}
+
+	PartCacheVariable->Set(SavedPartCache, ECVF_SetByCode);
+	PartCache.Empty();
+
+	for (int32 SkeletonIdx = 0; SkeletonIdx < 2; SkeletonIdx++)
+	{
+		const bool bMergeMeshSkeleton = SkeletonIdx > 0;
+		FValidationRun Run(*this, FString::Printf(TEXT("Sockets, merged mesh %s"), bMergeMeshSkeleton ? TEXT("with skeleton") : TEXT("without skeleton")));
+		ValidateSockets(Run, BaseMaterial, bMergeMeshSkeleton);
+		CountRun(Run);
+	}
+
+	for (const FLODValidationCase& Case : GetLODValidationCases())
+	{
+		FValidationRun Run(*this, FString::Printf(TEXT("LODs, %s"), Case.Name));
+		ValidateLODs(Run, Case, BaseMaterial);
+		CountRun(Run);
+	}
+
+	{
+		FValidationRun Run(*this, TEXT("Recycled render data"));
+		ValidateRecycledMerge(Run, BaseMaterial);
+		CountRun(Run);
+	}
+
+	AddInfo(FString::Printf(TEXT("%d of %d merges passed"), NumRuns - NumFailed, NumRuns));
+	return NumFailed == 0;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
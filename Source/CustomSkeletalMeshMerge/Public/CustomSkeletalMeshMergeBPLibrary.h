@@ -10,6 +10,13 @@ struct FCustomSkelMeshMergePart_BP
 {
 	GENERATED_BODY()
 
+	FCustomSkelMeshMergePart_BP()
+	{
+		SkeletalMesh = nullptr;
+		LODBias = 0;
+		MaxLOD = INDEX_NONE;
+	}
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mesh Merge Params")
 	USkeletalMesh* SkeletalMesh;
 
@@ -18,6 +25,16 @@ struct FCustomSkelMeshMergePart_BP
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mesh Merge Params")
 	FTransform VerticesTransform;
+
+	// Number of LODs the part is shifted by, e.g. 1 merges its LOD1 into the merged LOD0.
+	// Parts without enough LODs use their last one.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mesh Merge Params", meta = (ClampMin = "0"))
+	int32 LODBias;
+
+	// Last merged LOD the part is merged into, it is left out of the lower LODs.
+	// -1 merges the part into every LOD.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mesh Merge Params", meta = (ClampMin = "-1"))
+	int32 MaxLOD;
 };
 
 USTRUCT(BlueprintType)
@@ -43,7 +60,10 @@ struct  FCustomSkeletalMeshMergeParams
 		StripTopLODS = 0;
 		bNeedsCpuAccess = false;
 		bSkeletonBefore = false;
+		bIncremental = false;
 		Skeleton = nullptr;
+		PreviousMergedMesh = nullptr;
+		bMergeInPlace = false;
 	}
 
 	// An optional array to map sections from the source meshes to merged section entries
@@ -75,6 +95,187 @@ struct  FCustomSkeletalMeshMergeParams
 	// Material that will be used for the merged mesh.
 	UPROPERTY(EditAnywhere, BlueprintReadOnly)
 	class UMaterialInterface* BaseMaterial;
+
+	// Keep the processed parts of this merge so that a later merge passing the result
+	// as PreviousMergedMesh only reprocesses the parts that changed.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	uint32 bIncremental : 1;
+
+	// Mesh returned by an earlier incremental merge of the same character.
+	// Parts that did not change since then are reused instead of being merged again.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	class USkeletalMesh* PreviousMergedMesh;
+
+	// Rebuild PreviousMergedMesh itself instead of a new mesh, refilling its LOD render data. Skipped when other
+	// requests share the previous mesh or a component still shows it; release PreviousMergedMesh only if a
+	// different mesh is returned. A failed rebuild returns no mesh and has released PreviousMergedMesh.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	uint32 bMergeInPlace : 1;
+};
+
+/**
+* Footprint and activity of the merged mesh and atlas cache.
+*/
+USTRUCT(BlueprintType)
+struct FCustomSkeletalMeshMergeCacheStats
+{
+	GENERATED_BODY()
+
+	FCustomSkeletalMeshMergeCacheStats()
+	{
+		NumMeshes = 0;
+		NumAtlases = 0;
+		CPUBytes = 0;
+		GPUBytes = 0;
+		BudgetBytes = 0;
+		NumEvictions = 0;
+	}
+
+	// Number of cached merged meshes.
+	UPROPERTY(BlueprintReadOnly, Category = "Mesh Merge Cache")
+	int32 NumMeshes;
+
+	// Number of cached material atlases.
+	UPROPERTY(BlueprintReadOnly, Category = "Mesh Merge Cache")
+	int32 NumAtlases;
+
+	// CPU memory held by cached entries.
+	UPROPERTY(BlueprintReadOnly, Category = "Mesh Merge Cache")
+	int64 CPUBytes;
+
+	// GPU memory held by cached entries.
+	UPROPERTY(BlueprintReadOnly, Category = "Mesh Merge Cache")
+	int64 GPUBytes;
+
+	// Combined budget after which unreferenced entries are evicted.
+	UPROPERTY(BlueprintReadOnly, Category = "Mesh Merge Cache")
+	int64 BudgetBytes;
+
+	// Number of entries evicted so far.
+	UPROPERTY(BlueprintReadOnly, Category = "Mesh Merge Cache")
+	int32 NumEvictions;
+};
+
+/**
+* Where the merged mesh returned by a merge came from.
+*/
+UENUM(BlueprintType)
+enum class ECustomSkeletalMeshMergeSource : uint8
+{
+	// The meshes were merged.
+	Merged,
+	// An identical earlier request's mesh was shared.
+	SharedMesh,
+	// The merged data was baked at cook time.
+	Prebaked,
+	// The merged data was loaded from the persistent cache.
+	PersistentCache,
+};
+
+/**
+* Size of one LOD of a merged mesh.
+*/
+USTRUCT(BlueprintType)
+struct FCustomSkeletalMeshMergeLODReport
+{
+	GENERATED_BODY()
+
+	FCustomSkeletalMeshMergeLODReport()
+	{
+		NumVertices = 0;
+		NumIndices = 0;
+		NumSections = 0;
+		NumBones = 0;
+	}
+
+	UPROPERTY(BlueprintReadOnly, Category = "Mesh Merge Report")
+	int32 NumVertices;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Mesh Merge Report")
+	int32 NumIndices;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Mesh Merge Report")
+	int32 NumSections;
+
+	// Bones skinned by the vertices of the LOD.
+	UPROPERTY(BlueprintReadOnly, Category = "Mesh Merge Report")
+	int32 NumBones;
+};
+
+/**
+* Cost and size of a single merge.
+*/
+USTRUCT(BlueprintType)
+struct FCustomSkeletalMeshMergeReport
+{
+	GENERATED_BODY()
+
+	FCustomSkeletalMeshMergeReport()
+	{
+		Source = ECustomSkeletalMeshMergeSource::Merged;
+		TotalMs = 0.0f;
+		MergeMaterialMs = 0.0f;
+		TextureWaitMs = 0.0f;
+		MergeSkeletonMs = 0.0f;
+		MergeMeshMs = 0.0f;
+		CommitMs = 0.0f;
+		AtlasOccupancy = 0.0f;
+		AtlasScale = 0.0f;
+		NumReallocations = 0;
+		NumLODsFilledInPlace = 0;
+		PeakIntermediateBytes = 0;
+	}
+
+	UPROPERTY(BlueprintReadOnly, Category = "Mesh Merge Report")
+	ECustomSkeletalMeshMergeSource Source;
+
+	// Time spent in the whole request, in milliseconds.
+	UPROPERTY(BlueprintReadOnly, Category = "Mesh Merge Report")
+	float TotalMs;
+
+	// Time spent packing the atlas and compositing its textures, in milliseconds.
+	UPROPERTY(BlueprintReadOnly, Category = "Mesh Merge Report")
+	float MergeMaterialMs;
+
+	// Part of MergeMaterialMs spent waiting for source textures to stream in, in milliseconds.
+	UPROPERTY(BlueprintReadOnly, Category = "Mesh Merge Report")
+	float TextureWaitMs;
+
+	// Time spent building the merged skeleton, in milliseconds.
+	UPROPERTY(BlueprintReadOnly, Category = "Mesh Merge Report")
+	float MergeSkeletonMs;
+
+	// Time spent building, or loading, the merged render data, in milliseconds.
+	UPROPERTY(BlueprintReadOnly, Category = "Mesh Merge Report")
+	float MergeMeshMs;
+
+	// Game thread time spent applying the merge to the mesh, in milliseconds.
+	UPROPERTY(BlueprintReadOnly, Category = "Mesh Merge Report")
+	float CommitMs;
+
+	// Fraction of the atlas covered by source textures.
+	UPROPERTY(BlueprintReadOnly, Category = "Mesh Merge Report")
+	float AtlasOccupancy;
+
+	// Smallest scale applied to a source texture to fit it in the atlas, 1 if none was shrunk.
+	UPROPERTY(BlueprintReadOnly, Category = "Mesh Merge Report")
+	float AtlasScale;
+
+	// Number of intermediate buffers that grew past the size reserved for them.
+	UPROPERTY(BlueprintReadOnly, Category = "Mesh Merge Report")
+	int32 NumReallocations;
+
+	// Number of merged LODs written over the buffers recycled from the previous content of the mesh.
+	UPROPERTY(BlueprintReadOnly, Category = "Mesh Merge Report")
+	int32 NumLODsFilledInPlace;
+
+	// Largest size of the intermediate buffers of a single LOD.
+	UPROPERTY(BlueprintReadOnly, Category = "Mesh Merge Report")
+	int64 PeakIntermediateBytes;
+
+	// Size of every merged LOD, empty for shared meshes.
+	UPROPERTY(BlueprintReadOnly, Category = "Mesh Merge Report")
+	TArray<FCustomSkeletalMeshMergeLODReport> LODs;
 };
 
 UCLASS()
@@ -89,4 +290,26 @@ public:
 	//UFUNCTION(BlueprintCallable, Category = "Mesh Merge", meta = (UnsafeDuringActorConstruction = "true"))
 	UFUNCTION(BlueprintCallable, Category = "Mesh Merge")
 	static class USkeletalMesh* MergeMeshes(const FCustomSkeletalMeshMergeParams& Params);
+
+	/**
+	* Merges the given meshes into a single mesh, like MergeMeshes, and reports what the merge cost.
+	* @return The merged mesh (will be invalid if the merge failed).
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Mesh Merge")
+	static class USkeletalMesh* MergeMeshesWithReport(const FCustomSkeletalMeshMergeParams& Params, FCustomSkeletalMeshMergeReport& OutReport);
+
+	/**
+	* Identical merge requests share one merged mesh. Call this once for every mesh returned by
+	* MergeMeshes when it is no longer used, so the shared mesh can be dropped and the mesh object
+	* reused by a later merge.
+	* @return Whether the mesh was returned by MergeMeshes.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Mesh Merge")
+	static bool ReleaseMergedMesh(class USkeletalMesh* MergedMesh);
+
+	/**
+	* @return The current footprint, budget and eviction count of the merged mesh and atlas cache.
+	*/
+	UFUNCTION(BlueprintPure, Category = "Mesh Merge")
+	static FCustomSkeletalMeshMergeCacheStats GetMergeCacheStats();
 };
@@ -0,0 +1,103 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+/*=============================================================================
+	CustomSkeletalMeshMergeComponent.h: Merges off the game thread, showing the parts meanwhile.
+=============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Async/Future.h"
+#include "CustomSkeletalMeshMergeBPLibrary.h"
+#include "CustomSkeletalMeshMergeComponent.generated.h"
+
+class USkeletalMesh;
+class USkeletalMeshComponent;
+class FSkelMeshMergeJob;
+struct FSkelMeshMergeRequest;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnCustomSkeletalMeshMerged, USkeletalMesh*, MergedMesh);
+
+/**
+* Merges the parts of a skeletal mesh component on a worker thread. Until the merge is done the parts are
+* shown as separate components following the pose of the target, then the target switches to the merged
+* mesh and the part components are destroyed in the same frame. The merged mesh is released when play ends.
+*/
+UCLASS(ClassGroup = (Rendering), meta = (BlueprintSpawnableComponent))
+class CUSTOMSKELETALMESHMERGE_API UCustomSkeletalMeshMergeComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UCustomSkeletalMeshMergeComponent();
+
+	/**
+	 * Starts merging the parts for a component, cancelling a pending merge.
+	 * The merged mesh of the previous merge is passed as PreviousMergedMesh of incremental and in place merges
+	 * that have none, and is released once the target switched to another mesh. In place merges show the
+	 * parts before they start, so the previous mesh is no longer shown when it is rebuilt.
+	 * @param TargetComponent - component showing the merged mesh; the first part not attached to a bone meanwhile
+	 * @param Params - merge parameters
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Mesh Merge")
+	void StartMerge(USkeletalMeshComponent* TargetComponent, const FCustomSkeletalMeshMergeParams& Params);
+
+	/** @return Whether a merge was started and the target does not show its result yet. */
+	UFUNCTION(BlueprintPure, Category = "Mesh Merge")
+	bool IsMergePending() const;
+
+	/** @return Mesh shown by the target since the last merge that succeeded. */
+	UFUNCTION(BlueprintPure, Category = "Mesh Merge")
+	USkeletalMesh* GetMergedMesh() const { return MergedMesh; }
+
+	/** Called once the target switched to the merged mesh, or with nullptr if the merge failed and the parts stay shown */
+	UPROPERTY(BlueprintAssignable, Category = "Mesh Merge")
+	FOnCustomSkeletalMeshMerged OnMerged;
+
+	//~ Begin UActorComponent Interface
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void OnComponentDestroyed(bool bDestroyingHierarchy) override;
+	//~ End UActorComponent Interface
+
+	static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);
+
+private:
+	/** Shows the pending parts as the target mesh and follower components */
+	void ShowParts();
+
+	/** Switches the target to a merged mesh and destroys the followers */
+	void ShowMergedMesh(USkeletalMesh* NewMergedMesh);
+
+	/** Commits the prepared merge once the worker is done */
+	void FinishMerge();
+
+	/** Waits for the worker and gives back the merge mesh of a pending merge */
+	void CancelMerge();
+
+	void DestroyFollowers();
+
+	/** Component showing the merged mesh */
+	UPROPERTY(Transient)
+	USkeletalMeshComponent* Target;
+
+	/** Parameters of the pending merge, keeping its source objects alive */
+	UPROPERTY(Transient)
+	FCustomSkeletalMeshMergeParams PendingParams;
+
+	/** Components showing the parts other than the one shown by the target */
+	UPROPERTY(Transient)
+	TArray<USkeletalMeshComponent*> Followers;
+
+	UPROPERTY(Transient)
+	USkeletalMesh* MergedMesh;
+
+	/** Parts of the pending merge, viewed by the job */
+	TSharedPtr<FSkelMeshMergeRequest, ESPMode::ThreadSafe> PendingRequest;
+
+	TSharedPtr<FSkelMeshMergeJob, ESPMode::ThreadSafe> PendingJob;
+
+	/** Completes once the worker prepared the pending merge */
+	TFuture<void> PendingPrepare;
+};
@@ -11,4 +11,10 @@ public:
 	/** IModuleInterface implementation */
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
+
+private:
+	/** Fills the merge caches from baked content once assets can be loaded */
+	void OnPostEngineInit();
+
+	FDelegateHandle PostEngineInitHandle;
 };
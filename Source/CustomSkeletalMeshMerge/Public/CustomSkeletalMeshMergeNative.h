@@ -0,0 +1,114 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+/*=============================================================================
+	CustomSkeletalMeshMergeNative.h: Merge entry point for native callers.
+=============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+
+class USkeletalMesh;
+class USkeleton;
+class UMaterialInterface;
+struct FCustomSkeletalMeshMergeReport;
+
+/**
+* Source mesh of a merge and where its vertices go in the merged mesh.
+*/
+struct FSkelMeshMergePart
+{
+	USkeletalMesh* SkeletalMesh;
+	FName AttachedBoneName;
+	FTransform VerticesTransform;
+
+	/** Number of LODs the part is shifted by, clamped to its last LOD */
+	int32 LODBias;
+
+	/** Last merged LOD the part is merged into, or INDEX_NONE for every LOD */
+	int32 MaxLOD;
+
+	FSkelMeshMergePart()
+		: SkeletalMesh(nullptr)
+		, LODBias(0)
+		, MaxLOD(INDEX_NONE)
+	{}
+};
+
+/**
+* Info to map all the sections from a single source skeletal mesh to
+* a final section entry int he merged skeletal mesh
+*/
+struct FSkelMeshMergeSectionMapping
+{
+	/** indices to final section entries of the merged skel mesh */
+	TArray<int32> SectionIDs;
+};
+
+/**
+* Native form of FCustomSkeletalMeshMergeParams. The parts and section mappings are views of arrays
+* owned by the caller, so nothing is copied before the merge.
+*/
+struct FCustomSkeletalMeshMergeNativeParams
+{
+	/** Meshes to merge, every part must have a mesh */
+	TArrayView<const FSkelMeshMergePart> Parts;
+
+	/** Optional mapping of the sections of every part to merged section entries */
+	TArrayView<const FSkelMeshMergeSectionMapping> SectionMappings;
+
+	/** Number of high LODs to remove from input meshes */
+	int32 StripTopLODs;
+
+	EMeshBufferAccess MeshBufferAccess;
+
+	/** Skeleton of the merged mesh, set before the merge if bSkeletonBefore and after it otherwise */
+	USkeleton* Skeleton;
+	bool bSkeletonBefore;
+
+	UMaterialInterface* BaseMaterial;
+
+	/** Keep the processed parts so a merge passing the result as PreviousMergedMesh only reprocesses the parts that changed */
+	bool bIncremental;
+	USkeletalMesh* PreviousMergedMesh;
+
+	/**
+	 * Rebuild PreviousMergedMesh itself rather than a new mesh, refilling its LOD render data and material slots.
+	 * Only done when no other request shares the previous mesh and no component shows it; a failed rebuild
+	 * releases PreviousMergedMesh.
+	 */
+	bool bMergeInPlace;
+
+	FCustomSkeletalMeshMergeNativeParams()
+		: StripTopLODs(0)
+		, MeshBufferAccess(EMeshBufferAccess::Default)
+		, Skeleton(nullptr)
+		, bSkeletonBefore(false)
+		, BaseMaterial(nullptr)
+		, bIncremental(false)
+		, PreviousMergedMesh(nullptr)
+		, bMergeInPlace(false)
+	{}
+};
+
+/**
+* Merges for native callers that build their parts in place, without the copies of the Blueprint structs.
+*/
+class CUSTOMSKELETALMESHMERGE_API FCustomSkeletalMeshMergeNative
+{
+public:
+	/**
+	 * Merges the parts like UCustomSkeletalMeshMergeBPLibrary::MergeMeshes, with the same cache, pool and prebaked meshes.
+	 * The parts and section mappings are only referenced until the call returns. Must be called on the game thread.
+	 * @param OutReport - (optional) filled with the cost and size of the merge
+	 * @return The merged mesh, or nullptr if the merge failed.
+	 */
+	static USkeletalMesh* MergeMeshes(const FCustomSkeletalMeshMergeNativeParams& Params, FCustomSkeletalMeshMergeReport* OutReport = nullptr);
+
+	/**
+	 * Gives back a mesh returned by MergeMeshes once it is no longer used.
+	 * @return Whether the mesh was returned by a merge.
+	 */
+	static bool ReleaseMergedMesh(USkeletalMesh* MergedMesh);
+};
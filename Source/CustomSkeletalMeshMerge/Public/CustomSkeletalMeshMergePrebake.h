@@ -0,0 +1,146 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+/*=============================================================================
+	CustomSkeletalMeshMergePrebake.h: Merges baked at cook time.
+=============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "UObject/SoftObjectPtr.h"
+#include "Engine/DataAsset.h"
+#include "Misc/SecureHash.h"
+#include "CustomSkeletalMeshMergeBPLibrary.h"
+#include "CustomSkeletalMeshMergePrebake.generated.h"
+
+class UMaterialInterface;
+
+/**
+* Merged render data of one part combination, baked by the prebake commandlet.
+*/
+UCLASS()
+class CUSTOMSKELETALMESHMERGE_API UCustomSkeletalMeshMergePrebakedMesh : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	/** Atlas material bound to every merged material slot */
+	UPROPERTY(VisibleAnywhere, Category = "Mesh Merge")
+	UMaterialInterface* Material;
+
+	/** Hex string of the atlas key of the source materials, the material is shared under it by the merge cache */
+	UPROPERTY(VisibleAnywhere, Category = "Mesh Merge")
+	FString AtlasKey;
+
+	/** Merged data in the binary format of the merge disk cache */
+	TArray<uint8> MergedData;
+
+	//~ Begin UObject Interface
+	virtual void Serialize(FArchive& Ar) override;
+	//~ End UObject Interface
+};
+
+/**
+* Baked merges by merge content key, looked up by MergeMeshes before merging.
+*/
+UCLASS()
+class CUSTOMSKELETALMESHMERGE_API UCustomSkeletalMeshMergePrebakeTable : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	/** Baked merges keyed by the hex string of their content key */
+	UPROPERTY(VisibleAnywhere, Category = "Mesh Merge")
+	TMap<FString, TSoftObjectPtr<UCustomSkeletalMeshMergePrebakedMesh>> Entries;
+};
+
+/**
+* Part combinations to bake, read by the prebake commandlet.
+*/
+UCLASS()
+class CUSTOMSKELETALMESHMERGE_API UCustomSkeletalMeshMergePrebakeManifest : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	/** Merge requests exactly as they are passed to MergeMeshes at runtime */
+	UPROPERTY(EditAnywhere, Category = "Mesh Merge")
+	TArray<FCustomSkeletalMeshMergeParams> Combinations;
+};
+
+/** One texture parameter of the merged material that is packed into an atlas. */
+struct FCustomSkeletalMeshMergeAtlasProperty
+{
+	FName TextureName;
+	FIntPoint Size;
+	bool bIsNormal;
+
+	FCustomSkeletalMeshMergeAtlasProperty()
+		: Size(0, 0)
+		, bIsNormal(false)
+	{}
+};
+
+/** Where each source material lands in the atlas textures of a merge. */
+struct FCustomSkeletalMeshMergeAtlasLayout
+{
+	UMaterialInterface* BaseMaterial;
+
+	/** Source materials, in atlas order */
+	TArray<UMaterialInterface*> Materials;
+
+	/** Region of each source material, in atlas texels */
+	TArray<FBox2D> Boxes;
+
+	TArray<FCustomSkeletalMeshMergeAtlasProperty> Properties;
+
+	/** Key the merge cache shares atlases of the same base and source materials under */
+	FSHAHash Key;
+
+	FCustomSkeletalMeshMergeAtlasLayout()
+		: BaseMaterial(nullptr)
+	{}
+};
+
+/**
+* Lookup of merges baked at cook time, so the most common part combinations cost an asset load instead of a merge.
+*/
+class CUSTOMSKELETALMESHMERGE_API FCustomSkeletalMeshMergePrebake
+{
+public:
+	/** Content directory the commandlet writes to unless told otherwise */
+	static const TCHAR* const DefaultOutputPath;
+
+	/** Asset name of the table in the output directory */
+	static const TCHAR* const TableName;
+
+	/** @return The prebake table, or nullptr if the lookup is disabled or nothing was baked. Game thread only. */
+	static UCustomSkeletalMeshMergePrebakeTable* GetTable();
+
+	/**
+	 * Loads the baked merge for a merge content key. Game thread only.
+	 * @return The baked merge, or nullptr if the key was not baked.
+	 */
+	static UCustomSkeletalMeshMergePrebakedMesh* FindPrebakedMesh(const FSHAHash& Key);
+
+	/**
+	 * Registers the baked atlas materials with the merge cache, so runtime merges of the same source materials,
+	 * from the disk cache or not, skip compositing from the first spawn on. Game thread only, after engine init.
+	 */
+	static void WarmAtlasCache();
+
+	/** Drops the loaded table. */
+	static void Shutdown();
+
+#if WITH_EDITOR
+	/**
+	 * Merges a part combination without a renderer. The atlas textures are not composited,
+	 * their layout is returned instead so the caller can build them from the texture sources.
+	 * @param OutKey - content key MergeMeshes computes for the same parameters
+	 * @param OutMergedData - merged data in the binary format of the merge disk cache
+	 * @return 'false' if the combination can not be merged.
+	 */
+	static bool Bake(const FCustomSkeletalMeshMergeParams& Params, FSHAHash& OutKey, TArray<uint8>& OutMergedData, FCustomSkeletalMeshMergeAtlasLayout& OutAtlasLayout);
+#endif
+};
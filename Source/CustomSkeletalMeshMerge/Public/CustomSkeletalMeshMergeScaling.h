@@ -0,0 +1,101 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+/*=============================================================================
+	CustomSkeletalMeshMergeScaling.h: Merge cost of generated parts of a given size.
+=============================================================================*/
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Size of the generated parts of one measurement; every part has the same shape and skeleton */
+struct FCustomSkeletalMeshMergeScalingConfig
+{
+	int32 NumParts;
+	int32 NumVerticesPerPart;
+
+	/** Bones of every part, root included */
+	int32 NumBones;
+
+	/** LODs of every part, each with half the vertices of the previous one */
+	int32 NumLODs;
+
+	FCustomSkeletalMeshMergeScalingConfig()
+		: NumParts(8)
+		, NumVerticesPerPart(10000)
+		, NumBones(100)
+		, NumLODs(1)
+	{}
+};
+
+/** Cost of merging one configuration */
+struct FCustomSkeletalMeshMergeScalingResult
+{
+	/** Median time of each stage over the iterations, in milliseconds */
+	float MergeMaterialMs;
+	float MergeSkeletonMs;
+	float MergeMeshMs;
+	float CommitMs;
+	float TotalMs;
+
+	/**
+	 * Largest growth of the physical memory used by the process during each stage, over the iterations
+	 * and since the configuration started, in bytes.
+	 */
+	int64 MergeMaterialPeakBytes;
+	int64 MergeSkeletonPeakBytes;
+	int64 MergeMeshPeakBytes;
+	int64 CommitPeakBytes;
+
+	/** Largest intermediate buffers of a single LOD, held by the merge mesh stage */
+	int64 PeakIntermediateBytes;
+
+	/** Most intermediate buffers that grew past their reserved size in a single merge */
+	int32 NumReallocations;
+
+	/** Render data of the merged mesh, built by the merge mesh stage and handed to the mesh by the commit */
+	int64 MergedCPUBytes;
+	int64 MergedGPUBytes;
+
+	/** Merged vertices and sections over every LOD */
+	int64 NumMergedVertices;
+	int32 NumMergedSections;
+
+	/** Largest of the stage peaks, in bytes */
+	int64 PeakUsedPhysicalDelta;
+
+	FCustomSkeletalMeshMergeScalingResult()
+		: MergeMaterialMs(0.0f)
+		, MergeSkeletonMs(0.0f)
+		, MergeMeshMs(0.0f)
+		, CommitMs(0.0f)
+		, TotalMs(0.0f)
+		, MergeMaterialPeakBytes(0)
+		, MergeSkeletonPeakBytes(0)
+		, MergeMeshPeakBytes(0)
+		, CommitPeakBytes(0)
+		, PeakIntermediateBytes(0)
+		, NumReallocations(0)
+		, MergedCPUBytes(0)
+		, MergedGPUBytes(0)
+		, NumMergedVertices(0)
+		, NumMergedSections(0)
+		, PeakUsedPhysicalDelta(0)
+	{}
+};
+
+/**
+* Measures how the merge cost grows with the part count, the part size, the bones and the LODs,
+* on parts generated in memory so no content is needed.
+*/
+class CUSTOMSKELETALMESHMERGE_API FCustomSkeletalMeshMergeScaling
+{
+public:
+	/**
+	 * Generates the parts of a configuration and merges them into a pooled mesh a number of times.
+	 * The part cache is turned off so every merge converts its sources, and the atlas textures are not
+	 * composited, so no renderer is needed. Must be called on the game thread.
+	 * @return 'false' if a merge failed.
+	 */
+	static bool Measure(const FCustomSkeletalMeshMergeScalingConfig& Config, int32 NumIterations, FCustomSkeletalMeshMergeScalingResult& OutResult);
+};
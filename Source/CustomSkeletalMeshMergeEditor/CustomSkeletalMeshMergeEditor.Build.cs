@@ -0,0 +1,32 @@
+// Some copyright should be here...
+
+using UnrealBuildTool;
+
+public class CustomSkeletalMeshMergeEditor : ModuleRules
+{
+	public CustomSkeletalMeshMergeEditor(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(
+			new string[]
+			{
+				"Core",
+			}
+			);
+
+
+		PrivateDependencyModuleNames.AddRange(
+			new string[]
+			{
+				"CoreUObject",
+				"Engine",
+				"UnrealEd",
+				"AssetRegistry",
+				"Json",
+				"Projects",
+				"CustomSkeletalMeshMerge",
+			}
+			);
+	}
+}
@@ -0,0 +1,355 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "CustomSkeletalMeshMergePrebakeCommandlet.h"
+#include "CustomSkeletalMeshMergePrebake.h"
+#include "AssetRegistryModule.h"
+#include "Engine/Texture2D.h"
+#include "Materials/MaterialInstanceConstant.h"
+#include "Misc/PackageName.h"
+#include "UObject/Package.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogSkeletalMeshMergePrebake, Log, All);
+
+namespace
+{
+	/** Creates an empty package for a baked asset; saving it replaces the asset of an earlier run. */
+	UPackage* CreateAssetPackage(const FString& PackageName)
+	{
+		return CreatePackage(nullptr, *PackageName);
+	}
+
+	bool SaveAsset(UObject* Asset)
+	{
+		UPackage* Package = Asset->GetOutermost();
+		FAssetRegistryModule::AssetCreated(Asset);
+		Package->MarkPackageDirty();
+
+		const FString Filename = FPackageName::LongPackageNameToFilename(Package->GetName(), FPackageName::GetAssetPackageExtension());
+		return UPackage::SavePackage(Package, Asset, RF_Public | RF_Standalone, *Filename, GError, nullptr, false, true, SAVE_NoError);
+	}
+
+	/** @return Linear value of an sRGB encoded channel. */
+	float SRGBToLinear(float Value)
+	{
+		return Value <= 0.04045f ? Value / 12.92f : FMath::Pow((Value + 0.055f) / 1.055f, 2.4f);
+	}
+
+	/**
+	 * Reads mip 0 of a texture source as linear colors. Every source format is supported;
+	 * integer formats are decoded from sRGB when the texture samples them as sRGB.
+	 */
+	bool GetSourcePixels(UTexture2D* Texture, TArray<FLinearColor>& OutPixels, int32& OutSizeX, int32& OutSizeY)
+	{
+		FTextureSource& Source = Texture->Source;
+		if (!Source.IsValid())
+		{
+			return false;
+		}
+
+		TArray<uint8> MipData;
+		if (!Source.GetMipData(MipData, 0))
+		{
+			return false;
+		}
+
+		OutSizeX = Source.GetSizeX();
+		OutSizeY = Source.GetSizeY();
+		const int32 NumPixels = OutSizeX * OutSizeY;
+		if (MipData.Num() < NumPixels * Source.GetBytesPerPixel())
+		{
+			return false;
+		}
+
+		const bool bSRGB = Texture->SRGB;
+		const ETextureSourceFormat Format = Source.GetFormat();
+		OutPixels.SetNumUninitialized(NumPixels);
+
+		switch (Format)
+		{
+		case TSF_G8:
+			for (int32 PixelIdx = 0; PixelIdx < NumPixels; PixelIdx++)
+			{
+				const float Value = MipData[PixelIdx] / 255.0f;
+				const float LinearValue = bSRGB ? SRGBToLinear(Value) : Value;
+				OutPixels[PixelIdx] = FLinearColor(LinearValue, LinearValue, LinearValue, 1.0f);
+			}
+			return true;
+
+		case TSF_BGRA8:
+		case TSF_RGBA8:
+		case TSF_BGRE8:
+		case TSF_RGBE8:
+			{
+				const FColor* SrcColors = (const FColor*)MipData.GetData();
+				const bool bSwapRB = (Format == TSF_RGBA8 || Format == TSF_RGBE8);
+				const bool bShared = (Format == TSF_BGRE8 || Format == TSF_RGBE8);
+				for (int32 PixelIdx = 0; PixelIdx < NumPixels; PixelIdx++)
+				{
+					FColor Color = SrcColors[PixelIdx];
+					if (bSwapRB)
+					{
+						Swap(Color.R, Color.B);
+					}
+					if (bShared)
+					{
+						OutPixels[PixelIdx] = Color.FromRGBE();
+					}
+					else
+					{
+						OutPixels[PixelIdx] = bSRGB ? FLinearColor(Color) : Color.ReinterpretAsLinear();
+					}
+				}
+			}
+			return true;
+
+		case TSF_RGBA16:
+			{
+				const uint16* SrcChannels = (const uint16*)MipData.GetData();
+				for (int32 PixelIdx = 0; PixelIdx < NumPixels; PixelIdx++)
+				{
+					const uint16* Channels = SrcChannels + PixelIdx * 4;
+					FLinearColor& Pixel = OutPixels[PixelIdx];
+					Pixel = FLinearColor(Channels[0] / 65535.0f, Channels[1] / 65535.0f, Channels[2] / 65535.0f, Channels[3] / 65535.0f);
+					if (bSRGB)
+					{
+						Pixel.R = SRGBToLinear(Pixel.R);
+						Pixel.G = SRGBToLinear(Pixel.G);
+						Pixel.B = SRGBToLinear(Pixel.B);
+					}
+				}
+			}
+			return true;
+
+		case TSF_RGBA16F:
+			{
+				const FFloat16* SrcChannels = (const FFloat16*)MipData.GetData();
+				for (int32 PixelIdx = 0; PixelIdx < NumPixels; PixelIdx++)
+				{
+					const FFloat16* Channels = SrcChannels + PixelIdx * 4;
+					OutPixels[PixelIdx] = FLinearColor(Channels[0].GetFloat(), Channels[1].GetFloat(), Channels[2].GetFloat(), Channels[3].GetFloat());
+				}
+			}
+			return true;
+
+		default:
+			return false;
+		}
+	}
+
+	/**
+	 * Resamples source art into its atlas region. A region the size of the source gets the source texels
+	 * unchanged, as the runtime composite copies them on the GPU; a region the packing shrank gets the average
+	 * of the source texels under each atlas texel, renormalized for normal maps.
+	 */
+	void CompositeRegion(const TArray<FLinearColor>& SrcPixels, int32 SrcSizeX, int32 SrcSizeY, bool bIsNormal,
+		int32 MinX, int32 MinY, int32 MaxX, int32 MaxY, TArray<FLinearColor>& Pixels, int32 SizeX)
+	{
+		const int32 RegionSizeX = MaxX - MinX;
+		const int32 RegionSizeY = MaxY - MinY;
+
+		for (int32 Y = MinY; Y < MaxY; Y++)
+		{
+			const int32 SrcMinY = (int32)(((int64)(Y - MinY) * SrcSizeY) / RegionSizeY);
+			const int32 SrcMaxY = FMath::Max(SrcMinY + 1, (int32)(((int64)(Y - MinY + 1) * SrcSizeY) / RegionSizeY));
+			for (int32 X = MinX; X < MaxX; X++)
+			{
+				const int32 SrcMinX = (int32)(((int64)(X - MinX) * SrcSizeX) / RegionSizeX);
+				const int32 SrcMaxX = FMath::Max(SrcMinX + 1, (int32)(((int64)(X - MinX + 1) * SrcSizeX) / RegionSizeX));
+
+				FLinearColor Sum(0.0f, 0.0f, 0.0f, 0.0f);
+				for (int32 SrcY = SrcMinY; SrcY < SrcMaxY; SrcY++)
+				{
+					for (int32 SrcX = SrcMinX; SrcX < SrcMaxX; SrcX++)
+					{
+						Sum += SrcPixels[SrcY * SrcSizeX + SrcX];
+					}
+				}
+
+				const int32 NumSamples = (SrcMaxX - SrcMinX) * (SrcMaxY - SrcMinY);
+				FLinearColor Pixel = Sum / (float)NumSamples;
+				if (bIsNormal && NumSamples > 1)
+				{
+					const FVector Normal = FVector(Pixel.R * 2.0f - 1.0f, Pixel.G * 2.0f - 1.0f, Pixel.B * 2.0f - 1.0f).GetSafeNormal(SMALL_NUMBER, FVector(0.0f, 0.0f, 1.0f));
+					Pixel.R = Normal.X * 0.5f + 0.5f;
+					Pixel.G = Normal.Y * 0.5f + 0.5f;
+					Pixel.B = Normal.Z * 0.5f + 0.5f;
+				}
+				Pixels[Y * SizeX + X] = Pixel;
+			}
+		}
+	}
+
+	/**
+	 * Composites the atlas texture of one material property on the CPU from the source art,
+	 * placing every source texture in its atlas region the way the runtime composite does.
+	 */
+	UTexture2D* BakeAtlasTexture(const FCustomSkeletalMeshMergeAtlasLayout& Layout, const FCustomSkeletalMeshMergeAtlasProperty& Property, const FString& PackageName)
+	{
+		const int32 SizeX = Property.Size.X;
+		const int32 SizeY = Property.Size.Y;
+
+		TArray<FLinearColor> Pixels;
+		Pixels.Init(FLinearColor(0.0f, 0.0f, 0.0f, 0.0f), SizeX * SizeY);
+
+		for (int32 MaterialIdx = 0; MaterialIdx < Layout.Materials.Num(); MaterialIdx++)
+		{
+			UTexture* Texture = nullptr;
+			Layout.Materials[MaterialIdx]->GetTextureParameterValue(Property.TextureName, Texture);
+			UTexture2D* Texture2D = Cast<UTexture2D>(Texture);
+
+			TArray<FLinearColor> SrcPixels;
+			int32 SrcSizeX = 0;
+			int32 SrcSizeY = 0;
+			if (!Texture2D || !GetSourcePixels(Texture2D, SrcPixels, SrcSizeX, SrcSizeY))
+			{
+				UE_LOG(LogSkeletalMeshMergePrebake, Warning, TEXT("%s: no readable source art for %s of %s, its atlas region is left empty."),
+					*PackageName, *Property.TextureName.ToString(), *GetNameSafe(Layout.Materials[MaterialIdx]));
+				continue;
+			}
+
+			// the runtime copies to the integer origin of the box
+			const FBox2D& Box = Layout.Boxes[MaterialIdx];
+			const int32 MinX = FMath::Clamp(FMath::TruncToInt(Box.Min.X), 0, SizeX);
+			const int32 MinY = FMath::Clamp(FMath::TruncToInt(Box.Min.Y), 0, SizeY);
+			const int32 MaxX = FMath::Clamp(MinX + FMath::RoundToInt(Box.GetSize().X), MinX, SizeX);
+			const int32 MaxY = FMath::Clamp(MinY + FMath::RoundToInt(Box.GetSize().Y), MinY, SizeY);
+			if (MaxX > MinX && MaxY > MinY)
+			{
+				CompositeRegion(SrcPixels, SrcSizeX, SrcSizeY, Property.bIsNormal, MinX, MinY, MaxX, MaxY, Pixels, SizeX);
+			}
+		}
+
+		// the atlas is sampled as sRGB unless it holds normals
+		TArray<FColor> Colors;
+		Colors.SetNumUninitialized(Pixels.Num());
+		for (int32 PixelIdx = 0; PixelIdx < Pixels.Num(); PixelIdx++)
+		{
+			Colors[PixelIdx] = Pixels[PixelIdx].ToFColor(!Property.bIsNormal);
+		}
+
+		UPackage* Package = CreateAssetPackage(PackageName);
+		UTexture2D* AtlasTexture = NewObject<UTexture2D>(Package, *FPackageName::GetShortName(PackageName), RF_Public | RF_Standalone);
+		AtlasTexture->Source.Init(SizeX, SizeY, 1, 1, TSF_BGRA8, (const uint8*)Colors.GetData());
+		AtlasTexture->SRGB = !Property.bIsNormal;
+		if (Property.bIsNormal)
+		{
+			AtlasTexture->CompressionSettings = TC_Normalmap;
+			AtlasTexture->LODGroup = TEXTUREGROUP_WorldNormalMap;
+		}
+		AtlasTexture->PostEditChange();
+
+		return SaveAsset(AtlasTexture) ? AtlasTexture : nullptr;
+	}
+
+	/** Bakes the atlas textures and the material instance that uses them in place of the source materials. */
+	UMaterialInterface* BakeAtlasMaterial(const FCustomSkeletalMeshMergeAtlasLayout& Layout, const FString& EntryPath)
+	{
+		const FString PackageName = EntryPath / TEXT("AtlasMaterial");
+		UPackage* Package = CreateAssetPackage(PackageName);
+		UMaterialInstanceConstant* Material = NewObject<UMaterialInstanceConstant>(Package, *FPackageName::GetShortName(PackageName), RF_Public | RF_Standalone);
+		Material->SetParentEditorOnly(Layout.BaseMaterial);
+
+		for (const FCustomSkeletalMeshMergeAtlasProperty& Property : Layout.Properties)
+		{
+			UTexture2D* AtlasTexture = BakeAtlasTexture(Layout, Property, EntryPath / (TEXT("Atlas_") + Property.TextureName.ToString()));
+			if (!AtlasTexture)
+			{
+				return nullptr;
+			}
+			Material->SetTextureParameterValueEditorOnly(Property.TextureName, AtlasTexture);
+		}
+		Material->PostEditChange();
+
+		return SaveAsset(Material) ? Material : nullptr;
+	}
+}
+
+UCustomSkeletalMeshMergePrebakeCommandlet::UCustomSkeletalMeshMergePrebakeCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UCustomSkeletalMeshMergePrebakeCommandlet::Main(const FString& Params)
+{
+	FString ManifestPath;
+	if (!FParse::Value(*Params, TEXT("Manifest="), ManifestPath))
+	{
+		UE_LOG(LogSkeletalMeshMergePrebake, Error, TEXT("Usage: -run=CustomSkeletalMeshMergePrebake -Manifest=/Game/Path/Manifest [-Output=%s]"),
+			FCustomSkeletalMeshMergePrebake::DefaultOutputPath);
+		return 1;
+	}
+
+	FString OutputPath = FCustomSkeletalMeshMergePrebake::DefaultOutputPath;
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+	if (!ManifestPath.Contains(TEXT(".")))
+	{
+		ManifestPath += TEXT(".") + FPackageName::GetShortName(ManifestPath);
+	}
+	UCustomSkeletalMeshMergePrebakeManifest* Manifest = LoadObject<UCustomSkeletalMeshMergePrebakeManifest>(nullptr, *ManifestPath);
+	if (!Manifest)
+	{
+		UE_LOG(LogSkeletalMeshMergePrebake, Error, TEXT("Could not load the prebake manifest %s."), *ManifestPath);
+		return 1;
+	}
+
+	// The table is rebuilt from scratch, so combinations removed from the manifest stop being used
+	const FString TablePackageName = OutputPath / FCustomSkeletalMeshMergePrebake::TableName;
+	UPackage* TablePackage = CreateAssetPackage(TablePackageName);
+	UCustomSkeletalMeshMergePrebakeTable* Table = NewObject<UCustomSkeletalMeshMergePrebakeTable>(TablePackage, FCustomSkeletalMeshMergePrebake::TableName, RF_Public | RF_Standalone);
+
+	int32 NumFailed = 0;
+	for (int32 CombinationIdx = 0; CombinationIdx < Manifest->Combinations.Num(); CombinationIdx++)
+	{
+		FSHAHash Key;
+		TArray<uint8> MergedData;
+		FCustomSkeletalMeshMergeAtlasLayout AtlasLayout;
+		if (!FCustomSkeletalMeshMergePrebake::Bake(Manifest->Combinations[CombinationIdx], Key, MergedData, AtlasLayout))
+		{
+			UE_LOG(LogSkeletalMeshMergePrebake, Error, TEXT("Combination %d could not be merged."), CombinationIdx);
+			NumFailed++;
+			continue;
+		}
+
+		const FString KeyString = Key.ToString();
+		if (Table->Entries.Contains(KeyString))
+		{
+			UE_LOG(LogSkeletalMeshMergePrebake, Display, TEXT("Combination %d is a duplicate of an earlier one."), CombinationIdx);
+			continue;
+		}
+
+		const FString EntryPath = OutputPath / KeyString;
+		UMaterialInterface* AtlasMaterial = BakeAtlasMaterial(AtlasLayout, EntryPath);
+
+		const FString MeshPackageName = EntryPath / TEXT("MergedMesh");
+		UPackage* MeshPackage = CreateAssetPackage(MeshPackageName);
+		UCustomSkeletalMeshMergePrebakedMesh* PrebakedMesh = NewObject<UCustomSkeletalMeshMergePrebakedMesh>(MeshPackage, *FPackageName::GetShortName(MeshPackageName), RF_Public | RF_Standalone);
+		PrebakedMesh->Material = AtlasMaterial;
+		PrebakedMesh->AtlasKey = AtlasLayout.Key.ToString();
+		PrebakedMesh->MergedData = MoveTemp(MergedData);
+
+		if (!AtlasMaterial || !SaveAsset(PrebakedMesh))
+		{
+			UE_LOG(LogSkeletalMeshMergePrebake, Error, TEXT("Combination %d could not be saved to %s."), CombinationIdx, *EntryPath);
+			NumFailed++;
+			continue;
+		}
+
+		Table->Entries.Add(KeyString, PrebakedMesh);
+		UE_LOG(LogSkeletalMeshMergePrebake, Display, TEXT("Baked combination %d to %s (%d bytes)."), CombinationIdx, *EntryPath, PrebakedMesh->MergedData.Num());
+	}
+
+	if (!SaveAsset(Table))
+	{
+		UE_LOG(LogSkeletalMeshMergePrebake, Error, TEXT("Could not save %s."), *TablePackageName);
+		return 1;
+	}
+
+	UE_LOG(LogSkeletalMeshMergePrebake, Display, TEXT("Baked %d of %d combinations into %s. Cook %s and point SkeletalMeshMerge.PrebakeTable at %s."),
+		Table->Entries.Num(), Manifest->Combinations.Num(), *TablePackageName, *OutputPath, *TablePackageName);
+
+	return NumFailed > 0 ? 1 : 0;
+}
@@ -0,0 +1,30 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "CustomSkeletalMeshMergePrebakeCommandlet.generated.h"
+
+/**
+* Bakes the part combinations of a UCustomSkeletalMeshMergePrebakeManifest into assets, so MergeMeshes
+* loads them instead of merging at runtime.
+*
+* Usage: -run=CustomSkeletalMeshMergePrebake -Manifest=/Game/Path/Manifest [-Output=/Game/MergePrebake]
+*
+* Every combination is written to <Output>/<Key> as the merged data, its atlas textures and atlas material,
+* and is registered in <Output>/MergePrebakeTable. The output directory must be cooked, e.g. by adding it to
+* the project's additional asset directories to cook.
+*/
+UCLASS()
+class UCustomSkeletalMeshMergePrebakeCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UCustomSkeletalMeshMergePrebakeCommandlet();
+
+	//~ Begin UCommandlet Interface
+	virtual int32 Main(const FString& Params) override;
+	//~ End UCommandlet Interface
+};
@@ -0,0 +1,381 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "CustomSkeletalMeshMergeRegressionCommandlet.h"
+#include "CustomSkeletalMeshMergeScaling.h"
+#include "Dom/JsonObject.h"
+#include "Interfaces/IPluginManager.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "UObject/UObjectGlobals.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogSkeletalMeshMergeRegression, Log, All);
+
+namespace
+{
+	/** A generated merge of the gate, its name keys the baseline entry */
+	struct FRegressionWorkload
+	{
+		const TCHAR* Name;
+		int32 NumParts;
+		int32 NumVerticesPerPart;
+		int32 NumBones;
+		int32 NumLODs;
+	};
+
+	/** Covers the axes of the scaling sweep once each, small enough to run on every build */
+	const FRegressionWorkload Workloads[] = {
+		{ TEXT("Default"), 8, 10000, 100, 1 },
+		{ TEXT("ManyParts"), 32, 2000, 100, 1 },
+		{ TEXT("LargeParts"), 4, 100000, 100, 1 },
+		{ TEXT("ManyBones"), 8, 10000, 300, 1 },
+		{ TEXT("LODs"), 8, 10000, 100, 4 },
+	};
+
+	/** Stage times, they depend on the machine so they are compared with the baseline of the machine only */
+	struct FTimeMetric
+	{
+		const TCHAR* Name;
+		float FCustomSkeletalMeshMergeScalingResult::* Value;
+	};
+
+	const FTimeMetric TimeMetrics[] = {
+		{ TEXT("MergeMaterialMs"), &FCustomSkeletalMeshMergeScalingResult::MergeMaterialMs },
+		{ TEXT("MergeSkeletonMs"), &FCustomSkeletalMeshMergeScalingResult::MergeSkeletonMs },
+		{ TEXT("MergeMeshMs"), &FCustomSkeletalMeshMergeScalingResult::MergeMeshMs },
+		{ TEXT("CommitMs"), &FCustomSkeletalMeshMergeScalingResult::CommitMs },
+		{ TEXT("TotalMs"), &FCustomSkeletalMeshMergeScalingResult::TotalMs },
+	};
+
+	/** Allocations of a merge, any growth is a regression */
+	struct FAllocationMetric
+	{
+		const TCHAR* Name;
+		int64 (*GetValue)(const FCustomSkeletalMeshMergeScalingResult&);
+	};
+
+	/** Follow from the element counts alone, so they hold on every machine and are checked in */
+	const FAllocationMetric AllocationMetrics[] = {
+		{ TEXT("NumReallocations"), [](const FCustomSkeletalMeshMergeScalingResult& Result) -> int64 { return Result.NumReallocations; } },
+		{ TEXT("MergedGPUBytes"), [](const FCustomSkeletalMeshMergeScalingResult& Result) -> int64 { return Result.MergedGPUBytes; } },
+	};
+
+	/** Include the slack the allocator rounds allocations up to, which differs between platforms */
+	const FAllocationMetric MachineAllocationMetrics[] = {
+		{ TEXT("PeakIntermediateBytes"), [](const FCustomSkeletalMeshMergeScalingResult& Result) -> int64 { return Result.PeakIntermediateBytes; } },
+		{ TEXT("MergedCPUBytes"), [](const FCustomSkeletalMeshMergeScalingResult& Result) -> int64 { return Result.MergedCPUBytes; } },
+	};
+
+	/** Stage times closer than this to the baseline are timer noise, whatever the tolerance */
+	const double NoiseFloorMs = 0.1;
+
+	TSharedPtr<FJsonObject> FindBaselineWorkload(const TArray<TSharedPtr<FJsonValue>>& BaselineWorkloads, const TCHAR* Name)
+	{
+		for (const TSharedPtr<FJsonValue>& Value : BaselineWorkloads)
+		{
+			const TSharedPtr<FJsonObject>* Object = nullptr;
+			if (Value->TryGetObject(Object) && (*Object)->GetStringField(TEXT("Name")) == Name)
+			{
+				return *Object;
+			}
+		}
+		return nullptr;
+	}
+
+	bool MatchesShape(const FJsonObject& Baseline, const FRegressionWorkload& Workload)
+	{
+		return Baseline.GetIntegerField(TEXT("Parts")) == Workload.NumParts
+			&& Baseline.GetIntegerField(TEXT("VerticesPerPart")) == Workload.NumVerticesPerPart
+			&& Baseline.GetIntegerField(TEXT("Bones")) == Workload.NumBones
+			&& Baseline.GetIntegerField(TEXT("LODs")) == Workload.NumLODs;
+	}
+
+	/** @param bMachine - whether to record the metrics of the machine baseline rather than the checked in ones */
+	TSharedRef<FJsonObject> MakeBaselineWorkload(const FRegressionWorkload& Workload, const FCustomSkeletalMeshMergeScalingResult& Result, bool bMachine)
+	{
+		TSharedRef<FJsonObject> Object = MakeShareable(new FJsonObject);
+		Object->SetStringField(TEXT("Name"), Workload.Name);
+		Object->SetNumberField(TEXT("Parts"), Workload.NumParts);
+		Object->SetNumberField(TEXT("VerticesPerPart"), Workload.NumVerticesPerPart);
+		Object->SetNumberField(TEXT("Bones"), Workload.NumBones);
+		Object->SetNumberField(TEXT("LODs"), Workload.NumLODs);
+		if (bMachine)
+		{
+			for (const FTimeMetric& Metric : TimeMetrics)
+			{
+				Object->SetNumberField(Metric.Name, Result.*Metric.Value);
+			}
+			for (const FAllocationMetric& Metric : MachineAllocationMetrics)
+			{
+				Object->SetNumberField(Metric.Name, (double)Metric.GetValue(Result));
+			}
+		}
+		else
+		{
+			for (const FAllocationMetric& Metric : AllocationMetrics)
+			{
+				Object->SetNumberField(Metric.Name, (double)Metric.GetValue(Result));
+			}
+		}
+		return Object;
+	}
+
+	/** @return Workloads of a baseline file, or 'false' if it could not be read */
+	bool LoadBaseline(const FString& Path, TArray<TSharedPtr<FJsonValue>>& OutWorkloads)
+	{
+		FString BaselineText;
+		TSharedPtr<FJsonObject> BaselineRoot;
+		const TArray<TSharedPtr<FJsonValue>>* BaselineArray = nullptr;
+		if (!FFileHelper::LoadFileToString(BaselineText, *Path)
+			|| !FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(BaselineText), BaselineRoot)
+			|| !BaselineRoot.IsValid()
+			|| !BaselineRoot->TryGetArrayField(TEXT("Workloads"), BaselineArray))
+		{
+			return false;
+		}
+		OutWorkloads = *BaselineArray;
+		return true;
+	}
+
+	bool SaveBaseline(const FString& Path, int32 NumIterations, const TArray<TSharedPtr<FJsonValue>>& Workloads)
+	{
+		TSharedRef<FJsonObject> BaselineRoot = MakeShareable(new FJsonObject);
+		BaselineRoot->SetNumberField(TEXT("Iterations"), NumIterations);
+		BaselineRoot->SetArrayField(TEXT("Workloads"), Workloads);
+
+		FString BaselineText;
+		if (!FJsonSerializer::Serialize(BaselineRoot, TJsonWriterFactory<>::Create(&BaselineText)) || !FFileHelper::SaveStringToFile(BaselineText, *Path))
+		{
+			UE_LOG(LogSkeletalMeshMergeRegression, Error, TEXT("Could not write the baseline %s."), *Path);
+			return false;
+		}
+
+		UE_LOG(LogSkeletalMeshMergeRegression, Display, TEXT("Wrote the baseline of %d workloads to %s."), Workloads.Num(), *Path);
+		return true;
+	}
+
+	/**
+	 * Logs the difference of every stage time with the baseline of the machine.
+	 * @return Number of metrics that regressed
+	 */
+	int32 CompareTimes(const FJsonObject& Baseline, const FRegressionWorkload& Workload, const FCustomSkeletalMeshMergeScalingResult& Result, double Tolerance)
+	{
+		int32 NumRegressions = 0;
+
+		for (const FTimeMetric& Metric : TimeMetrics)
+		{
+			const double BaselineMs = Baseline.GetNumberField(Metric.Name);
+			const double CurrentMs = Result.*Metric.Value;
+			const double Change = BaselineMs > 0.0 ? (CurrentMs - BaselineMs) / BaselineMs : 0.0;
+			const bool bRegressed = CurrentMs > BaselineMs * (1.0 + Tolerance) && CurrentMs - BaselineMs > NoiseFloorMs;
+
+			if (bRegressed)
+			{
+				UE_LOG(LogSkeletalMeshMergeRegression, Error, TEXT("  %-12s %-22s %12.3f -> %12.3f (%+.1f%%) REGRESSED"), Workload.Name, Metric.Name, BaselineMs, CurrentMs, Change * 100.0);
+				NumRegressions++;
+			}
+			else
+			{
+				UE_LOG(LogSkeletalMeshMergeRegression, Display, TEXT("  %-12s %-22s %12.3f -> %12.3f (%+.1f%%)"), Workload.Name, Metric.Name, BaselineMs, CurrentMs, Change * 100.0);
+			}
+		}
+
+		return NumRegressions;
+	}
+
+	/**
+	 * Logs the difference of allocation metrics with a baseline.
+	 * @return Number of metrics that regressed
+	 */
+	template<int32 NumMetrics>
+	int32 CompareAllocations(const FJsonObject& Baseline, const FRegressionWorkload& Workload, const FCustomSkeletalMeshMergeScalingResult& Result, const FAllocationMetric (&Metrics)[NumMetrics])
+	{
+		int32 NumRegressions = 0;
+
+		for (const FAllocationMetric& Metric : Metrics)
+		{
+			const int64 BaselineValue = (int64)Baseline.GetNumberField(Metric.Name);
+			const int64 CurrentValue = Metric.GetValue(Result);
+
+			if (CurrentValue > BaselineValue)
+			{
+				UE_LOG(LogSkeletalMeshMergeRegression, Error, TEXT("  %-12s %-22s %12lld -> %12lld (%+lld) REGRESSED"), Workload.Name, Metric.Name, BaselineValue, CurrentValue, CurrentValue - BaselineValue);
+				NumRegressions++;
+			}
+			else
+			{
+				UE_LOG(LogSkeletalMeshMergeRegression, Display, TEXT("  %-12s %-22s %12lld -> %12lld (%+lld)"), Workload.Name, Metric.Name, BaselineValue, CurrentValue, CurrentValue - BaselineValue);
+			}
+		}
+
+		return NumRegressions;
+	}
+}
+
+UCustomSkeletalMeshMergeRegressionCommandlet::UCustomSkeletalMeshMergeRegressionCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UCustomSkeletalMeshMergeRegressionCommandlet::Main(const FString& Params)
+{
+	TSharedPtr<IPlugin> Plugin = IPluginManager::Get().FindPlugin(TEXT("CustomSkeletalMeshMerge"));
+	check(Plugin.IsValid());
+	const FString PluginConfigDir = Plugin->GetBaseDir() / TEXT("Config");
+
+	FString BaselinePath;
+	if (!FParse::Value(*Params, TEXT("Baseline="), BaselinePath))
+	{
+		BaselinePath = PluginConfigDir / TEXT("SkeletalMeshMergeBaseline.json");
+	}
+
+	// a runner class shares the checked in baseline of its hardware, so fresh build agents compare their stage times too
+	FString Runner;
+	const bool bHasRunner = FParse::Value(*Params, TEXT("Runner="), Runner) && !Runner.IsEmpty();
+
+	FString MachineBaselinePath;
+	const bool bHasMachineBaselinePath = FParse::Value(*Params, TEXT("MachineBaseline="), MachineBaselinePath);
+	if (!bHasMachineBaselinePath)
+	{
+		MachineBaselinePath = bHasRunner
+			? PluginConfigDir / FString::Printf(TEXT("SkeletalMeshMergeBaseline-%s.json"), *Runner)
+			: FPaths::ProjectSavedDir() / TEXT("SkeletalMeshMerge") / FString::Printf(TEXT("Baseline-%s.json"), FPlatformProcess::ComputerName());
+	}
+
+	// stage times were asked for, so a missing baseline for them fails the gate instead of passing it unchecked
+	const bool bRequireTimes = bHasRunner || bHasMachineBaselinePath || FParse::Param(*Params, TEXT("RequireTimes"));
+
+	float Tolerance = 0.2f;
+	FParse::Value(*Params, TEXT("Tolerance="), Tolerance);
+	Tolerance = FMath::Max(Tolerance, 0.0f);
+
+	int32 NumIterations = 9;
+	FParse::Value(*Params, TEXT("Iterations="), NumIterations);
+	NumIterations = FMath::Max(NumIterations, 1);
+
+	const bool bUpdateBaseline = FParse::Param(*Params, TEXT("UpdateBaseline"));
+	const bool bUpdateMachineBaseline = FParse::Param(*Params, TEXT("UpdateMachineBaseline"));
+	const bool bCompare = !bUpdateBaseline && !bUpdateMachineBaseline;
+
+	TArray<TSharedPtr<FJsonValue>> BaselineWorkloads;
+	TArray<TSharedPtr<FJsonValue>> MachineBaselineWorkloads;
+	bool bHasMachineBaseline = false;
+	if (bCompare)
+	{
+		if (!LoadBaseline(BaselinePath, BaselineWorkloads))
+		{
+			UE_LOG(LogSkeletalMeshMergeRegression, Error, TEXT("Could not read the baseline %s, record one with -UpdateBaseline."), *BaselinePath);
+			return 1;
+		}
+
+		// stage times only mean something on the machine they were recorded on, without a baseline of its own they are only logged
+		bHasMachineBaseline = LoadBaseline(MachineBaselinePath, MachineBaselineWorkloads);
+		if (!bHasMachineBaseline && bRequireTimes)
+		{
+			UE_LOG(LogSkeletalMeshMergeRegression, Error, TEXT("Could not read the stage time baseline %s, record one with -UpdateMachineBaseline."), *MachineBaselinePath);
+			return 1;
+		}
+		else if (!bHasMachineBaseline)
+		{
+			UE_LOG(LogSkeletalMeshMergeRegression, Display, TEXT("No baseline for this machine at %s, stage times are not compared. Record one with -UpdateMachineBaseline."), *MachineBaselinePath);
+		}
+	}
+
+	TArray<TSharedPtr<FJsonValue>> MeasuredWorkloads;
+	TArray<TSharedPtr<FJsonValue>> MeasuredMachineWorkloads;
+	int32 NumFailed = 0;
+	int32 NumRegressions = 0;
+
+	for (const FRegressionWorkload& Workload : Workloads)
+	{
+		FCustomSkeletalMeshMergeScalingConfig Config;
+		Config.NumParts = Workload.NumParts;
+		Config.NumVerticesPerPart = Workload.NumVerticesPerPart;
+		Config.NumBones = Workload.NumBones;
+		Config.NumLODs = Workload.NumLODs;
+
+		FCustomSkeletalMeshMergeScalingResult Result;
+		const bool bSucceeded = FCustomSkeletalMeshMergeScaling::Measure(Config, NumIterations, Result);
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+		if (!bSucceeded)
+		{
+			UE_LOG(LogSkeletalMeshMergeRegression, Error, TEXT("%s: the parts could not be merged."), Workload.Name);
+			NumFailed++;
+			continue;
+		}
+
+		if (!bCompare)
+		{
+			UE_LOG(LogSkeletalMeshMergeRegression, Display, TEXT("%s: merged in %.3f ms"), Workload.Name, Result.TotalMs);
+			MeasuredWorkloads.Add(MakeShareable(new FJsonValueObject(MakeBaselineWorkload(Workload, Result, false))));
+			MeasuredMachineWorkloads.Add(MakeShareable(new FJsonValueObject(MakeBaselineWorkload(Workload, Result, true))));
+			continue;
+		}
+
+		const TSharedPtr<FJsonObject> Baseline = FindBaselineWorkload(BaselineWorkloads, Workload.Name);
+		if (!Baseline.IsValid() || !MatchesShape(*Baseline, Workload))
+		{
+			UE_LOG(LogSkeletalMeshMergeRegression, Error, TEXT("%s: not in the baseline or recorded for other parts, run with -UpdateBaseline."), Workload.Name);
+			NumFailed++;
+			continue;
+		}
+		NumRegressions += CompareAllocations(*Baseline, Workload, Result, AllocationMetrics);
+
+		const TSharedPtr<FJsonObject> MachineBaseline = bHasMachineBaseline ? FindBaselineWorkload(MachineBaselineWorkloads, Workload.Name) : nullptr;
+		if (MachineBaseline.IsValid() && MatchesShape(*MachineBaseline, Workload))
+		{
+			NumRegressions += CompareAllocations(*MachineBaseline, Workload, Result, MachineAllocationMetrics);
+			NumRegressions += CompareTimes(*MachineBaseline, Workload, Result, Tolerance);
+		}
+		else
+		{
+			if (bRequireTimes)
+			{
+				UE_LOG(LogSkeletalMeshMergeRegression, Error, TEXT("%s: not in the stage time baseline or recorded for other parts, run with -UpdateMachineBaseline."), Workload.Name);
+				NumFailed++;
+			}
+			else if (bHasMachineBaseline)
+			{
+				UE_LOG(LogSkeletalMeshMergeRegression, Warning, TEXT("%s: not in the baseline of this machine or recorded for other parts, run with -UpdateMachineBaseline."), Workload.Name);
+			}
+			for (const FTimeMetric& Metric : TimeMetrics)
+			{
+				UE_LOG(LogSkeletalMeshMergeRegression, Display, TEXT("  %-12s %-22s %12.3f"), Workload.Name, Metric.Name, Result.*Metric.Value);
+			}
+		}
+	}
+
+	if (!bCompare)
+	{
+		if (NumFailed > 0)
+		{
+			UE_LOG(LogSkeletalMeshMergeRegression, Error, TEXT("The baseline was not written, %d workloads failed."), NumFailed);
+			return 1;
+		}
+
+		if (bUpdateBaseline && !SaveBaseline(BaselinePath, NumIterations, MeasuredWorkloads))
+		{
+			return 1;
+		}
+		if (bUpdateMachineBaseline && !SaveBaseline(MachineBaselinePath, NumIterations, MeasuredMachineWorkloads))
+		{
+			return 1;
+		}
+		return 0;
+	}
+
+	if (NumRegressions > 0 || NumFailed > 0)
+	{
+		UE_LOG(LogSkeletalMeshMergeRegression, Error, TEXT("%d metrics regressed and %d workloads failed against %s."), NumRegressions, NumFailed, *BaselinePath);
+		return 1;
+	}
+
+	UE_LOG(LogSkeletalMeshMergeRegression, Display, TEXT("No regression against %s%s."), *BaselinePath,
+		bHasMachineBaseline ? *FString::Printf(TEXT(" and stage times within %.0f%% of %s"), Tolerance * 100.0f, *MachineBaselinePath) : TEXT(""));
+	return 0;
+}
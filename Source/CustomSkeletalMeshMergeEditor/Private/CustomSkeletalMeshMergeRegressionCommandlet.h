@@ -0,0 +1,43 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "CustomSkeletalMeshMergeRegressionCommandlet.generated.h"
+
+/**
+* Merges a fixed set of generated workloads, see FCustomSkeletalMeshMergeScaling, and compares the stage
+* times and allocations with stored baselines.
+*
+* Usage: -run=CustomSkeletalMeshMergeRegression -nullrhi [-Baseline=<File>] [-Runner=<Class>] [-MachineBaseline=<File>] [-RequireTimes]
+*        [-Tolerance=0.2] [-Iterations=9] [-UpdateBaseline] [-UpdateMachineBaseline]
+*
+* The baseline, Config/SkeletalMeshMergeBaseline.json in the plugin by default, is checked in. It holds the allocations
+* that follow from the element counts alone, so it holds on every machine. The baseline of the machine, in the Saved
+* folder of the project by default, holds the stage times and the allocations that include allocator slack. It is
+* optional: without it the stage times are only logged.
+*
+* Build agents are fresh machines without a baseline of their own, so they pass -Runner=<Class> to use the baseline of
+* their runner class, Config/SkeletalMeshMergeBaseline-<Class>.json in the plugin, which is checked in next to the
+* other one. -UpdateMachineBaseline with -Runner records it on a machine of that class. Stage times are required when
+* a runner or a machine baseline is given, or with -RequireTimes: a missing baseline or workload then fails the gate.
+*
+* A stage time regresses when it is slower than the baseline
+* by more than the tolerance fraction and by more than a fixed noise floor, allocations regress as soon as they grow.
+* -UpdateBaseline and -UpdateMachineBaseline write the measured values to the baselines instead.
+*
+* Returns 1 if any workload regressed, failed to merge or is missing from the baseline.
+*/
+UCLASS()
+class UCustomSkeletalMeshMergeRegressionCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UCustomSkeletalMeshMergeRegressionCommandlet();
+
+	//~ Begin UCommandlet Interface
+	virtual int32 Main(const FString& Params) override;
+	//~ End UCommandlet Interface
+};
@@ -0,0 +1,161 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "CustomSkeletalMeshMergeScalingCommandlet.h"
+#include "CustomSkeletalMeshMergeScaling.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectGlobals.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogSkeletalMeshMergeScaling, Log, All);
+
+namespace
+{
+	/** Reads a comma separated list of values, or keeps the defaults if the switch is missing */
+	TArray<int32> ParseAxis(const FString& Params, const TCHAR* Switch, const TArray<int32>& Defaults)
+	{
+		FString Value;
+		if (!FParse::Value(*Params, Switch, Value, false))
+		{
+			return Defaults;
+		}
+
+		TArray<FString> Items;
+		Value.ParseIntoArray(Items, TEXT(","));
+
+		TArray<int32> Values;
+		for (const FString& Item : Items)
+		{
+			const int32 ItemValue = FCString::Atoi(*Item);
+			if (ItemValue > 0)
+			{
+				Values.Add(ItemValue);
+			}
+		}
+		return Values.Num() > 0 ? Values : Defaults;
+	}
+
+	/** One row of the output */
+	struct FScalingRun
+	{
+		const TCHAR* Sweep;
+		FCustomSkeletalMeshMergeScalingConfig Config;
+	};
+}
+
+UCustomSkeletalMeshMergeScalingCommandlet::UCustomSkeletalMeshMergeScalingCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UCustomSkeletalMeshMergeScalingCommandlet::Main(const FString& Params)
+{
+	const TArray<int32> PartCounts = ParseAxis(Params, TEXT("Parts="), { 2, 4, 8, 16, 32, 64 });
+	const TArray<int32> VertexCounts = ParseAxis(Params, TEXT("Vertices="), { 1000, 5000, 10000, 50000, 100000, 500000 });
+	const TArray<int32> BoneCounts = ParseAxis(Params, TEXT("Bones="), { 50, 100, 200, 300, 500 });
+	const TArray<int32> LODCounts = ParseAxis(Params, TEXT("LODs="), { 1, 2, 3, 4 });
+
+	int32 NumIterations = 3;
+	FParse::Value(*Params, TEXT("Iterations="), NumIterations);
+	NumIterations = FMath::Max(NumIterations, 1);
+
+	FString OutputPath = FPaths::ProjectSavedDir() / TEXT("Profiling") / TEXT("SkeletalMeshMergeScaling.csv");
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+	TArray<FScalingRun> Runs;
+	if (FParse::Param(*Params, TEXT("Full")))
+	{
+		for (int32 NumParts : PartCounts)
+		{
+			for (int32 NumVertices : VertexCounts)
+			{
+				for (int32 NumBones : BoneCounts)
+				{
+					for (int32 NumLODs : LODCounts)
+					{
+						FScalingRun& Run = Runs[Runs.AddDefaulted()];
+						Run.Sweep = TEXT("Full");
+						Run.Config.NumParts = NumParts;
+						Run.Config.NumVerticesPerPart = NumVertices;
+						Run.Config.NumBones = NumBones;
+						Run.Config.NumLODs = NumLODs;
+					}
+				}
+			}
+		}
+	}
+	else
+	{
+		for (int32 NumParts : PartCounts)
+		{
+			FScalingRun& Run = Runs[Runs.AddDefaulted()];
+			Run.Sweep = TEXT("Parts");
+			Run.Config.NumParts = NumParts;
+		}
+		for (int32 NumVertices : VertexCounts)
+		{
+			FScalingRun& Run = Runs[Runs.AddDefaulted()];
+			Run.Sweep = TEXT("Vertices");
+			Run.Config.NumVerticesPerPart = NumVertices;
+		}
+		for (int32 NumBones : BoneCounts)
+		{
+			FScalingRun& Run = Runs[Runs.AddDefaulted()];
+			Run.Sweep = TEXT("Bones");
+			Run.Config.NumBones = NumBones;
+		}
+		for (int32 NumLODs : LODCounts)
+		{
+			FScalingRun& Run = Runs[Runs.AddDefaulted()];
+			Run.Sweep = TEXT("LODs");
+			Run.Config.NumLODs = NumLODs;
+		}
+	}
+
+	FString Csv = TEXT("Sweep,Parts,VerticesPerPart,Bones,LODs,Iterations,MergedVertices,MergedSections,")
+		TEXT("MergeMaterialMs,MergeSkeletonMs,MergeMeshMs,CommitMs,TotalMs,")
+		TEXT("MergeMaterialPeakBytes,MergeSkeletonPeakBytes,MergeMeshPeakBytes,CommitPeakBytes,")
+		TEXT("PeakIntermediateBytes,NumReallocations,MergedCPUBytes,MergedGPUBytes,PeakUsedPhysicalDeltaBytes\n");
+
+	int32 NumFailed = 0;
+	for (int32 RunIdx = 0; RunIdx < Runs.Num(); RunIdx++)
+	{
+		const FScalingRun& Run = Runs[RunIdx];
+		const FCustomSkeletalMeshMergeScalingConfig& Config = Run.Config;
+
+		FCustomSkeletalMeshMergeScalingResult Result;
+		const bool bSucceeded = FCustomSkeletalMeshMergeScaling::Measure(Config, NumIterations, Result);
+
+		// the generated parts and the merged mesh data are dropped before the next configuration
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+		if (!bSucceeded)
+		{
+			UE_LOG(LogSkeletalMeshMergeScaling, Error, TEXT("%d parts of %d vertices, %d bones and %d LODs could not be merged."),
+				Config.NumParts, Config.NumVerticesPerPart, Config.NumBones, Config.NumLODs);
+			NumFailed++;
+			continue;
+		}
+
+		UE_LOG(LogSkeletalMeshMergeScaling, Display, TEXT("[%d/%d] %s: %d parts of %d vertices, %d bones and %d LODs merged in %.3f ms"),
+			RunIdx + 1, Runs.Num(), Run.Sweep, Config.NumParts, Config.NumVerticesPerPart, Config.NumBones, Config.NumLODs, Result.TotalMs);
+
+		Csv += FString::Printf(TEXT("%s,%d,%d,%d,%d,%d,%lld,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%lld,%lld,%lld,%lld,%lld,%d,%lld,%lld,%lld\n"),
+			Run.Sweep, Config.NumParts, Config.NumVerticesPerPart, Config.NumBones, Config.NumLODs, NumIterations,
+			Result.NumMergedVertices, Result.NumMergedSections,
+			Result.MergeMaterialMs, Result.MergeSkeletonMs, Result.MergeMeshMs, Result.CommitMs, Result.TotalMs,
+			Result.MergeMaterialPeakBytes, Result.MergeSkeletonPeakBytes, Result.MergeMeshPeakBytes, Result.CommitPeakBytes,
+			Result.PeakIntermediateBytes, Result.NumReallocations, Result.MergedCPUBytes, Result.MergedGPUBytes, Result.PeakUsedPhysicalDelta);
+	}
+
+	if (!FFileHelper::SaveStringToFile(Csv, *OutputPath))
+	{
+		UE_LOG(LogSkeletalMeshMergeScaling, Error, TEXT("Could not write %s."), *OutputPath);
+		return 1;
+	}
+
+	UE_LOG(LogSkeletalMeshMergeScaling, Display, TEXT("Wrote %d of %d configurations to %s."), Runs.Num() - NumFailed, Runs.Num(), *OutputPath);
+	return NumFailed > 0 ? 1 : 0;
+}
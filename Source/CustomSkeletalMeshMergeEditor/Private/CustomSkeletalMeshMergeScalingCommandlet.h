@@ -0,0 +1,30 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "CustomSkeletalMeshMergeScalingCommandlet.generated.h"
+
+/**
+* Sweeps the part count, vertices per part, bones and LODs of generated parts, see FCustomSkeletalMeshMergeScaling,
+* and writes the time and memory of every merge stage to a CSV file, one row per configuration.
+*
+* Usage: -run=CustomSkeletalMeshMergeScaling -nullrhi [-Parts=2,4,8] [-Vertices=1000,10000] [-Bones=50,100]
+*        [-LODs=1,2] [-Iterations=3] [-Full] [-Output=Saved/Profiling/SkeletalMeshMergeScaling.csv]
+*
+* By default every axis is swept on its own, the others held at FCustomSkeletalMeshMergeScalingConfig's
+* defaults. -Full measures every combination of the axes instead, which takes long with the default axes.
+*/
+UCLASS()
+class UCustomSkeletalMeshMergeScalingCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UCustomSkeletalMeshMergeScalingCommandlet();
+
+	//~ Begin UCommandlet Interface
+	virtual int32 Main(const FString& Params) override;
+	//~ End UCommandlet Interface
+};